@@ -0,0 +1,11 @@
+#pragma once
+
+// Counts calls to the global operator new, which is replaced in allocationCounter.cpp
+// Used to verify that the frame loop doesn't allocate once it has reached a steady state
+// The replacement is only compiled into builds with CHECK_ALLOCATIONS defined, so other builds keep the standard library's
+// operator new; there, the count stays at 0 and isEnabled() returns false
+class AllocationCounter {
+public:
+	static bool isEnabled();
+	static unsigned long long getAllocationCount();
+};
\ No newline at end of file
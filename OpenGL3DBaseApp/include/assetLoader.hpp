@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Reads, decodes and uploads textures and meshes on a thread of its own, so that assets can be added while frames keep rendering
+// The loader thread has its own OpenGL context which shares its objects with the window's context. The objects are created on the
+// main thread and handed out right away; the loader thread only fills them. After each upload, the loader thread puts a fence into
+// its context's command stream and passes the asset back through a lock-free queue. update() takes the asset over once the fence
+// has signaled, i.e. once the GPU has actually finished the upload, which never makes the main thread wait
+// Until then, getTexture() returns a placeholder texture in place of the texture and isMeshResident() returns false
+// Meshes are Wavefront OBJ files of which only the positions, texture coordinates and faces are read; their vertices are laid out
+// like the cube's: 3 floats for the position followed by 2 for the texture coordinates, 3 vertices per triangle
+class AssetLoader {
+public:
+	static void initialize(GLFWwindow& window);
+	static unsigned int loadTexture(const std::string& texturePath);
+	static unsigned int loadMesh(const std::string& meshPath);
+	static void update();
+	static unsigned int getTexture(const unsigned int textureID);
+	static bool isMeshResident(const unsigned int bufferID, unsigned int& vertexCount);
+	static void unloadTexture(const unsigned int textureID);
+	static void unloadMesh(const unsigned int bufferID);
+	static void shutdown();
+
+	static unsigned int getPendingCount();
+	static size_t getResidentMemory();
+};
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include <glm/glm.hpp>
 
 class Camera {
+private:
+	void rotateYawAndPitch(const float yawOffset, const float pitchOffset);
+	void rotateRoll(const float rollOffset);
 public:
 	glm::vec3 cameraPosition;
 	glm::vec3 cameraDirectionVector;
@@ -11,11 +14,14 @@ public:
 	float fov;
 	float moveSpeed, rollSpeed;
 	float mouseSensitivity;
+	float collisionRadius;
+	float aspectRatio;
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
 
 	Camera(const glm::vec3 cameraPosition, const glm::vec3 cameraTarget, const float moveSpeed, const float rollSpeed);
 
-	void updateYawAndPitch(const float yawOffset, const float pitchOffset);
-	void updateRotation(const float rollOffset);
-	void updateViewMatrix() const;
-	void updateProjectionMatrix() const;
+	void update(const glm::vec3& localMovement, const float yawOffset, const float pitchOffset, const float rollOffset);
+	void updateViewMatrix();
+	void updateProjectionMatrix();
 };
\ No newline at end of file
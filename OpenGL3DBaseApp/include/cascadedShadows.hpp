@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "shaders.hpp"
+
+struct CascadeStats {
+	float splitDistance;		// The cascade covers the primary view up to this distance from the camera
+	unsigned int renders;		// Frames in which the shadow map was rendered
+	unsigned int reuses;		// Frames in which the cached shadow map was still valid
+	unsigned int deferrals;		// Frames in which the shadow map was outdated but had to wait for its time slice
+	double gpuMilliseconds;		// Average GPU time of a render
+};
+
+// Shadows of the sun: the primary view's frustum is split into slices by distance and each slice (cascade) gets its own shadow map,
+// so that near shadows get as much resolution as far ones without a huge shadow map
+// Shadow maps are cached and only rendered again if the sun moved, the cascade moved or something in the cascade moved
+class CascadedShadows {
+public:
+	static const unsigned int maxCascadeCount = 4;
+
+	static void initialize(const unsigned int resolution, const unsigned int cascadeCount, const float shadowDistance, const unsigned int timeSliceInterval);
+	static void setOptions(const unsigned int resolution, const unsigned int cascadeCount);
+	static void configureShader(Shader& shader);
+	static void setSun(const glm::vec3& direction, const glm::vec3& color);
+	static void markChanged(const glm::vec3& center, const float radius);
+	static void update(void (*drawShadowCasters)(const bool animated));
+	static void shutdown();
+	static unsigned int getCascadeCount();
+	static const CascadeStats& getStats(const unsigned int cascade);
+	static void resetStats();
+	static void printStats(const std::string& label);
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// The one place the application gets its time from. By default, it follows the real time (glfwGetTime())
+// With a fixed timestep, every frame advances the time by exactly the same amount no matter how long it really took,
+// which makes runs reproducible
+class Clock {
+public:
+	static void setTimeSource(double (*timeSource)());
+	static void useFixedTimestep(const double timestep);
+	static double getFixedTimestep();
+	static void beginFrame();
+	static float getTime();
+	static float getDeltaTime();
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "shaders.hpp"
+
+struct PointLight {
+	glm::vec3 position;		// In world space
+	float radius;			// The light has no effect beyond this distance
+	glm::vec3 color;
+};
+
+// Clustered forward shading: the view frustum is split into a grid of clusters and every cluster gets a list of the lights
+// reaching into it. Fragments then only loop over the lights of their own cluster instead of over all lights of the scene
+class ClusteredLighting {
+public:
+	static void initialize();
+	static void shutdown();
+	static void configureShader(Shader& shader);
+	static void setLights(const std::vector<PointLight>& lights);
+	static void setViewMatrix(const glm::mat4& viewMatrix);
+	static void setProjectionMatrix(const glm::mat4& projectionMatrix);
+	static void update();
+
+	// Standalone tool, runs without a window: reports binning time for increasing light counts
+	static void printBenchmark();
+};
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Axis-aligned bounding box
+struct AABB {
+	glm::vec3 minimum;
+	glm::vec3 maximum;
+};
+
+// Oriented bounding box: a box that is rotated along with the object it bounds
+struct OBB {
+	glm::vec3 center;
+	glm::vec3 halfExtents;	// Half the box's size along each of its axes
+	glm::mat3 axes;			// The box's x, y and z axis as normalized columns
+};
+
+// Two boxes whose bounds overlap, by their indices; first is always the lower index
+struct CollisionPair {
+	unsigned int first;
+	unsigned int second;
+};
+
+// "--collision-benchmark" compares them
+enum class Broadphase {
+	SweepAndPrune,	// Needs no tuning to the objects' sizes; slows down the more objects overlap along the axis it sorts them along
+	SpatialHash,	// Costs the same however far objects move each frame; fastest for many objects of similar size spread across the world
+};
+
+// Finds all pairs of overlapping boxes without testing every box against every other one (which takes N * (N - 1) / 2 tests)
+// The boxes are sorted by their lower end along one axis. Only boxes that start before another box ends along that axis can overlap it,
+// so sweeping through the sorted boxes only tests neighbours. The order is kept between updates: objects that move a little only swap
+// places with a few neighbours, which an insertion sort fixes in close to O(N) ("temporal coherence")
+class SweepAndPrune {
+private:
+	// Every entry holds a copy of its box, so the sweep streams through the entries instead of jumping around in the boxes
+	struct SweepEntry {
+		AABB box;
+		unsigned int index;
+	};
+	std::vector<SweepEntry> entries;
+	std::vector<CollisionPair> pairs;
+	unsigned int axis = 0;
+	// The longest box along the axis, which bounds how far before a query a box may start and still reach into it
+	float maximumExtent = 0.0f;
+	unsigned long long swapCount = 0;
+public:
+	// The boxes have to be the same ones in the same order as during the last update, except for boxes added to the end
+	void update(const std::vector<AABB>& boxes);
+	// Forgets the order, so the next update sorts all boxes from scratch
+	void reset();
+	// Adds the indices of all boxes of the last update that overlap the given box
+	void query(const AABB& box, std::vector<unsigned int>& results) const;
+	const std::vector<CollisionPair>& getPairs() const;
+	// How many places boxes moved during the last update's sort
+	unsigned long long getSwapCount() const;
+};
+
+// Finds all pairs of overlapping boxes by putting every box into the cells of a uniform grid that it touches
+// Only boxes in the same cell are tested against each other. The grid is infinite, as cells are stored in a hash table by
+// their coordinates; it is filled anew every update with a counting sort, so it costs the same no matter how far objects moved
+// Works best if the cells are about as large as the largest boxes
+class SpatialHash {
+private:
+	struct CellEntry {
+		glm::ivec3 cell;
+		unsigned int index;
+	};
+	float cellSize;
+	// Entries of the hash table's bucket i are cellEntries[bucketStarts[i]] up to cellEntries[bucketStarts[i + 1]]
+	std::vector<unsigned int> bucketStarts;
+	std::vector<CellEntry> cellEntries;
+	std::vector<CollisionPair> pairs;
+
+	glm::ivec3 getCell(const glm::vec3& point) const;
+	unsigned int getBucket(const glm::ivec3& cell) const;
+public:
+	explicit SpatialHash(const float cellSize);
+
+	void update(const std::vector<AABB>& boxes);
+	// Adds the indices of all boxes that overlap the given box; they have to be the boxes of the last update
+	void query(const std::vector<AABB>& boxes, const AABB& box, std::vector<unsigned int>& results) const;
+	const std::vector<CollisionPair>& getPairs() const;
+};
+
+// Collision detection between the objects of the scene, and the camera's movement through them
+// Every object is an oriented box (collider). The broadphase finds the pairs of colliders whose bounds overlap,
+// and the narrowphase tests the boxes themselves
+class Collision {
+public:
+	// The spatial hash's cells are cellSize units across
+	static void initialize(const Broadphase broadphase, const float cellSize);
+	static void shutdown();
+	static void setBroadphase(const Broadphase broadphase);
+
+	//* Colliders are numbered from 0 on; the scene sets all of them every frame, then calls update()
+	static void setColliderCount(const unsigned int count);
+	static void setCollider(const unsigned int index, const OBB& box);
+	static void update();
+	// Pairs of colliders whose bounds overlapped during the last update; the boxes themselves may still be apart
+	static const std::vector<CollisionPair>& getPairs();
+
+	//* Narrowphase
+	static bool testOverlap(const AABB& a, const AABB& b);
+	static bool testOverlap(const OBB& a, const OBB& b);
+	static AABB getBounds(const OBB& box);
+	// The box of a unit cube (from -0.5 to 0.5 along each axis) that is transformed by the model matrix
+	static OBB getCubeBox(const glm::mat4& modelMatrix);
+	// Tests a sphere that moves from start to start + movement against the box
+	// Returns the fraction of the movement after which they touch and the box's normal at that point
+	static bool sweepSphere(const glm::vec3& start, const glm::vec3& movement, const float radius, const OBB& box, float& hitFraction, glm::vec3& hitNormal);
+
+	// Shortens the movement of a sphere through the colliders: it stops where it would hit a collider and slides along it instead
+	// Returns whether it hit any; the movement is left untouched if it didn't
+	static bool moveSphere(const glm::vec3& start, glm::vec3& movement, const float radius);
+
+	// Standalone tool, runs without a window: measures how long finding the pairs among 100K moving boxes takes with each broadphase
+	static void printBenchmark();
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Renders the scene into an offscreen target whose resolution follows the GPU frame time: heavy views are rendered at a lower
+// resolution so that the frame rate stays steady, light views go back up to full resolution
+// The result is scaled up to the window with a sharpening filter. The offscreen target is a transient render target of the render graph
+class DynamicResolution {
+public:
+	static void initialize(const float minScale, const float maxScale, const float targetMilliseconds);
+	static void beginFrame();
+	static void upscale(const unsigned int sceneTextureID, const unsigned int sceneTargetWidth, const unsigned int sceneTargetHeight);
+	static void shutdown();
+	static void setEnabled(const bool enabled);
+	static bool isEnabled();
+	static float getSceneTargetScale();
+	static float getScale();
+	static float getGpuMilliseconds();
+	static void getRenderSize(unsigned int& width, unsigned int& height);
+};
\ No newline at end of file
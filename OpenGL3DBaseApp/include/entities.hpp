@@ -0,0 +1,43 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "transforms.hpp"
+
+// Refers to an entity no matter where its data is moved to in the component arrays
+// The generation tells an entity apart from the ones that used the same slot before it, so handles of destroyed entities stay invalid
+struct Entity {
+	unsigned int slot;
+	unsigned int generation;
+};
+
+// Stores all objects of the scene as one array per component ("structure of arrays"), so every loop over the scene only
+// touches the components it needs and streams through contiguous memory
+// Entities are kept grouped by their mesh: all entities of a mesh are next to each other, which makes "all entities of mesh X"
+// a simple range of the arrays. Creating and destroying an entity only moves one entity per mesh, no matter how many there are
+// Indices into the arrays change whenever entities are created or destroyed, handles don't
+class Entities {
+public:
+	static void reserve(const unsigned int entityCount);
+	static Entity create(const unsigned int meshID, const unsigned int materialID, const glm::vec3& position,
+		const glm::vec3& angularVelocity = glm::vec3(0.0f), const float scale = 1.0f, const glm::quat& orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	static Entity createChild(const Entity parent, const unsigned int meshID, const unsigned int materialID, const glm::vec3& position,
+		const glm::vec3& angularVelocity = glm::vec3(0.0f), const float scale = 1.0f, const glm::quat& orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	static void destroy(const Entity entity);
+	static bool isAlive(const Entity entity);
+	static unsigned int getIndex(const Entity entity);
+	static unsigned int getCount();
+	static void getMeshRange(const unsigned int meshID, unsigned int& first, unsigned int& count);
+
+	//* Component arrays, all getCount() elements long and in the same order
+	static const Transform* getTransforms();	// Position, orientation and scale live in the transform hierarchy
+	static glm::vec3* getAngularVelocities();	// Axis of rotation scaled by the speed in radians per second
+	static const unsigned int* getMeshIDs();	// Read only; an entity has to be created anew to change its mesh
+	static unsigned int* getMaterialIDs();
+
+	static void update(const float deltaTime);
+
+	// Standalone tool, runs without a window: measures how many entities can be created, destroyed and updated per second
+	static void printBenchmark();
+};
\ No newline at end of file
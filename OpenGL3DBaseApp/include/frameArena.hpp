@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+// Linear ("bump") allocator for data that only lives for the duration of a single frame
+// Allocating just moves an offset forward; everything is freed at once when the arena is reset at the top of the frame loop
+class FrameArena {
+public:
+	static void initialize(const size_t capacityBytes);
+	static void reset();
+	static void* allocate(const size_t size, const size_t alignment);
+	static size_t getPeakUsage();
+	static unsigned long long getOverflowCount();
+
+	template <typename T>
+	static T* allocateArray(const size_t count) {
+		return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+	}
+};
+
+// Lets standard containers use the frame arena, e.g. std::vector<T, FrameAllocator<T>>
+// Such containers must not outlive the frame they were created in
+template <typename T>
+class FrameAllocator {
+public:
+	typedef T value_type;
+
+	FrameAllocator() {}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(const size_t count) {
+		return FrameArena::allocateArray<T>(count);
+	}
+	// Memory is given back all at once when the arena is reset
+	void deallocate(T*, const size_t) {}
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) {
+	return true;
+}
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) {
+	return false;
+}
\ No newline at end of file
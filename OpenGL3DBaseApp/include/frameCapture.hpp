@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+enum class FrameCaptureFormat {
+	Png,	// One file per frame, losslessly compressed
+	Y4m,	// A single uncompressed YUV 4:2:0 video that video tools read directly; cheap enough to keep up with any frame rate
+};
+
+// Writes every frame to disk without making the render thread wait for the GPU
+// Reading the framebuffer into client memory would wait until the GPU has finished the frame. Instead, each frame is copied into one
+// of a ring of pixel pack buffers (PBOs), which the GPU does in the background, and a fence marks the end of the copy. A few frames later,
+// once the fence has signaled, the buffer is mapped and its pixels are handed to a thread of its own that encodes them and writes them out
+// The render thread only waits if the GPU falls behind by the whole ring, or if the encoder thread falls too far behind; no frame is ever dropped
+// Reads the window's back buffer, so it works wherever the window can be rendered to, including Mesa's software renderer in headless CI
+class FrameCapture {
+public:
+	// For PNG, the path is the start of the files' names, which end in the frame's number: <path>_00000.png etc.
+	// Frames per second only go into the Y4M header
+	static bool start(const std::string& path, const FrameCaptureFormat format, const unsigned int framesPerSecond);
+	// Should be called once the frame has been drawn into the window's back buffer, before the buffers are swapped
+	static void captureFrame();
+	// Writes out every frame that is still on its way and stops the encoder thread. Has to be called while the OpenGL context still exists
+	static void stop();
+	static bool isCapturing();
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+enum class GLObjectType {
+	Buffer,
+	VertexArray,
+	Texture,
+	Renderbuffer,
+	Framebuffer,
+	Program,
+};
+
+// What an object's memory is used for, so the report can tell where the GPU memory goes
+enum class GLMemoryCategory {
+	Geometry,		// Vertex and index data
+	Instances,		// Per-instance data that changes every frame
+	Uniforms,		// Uniform buffers and buffers behind buffer textures
+	Textures,
+	RenderTargets,	// Textures and renderbuffers that are rendered into
+	Staging,		// Memory the CPU writes to for uploads, or reads from after readbacks
+	Shaders,
+};
+
+// Keeps track of every OpenGL object that is alive, and of how many bytes of GPU memory each of them holds
+// Objects register themselves through GLObject below; the sizes are set by whoever allocates the objects' storage
+class GLResources {
+public:
+	static const unsigned int categoryCount = 7;
+
+	static unsigned int createObject(const GLObjectType type, const GLMemoryCategory category, const char* label);
+	static void deleteObject(const GLObjectType type, const unsigned int objectID);
+	static void setSize(const GLObjectType type, const unsigned int objectID, const size_t bytes);
+	static size_t getMemory(const GLMemoryCategory category);
+	static size_t getTotalMemory();
+	static unsigned int getObjectCount();
+	static void printReport();
+	static unsigned int reportLeaks();
+};
+
+// Owns an OpenGL object: creates and registers it on construction, and deletes it when it goes out of scope
+// Can be moved but not copied, as only a single owner may delete the object. A default constructed GLObject is empty (ID 0)
+template <GLObjectType type>
+class GLObject {
+private:
+	unsigned int objectID;
+public:
+	GLObject() : objectID(0) {}
+	// The label shows up in the memory report and in the leak report, so it has to outlive the object (e.g. a string literal)
+	GLObject(const GLMemoryCategory category, const char* label) : objectID(GLResources::createObject(type, category, label)) {}
+	GLObject(GLObject&& other) noexcept : objectID(other.objectID) {
+		other.objectID = 0;
+	}
+	GLObject& operator=(GLObject&& other) noexcept {
+		if (this != &other) {
+			reset();
+			objectID = other.objectID;
+			other.objectID = 0;
+		}
+		return *this;
+	}
+	GLObject(const GLObject&) = delete;
+	GLObject& operator=(const GLObject&) = delete;
+	~GLObject() {
+		reset();
+	}
+
+	void reset() {
+		if (objectID != 0) {
+			GLResources::deleteObject(type, objectID);
+			objectID = 0;
+		}
+	}
+	unsigned int getID() const {
+		return objectID;
+	}
+	// Should be called whenever the object's storage is (re)allocated
+	void setSize(const size_t bytes) const {
+		GLResources::setSize(type, objectID, bytes);
+	}
+};
+
+typedef GLObject<GLObjectType::Buffer> GLBuffer;
+typedef GLObject<GLObjectType::VertexArray> GLVertexArray;
+typedef GLObject<GLObjectType::Texture> GLTexture;
+typedef GLObject<GLObjectType::Renderbuffer> GLRenderbuffer;
+typedef GLObject<GLObjectType::Framebuffer> GLFramebuffer;
+typedef GLObject<GLObjectType::Program> GLProgram;
\ No newline at end of file
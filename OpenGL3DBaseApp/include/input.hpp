@@ -4,9 +4,51 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+// Everything the user can tell the application to do with a key. Keys are bound to actions, and nothing but the input layer
+// knows which key does what. InputFrame stores the actions as one bit each, in this order, so it must not be changed
+enum class InputAction {
+	Quit,
+	ShowWireframe,
+	ShowFilled,
+	ToggleDepthPrepass,
+	CaptureOverdraw,
+	ToggleDynamicResolution,
+	IncreaseBlend,
+	DecreaseBlend,
+	MoveForward,
+	MoveBackward,
+	MoveLeft,
+	MoveRight,
+	RollLeft,
+	RollRight,
+	MoveUp,
+	MoveDown,
+	CycleViewLayout,
+	PrintMemoryReport,
+	ToggleTerrain,
+	ToggleParticles,
+	Count,
+};
+
+// Everything the user did during one frame. Input is applied from this only, so it can be recorded and replayed
+struct InputFrame {
+	unsigned int actions;		// One bit per InputAction, set while a key bound to the action is held down
+	float mouseOffsetX;			// Mouse movement since the last frame in pixels
+	float mouseOffsetY;
+	float scrollOffset;			// Vertical scrolling since the last frame
+};
+
+// Maps keys to actions and applies a frame's actions and mouse movement
+// Everything that moves the camera during a frame is summed up first and applied at once, so the view matrix is rebuilt at most once
+// per frame no matter how many keys are held or how many mouse events arrived
 class Input {
 public:
-	static void processKeyboardInput(GLFWwindow& window, const float deltaTime);
+	static const unsigned int maxKeyBindings = 32;
+
+	static void bindKey(const int keyCode, const InputAction action);
+	static void unbindKey(const int keyCode);
+	static void captureFrame(GLFWwindow& window, InputFrame& frame);
+	static void processFrame(GLFWwindow& window, const InputFrame& frame, const float deltaTime);
 	
 	// Callbacks
 	static void processMouse(GLFWwindow* window, double x, double y);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+#include "input.hpp"
+
+// Writes the input of every frame to a compact binary file and plays such a file back
+// Recording and replay both run at a fixed timestep, so a replay renders exactly the frames of the recorded session
+class InputRecorder {
+public:
+	static bool startRecording(const std::string& path, const double timestep);
+	static bool startReplay(const std::string& path, double& timestep);
+	static void stop();
+	static bool isRecording();
+	static bool isReplaying();
+	static void recordFrame(const InputFrame& frame);
+	static bool replayFrame(InputFrame& frame);
+	static unsigned int getReplayFrameCount();
+};
\ No newline at end of file
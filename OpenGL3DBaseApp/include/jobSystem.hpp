@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+
+struct Job;
+
+// Counts the unfinished jobs that were started with it. Callers can wait for it, and jobs can be made to start only once it is done
+// A counter has to stay alive until all of its jobs are finished, and until all jobs that depend on it have started
+struct JobCounter {
+	std::atomic<unsigned int> pendingJobs;
+	// Jobs that are just finishing and still touch the counter, so waiting has to go on until they are done
+	std::atomic<unsigned int> finishingJobs;
+	// Jobs that start once pendingJobs reaches 0, linked through Job::next
+	std::atomic<Job*> waitingJobs;
+
+	JobCounter() : pendingJobs(0), finishingJobs(0), waitingJobs(nullptr) {}
+	bool isDone() const {
+		return pendingJobs.load() == 0 && finishingJobs.load() == 0;
+	}
+};
+
+// Runs jobs on a fixed set of worker threads
+// Every thread has its own queue of jobs; threads that run out of work steal jobs from the others, so the load evens out by itself
+// Jobs may be started from the main thread (the one that called initialize()) and from other jobs, but not from threads of
+// their own like the asset loader's. Jobs that make OpenGL calls have to run on the main thread,
+// which runs them whenever it waits for a counter and once per frame in runMainThreadJobs()
+class JobSystem {
+public:
+	static void initialize(const unsigned int threadCount);
+	static void shutdown();
+	static unsigned int getThreadCount();
+
+	static void run(void (*function)(void* data), void* data, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	static void runOnMainThread(void (*function)(void* data), void* data, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	static void wait(JobCounter& counter);
+	static void runMainThreadJobs();
+
+	static void parallelFor(const unsigned int count, const unsigned int grainSize,
+		void (*function)(const unsigned int first, const unsigned int last, void* data), void* data);
+
+	// Same as above for lambdas, e.g. parallelFor(count, 64, [&](unsigned int first, unsigned int last) { ... })
+	// The lambda is called for ranges of at most grainSize elements; it may capture by reference as parallelFor() waits for all of them
+	template <typename Function>
+	static void parallelFor(const unsigned int count, const unsigned int grainSize, const Function& function) {
+		parallelFor(count, grainSize, [](const unsigned int first, const unsigned int last, void* data) {
+			(*static_cast<const Function*>(data))(first, last);
+		}, const_cast<Function*>(&function));
+	}
+
+	// Standalone tool, runs without a window: reports how a parallel workload scales from 1 to all threads
+	static void printBenchmark();
+};
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "shaders.hpp"
+
+struct Material {
+	float blendValue;	// How much of the second texture shows through the first one, from 0 to 1
+	glm::vec3 tint;		// Multiplied with the texture color
+};
+
+// Table of all materials, shared with the shaders through a uniform buffer
+// Every instance carries the ID of its material, so instances with different materials can still be drawn with a single draw call
+// Editing a material only changes its entry of the table; all edits of a frame are uploaded together
+class Materials {
+public:
+	static const unsigned int maxMaterialCount = 256;
+
+	static void initialize();
+	static void shutdown();
+	static void configureShader(Shader& shader);
+	static unsigned int create(const Material& material);
+	static void edit(const unsigned int materialID, const Material& material);
+	static const Material& get(const unsigned int materialID);
+	static unsigned int getCount();
+	static void update();
+};
\ No newline at end of file
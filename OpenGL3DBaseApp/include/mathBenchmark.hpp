@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+// Times the math that runs every frame or every input event on the CPU (camera rotations, model matrices, quaternions)
+// Runs without an OpenGL context. Every case is warmed up first, then timed in a number of samples of many iterations each,
+// which gives the mean time per iteration along with its 95% confidence interval
+// The results can be written to a file and compared against the results of an earlier run (the baseline): a case counts as
+// a regression if it is slower than the baseline by more than the threshold even at the fast end of its confidence interval
+class MathBenchmark {
+public:
+	// Returns 1 if any case regressed against the baseline, 0 otherwise. Empty paths skip writing and comparing respectively
+	static int run(const std::string& resultsPath, const std::string& baselinePath, const double thresholdPercent);
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+// Hands out memory for objects of a single type from larger chunks instead of allocating each object on its own
+// Destroyed objects leave their slot in a free list, so creating and destroying objects at runtime never touches the heap
+// once the pool has grown large enough. Objects that are still alive when the pool is destroyed are not destructed
+template <typename T>
+class ObjectPool {
+private:
+	union Slot {
+		Slot* next;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type object;
+	};
+
+	size_t objectsPerChunk;
+	std::vector<std::unique_ptr<Slot[]>> chunks;
+	Slot* freeList;
+
+	void addChunk() {
+		chunks.emplace_back(new Slot[objectsPerChunk]);
+		Slot* chunk = chunks.back().get();
+		for (size_t i = 0; i < objectsPerChunk; i++) {
+			chunk[i].next = i + 1 < objectsPerChunk ? &chunk[i + 1] : freeList;
+		}
+		freeList = chunk;
+	}
+public:
+	explicit ObjectPool(const size_t objectsPerChunk = 64) : objectsPerChunk(objectsPerChunk), freeList(nullptr) {}
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	template <typename... Arguments>
+	T* create(Arguments&&... arguments) {
+		if (freeList == nullptr) {
+			addChunk();
+		}
+		Slot* slot = freeList;
+		freeList = slot->next;
+		// Placement new constructs the object inside the slot instead of allocating memory for it
+		return new (&slot->object) T(std::forward<Arguments>(arguments)...);
+	}
+
+	void destroy(T* object) {
+		if (object == nullptr) {
+			return;
+		}
+		object->~T();
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next = freeList;
+		freeList = slot;
+	}
+};
\ No newline at end of file
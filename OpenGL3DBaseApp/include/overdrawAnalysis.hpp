@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+struct OverdrawResult {
+	double averageOverdraw;		// Fragment writes per pixel, averaged over the pixels that were written at least once
+	unsigned int maxOverdraw;
+	double coverage;			// Share of the pixels that were written at least once
+	unsigned long long fragmentWrites;
+	double gpuMilliseconds;		// Time the GPU spent on the scene
+};
+
+// Renders a frame into an offscreen target whose stencil buffer counts how often every pixel is written
+class OverdrawAnalysis {
+public:
+	static void requestCapture(const std::string& heatmapPath);
+	static void beginFrame();
+	static void endFrame();
+	static void shutdown();
+	static bool getLastResult(OverdrawResult& result);
+};
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+// Where particles are born and how they move, fade and die
+struct ParticleEmitter {
+	glm::vec3 position;
+	float radius;				// Particles are born at random positions within a sphere of this radius
+	glm::vec3 velocity;
+	float velocitySpread;		// A random velocity of up to this length is added to every particle's velocity
+	glm::vec3 acceleration;		// E.g. gravity
+	float drag;					// Share of the velocity that is lost per second
+	float minimumLifetime, maximumLifetime;
+	float emissionRate;			// Particles born per second
+	float size;					// Half the width of a particle's sprite
+	glm::vec4 startColor, endColor;
+};
+
+// Simulates and draws up to millions of particles without touching any of them on the CPU
+// The particles live in two buffers on the GPU. Every update, a vertex shader reads each particle from one buffer, moves it on,
+// and writes it into the other buffer through transform feedback; then the buffers swap roles (ping-pong). Dead particles
+// are born again in the same shader: each update, a window of particles that moves around the buffer like a ring may be reborn,
+// which gives the emitter its rate. The buffer should thus hold at least emissionRate * maximumLifetime particles
+// The emitter's settings reach both shaders through a small uniform buffer. Particles are drawn as camera-facing quads,
+// one instance per particle and view, blended additively on top of the scene
+class ParticleSystem {
+public:
+	static void initialize(const unsigned int particleCount);
+	static void shutdown();
+	static void setEmitter(const ParticleEmitter& emitter);
+	static void update(const float deltaTime);
+	static void render(const unsigned int viewCount);
+
+	// Runs without drawing anything: reports the time a simulation step takes for increasing numbers of particles
+	// Needs an OpenGL context
+	static void printBenchmark();
+};
\ No newline at end of file
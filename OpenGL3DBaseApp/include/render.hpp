@@ -9,22 +9,26 @@
 #include <glm/glm.hpp>
 
 #include "shaders.hpp"
+#include "glResources.hpp"
 
 class Triangle {
 private:
-	unsigned int VAO_ID;
+	GLVertexArray VAO;
+	GLBuffer VBO;
 
 	void initializeVAO(const std::vector<float>& vertices);
 public:
 	Triangle();
 	Triangle(const std::vector<float>& vertices);
+	~Triangle();
 
 	void render();
 };
 
 class Rectangle {
 private:
-	unsigned int VAO_ID;
+	GLVertexArray VAO;
+	GLBuffer VBO, EBO;
 	unsigned int texture1ID;
 	unsigned int texture2ID;
 
@@ -32,39 +36,78 @@ private:
 	void initializeVAO();
 public:
 	Rectangle(const std::string& texture1Path, const std::string& texture2Path);
+	~Rectangle();
 
 	void render();
 };
 
+// A cube whose model matrix is calculated by the vertex shader from these parameters and the frame's time
+// It spins in place around the axis: angle = angularSpeed * time + phase (in radians)
+struct AnimatedCubeInstance {
+	glm::vec3 position;
+	float angularSpeed;
+	glm::vec3 rotationAxis;		// Normalized
+	float phase;
+	float scale;
+	unsigned int materialID;
+};
+
 class Cube {
 private:
-	unsigned int VAO_ID;
+	GLVertexArray VAO;
+	GLBuffer VBO;
+	GLBuffer instanceVBO;
+	unsigned int instanceCapacity;
+	unsigned int instanceCount;
+	unsigned int shadowCasterCount;
+	// The animated cubes are drawn through a second VAO that reads the same vertices, but its instances from a static buffer
+	GLVertexArray animatedVAO;
+	GLBuffer animatedInstanceVBO;
+	unsigned int animatedInstanceCount;
+	glm::vec4 animatedBounds;	// Sphere around all animated cubes; center (xyz) and radius (w)
+	bool animatedInstancesVisible;
 	unsigned int texture1ID;
 	unsigned int texture2ID;
+	// Cubes loaded in the background get their vertices and textures from the asset loader instead of the upload manager
+	// and the texture streamer. Their vertex buffer belongs to the asset loader, so it is only known by its ID
+	bool loadedInBackground;
+	unsigned int vertexBufferID;
+	unsigned int vertexCount;
 
 	void initializeTextures(const std::string& texture1Path, const std::string& texture2Path);
 	void initializeVAO();
-	void calculateModelMatrix(const Shader& shader, const glm::vec3& cubePosition);
+	void initializeInstanceAttributes();
+	void initializeVertexAttributes();
+	void requestTextureResolution(const glm::vec3* cubePositions, const unsigned int cubeCount);
+	bool bindTextures();
 public:
 	Cube(const std::string& texture1Path, const std::string& texture2Path);
+	Cube(const std::string& meshPath, const std::string& texture1Path, const std::string& texture2Path);
+	~Cube();
 
-	void renderMultiple(const Shader& shader, const std::vector<glm::vec3>& cubePositions);
+	void setAnimatedInstances(const std::vector<AnimatedCubeInstance>& instances);
+	void prepareInstances(const unsigned int meshID);
+	void renderInstances(const unsigned int viewCount);
+	void renderAnimatedInstances(const unsigned int viewCount);
+	void renderShadowCasters();
+	void renderAnimatedShadowCasters();
 };
 
 class Plane {
 private:
-	unsigned int VAO_ID;
+	GLVertexArray VAO;
+	GLBuffer VBO, EBO;
 	
 	void initializeVAO();
 public:
 	Plane();
+	~Plane();
 
-	void render();
+	void render(const unsigned int viewCount);
 };
 
 class Render {
 public:
 	static void initialize(GLFWwindow& window);
 	static void clearWindow();
-	static void updateBlendValue(const Shader& shader, const float delta);
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Refer to a render target or buffer and to a pass of the graph, in the order they were added
+typedef unsigned int RenderGraphResource;
+typedef unsigned int RenderGraphPass;
+
+// Format and size of a render target that the graph allocates itself
+struct RenderTargetDescription {
+	unsigned int internalFormat;	// e.g. GL_RGBA8, GL_RGBA16F, GL_R8 or GL_DEPTH24_STENCIL8
+	float scale;					// Size along each axis relative to the graph's reference size, e.g. 0.5 for half resolution
+};
+
+// Describes a frame as passes that declare which render targets and buffers they read and write. From that, compile() works out
+// - which passes can be left out because nothing uses what they write
+// - in which order the passes run so that the framebuffer changes as rarely as possible
+// - which transient render targets and buffers can share the same texture or buffer because they are never needed at the same time
+// Transient resources only live within a frame and are created and allocated by the graph; their content is undefined until a pass
+// writes it. Imported resources live outside of the graph (e.g. the window or the shadow maps) and passes writing them are never left out
+// The graph is built and compiled whenever the frame's structure changes; execute() then runs it every frame without allocating anything
+class RenderGraph {
+public:
+	static void clear();
+	static RenderGraphResource createRenderTarget(const char* name, const RenderTargetDescription& description);
+	static RenderGraphResource createBuffer(const char* name, const size_t bytes);
+	static RenderGraphResource importRenderTarget(const char* name, const unsigned int framebufferID);
+	static RenderGraphResource importResource(const char* name);
+	static RenderGraphPass addPass(const char* name, void (*execute)(void* data), void* data = nullptr);
+	static void read(const RenderGraphPass pass, const RenderGraphResource resource);
+	static void write(const RenderGraphPass pass, const RenderGraphResource resource);
+	static void writeAttachment(const RenderGraphPass pass, const RenderGraphResource resource);
+	static void compile();
+
+	static void setReferenceSize(const unsigned int width, const unsigned int height);
+	static void execute();
+	static unsigned int getTexture(const RenderGraphResource resource);
+	static unsigned int getBuffer(const RenderGraphResource resource);
+	static void getSize(const RenderGraphResource resource, unsigned int& width, unsigned int& height);
+	static void shutdown();
+
+	static void printReport();
+	// Standalone tool, runs without a window: compiles the frame of an example deferred renderer and prints its report
+	static void printExampleReport();
+};
\ No newline at end of file
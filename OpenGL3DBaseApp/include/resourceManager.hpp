@@ -10,12 +10,27 @@
 #include "camera.hpp"
 #include "shaders.hpp"
 
+enum class ViewLayout {
+	Single,				// Only the main camera
+	PictureInPicture,	// The overview camera in a small view in the upper right corner
+	SplitScreen,		// Main camera on the left, overview camera on the right half
+};
+
 class ResourceManager {
 public:
 	static void initialize(GLFWwindow& window);
+	static void shutdown();
 	static void render();
+	static void finishLoading();
+	static void addBackgroundLoadedCubes(const unsigned int count);
 	static Camera& giveCamera();
-	static const std::vector<Shader>& giveShaders();
-	static void setViewMatrix(const glm::mat4& viewMatrix);
-	static void setProjectionMatrix(const glm::mat4& projectionMatrix);
+	static const std::vector<Shader*>& giveShaders();
+	static void setViewLayout(const ViewLayout layout);
+	static ViewLayout getViewLayout();
+	static void setDepthPrepass(const bool enabled);
+	static bool isDepthPrepassEnabled();
+	static void setTerrainEnabled(const bool enabled);
+	static bool isTerrainEnabled();
+	static void setParticlesEnabled(const bool enabled);
+	static bool areParticlesEnabled();
 };
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "shaders.hpp"
+
+// Preprocesses shader sources and keeps every program that has been compiled, so each variant of a shader is only compiled once
+// Shaders may include shared files with #include "file", relative to the including file; every file is included only once per shader
+// Keywords turn into a #define each, right after the #version line. Shaders test them with #ifdef, which compiles a specialized
+// variant per combination of keywords (permutation) instead of branching on a uniform at runtime
+// If the program is built with EMBED_SHADERS defined, the sources come from the embeddedShaders.hpp header instead of the
+// shader files, so starting up reads no shader files at all. The header is written by "OpenGL3DBaseApp --embed-shaders", which
+// has to run again whenever a shader changes
+class ShaderLibrary {
+public:
+	// Returns the shader's source with all includes resolved; files are only read and preprocessed once
+	static const std::string& getSource(const std::string& path);
+	// Returns the source with a #define for every keyword
+	static std::string specialize(const std::string& source, const std::vector<std::string>& keywords);
+	// Returns the program built from the two shaders with the given keywords, compiling it on first use
+	// The program belongs to the library and stays alive until clear()
+	static Shader& getShader(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& keywords = {});
+	// Deletes all programs and forgets the sources. Has to be called while the OpenGL context still exists
+	static void clear();
+
+	// Standalone tool, runs without a window: writes the header with the preprocessed sources of all shaders
+	static bool writeEmbeddedSources(const std::string& outputPath);
+};
\ No newline at end of file
@@ -1,14 +1,20 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <glm/glm.hpp>
 
+#include "glResources.hpp"
+
 class Shader {
 private:
-    unsigned int shaderProgramID;
+    // Deleted along with the Shader, so a Shader can be moved but not copied
+    GLProgram program;
 public:
-    Shader(const std::string& vertexPath, const std::string& fragmentPath);
+    // keywords are defined in both shaders to compile a specialized variant of them, see ShaderLibrary
+    Shader(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& keywords = {});
+    Shader(const std::string& vertexPath, const std::vector<const char*>& feedbackOutputs);
 
     void use() const;
     void setBool(const std::string& name, bool value) const;
@@ -20,6 +26,9 @@ public:
     void setMat2(const std::string& name, const glm::mat2& value) const;
     void setMat3(const std::string& name, const glm::mat3& value) const;
     void setMat4(const std::string& name, const glm::mat4& value) const;
+    void setMat4(const int location, const glm::mat4& value) const;
+
+    int getUniformLocation(const char* name) const;
 
     unsigned int getShaderProgramID();
 };
\ No newline at end of file
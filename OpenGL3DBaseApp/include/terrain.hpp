@@ -0,0 +1,29 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "shaders.hpp"
+
+// Hilly terrain around the scene whose level of detail (LOD) follows the distance from the camera (CDLOD)
+// The terrain is split into a quadtree of nodes; every level up, the nodes are twice as large and are used up to twice the distance.
+// Each frame, the nodes that are close enough for their level and visible in a view are selected, and every selected node is drawn
+// as the same grid mesh, instanced, scaled to the node's size. The vertex shader samples the heights from textures and morphs each
+// vertex into the grid of the next coarser level as it nears the end of its level's range, so the LOD changes without any cracks or popping
+// The heights come from a coarse heightmap of the whole terrain that is always resident, and from detailed tiles for the levels
+// close to the camera. The tiles are generated by jobs, streamed into a fixed number of slots of an atlas texture, and evicted
+// in least recently used order; until a tile is resident, its area falls back to the coarse heightmap
+class Terrain {
+public:
+	// terrainSize is the length of the terrain's sides; it is rounded up to the next power of two that can be split into whole tiles
+	static void initialize(const float terrainSize, const unsigned int tileCacheSize);
+	static void shutdown();
+	static void configureShader(Shader& shader);
+	static void update(const glm::vec3& cameraPosition);
+	static void render(const Shader& shader, const unsigned int viewCount);
+
+	// Standalone tool, runs without a window: reports the vertices drawn per frame for different terrain sizes
+	static void printReport();
+};
\ No newline at end of file
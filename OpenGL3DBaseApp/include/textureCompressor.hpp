@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+enum class CompressedFormat {
+	None,		// Uncompressed GL_RGB / GL_RGBA, used as fallback
+	BC1,		// RGB, 4 bits per pixel (also known as DXT1 / S3TC)
+	BC3,		// RGBA, 8 bits per pixel (also known as DXT5 / S3TC)
+	BC7,		// RGBA, 8 bits per pixel (also known as BPTC), best quality of the desktop formats
+	ETC2_RGB,	// RGB, 4 bits per pixel (also known as ETC2 / ETC1)
+	ETC2_RGBA,	// RGBA, 8 bits per pixel (ETC2 color with EAC alpha)
+};
+
+enum class CompressionQuality {
+	Fast,	// Bounding box endpoints, used when loading times matter most
+	High,	// Principal axis endpoints with least squares refinement
+};
+
+class TextureCompressor {
+public:
+	static CompressedFormat chooseFormat(const bool hasAlpha, const CompressionQuality quality);
+	static bool isSupported(const CompressedFormat format);
+	static unsigned int getInternalFormat(const CompressedFormat format);
+	static size_t calculateCompressedSize(const int width, const int height, const CompressedFormat format);
+	static bool hasTranslucentPixels(const unsigned char* imageData, const int width, const int height, const int numberOfColorChannels);
+
+	static void compress(const unsigned char* imageData, const int width, const int height, const int numberOfColorChannels,
+		const CompressedFormat format, const CompressionQuality quality, std::vector<unsigned char>& compressedData);
+	static void decompress(const std::vector<unsigned char>& compressedData, const int width, const int height,
+		const CompressedFormat format, std::vector<unsigned char>& rgbaData);
+
+	// Standalone tool, runs without a window: reports encode throughput and PSNR for the given images
+	static void printReport(const std::vector<std::string>& imagePaths);
+};
\ No newline at end of file
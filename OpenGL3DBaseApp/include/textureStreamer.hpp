@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "textureCompressor.hpp"
+
+class TextureStreamer {
+public:
+	static void initialize(const size_t memoryBudgetBytes, const CompressionQuality quality);
+	static unsigned int loadTexture(const std::string& texturePath);
+	static void requestScreenSize(const unsigned int textureID, const float screenSizeInPixels);
+	static void update();
+	static bool isResident(const unsigned int textureID);
+	static void unloadTexture(const unsigned int textureID);
+	static void shutdown();
+
+	static void setMemoryBudget(const size_t memoryBudgetBytes);
+	static unsigned int getPendingCount();
+	static size_t getResidentMemory();
+};
\ No newline at end of file
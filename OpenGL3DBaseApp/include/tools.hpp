@@ -0,0 +1,21 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Command line options of the program: benchmarks, reports and checks, as well as recording, replaying and capturing sessions
+// Tools that don't need the scene run on their own and end the program; the others run the scene and hook into the main loop,
+// where they may change the scene between frames and end the loop once they are done
+// --capture <path> [png|y4m] has to come last; the options before it don't see its arguments
+class Tools {
+public:
+	static void initialize(const int argc, char* argv[]);
+	static bool runWithoutWindow(int& exitCode);
+	static bool parseOptions();
+	static bool runWithoutScene(GLFWwindow& window, int& exitCode);
+	static bool start();
+	static bool beginFrame();
+	static void endFrame();
+	static int finish();
+};
\ No newline at end of file
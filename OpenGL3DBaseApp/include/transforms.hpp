@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Refers to a transform no matter where its data is moved to, like Entity does for entities
+struct Transform {
+	unsigned int slot;
+	unsigned int generation;
+};
+
+// Hierarchy of transforms: every transform has a local position, orientation and scale relative to its parent (if it has one)
+// and a world matrix that combines them with the parent's world matrix
+// Transforms are stored ordered by their depth in the hierarchy, so parents always come before their children and a single
+// pass from front to back calculates all world matrices. Only transforms that changed (or whose parent changed) are calculated:
+// every level keeps a list of them, so the update only looks at the rest of a level if much of it changed anyway.
+// The transforms of a level don't depend on each other, so every level is spread across the job system
+class Transforms {
+public:
+	static const unsigned int maxDepth = 32;
+
+	static Transform create(const glm::vec3& position, const glm::quat& orientation, const float scale);
+	static Transform createChild(const Transform parent, const glm::vec3& position, const glm::quat& orientation, const float scale);
+	static void destroy(const Transform transform);
+	static bool isAlive(const Transform transform);
+
+	static const glm::vec3& getLocalPosition(const Transform transform);
+	static const glm::quat& getLocalOrientation(const Transform transform);
+	static float getLocalScale(const Transform transform);
+	static void setLocalPosition(const Transform transform, const glm::vec3& position);
+	static void setLocalOrientation(const Transform transform, const glm::quat& orientation);
+	static void setLocalScale(const Transform transform, const float scale);
+
+	static const glm::mat4& getWorldMatrix(const Transform transform);
+	static bool hasChanged(const Transform transform);
+	static void update();
+
+	// Standalone tool, runs without a window: measures the update of a large hierarchy depending on how much of it changed
+	static void printBenchmark();
+};
\ No newline at end of file
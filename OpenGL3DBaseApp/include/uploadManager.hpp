@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Queues buffer and texture uploads and copies them to the GPU through a staging buffer, a limited amount of bytes per frame
+// Uploads complete in the order they were queued; onComplete is called once the data is resident on the GPU
+// Whoever deletes an object has to cancel its uploads first, as its ID may be handed out again right away
+class UploadManager {
+public:
+	static void initialize(const size_t stagingBufferBytes, const size_t uploadBudgetBytesPerFrame);
+	static void uploadBuffer(const unsigned int bufferID, const void* data, const size_t size, const std::function<void()>& onComplete);
+	static void uploadTexture(const unsigned int textureID, const int level, const int width, const int height, const unsigned int format,
+		const bool compressed, const void* data, const size_t size, const std::function<void()>& onComplete);
+	static void uploadTextureRegion(const unsigned int textureID, const int level, const int x, const int y, const int width, const int height,
+		const unsigned int format, const unsigned int pixelType, const void* data, const size_t size, const std::function<void()>& onComplete);
+	static void cancelBufferUploads(const unsigned int bufferID);
+	static void cancelTextureUploads(const unsigned int textureID);
+	static void update();
+	static void shutdown();
+
+	static void setUploadBudget(const size_t uploadBudgetBytesPerFrame);
+	static size_t getUploadBudget();
+	static size_t getQueuedBytes();
+	static bool isIdle();
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+// Always include GLAD before GLFW or anything else that requires OpenGL
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include "camera.hpp"
+
+// A camera shown in a rectangle of the render target
+struct View {
+	Camera* camera;
+	glm::vec4 viewport;		// x, y, width and height as shares of the render target; (0, 0) is the lower left corner
+};
+
+// Manages all views that are rendered each frame (e.g. split-screen or picture-in-picture)
+// The scene is traversed once per frame for all views: objects are culled against the union of the view frusta and
+// drawn instanced, with one instance per view. Views whose viewports don't overlap share a single pass this way
+class Views {
+public:
+	static const unsigned int maxViewCount = 4;
+
+	static void initialize();
+	static void shutdown();
+	static void clearViews();
+	static void addView(Camera& camera, const glm::vec4& viewport);
+	static unsigned int getViewCount();
+	static const View& getView(const unsigned int index);
+	static void updateAspectRatios();
+	static void update();
+	static bool isVisible(const glm::vec3& center, const float radius);
+	static unsigned int getPassCount();
+	static unsigned int beginPass(const unsigned int pass);
+	static void endPasses();
+};
\ No newline at end of file
@@ -7,6 +7,8 @@
 class Window {
 public:
 	static GLFWwindow& initialize();
+	static GLFWwindow* createSharedContext(GLFWwindow& window);
 	static void getMonitorScreenSize(unsigned int& width, unsigned int& height);
 	static float getAspectRatio();
+	static void getFramebufferSize(unsigned int& width, unsigned int& height);
 };
\ No newline at end of file
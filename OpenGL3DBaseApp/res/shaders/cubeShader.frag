@@ -1,21 +1,38 @@
 #version 330 core
 in vec2 vertexTexturePosition;
+in vec3 vertexViewPosition;
+in vec4 vertexClusterPosition;
+flat in uint vertexMaterialID;
 
 // For good reason, we start numbering at 0
 // This way, our numbers will match up with OpenGL's which reduces room for errors
 uniform sampler2D texture0;
 uniform sampler2D texture1;
 
-uniform float blendValue;
+// Table of all materials, see Materials
+// Every material takes a single vec4: the tint in rgb, the blend value between the two textures in a
+layout (std140) uniform materials {
+	vec4 materialData[256];
+};
+
+#include "include/lighting.glsl"
 
 out vec4 fragColor;
 
 void main() {
+	vec4 material = materialData[vertexMaterialID];
+
 	// The mix function blends the textures by using the modifier given as third argument.
 	// texture() assisgns a texture to the specified texture coordinates
 	// The higher the value, the higher the influence of the second texture
-	fragColor = mix(
+	vec4 textureColor = mix(
 		texture(texture0, vertexTexturePosition),
 		texture(texture1, vertexTexturePosition),
-		blendValue);
+		material.a);
+	textureColor.rgb *= material.rgb;
+
+	// Our vertices don't have normals, but the cube's faces are flat
+	// So the face normal is the cross product of how the position changes from one pixel to the next in x and y
+	vec3 viewNormal = normalize(cross(dFdx(vertexViewPosition), dFdy(vertexViewPosition)));
+	fragColor = vec4(textureColor.rgb * calculateLighting(vertexViewPosition, viewNormal, vertexClusterPosition), textureColor.a);
 }
\ No newline at end of file
@@ -1,22 +1,64 @@
 #version 330 core
 layout (location = 0) in vec3 givenPosition;
 layout (location = 1) in vec2 givenTexturePosition;
+// The model matrix comes from the instance buffer: each cube is one instance per view, see Cube::renderInstances()
+// A mat4 attribute takes up 4 locations (2 to 5), one for each column
+layout (location = 2) in mat4 givenModelMatrix;
+// Index of the cube's material in the material table, also from the instance buffer
+layout (location = 6) in uint givenMaterialID;
+// Cubes that are animated on the GPU are drawn with the ANIMATED variant, which takes their animation parameters (locations 7 to 9)
+// instead of a model matrix
+// The include also declares the "matrices" uniform block
+#include "include/animation.glsl"
 
-uniform mat4 modelMatrix;
-
-// Uniform buffer object (UBO) that stores matrices that can be shared between shaders
-layout (std140) uniform matrices {
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
-};
-
+// The depth pre-pass variant (DEPTH_ONLY) leaves out everything that is only needed for shading
+#ifndef DEPTH_ONLY
 // vertexColor isn't actually used anymore, I left it in here for possible later use
 out vec3 vertexColor;
 out vec2 vertexTexturePosition;
+// Position in the primary view's space (= relative to its camera), needed for lighting as the lights are binned for the primary view
+out vec3 vertexViewPosition;
+// Position in the primary view's clip space, used to find the light cluster
+out vec4 vertexClusterPosition;
+// Integers can't be interpolated between vertices, so every fragment gets the value of the triangle's last vertex ("flat")
+flat out uint vertexMaterialID;
+#endif
+// Keeps the vertex inside of its view's viewport
+out float gl_ClipDistance[4];
+
+// Guarantees that this shader computes exactly the same positions in every program it is linked into
+// Needed for the depth pre-pass, where the shading pass only draws fragments whose depth is equal to the pre-pass' depth
+invariant gl_Position;
 
 void main() {
+	// All views of a pass are drawn at once: instance 0 is the first cube in the first view, instance 1 the first cube in the second view etc.
+	int view = passViews.x + gl_InstanceID % passViews.y;
+
 	// Follows the classic OpenGL Model-View-Projection-Matrix style
 	// Remember that matrix multiplications are read from right to left
-	gl_Position = projectionMatrix * viewMatrix * modelMatrix * vec4(givenPosition, 1.0f);
+#ifdef ANIMATED
+	mat4 modelMatrix = calculateAnimatedModelMatrix();
+#else
+	mat4 modelMatrix = givenModelMatrix;
+#endif
+	vec4 worldPosition = modelMatrix * vec4(givenPosition, 1.0f);
+	vec4 clipPosition = projectionMatrices[view] * viewMatrices[view] * worldPosition;
+
+	//* Squeeze the view into its viewport
+	// Everything outside of [-w, w] would end up in a neighbouring viewport, so it is clipped away
+	gl_ClipDistance[0] = clipPosition.w + clipPosition.x;
+	gl_ClipDistance[1] = clipPosition.w - clipPosition.x;
+	gl_ClipDistance[2] = clipPosition.w + clipPosition.y;
+	gl_ClipDistance[3] = clipPosition.w - clipPosition.y;
+	// Scaling and offsetting x and y after the division by w is the same as doing it to x / w and y / w
+	clipPosition.xy = clipPosition.xy * viewportTransforms[view].xy + viewportTransforms[view].zw * clipPosition.w;
+	gl_Position = clipPosition;
+
+#ifndef DEPTH_ONLY
+	vec4 viewPosition = viewMatrices[0] * worldPosition;
+	vertexViewPosition = viewPosition.xyz;
+	vertexClusterPosition = projectionMatrices[0] * viewPosition;
 	vertexTexturePosition = givenTexturePosition;
+	vertexMaterialID = givenMaterialID;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,5 @@
+#version 330 core
+
+// Used for the depth pre-pass: only the depth of the fragments is written, so there is nothing to compute here
+void main() {
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+// Spins cubes that are animated on the GPU, see Cube::setAnimatedInstances()
+// Only the ANIMATED variant of a shader reads the animation parameters; the other one takes a model matrix per cube instead
+#include "matrices.glsl"
+
+#ifdef ANIMATED
+// Cubes that are animated on the GPU get these instead of a model matrix
+layout (location = 7) in vec4 givenAnimationPositionAndSpeed;	// Position (xyz) and angular speed in radians per second (w)
+layout (location = 8) in vec4 givenAnimationAxisAndPhase;		// Normalized rotation axis (xyz) and angle at time 0 (w)
+layout (location = 9) in float givenAnimationScale;
+
+// Builds the model matrix of an animated cube: scale, then spin around the axis, then move to the position
+mat4 calculateAnimatedModelMatrix() {
+	float angle = givenAnimationPositionAndSpeed.w * animation.x + givenAnimationAxisAndPhase.w;
+	vec3 axis = givenAnimationAxisAndPhase.xyz;
+	float c = cos(angle);
+	float s = sin(angle);
+	// Rotation matrix around an arbitrary axis (Rodrigues' formula), the same one glm::toMat4(glm::angleAxis()) gives us
+	mat3 rotation = (1.0f - c) * outerProduct(axis, axis) + mat3(
+		c, s * axis.z, -s * axis.y,
+		-s * axis.z, c, s * axis.x,
+		s * axis.y, -s * axis.x, c);
+	rotation *= givenAnimationScale;
+	return mat4(vec4(rotation[0], 0.0f), vec4(rotation[1], 0.0f), vec4(rotation[2], 0.0f), vec4(givenAnimationPositionAndSpeed.xyz, 1.0f));
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+// Settings of the particle emitter, shared by the shader that updates the particles and the one that draws them
+// See ParticleSystem::setEmitter()
+layout (std140) uniform emitter {
+	vec4 positionAndRadius;			// Particles are born within a sphere of this radius around the position
+	vec4 velocityAndSpread;			// Velocity at birth, plus a random velocity of up to the spread
+	vec4 accelerationAndDrag;		// Acceleration (xyz) and share of the velocity lost per second (w)
+	vec4 startColor;
+	vec4 endColor;
+	vec4 lifetimeSizeAndTimestep;	// Minimum and maximum lifetime, size, seconds to simulate
+	uvec4 emission;					// First particle that may be reborn, number of them, number of particles, update number
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+// Lighting shared by every lit fragment shader: the clustered point lights, the sun and its shadows
+// See ClusteredLighting and CascadedShadows for the data behind the uniforms
+
+//* Clustered lighting
+// The view frustum is split into a grid of clusters; the CPU lists the lights that reach into each cluster
+// clusterGrid stores the offset and number of lights of every cluster in lightIndices
+// lightData stores two texels per light: view space position and radius, followed by the color
+uniform usamplerBuffer clusterGrid;
+uniform usamplerBuffer lightIndices;
+uniform samplerBuffer lightData;
+
+layout (std140) uniform clusters {
+	uvec4 clusterGridSize;	// Number of clusters along x, y and z
+	vec4 clusterMapping;	// Near plane distance, depth slices per log unit
+	vec3 ambientLight;
+};
+
+//* Shadows of the sun
+// Every cascade has its own layer in the shadow map array; see CascadedShadows
+// Sampling a shadow sampler compares the given depth with the stored one and returns how much of the sun gets through
+uniform sampler2DArrayShadow shadowMaps;
+
+layout (std140) uniform shadows {
+	mat4 cascadeMatrices[4];	// Move positions from the primary view's space into the cascades' shadow maps
+	vec4 sunDirection;			// Points towards the sun, in the primary view's space
+	vec4 sunColor;
+	uvec4 cascadeCount;			// x = number of cascades
+};
+
+// Returns how much of the sun reaches the position: 0 = fully in shadow, 1 = fully lit
+float calculateShadow(vec3 viewPosition) {
+	// Cascades are ordered from near to far, so the first one that contains the position has the most detail
+	for (uint i = 0u; i < cascadeCount.x; i++) {
+		vec3 shadowPosition = (cascadeMatrices[i] * vec4(viewPosition, 1.0f)).xyz;
+		if (all(greaterThan(shadowPosition, vec3(0.0f))) && all(lessThan(shadowPosition, vec3(1.0f)))) {
+			return texture(shadowMaps, vec4(shadowPosition.xy, float(i), shadowPosition.z));
+		}
+	}
+	// Beyond the shadow distance, everything is lit
+	return 1.0f;
+}
+
+vec3 calculateLighting(vec3 viewPosition, vec3 viewNormal, vec4 clusterPosition) {
+	//* The sun lights everything that isn't in its shadow
+	vec3 light = ambientLight + sunColor.rgb * max(dot(viewNormal, sunDirection.xyz), 0.0f) * calculateShadow(viewPosition);
+
+	//* Find the fragment's cluster: x and y are split evenly across the primary view's screen, depth is split logarithmically
+	// The clusters only cover the primary view's frustum; other views only get the sun and the ambient light outside of it
+	vec2 screenPosition = clusterPosition.xy / clusterPosition.w * 0.5f + 0.5f;
+	if (clusterPosition.w <= 0.0f || any(lessThan(screenPosition, vec2(0.0f))) || any(greaterThan(screenPosition, vec2(1.0f)))) {
+		return light;
+	}
+	uvec3 cluster;
+	cluster.xy = uvec2(screenPosition * vec2(clusterGridSize.xy));
+	cluster.z = uint(max(log(-viewPosition.z / clusterMapping.x) * clusterMapping.y, 0.0f));
+	cluster = min(cluster, clusterGridSize.xyz - 1u);
+	uvec2 lightList = texelFetch(clusterGrid, int((cluster.z * clusterGridSize.y + cluster.y) * clusterGridSize.x + cluster.x)).xy;
+
+	//* Only loop over the lights of our cluster
+	for (uint i = 0u; i < lightList.y; i++) {
+		int lightIndex = int(texelFetch(lightIndices, int(lightList.x + i)).x);
+		vec4 positionAndRadius = texelFetch(lightData, lightIndex * 2);
+		vec3 color = texelFetch(lightData, lightIndex * 2 + 1).rgb;
+
+		// Diffuse lighting that smoothly falls off to 0 at the light's radius
+		vec3 toLight = positionAndRadius.xyz - viewPosition;
+		float distance = length(toLight);
+		float falloff = clamp(1.0f - (distance * distance) / (positionAndRadius.w * positionAndRadius.w), 0.0f, 1.0f);
+		light += color * max(dot(viewNormal, toLight / max(distance, 0.0001f)), 0.0f) * falloff * falloff;
+	}
+	return light;
+}
\ No newline at end of file
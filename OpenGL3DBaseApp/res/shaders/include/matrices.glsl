@@ -0,0 +1,9 @@
+// Uniform buffer object (UBO) that stores matrices that can be shared between shaders
+// It holds the matrices of all views, see Views::update()
+layout (std140) uniform matrices {
+	mat4 viewMatrices[4];
+	mat4 projectionMatrices[4];
+	vec4 viewportTransforms[4];	// Scale (xy) and offset (zw) that move normalized device coordinates into the view's viewport
+	ivec4 passViews;			// x = first view of the current pass, y = number of views in the pass
+	vec4 animation;				// x = time at the start of the frame in seconds
+};
\ No newline at end of file
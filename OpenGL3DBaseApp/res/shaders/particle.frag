@@ -0,0 +1,15 @@
+#version 330 core
+in vec2 vertexCorner;
+in vec4 vertexColor;
+
+out vec4 fragColor;
+
+void main() {
+	//* Round sprites that fade out towards their edge
+	float falloff = 1.0f - dot(vertexCorner, vertexCorner);
+	if (falloff <= 0.0f) {
+		discard;
+	}
+	// The particles are added on top of what is behind them, so the alpha goes into the color
+	fragColor = vec4(vertexColor.rgb * vertexColor.a * falloff, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 330 core
+// The particle's state, one instance per particle and view, see ParticleSystem::render()
+layout (location = 0) in vec4 givenPositionAndAge;
+layout (location = 1) in vec4 givenVelocityAndLifetime;
+
+#include "include/matrices.glsl"
+
+#include "include/emitter.glsl"
+
+// Position within the quad, from -1 to 1 along both axes
+out vec2 vertexCorner;
+out vec4 vertexColor;
+// Keeps the vertex inside of its view's viewport
+out float gl_ClipDistance[4];
+
+void main() {
+	// All views of a pass are drawn at once: instance 0 is the first particle in the first view, instance 1 the first particle in the second view etc.
+	int view = passViews.x + gl_InstanceID % passViews.y;
+
+	//* Dead particles are moved out of sight; all 4 corners end up in the same place, so nothing is drawn
+	float life = givenPositionAndAge.w / givenVelocityAndLifetime.w;
+	if (!(life < 1.0f)) {
+		gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+		gl_ClipDistance[0] = gl_ClipDistance[1] = gl_ClipDistance[2] = gl_ClipDistance[3] = -1.0f;
+		vertexCorner = vec2(0.0f);
+		vertexColor = vec4(0.0f);
+		return;
+	}
+
+	//* The corners of a triangle strip: (-1, -1), (1, -1), (-1, 1), (1, 1)
+	// They are spread out in view space, so the quad always faces the camera
+	vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) * 2.0f - 1.0f;
+	vec4 viewPosition = viewMatrices[view] * vec4(givenPositionAndAge.xyz, 1.0f);
+	viewPosition.xy += corner * lifetimeSizeAndTimestep.z;
+	vec4 clipPosition = projectionMatrices[view] * viewPosition;
+
+	//* Squeeze the view into its viewport
+	// Everything outside of [-w, w] would end up in a neighbouring viewport, so it is clipped away
+	gl_ClipDistance[0] = clipPosition.w + clipPosition.x;
+	gl_ClipDistance[1] = clipPosition.w - clipPosition.x;
+	gl_ClipDistance[2] = clipPosition.w + clipPosition.y;
+	gl_ClipDistance[3] = clipPosition.w - clipPosition.y;
+	// Scaling and offsetting x and y after the division by w is the same as doing it to x / w and y / w
+	clipPosition.xy = clipPosition.xy * viewportTransforms[view].xy + viewportTransforms[view].zw * clipPosition.w;
+	gl_Position = clipPosition;
+
+	vertexCorner = corner;
+	// The color fades from the start color to the end color over the particle's life
+	vertexColor = mix(startColor, endColor, life);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#version 330 core
+// The particle's state from the buffer that holds the current state, see ParticleSystem::update()
+layout (location = 0) in vec4 givenPositionAndAge;
+layout (location = 1) in vec4 givenVelocityAndLifetime;
+
+#include "include/emitter.glsl"
+
+// The particle's new state, written into the other buffer through transform feedback
+out vec4 positionAndAge;
+out vec4 velocityAndLifetime;
+
+// Scrambles the bits of x, which makes for cheap random numbers
+uint hash(uint x) {
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+// Random number in [0, 1]; every call moves the state on
+float random(inout uint state) {
+	state = hash(state);
+	return float(state) / 4294967295.0f;
+}
+
+// Random position within a sphere of radius 1, evenly spread
+vec3 randomInSphere(inout uint state) {
+	float y = random(state) * 2.0f - 1.0f;
+	float angle = random(state) * 6.2831853f;
+	vec3 direction = vec3(sqrt(1.0f - y * y) * cos(angle), y, sqrt(1.0f - y * y) * sin(angle));
+	// Without the cube root, the particles would crowd around the center
+	return direction * pow(random(state), 1.0f / 3.0f);
+}
+
+void main() {
+	uint particle = uint(gl_VertexID);
+	float timestep = lifetimeSizeAndTimestep.w;
+
+	//* Living particles move on
+	// In the first update, the buffer's contents are undefined, so every particle counts as dead
+	if (emission.w != 0u && givenPositionAndAge.w < givenVelocityAndLifetime.w) {
+		vec3 velocity = (givenVelocityAndLifetime.xyz + accelerationAndDrag.xyz * timestep) / (1.0f + accelerationAndDrag.w * timestep);
+		positionAndAge = vec4(givenPositionAndAge.xyz + velocity * timestep, givenPositionAndAge.w + timestep);
+		velocityAndLifetime = vec4(velocity, givenVelocityAndLifetime.w);
+	}
+	//* Dead particles within this update's emission window are born again
+	// The window starts at emission.x and may wrap around the end of the buffer
+	else if ((particle + emission.z - emission.x) % emission.z < emission.y) {
+		uint state = hash(particle ^ hash(emission.w));
+		positionAndAge = vec4(positionAndRadius.xyz + randomInSphere(state) * positionAndRadius.w, 0.0f);
+		velocityAndLifetime = vec4(velocityAndSpread.xyz + randomInSphere(state) * velocityAndSpread.w,
+			mix(lifetimeSizeAndTimestep.x, lifetimeSizeAndTimestep.y, random(state)));
+	}
+	//* The others stay dead: an age of 0 reached a lifetime of 0
+	else {
+		positionAndAge = vec4(0.0f);
+		velocityAndLifetime = vec4(0.0f);
+	}
+}
\ No newline at end of file
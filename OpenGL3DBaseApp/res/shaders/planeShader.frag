@@ -1,8 +1,15 @@
 #version 330 core
+in vec4 vertexViewPosition;
+in vec4 vertexClusterPosition;
+
+#include "include/lighting.glsl"
 
 out vec4 fragColor;
 
 void main() {
-	// For now, we leave the floor plane colored in pure white
-	fragColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	// The floor plane is white, so its color is just the light that reaches it
+	// Dividing by w gives us the actual position of the fragment
+	vec3 viewPosition = vertexViewPosition.xyz / vertexViewPosition.w;
+	vec3 viewNormal = normalize(cross(dFdx(viewPosition), dFdy(viewPosition)));
+	fragColor = vec4(calculateLighting(viewPosition, viewNormal, vertexClusterPosition), 1.0f);
 }
\ No newline at end of file
@@ -1,14 +1,43 @@
 #version 330 core
 layout (location = 0) in vec4 givenPosition;
 
-// Uniform buffer object (UBO) that stores matrices that can be shared between shaders
 // We don't need a model matrix, the plane never changes
-layout (std140) uniform matrices {
-	mat4 viewMatrix;
-	mat4 projectionMatrix;
-};
+#include "include/matrices.glsl"
+
+// The depth pre-pass variant (DEPTH_ONLY) leaves out everything that is only needed for shading
+#ifndef DEPTH_ONLY
+// Position in the primary view's space (= relative to its camera), needed for lighting as the lights are binned for the primary view
+// It has to keep its w component as the plane's outer vertices are at infinity (w = 0)
+out vec4 vertexViewPosition;
+// Position in the primary view's clip space, used to find the light cluster
+out vec4 vertexClusterPosition;
+#endif
+// Keeps the vertex inside of its view's viewport
+out float gl_ClipDistance[4];
+
+// Guarantees that this shader computes exactly the same positions in every program it is linked into
+// Needed for the depth pre-pass, where the shading pass only draws fragments whose depth is equal to the pre-pass' depth
+invariant gl_Position;
 
 void main() {
+	// All views of a pass are drawn at once, with one instance per view
+	int view = passViews.x + gl_InstanceID;
+
 	// Remember that matrix multiplications are read from right to left
-	gl_Position = projectionMatrix * viewMatrix * givenPosition;
+	vec4 clipPosition = projectionMatrices[view] * viewMatrices[view] * givenPosition;
+
+	//* Squeeze the view into its viewport
+	// Everything outside of [-w, w] would end up in a neighbouring viewport, so it is clipped away
+	gl_ClipDistance[0] = clipPosition.w + clipPosition.x;
+	gl_ClipDistance[1] = clipPosition.w - clipPosition.x;
+	gl_ClipDistance[2] = clipPosition.w + clipPosition.y;
+	gl_ClipDistance[3] = clipPosition.w - clipPosition.y;
+	// Scaling and offsetting x and y after the division by w is the same as doing it to x / w and y / w
+	clipPosition.xy = clipPosition.xy * viewportTransforms[view].xy + viewportTransforms[view].zw * clipPosition.w;
+	gl_Position = clipPosition;
+
+#ifndef DEPTH_ONLY
+	vertexViewPosition = viewMatrices[0] * givenPosition;
+	vertexClusterPosition = projectionMatrices[0] * vertexViewPosition;
+#endif
 }
\ No newline at end of file
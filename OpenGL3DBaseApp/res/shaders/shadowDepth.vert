@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 givenPosition;
+// The model matrix comes from the cube's instance buffer, just like in the cube shader
+layout (location = 2) in mat4 givenModelMatrix;
+// Or the animation parameters for cubes that are animated on the GPU (ANIMATED variant), just like in the cube shader
+// Only the animation time is needed from the views' "matrices" uniform block, which the include declares as well
+#include "include/animation.glsl"
+
+// The sun's projection matrix * view matrix of the cascade that is rendered, see CascadedShadows::update()
+uniform mat4 lightMatrix;
+
+void main() {
+#ifdef ANIMATED
+	mat4 modelMatrix = calculateAnimatedModelMatrix();
+#else
+	mat4 modelMatrix = givenModelMatrix;
+#endif
+	gl_Position = lightMatrix * modelMatrix * vec4(givenPosition, 1.0f);
+}
\ No newline at end of file
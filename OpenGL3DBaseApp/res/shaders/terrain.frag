@@ -0,0 +1,19 @@
+#version 330 core
+in vec3 vertexViewPosition;
+in vec4 vertexClusterPosition;
+in vec3 vertexWorldPosition;
+
+#include "include/lighting.glsl"
+
+out vec4 fragColor;
+
+void main() {
+	//* The normals come from how the position changes between neighbouring fragments, like for the floor plane
+	vec3 viewNormal = normalize(cross(dFdx(vertexViewPosition), dFdy(vertexViewPosition)));
+	float steepness = 1.0f - abs(normalize(cross(dFdx(vertexWorldPosition), dFdy(vertexWorldPosition))).y);
+
+	//* Grass on flat ground, rock on the slopes and snow on the flatter parts of the peaks
+	vec3 color = mix(vec3(0.35f, 0.5f, 0.25f), vec3(0.45f, 0.42f, 0.4f), smoothstep(0.25f, 0.45f, steepness));
+	color = mix(color, vec3(0.95f), smoothstep(16.0f, 20.0f, vertexWorldPosition.y) * (1.0f - smoothstep(0.4f, 0.6f, steepness)));
+	fragColor = vec4(color * calculateLighting(vertexViewPosition, viewNormal, vertexClusterPosition), 1.0f);
+}
\ No newline at end of file
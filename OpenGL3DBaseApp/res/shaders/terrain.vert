@@ -0,0 +1,102 @@
+#version 330 core
+// Position in the grid, from 0 to 1 along x and z
+layout (location = 0) in vec2 givenGridPosition;
+// The node this instance draws, from the instance buffer: its corner (x and z), its size and its level of detail, see Terrain::update()
+layout (location = 1) in vec4 givenNode;
+
+// We don't need a model matrix, the nodes are placed by the instance buffer
+#include "include/matrices.glsl"
+
+//* Heights
+// The coarse heightmap covers the whole terrain and is always resident
+// The detailed tiles are only resident close to the camera; they are kept in the slots of an atlas, and the table tells which slot
+// holds which tile (-1 if the tile isn't resident)
+uniform sampler2D coarseHeights;
+uniform sampler2D tileAtlas;
+uniform sampler2D tileTable;
+
+uniform vec4 terrainLayout;			// Size of the terrain, size of a tile, slots per row of the atlas, number of levels that use the tiles
+uniform vec3 lodCameraPosition;		// Position the levels of detail are selected for
+uniform vec2 morphRanges[16];		// Distances at which the vertices of each level start and finish morphing into the next level
+uniform float gridDimension;		// Number of quads per side of the grid that is drawn
+
+// The depth pre-pass variant (DEPTH_ONLY) leaves out everything that is only needed for shading
+#ifndef DEPTH_ONLY
+// Position in the primary view's space (= relative to its camera), needed for lighting as the lights are binned for the primary view
+out vec3 vertexViewPosition;
+// Position in the primary view's clip space, used to find the light cluster
+out vec4 vertexClusterPosition;
+out vec3 vertexWorldPosition;
+#endif
+// Keeps the vertex inside of its view's viewport
+out float gl_ClipDistance[4];
+
+// Guarantees that this shader computes exactly the same positions in every program it is linked into
+// Needed for the depth pre-pass, where the shading pass only draws fragments whose depth is equal to the pre-pass' depth
+invariant gl_Position;
+
+// The positions are relative to the terrain's corner
+// The samples sit on the corners of the grid, but texels are sampled at their centers, hence the half texel
+float sampleCoarseHeight(vec2 position) {
+	vec2 size = vec2(textureSize(coarseHeights, 0));
+	return textureLod(coarseHeights, (position / terrainLayout.x * (size - 1.0f) + 0.5f) / size, 0.0f).r;
+}
+
+// Returns false if the position's tile isn't resident
+bool sampleDetailedHeight(vec2 position, out float height) {
+	vec2 tilePosition = position / terrainLayout.y;
+	ivec2 tile = min(ivec2(tilePosition), textureSize(tileTable, 0) - 1);
+	float slot = texelFetch(tileTable, tile, 0).r;
+	if (slot < 0.0f) {
+		return false;
+	}
+	vec2 atlasSize = vec2(textureSize(tileAtlas, 0));
+	float tileSamples = atlasSize.x / terrainLayout.z;
+	vec2 slotCorner = vec2(mod(slot, terrainLayout.z), floor(slot / terrainLayout.z)) * tileSamples;
+	height = textureLod(tileAtlas, (slotCorner + (tilePosition - vec2(tile)) * (tileSamples - 1.0f) + 0.5f) / atlasSize, 0.0f).r;
+	return true;
+}
+
+void main() {
+	// All views of a pass are drawn at once: instance 0 is the first node in the first view, instance 1 the first node in the second view etc.
+	int view = passViews.x + gl_InstanceID % passViews.y;
+	int level = int(givenNode.w);
+	vec2 terrainCorner = vec2(-terrainLayout.x * 0.5f);
+	vec2 position = givenNode.xy + givenGridPosition * givenNode.z;
+
+	//* Morph into the next coarser level towards the end of this level's range
+	// The distance is measured with the coarse heights, which are the same for every node that shares the vertex, so neighbouring nodes agree
+	float distance = length(vec3(position.x, sampleCoarseHeight(position - terrainCorner), position.y) - lodCameraPosition);
+	float morph = clamp((distance - morphRanges[level].x) / (morphRanges[level].y - morphRanges[level].x), 0.0f, 1.0f);
+	// The next level only has every other vertex; the ones in between slide onto their even neighbour
+	vec2 oddOffset = fract(givenGridPosition * gridDimension * 0.5f) * 2.0f / gridDimension;
+	position -= oddOffset * givenNode.z * morph;
+
+	//* Height at the morphed position
+	float height = sampleCoarseHeight(position - terrainCorner);
+	float detailedHeight;
+	if (float(level) < terrainLayout.w && sampleDetailedHeight(position - terrainCorner, detailedHeight)) {
+		// The last level with details fades them out as it morphs into the next level, which only has the coarse heights
+		height = level == int(terrainLayout.w) - 1 ? mix(detailedHeight, height, morph) : detailedHeight;
+	}
+	vec4 worldPosition = vec4(position.x, height, position.y, 1.0f);
+
+	// Remember that matrix multiplications are read from right to left
+	vec4 clipPosition = projectionMatrices[view] * viewMatrices[view] * worldPosition;
+
+	//* Squeeze the view into its viewport
+	// Everything outside of [-w, w] would end up in a neighbouring viewport, so it is clipped away
+	gl_ClipDistance[0] = clipPosition.w + clipPosition.x;
+	gl_ClipDistance[1] = clipPosition.w - clipPosition.x;
+	gl_ClipDistance[2] = clipPosition.w + clipPosition.y;
+	gl_ClipDistance[3] = clipPosition.w - clipPosition.y;
+	// Scaling and offsetting x and y after the division by w is the same as doing it to x / w and y / w
+	clipPosition.xy = clipPosition.xy * viewportTransforms[view].xy + viewportTransforms[view].zw * clipPosition.w;
+	gl_Position = clipPosition;
+
+#ifndef DEPTH_ONLY
+	vertexViewPosition = (viewMatrices[0] * worldPosition).xyz;
+	vertexClusterPosition = projectionMatrices[0] * vec4(vertexViewPosition, 1.0f);
+	vertexWorldPosition = worldPosition.xyz;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#version 330 core
+in vec2 screenPosition;
+
+out vec4 FragColor;
+
+// The scene, rendered into the lower left corner of the texture
+uniform sampler2D sceneTexture;
+// Share of the texture the scene was rendered to
+uniform vec2 sourceScale;
+// Size of one of the texture's pixels in texture coordinates
+uniform vec2 sourceTexelSize;
+#ifdef SHARPEN
+// Strength of the sharpening; without the SHARPEN keyword, the shader is plain bilinear upscaling and doesn't sample any neighbours
+uniform float sharpness;
+#endif
+
+// Reads the scene without ever reaching into the unused part of the texture
+vec3 sampleScene(vec2 position) {
+	return texture(sceneTexture, clamp(position, sourceTexelSize * 0.5, sourceScale - sourceTexelSize * 0.5)).rgb;
+}
+
+void main() {
+	//* Bilinear upscaling
+	vec2 position = screenPosition * sourceScale;
+	vec3 center = sampleScene(position);
+
+#ifdef SHARPEN
+	//* Sharpening
+	// Bilinear filtering blurs edges across the upscaled pixels, so we add back the difference between the pixel and its neighbors
+	vec3 north = sampleScene(position + vec2(0.0, sourceTexelSize.y));
+	vec3 south = sampleScene(position - vec2(0.0, sourceTexelSize.y));
+	vec3 east = sampleScene(position + vec2(sourceTexelSize.x, 0.0));
+	vec3 west = sampleScene(position - vec2(sourceTexelSize.x, 0.0));
+	vec3 sharpened = center + sharpness * (4.0 * center - north - south - east - west);
+
+	// Staying within the range of the neighborhood prevents bright or dark halos around edges
+	vec3 neighborhoodMin = min(center, min(min(north, south), min(east, west)));
+	vec3 neighborhoodMax = max(center, max(max(north, south), max(east, west)));
+	FragColor = vec4(clamp(sharpened, neighborhoodMin, neighborhoodMax), 1.0);
+#else
+	FragColor = vec4(center, 1.0);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 330 core
+
+// Position across the window, from (0, 0) in the lower left to (1, 1) in the upper right corner
+out vec2 screenPosition;
+
+void main() {
+	// A single triangle that covers the whole window, so no vertex data is needed
+	// Vertices 0, 1 and 2 end up at (0, 0), (2, 0) and (0, 2); everything outside of [0, 1] is clipped away
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	screenPosition = position;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+
+#include "allocationCounter.hpp"
+
+//** Private **//
+// Relaxed atomics are enough here as we only ever look at the total
+std::atomic<unsigned long long> allocationCount(0);
+
+//** Public **//
+bool AllocationCounter::isEnabled() {
+#ifdef CHECK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+unsigned long long AllocationCounter::getAllocationCount() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+#ifdef CHECK_ALLOCATIONS
+//* Replacements for the global operator new / delete
+// Defining these anywhere in the program replaces the versions of the standard library. Every variant is replaced, so that
+// none of them can allocate without being counted and memory is always freed by the counterpart of what allocated it
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	// operator new has to return a unique pointer even if no memory is requested
+	if (size == 0) {
+		size = 1;
+	}
+	while (true) {
+		void* memory = std::malloc(size);
+		if (memory != nullptr) {
+			return memory;
+		}
+		// Give the new handler a chance to free some memory, if there is none, report the failure like the default operator new does
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+// The nothrow variants report a failure by returning nullptr instead
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	try {
+		return operator new(size);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+	std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+	std::free(memory);
+}
+
+#ifdef __cpp_aligned_new
+//* Over-aligned types (alignas larger than what malloc guarantees) go through the aligned variants
+// malloc knows nothing about alignment, so we allocate enough to move the block up to the next aligned address
+// and keep the pointer that malloc returned right in front of it, where operator delete finds it again
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	const std::size_t alignmentBytes = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+	void* memory = operator new(size + alignmentBytes + sizeof(void*));
+	const std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(memory) + sizeof(void*) + alignmentBytes - 1) & ~(std::uintptr_t)(alignmentBytes - 1);
+	reinterpret_cast<void**>(aligned)[-1] = memory;
+	return reinterpret_cast<void*>(aligned);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	try {
+		return operator new(size, alignment);
+	}
+	catch (...) {
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+	if (memory != nullptr) {
+		std::free(reinterpret_cast<void**>(memory)[-1]);
+	}
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+	operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+	operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	operator delete(memory, alignment);
+}
+#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,493 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// The implementation of stb_image.h is compiled in textureStreamer.cpp, here we only need its declarations
+#include "STB/stb_image.h"
+
+#include "assetLoader.hpp"
+#include "window.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+enum class AssetType {
+	Texture,
+	Mesh,
+};
+
+// A request to the loader thread, which it fills in and hands back once the asset is uploaded
+// The main thread doesn't touch it in between
+struct AssetLoad {
+	AssetType type;
+	std::string path;
+	unsigned int objectID;		// Texture or buffer that the loader thread fills
+	bool failed;
+	size_t bytes;
+	unsigned int vertexCount;
+	GLsync fence;				// Signals once the GPU has finished the upload
+};
+
+struct LoadedAsset {
+	AssetType type;
+	unsigned int objectID;
+	GLTexture texture;			// Owns the object with the ID above, depending on the type
+	GLBuffer buffer;
+	size_t bytes;
+	unsigned int vertexCount;
+	bool resident;
+	bool loading;				// Whether the loader thread still works on the object
+	bool unloadRequested;		// Unloaded while loading; the object is deleted once the loader thread is done with it
+};
+
+//* Lock-free completion queue from the loader thread to the main thread
+// A ring buffer with a single producer (the loader thread) and a single consumer (the main thread): each side only ever writes
+// its own end. Writing the end with release order publishes the slot written before it to the other side, which reads it with acquire order
+// The capacity has to be a power of 2 so that positions can wrap around with a bit mask
+const unsigned int completionQueueCapacity = 256;
+AssetLoad* completionQueue[completionQueueCapacity];
+std::atomic<unsigned int> completionQueueFront(0), completionQueueBack(0);
+
+//* Requests from the main thread to the loader thread
+// The loader thread sleeps while there is nothing to load, so these go through a mutex; the main thread only ever holds it briefly
+std::mutex loadRequestMutex;
+std::condition_variable loadRequested;
+std::deque<AssetLoad*> loadRequests;
+std::atomic<bool> stopLoaderThread(false);
+
+GLFWwindow* loaderContext = nullptr;
+std::thread loaderThread;
+// Loads whose upload has been issued, but whose fence hasn't signaled yet
+std::vector<AssetLoad*> fencedLoads;
+std::vector<LoadedAsset> loadedAssets;
+GLTexture placeholderTexture;
+size_t assetMemory = 0;
+
+bool pushCompletion(AssetLoad* load) {
+	const unsigned int back = completionQueueBack.load(std::memory_order_relaxed);
+	if (back - completionQueueFront.load(std::memory_order_acquire) == completionQueueCapacity) {
+		return false;
+	}
+	completionQueue[back & (completionQueueCapacity - 1)] = load;
+	completionQueueBack.store(back + 1, std::memory_order_release);
+	return true;
+}
+
+AssetLoad* popCompletion() {
+	const unsigned int front = completionQueueFront.load(std::memory_order_relaxed);
+	if (front == completionQueueBack.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+	AssetLoad* load = completionQueue[front & (completionQueueCapacity - 1)];
+	completionQueueFront.store(front + 1, std::memory_order_release);
+	return load;
+}
+
+LoadedAsset* findAsset(const AssetType type, const unsigned int objectID) {
+	for (unsigned int i = 0; i < loadedAssets.size(); i++) {
+		if (loadedAssets[i].type == type && loadedAssets[i].objectID == objectID) {
+			return &loadedAssets[i];
+		}
+	}
+	return nullptr;
+}
+
+void eraseAsset(const LoadedAsset* asset) {
+	loadedAssets.erase(loadedAssets.begin() + (asset - &loadedAssets[0]));
+}
+
+// Reads an OBJ file into triangles of 5 floats per vertex; faces with more than 3 corners are split into a fan around their first corner
+bool readMesh(const std::string& meshPath, std::vector<float>& vertices) {
+	std::ifstream file(meshPath);
+	if (!file) {
+		std::cout << "Error: Could not open mesh " << meshPath << std::endl;
+		return false;
+	}
+	std::vector<float> positions, textureCoordinates;
+	std::vector<int> corners;
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream stream(line);
+		std::string keyword;
+		stream >> keyword;
+		if (keyword == "v") {
+			float x, y, z;
+			stream >> x >> y >> z;
+			positions.insert(positions.end(), { x, y, z });
+		}
+		else if (keyword == "vt") {
+			float u, v;
+			stream >> u >> v;
+			textureCoordinates.insert(textureCoordinates.end(), { u, v });
+		}
+		else if (keyword == "f") {
+			//* Corners are written as position/texture coordinates(/normal), with indices starting at 1
+			// Negative indices count backwards from the last position or texture coordinate read so far
+			corners.clear();
+			std::string corner;
+			while (stream >> corner) {
+				std::istringstream cornerStream(corner);
+				int position = 0, textureCoordinate = 0;
+				cornerStream >> position;
+				if (cornerStream.peek() == '/') {
+					cornerStream.get();
+					if (cornerStream.peek() != '/') {
+						cornerStream >> textureCoordinate;
+					}
+				}
+				const int positionCount = (int)positions.size() / 3, textureCoordinateCount = (int)textureCoordinates.size() / 2;
+				position = position < 0 ? positionCount + position : position - 1;
+				textureCoordinate = textureCoordinate < 0 ? textureCoordinateCount + textureCoordinate : textureCoordinate - 1;
+				if (position < 0 || position >= positionCount || textureCoordinate >= textureCoordinateCount) {
+					std::cout << "Error: Mesh " << meshPath << " refers to a vertex that doesn't exist" << std::endl;
+					return false;
+				}
+				corners.push_back(position);
+				corners.push_back(textureCoordinate);
+			}
+			for (unsigned int i = 2; i < corners.size() / 2; i++) {
+				const unsigned int triangle[3] = { 0, i - 1, i };
+				for (unsigned int corner : triangle) {
+					const int position = corners[2 * corner], textureCoordinate = corners[2 * corner + 1];
+					vertices.insert(vertices.end(), positions.begin() + 3 * position, positions.begin() + 3 * position + 3);
+					// Corners without texture coordinates get (0, 0)
+					if (textureCoordinate < 0) {
+						vertices.insert(vertices.end(), { 0.0f, 0.0f });
+					}
+					else {
+						vertices.insert(vertices.end(), textureCoordinates.begin() + 2 * textureCoordinate, textureCoordinates.begin() + 2 * textureCoordinate + 2);
+					}
+				}
+			}
+		}
+	}
+	if (vertices.empty()) {
+		std::cout << "Error: Mesh " << meshPath << " has no faces" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Runs on the loader thread: decodes the image and uploads it with a full mip chain
+void uploadTexture(AssetLoad& load) {
+	int width, height, numberOfColorChannels;
+	unsigned char* imageData = stbi_load(load.path.c_str(), &width, &height, &numberOfColorChannels, 0);
+	if (!imageData || (numberOfColorChannels != 3 && numberOfColorChannels != 4)) {
+		std::cout << "Error: Failed to load texture " << load.path << std::endl;
+		stbi_image_free(imageData);
+		load.failed = true;
+		return;
+	}
+	// 3 color channels means no alpha channel, 4 means there is one
+	const unsigned int rgbType = numberOfColorChannels == 4 ? GL_RGBA : GL_RGB;
+
+	glBindTexture(GL_TEXTURE_2D, load.objectID);
+	glTexImage2D(GL_TEXTURE_2D, 0, rgbType, width, height, 0, rgbType, GL_UNSIGNED_BYTE, imageData);
+	// The driver calculates the smaller mip levels on the GPU, which is about as cheap as uploading them
+	glGenerateMipmap(GL_TEXTURE_2D);
+	//* The sampler state is set here as well, so that the fence covers it along with the image
+	// Had the main context set it, nothing would guarantee that this context sees it before the upload
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	// Unbinding lets the texture go as soon as the main thread deletes it
+	glBindTexture(GL_TEXTURE_2D, 0);
+	stbi_image_free(imageData);
+
+	// The mip chain adds a third to the size of the full resolution
+	load.bytes = (size_t)width * height * numberOfColorChannels * 4 / 3;
+}
+
+// Runs on the loader thread: reads the mesh and uploads its vertices
+void uploadMesh(AssetLoad& load) {
+	std::vector<float> vertices;
+	if (!readMesh(load.path, vertices)) {
+		load.failed = true;
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, load.objectID);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	load.bytes = vertices.size() * sizeof(float);
+	load.vertexCount = (unsigned int)vertices.size() / 5;
+}
+
+// Uploads the asset on whichever context is current and puts a fence behind the upload
+void processLoad(AssetLoad& load) {
+	if (load.type == AssetType::Texture) {
+		uploadTexture(load);
+	}
+	else {
+		uploadMesh(load);
+	}
+	// Sync objects are shared between the contexts, so the main thread can ask this fence whether the GPU is done with the upload
+	load.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	// The commands only reach the GPU once the context flushes them; without this, the fence might never signal for the main thread
+	glFlush();
+}
+
+void runLoaderThread() {
+	//* Contexts are current on one thread at a time, the main thread's context stays with the main thread
+	// GLAD's function pointers are shared by both contexts as they are created alike
+	glfwMakeContextCurrent(loaderContext);
+	// Rows of RGB images aren't padded to 4 bytes; this only changes the loader's context
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	while (true) {
+		AssetLoad* load;
+		{
+			std::unique_lock<std::mutex> lock(loadRequestMutex);
+			loadRequested.wait(lock, []() { return stopLoaderThread || !loadRequests.empty(); });
+			if (stopLoaderThread) {
+				break;
+			}
+			load = loadRequests.front();
+			loadRequests.pop_front();
+		}
+
+		processLoad(*load);
+
+		//* Hand the asset back; should the main thread fall that far behind, wait for it to make room
+		while (!pushCompletion(load)) {
+			// The main thread doesn't take anything over anymore once it shuts down
+			if (stopLoaderThread) {
+				glDeleteSync(load->fence);
+				delete load;
+				break;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+// Runs on the main thread once the fence of a load has signaled
+void finishLoad(AssetLoad& load) {
+	LoadedAsset* asset = findAsset(load.type, load.objectID);
+	asset->loading = false;
+	if (asset->unloadRequested) {
+		eraseAsset(asset);
+		return;
+	}
+	// Failed assets stay what they were until then: a placeholder texture or a mesh that isn't drawn
+	if (load.failed) {
+		return;
+	}
+
+	//* Changes made in another context are only guaranteed to be visible once the object is bound again in this one
+	if (load.type == AssetType::Texture) {
+		glBindTexture(GL_TEXTURE_2D, asset->objectID);
+		asset->texture.setSize(load.bytes);
+	}
+	else {
+		glBindBuffer(GL_ARRAY_BUFFER, asset->objectID);
+		asset->buffer.setSize(load.bytes);
+	}
+	asset->bytes = load.bytes;
+	asset->vertexCount = load.vertexCount;
+	asset->resident = true;
+	assetMemory += load.bytes;
+}
+
+// Creates the record of an asset on the main thread, as objects must only be created and registered here, and queues its load
+void requestLoad(LoadedAsset&& asset, const std::string& path) {
+	asset.bytes = 0;
+	asset.vertexCount = 0;
+	asset.resident = false;
+	asset.loading = true;
+	asset.unloadRequested = false;
+
+	AssetLoad* load = new AssetLoad();
+	load->type = asset.type;
+	load->path = path;
+	load->objectID = asset.objectID;
+	load->failed = false;
+	load->bytes = 0;
+	load->vertexCount = 0;
+	load->fence = nullptr;
+	loadedAssets.push_back(std::move(asset));
+
+	{
+		std::lock_guard<std::mutex> lock(loadRequestMutex);
+		loadRequests.push_back(load);
+	}
+	loadRequested.notify_one();
+}
+
+void unloadAsset(const AssetType type, const unsigned int objectID) {
+	LoadedAsset* asset = findAsset(type, objectID);
+	if (asset == nullptr) {
+		return;
+	}
+	//* An object the loader thread may still write to can't be deleted yet: its ID could be handed out again right away
+	if (asset->loading) {
+		asset->unloadRequested = true;
+		return;
+	}
+	assetMemory -= asset->bytes;
+	eraseAsset(asset);
+}
+
+//** Public **//
+// Has to be called after the window has been created, on the main thread
+void AssetLoader::initialize(GLFWwindow& window) {
+	//* The placeholder stands in for every texture until it has arrived: a single mid gray texel
+	placeholderTexture = GLTexture(GLMemoryCategory::Textures, "Placeholder texture");
+	const unsigned char gray[4] = { 128, 128, 128, 255 };
+	glBindTexture(GL_TEXTURE_2D, placeholderTexture.getID());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, gray);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	placeholderTexture.setSize(4);
+
+	//* Without a second context, the main thread loads one asset per frame itself in update()
+	stopLoaderThread = false;
+	loaderContext = Window::createSharedContext(window);
+	if (loaderContext != nullptr) {
+		loaderThread = std::thread(runLoaderThread);
+	}
+}
+
+// Starts loading a texture and returns its ID right away. Until it has arrived, getTexture() returns the placeholder in its place
+unsigned int AssetLoader::loadTexture(const std::string& texturePath) {
+	LoadedAsset asset;
+	asset.type = AssetType::Texture;
+	asset.texture = GLTexture(GLMemoryCategory::Textures, "Background loaded texture");
+	asset.objectID = asset.texture.getID();
+	// The loader thread sets the sampler state along with the image; this context only binds the texture once it has arrived
+
+	const unsigned int textureID = asset.objectID;
+	requestLoad(std::move(asset), texturePath);
+	return textureID;
+}
+
+// Starts loading a mesh and returns the ID of the vertex buffer it is loaded into right away
+// The buffer has no storage until isMeshResident() returns true, so VAOs should only point to it from then on
+unsigned int AssetLoader::loadMesh(const std::string& meshPath) {
+	LoadedAsset asset;
+	asset.type = AssetType::Mesh;
+	asset.buffer = GLBuffer(GLMemoryCategory::Geometry, "Background loaded mesh");
+	asset.objectID = asset.buffer.getID();
+
+	const unsigned int bufferID = asset.objectID;
+	requestLoad(std::move(asset), meshPath);
+	return bufferID;
+}
+
+// Takes over the assets whose uploads the GPU has finished. Should be called once per frame
+void AssetLoader::update() {
+	//* Without a loader thread, one queued asset is loaded per frame
+	if (loaderContext == nullptr && !loadRequests.empty()) {
+		AssetLoad* load = loadRequests.front();
+		loadRequests.pop_front();
+		processLoad(*load);
+		fencedLoads.push_back(load);
+	}
+
+	//* Collect everything the loader thread has finished uploading
+	AssetLoad* completedLoad;
+	while ((completedLoad = popCompletion()) != nullptr) {
+		fencedLoads.push_back(completedLoad);
+	}
+
+	//* Take over the assets whose fences have signaled
+	for (unsigned int i = 0; i < fencedLoads.size();) {
+		AssetLoad* load = fencedLoads[i];
+		// A timeout of 0 only asks whether the fence has signaled, without ever waiting for it
+		const GLenum status = glClientWaitSync(load->fence, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			i++;
+			continue;
+		}
+		glDeleteSync(load->fence);
+		finishLoad(*load);
+		delete load;
+		fencedLoads.erase(fencedLoads.begin() + i);
+	}
+}
+
+// Returns the texture if it has arrived, the placeholder texture otherwise. Textures that failed to load stay the placeholder
+unsigned int AssetLoader::getTexture(const unsigned int textureID) {
+	const LoadedAsset* asset = findAsset(AssetType::Texture, textureID);
+	return asset != nullptr && asset->resident ? textureID : placeholderTexture.getID();
+}
+
+bool AssetLoader::isMeshResident(const unsigned int bufferID, unsigned int& vertexCount) {
+	const LoadedAsset* asset = findAsset(AssetType::Mesh, bufferID);
+	if (asset == nullptr || !asset->resident) {
+		return false;
+	}
+	vertexCount = asset->vertexCount;
+	return true;
+}
+
+// Deletes the texture. Its ID must not be used anymore afterwards
+void AssetLoader::unloadTexture(const unsigned int textureID) {
+	unloadAsset(AssetType::Texture, textureID);
+}
+
+// Deletes the mesh's vertex buffer. Its ID must not be used anymore afterwards
+void AssetLoader::unloadMesh(const unsigned int bufferID) {
+	unloadAsset(AssetType::Mesh, bufferID);
+}
+
+// Stops the loader thread and deletes all assets. Has to be called while the main thread's context still exists
+void AssetLoader::shutdown() {
+	//* Stop the loader thread; it finishes the asset it is working on, but doesn't start another one
+	if (loaderThread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(loadRequestMutex);
+			stopLoaderThread = true;
+		}
+		loadRequested.notify_one();
+		loaderThread.join();
+	}
+
+	//* Drop all loads that haven't been taken over yet
+	for (AssetLoad* load : loadRequests) {
+		delete load;
+	}
+	loadRequests.clear();
+	AssetLoad* completedLoad;
+	while ((completedLoad = popCompletion()) != nullptr) {
+		fencedLoads.push_back(completedLoad);
+	}
+	for (AssetLoad* load : fencedLoads) {
+		glDeleteSync(load->fence);
+		delete load;
+	}
+	fencedLoads.clear();
+
+	//* The loader's context goes last, once no thread can use it anymore
+	if (loaderContext != nullptr) {
+		glfwDestroyWindow(loaderContext);
+		loaderContext = nullptr;
+	}
+	loadedAssets.clear();
+	placeholderTexture.reset();
+	assetMemory = 0;
+}
+
+// Number of assets that haven't arrived yet
+unsigned int AssetLoader::getPendingCount() {
+	unsigned int pendingCount = 0;
+	for (const LoadedAsset& asset : loadedAssets) {
+		if (asset.loading) {
+			pendingCount++;
+		}
+	}
+	return pendingCount;
+}
+
+// Bytes of GPU memory taken up by the assets that have arrived
+size_t AssetLoader::getResidentMemory() {
+	return assetMemory;
+}
\ No newline at end of file
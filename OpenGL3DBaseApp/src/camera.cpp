@@ -2,7 +2,6 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include "camera.hpp"
-#include "resourceManager.hpp"
 #include "window.hpp"
 
 //** Private **//
@@ -16,6 +15,10 @@ Camera::Camera(const glm::vec3 cameraPosition, const glm::vec3 cameraTarget, con
 
 	fov = 45.0f;
 	mouseSensitivity = 0.1f;
+	// Larger than the distance of the near plane's corners, so the near plane never cuts into an object the camera collides with
+	collisionRadius = 0.2f;
+	// Views set this to the shape of their viewport
+	aspectRatio = Window::getAspectRatio();
 
 	/// The initial up vector is the cross product of the direction vector and a right vector which simply points towards positive x
 	// Normalization ensures that vertical strafing always has the same speed
@@ -26,8 +29,8 @@ Camera::Camera(const glm::vec3 cameraPosition, const glm::vec3 cameraTarget, con
 	cameraRightVector = glm::normalize(glm::cross(cameraDirectionVector, cameraUpVector));
 }
 
-// Changes the camera's direction
-void Camera::updateYawAndPitch(const float yawOffset, const float pitchOffset) {
+// Turns the camera's vectors without rebuilding the view matrix, so several changes can share a single rebuild
+void Camera::rotateYawAndPitch(const float yawOffset, const float pitchOffset) {
 	// We'll use quaternions for rotations as they save at least 50% computation time over Euler rotations
 	// Note, and this is very important: Quaternions do, in any case, need a normalized vector! Or else they will behave very weirdly
 
@@ -53,9 +56,6 @@ void Camera::updateYawAndPitch(const float yawOffset, const float pitchOffset) {
 	glm::mat4 combinedRotationMatrix = glm::toMat4(combinedQuaternion);
 	cameraDirectionVector = glm::normalize(glm::vec3(combinedRotationMatrix * glm::vec4(cameraDirectionVector, 1.0f)));
 
-	// Since the view matrix has changed, we update it
-	updateViewMatrix();
-
 	// Due to this kind of free flight camera implementation, the view will rotate if you look around in circles
 	// Looking 90 up, then 90 left and then 90 down again will roll the camera counter-clockwise by 90
 	// This effect is normal for free flight cameras and if you want to discard it, you have to fix the camera in place
@@ -63,8 +63,8 @@ void Camera::updateYawAndPitch(const float yawOffset, const float pitchOffset) {
 	// and prevent the user from looking too far down / up (= FPS cam)
 }
 
-// Rotates the camera by the amount given
-void Camera::updateRotation(const float rollOffset) {
+// Rolls the camera's vectors around its direction vector without rebuilding the view matrix
+void Camera::rotateRoll(const float rollOffset) {
 	// We'll use quaternions for rotations as they save at least 50% computation time over Euler rotations
 	// Note, and this is very important: Quaternions do, in any case, need a normalized vector! Or else they will behave very weirdly
 
@@ -80,26 +80,37 @@ void Camera::updateRotation(const float rollOffset) {
 	// We need to normalize after the rotation or else the vector will change slightly over time
 	cameraUpVector = glm::normalize(glm::vec3(rotationMatrix * glm::vec4(cameraUpVector, 1.0f)));
 	cameraRightVector = glm::normalize(glm::vec3(rotationMatrix * glm::vec4(cameraRightVector, 1.0f)));
+}
 
-	// Since the view matrix has changed, we update it
+// Applies everything that moved the camera during a frame at once
+// localMovement is the distance to move along the camera's right, up and direction vector; the rotations are in degrees
+// However many things changed, the view matrix is only rebuilt once, and not at all if nothing changed
+void Camera::update(const glm::vec3& localMovement, const float yawOffset, const float pitchOffset, const float rollOffset) {
+	if (localMovement == glm::vec3(0.0f) && yawOffset == 0.0f && pitchOffset == 0.0f && rollOffset == 0.0f) {
+		return;
+	}
+	// The movement follows the direction the camera was facing at the start of the frame
+	cameraPosition += cameraRightVector * localMovement.x + cameraUpVector * localMovement.y + cameraDirectionVector * localMovement.z;
+	if (rollOffset != 0.0f) {
+		rotateRoll(rollOffset);
+	}
+	if (yawOffset != 0.0f || pitchOffset != 0.0f) {
+		rotateYawAndPitch(yawOffset, pitchOffset);
+	}
 	updateViewMatrix();
 }
 
-void Camera::updateViewMatrix() const {
+void Camera::updateViewMatrix() {
 	// Calculate the new view matrix (GLM does this for us, luckily)
 	// First argument of glm::lookAt is the camera position, second argument the target position, third argument the up vector
-	glm::mat4 viewMatrix = glm::lookAt(cameraPosition, cameraPosition + cameraDirectionVector, cameraUpVector);
-
-	// Update the view matrix (that we stored in a uniform buffer object earlier)
-	ResourceManager::setViewMatrix(viewMatrix);
+	// Views::update() copies it into the uniform buffer object (UBO) of the shaders once per frame
+	viewMatrix = glm::lookAt(cameraPosition, cameraPosition + cameraDirectionVector, cameraUpVector);
 }
 
-void Camera::updateProjectionMatrix() const {
+void Camera::updateProjectionMatrix() {
 	// Calculate the new projection matrix (GLM does this for us, luckily)
-	// First argument of glm::perspective is the FOV, second argument the window's aspect ratio
+	// First argument of glm::perspective is the FOV, second argument the aspect ratio of the camera's viewport
 	// Third argument is the distance of the near plane, fourth argument the distance of the far plane
-	glm::mat4 projectionMatrix = glm::perspective(glm::radians(fov), Window::getAspectRatio(), 0.1f, 100.0f);
-
-	// Update the view matrix (that we stored in a uniform buffer object earlier)
-	ResourceManager::setProjectionMatrix(projectionMatrix);
+	// Views::update() copies it into the uniform buffer object (UBO) of the shaders once per frame
+	projectionMatrix = glm::perspective(glm::radians(fov), aspectRatio, 0.1f, 100.0f);
 }
\ No newline at end of file
@@ -0,0 +1,396 @@
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "cascadedShadows.hpp"
+#include "views.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Texture units 0 and 1 are used by the objects' own textures, 2 to 4 by the lighting's buffer textures
+const int shadowMapTextureUnit = 5;
+const unsigned int shadowParametersBindingPoint = 2;
+// Same as the near plane of the cameras
+const float cameraNearPlane = 0.1f;
+// Split distances are a blend of logarithmic (1) and even (0) splits. Purely logarithmic splits spend too much resolution right in front of the camera
+const float logarithmicSplitShare = 0.75f;
+// Slope scaled depth offset while rendering the shadow maps, so that lit surfaces don't shadow themselves ("shadow acne")
+const float depthOffsetFactor = 2.0f, depthOffsetUnits = 4.0f;
+// GPU timer results arrive a few frames late; this many frames may be in flight before we stop measuring
+const unsigned int timerQueryLatency = 4;
+
+// Same layout as the "shadows" uniform block in the shaders (std140)
+struct ShadowParameters {
+	// Move positions from the primary view's space into the shadow maps' texture space (xy = texture coordinates, z = depth)
+	glm::mat4 cascadeMatrices[CascadedShadows::maxCascadeCount];
+	glm::vec4 sunDirection;		// Points towards the sun, in the primary view's space
+	glm::vec4 sunColor;
+	unsigned int cascadeCount[4];
+};
+
+struct Cascade {
+	// Bounding sphere of the cascade's slice of the frustum in the sun's space, as the shadow map was last rendered with it
+	glm::vec3 center;
+	float radius;
+	// Sun's projection matrix * view matrix the shadow map was last rendered with
+	glm::mat4 lightMatrix;
+	bool hasShadowMap;
+	// Something moved within the cascade since it was last rendered
+	bool changed;
+};
+
+unsigned int shadowMapResolution = 2048, shadowCascadeCount = 4;
+float shadowsDistance = 50.0f;
+// Cascades from this one on are distant enough to be only rendered every cascadeTimeSliceInterval frames
+unsigned int firstTimeSlicedCascade = 2, cascadeTimeSliceInterval = 4;
+unsigned long long shadowFrameNumber = 0;
+
+glm::vec3 sunDirection = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.3f)), sunColor = glm::vec3(0.5f);
+glm::mat4 sunViewMatrix;
+
+Cascade cascades[CascadedShadows::maxCascadeCount];
+// splitDistances[c] to splitDistances[c + 1] is the slice of the frustum that cascade c covers
+float splitDistances[CascadedShadows::maxCascadeCount + 1];
+ShadowParameters shadowParameters;
+
+GLFramebuffer shadowFBO;
+GLTexture shadowMapTexture;
+GLBuffer shadowParametersBuffer;
+// [0] => Shadow casters with a model matrix, [1] => ANIMATED variant for the cubes that are animated on the GPU
+std::unique_ptr<Shader> shadowDepthShaders[2];
+int lightMatrixLocations[2];
+
+//* Statistics
+CascadeStats cascadeStats[CascadedShadows::maxCascadeCount];
+double cascadeGpuMilliseconds[CascadedShadows::maxCascadeCount];
+unsigned int measuredRenders[CascadedShadows::maxCascadeCount];
+// Timestamps at the start and end of every cascade's render, one set per frame in flight
+unsigned int cascadeStartQueryIDs[timerQueryLatency][CascadedShadows::maxCascadeCount];
+unsigned int cascadeEndQueryIDs[timerQueryLatency][CascadedShadows::maxCascadeCount];
+bool cascadeQueryPending[timerQueryLatency][CascadedShadows::maxCascadeCount] = {};
+unsigned int shadowQuerySlot = 0;
+
+void updateSunViewMatrix() {
+	// The sun only has a direction, so it looks from the origin into that direction. Its projection matrices then move to the cascades
+	const glm::vec3 upVector = std::abs(sunDirection.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	sunViewMatrix = glm::lookAt(glm::vec3(0.0f), sunDirection, upVector);
+}
+
+void calculateSplitDistances() {
+	for (unsigned int c = 0; c <= shadowCascadeCount; c++) {
+		const float share = (float)c / shadowCascadeCount;
+		const float logarithmicSplit = cameraNearPlane * std::pow(shadowsDistance / cameraNearPlane, share);
+		const float evenSplit = cameraNearPlane + (shadowsDistance - cameraNearPlane) * share;
+		splitDistances[c] = logarithmicSplit * logarithmicSplitShare + evenSplit * (1.0f - logarithmicSplitShare);
+	}
+}
+
+// Finds the bounding sphere of the cascade's slice of the camera's frustum, in the sun's space
+void fitCascade(const Camera& camera, const unsigned int c, glm::vec3& center, float& radius) {
+	//* The smallest sphere around the slice
+	// Its center lies on the camera's view direction. A sphere keeps the same size no matter where the camera looks,
+	// so the shadow map's texels keep their size as well, which stops shadow edges from swimming when the camera turns
+	// cornerSpread is the squared distance of the slice's corners from the view direction, per unit of distance from the camera
+	const float sliceNear = splitDistances[c], sliceFar = splitDistances[c + 1];
+	const float tanHalfFov = std::tan(glm::radians(camera.fov) / 2.0f);
+	const float cornerSpread = tanHalfFov * tanHalfFov * (1.0f + camera.aspectRatio * camera.aspectRatio);
+	// The center is where the near and far corners are equally far away, but not beyond the far end of the slice
+	const float centerDistance = std::min((sliceNear + sliceFar) * (1.0f + cornerSpread) / 2.0f, sliceFar);
+	radius = std::sqrt((centerDistance - sliceNear) * (centerDistance - sliceNear) + sliceNear * sliceNear * cornerSpread);
+	radius = std::max(radius, std::sqrt(sliceFar * sliceFar * cornerSpread + (sliceFar - centerDistance) * (sliceFar - centerDistance)));
+	center = glm::vec3(sunViewMatrix * glm::vec4(camera.cameraPosition + camera.cameraDirectionVector * centerDistance, 1.0f));
+
+	//* Snap the center to the texels of the shadow map
+	// Otherwise, moving the camera moves the shadow map by fractions of a texel which makes shadow edges flicker
+	// It also means that the cascade doesn't move at all as long as the camera moves less than a texel
+	const float texelSize = 2.0f * radius / shadowMapResolution;
+	center = glm::floor(center / texelSize) * texelSize;
+}
+
+// Picks up the GPU times of the renders in the current query slot, if they have arrived by now
+void readCascadeGpuTimes() {
+	for (unsigned int c = 0; c < CascadedShadows::maxCascadeCount; c++) {
+		if (!cascadeQueryPending[shadowQuerySlot][c]) {
+			continue;
+		}
+		GLint available = 0;
+		glGetQueryObjectiv(cascadeEndQueryIDs[shadowQuerySlot][c], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			continue;
+		}
+		GLuint64 startNanoseconds = 0, endNanoseconds = 0;
+		glGetQueryObjectui64v(cascadeStartQueryIDs[shadowQuerySlot][c], GL_QUERY_RESULT, &startNanoseconds);
+		glGetQueryObjectui64v(cascadeEndQueryIDs[shadowQuerySlot][c], GL_QUERY_RESULT, &endNanoseconds);
+		cascadeQueryPending[shadowQuerySlot][c] = false;
+		cascadeGpuMilliseconds[c] += (endNanoseconds - startNanoseconds) / 1000000.0;
+		measuredRenders[c]++;
+	}
+}
+
+void renderCascade(const unsigned int c, const glm::vec3& center, const float radius, void (*drawShadowCasters)(const bool animated)) {
+	Cascade& cascade = cascades[c];
+	cascade.center = center;
+	cascade.radius = radius;
+	cascade.hasShadowMap = true;
+	cascade.changed = false;
+	//* An orthographic projection around the sphere, as the sun's rays are parallel
+	// The sun looks down the negative z axis, so the sphere's near side is at -(center.z + radius)
+	// Anything between the sun and the sphere still casts shadows into it; depth clamping flattens it onto the near plane instead of clipping it
+	const glm::mat4 projectionMatrix = glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius, -(center.z + radius), -(center.z - radius));
+	cascade.lightMatrix = projectionMatrix * sunViewMatrix;
+
+	const bool measured = !cascadeQueryPending[shadowQuerySlot][c];
+	if (measured) {
+		glQueryCounter(cascadeStartQueryIDs[shadowQuerySlot][c], GL_TIMESTAMP);
+	}
+	// Every cascade is a layer of the shadow map array
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMapTexture.getID(), 0, c);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	// Both kinds of shadow casters are drawn with their own variant of the shadow depth shader
+	for (unsigned int variant = 0; variant < 2; variant++) {
+		shadowDepthShaders[variant]->use();
+		shadowDepthShaders[variant]->setMat4(lightMatrixLocations[variant], cascade.lightMatrix);
+		drawShadowCasters(variant == 1);
+	}
+	if (measured) {
+		glQueryCounter(cascadeEndQueryIDs[shadowQuerySlot][c], GL_TIMESTAMP);
+		cascadeQueryPending[shadowQuerySlot][c] = true;
+	}
+	cascadeStats[c].renders++;
+}
+
+// Uploads the matrices that take the primary view's positions into the shadow maps
+void uploadShadowParameters(const glm::mat4& viewMatrix) {
+	// Clip space goes from -1 to 1, but texture coordinates and depth from 0 to 1
+	const glm::mat4 textureSpaceMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
+	const glm::mat4 inverseViewMatrix = glm::inverse(viewMatrix);
+	unsigned int renderedCascadeCount = 0;
+	for (unsigned int c = 0; c < shadowCascadeCount && cascades[c].hasShadowMap; c++) {
+		shadowParameters.cascadeMatrices[c] = textureSpaceMatrix * cascades[c].lightMatrix * inverseViewMatrix;
+		renderedCascadeCount++;
+	}
+	shadowParameters.sunDirection = glm::vec4(glm::normalize(glm::mat3(viewMatrix) * -sunDirection), 0.0f);
+	shadowParameters.sunColor = glm::vec4(sunColor, 0.0f);
+	shadowParameters.cascadeCount[0] = renderedCascadeCount;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, shadowParametersBuffer.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowParameters), &shadowParameters);
+}
+
+//** Public **//
+// resolution is the width and height of every cascade's shadow map; cascades only cover the primary view up to shadowDistance
+// Cascades in the far half are only rendered every timeSliceInterval frames (1 = every frame)
+void CascadedShadows::initialize(const unsigned int resolution, const unsigned int cascadeCount, const float shadowDistance, const unsigned int timeSliceInterval) {
+	shadowsDistance = shadowDistance;
+	cascadeTimeSliceInterval = std::max(timeSliceInterval, 1u);
+	updateSunViewMatrix();
+
+	shadowFBO = GLFramebuffer(GLMemoryCategory::RenderTargets, "Shadow map framebuffer");
+	shadowMapTexture = GLTexture(GLMemoryCategory::RenderTargets, "Shadow maps");
+	for (unsigned int slot = 0; slot < timerQueryLatency; slot++) {
+		glGenQueries(maxCascadeCount, cascadeStartQueryIDs[slot]);
+		glGenQueries(maxCascadeCount, cascadeEndQueryIDs[slot]);
+	}
+
+	shadowParametersBuffer = GLBuffer(GLMemoryCategory::Uniforms, "Shadow parameters");
+	glBindBuffer(GL_UNIFORM_BUFFER, shadowParametersBuffer.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowParameters), nullptr, GL_DYNAMIC_DRAW);
+	shadowParametersBuffer.setSize(sizeof(ShadowParameters));
+	glBindBufferBase(GL_UNIFORM_BUFFER, shadowParametersBindingPoint, shadowParametersBuffer.getID());
+
+	// Shadow casters only need their depth; the vertex shader takes the cube instances' model matrices or animation parameters
+	shadowDepthShaders[0].reset(new Shader("res/shaders/shadowDepth.vert", "res/shaders/depthOnly.frag"));
+	shadowDepthShaders[1].reset(new Shader("res/shaders/shadowDepth.vert", "res/shaders/depthOnly.frag", { "ANIMATED" }));
+	for (unsigned int variant = 0; variant < 2; variant++) {
+		lightMatrixLocations[variant] = shadowDepthShaders[variant]->getUniformLocation("lightMatrix");
+	}
+	// Cubes that are animated on the GPU need the frame's time from the views' "matrices" uniform block, which lives at binding point 0
+	glUniformBlockBinding(shadowDepthShaders[1]->getShaderProgramID(), glGetUniformBlockIndex(shadowDepthShaders[1]->getShaderProgramID(), "matrices"), 0);
+
+	setOptions(resolution, cascadeCount);
+}
+
+// Changes the shadow maps' resolution and the number of cascades (at most maxCascadeCount). All shadow maps are rendered anew
+void CascadedShadows::setOptions(const unsigned int resolution, const unsigned int cascadeCount) {
+	shadowMapResolution = std::max(resolution, 1u);
+	shadowCascadeCount = std::min(std::max(cascadeCount, 1u), maxCascadeCount);
+	firstTimeSlicedCascade = (shadowCascadeCount + 1) / 2;
+	calculateSplitDistances();
+	for (unsigned int c = 0; c < maxCascadeCount; c++) {
+		cascades[c].hasShadowMap = false;
+		cascadeStats[c].splitDistance = splitDistances[std::min(c + 1, shadowCascadeCount)];
+	}
+
+	//* All cascades share one depth texture array, one layer per cascade
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMapTexture.getID());
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, shadowMapResolution, shadowMapResolution, shadowCascadeCount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	// 24 bit depth is stored in 4 bytes per texel by every common driver
+	shadowMapTexture.setSize((size_t)shadowMapResolution * shadowMapResolution * shadowCascadeCount * 4);
+	// With a comparison mode, sampling compares the given depth with the stored one instead of returning it
+	// Linear filtering then averages the comparison of the 4 closest texels, which softens the shadow edges for free
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// Only depth is rendered, so the framebuffer has no color buffer
+	glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO.getID());
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, shadowMapTexture.getID(), 0, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "Error: Shadow map framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Links the shader's "shadows" uniform block and shadow map sampler to the shadow data
+void CascadedShadows::configureShader(Shader& shader) {
+	// Shaders that don't do any lighting (e.g. for the depth pre-pass) don't have the block
+	unsigned int blockIndex = glGetUniformBlockIndex(shader.getShaderProgramID(), "shadows");
+	if (blockIndex == GL_INVALID_INDEX) {
+		return;
+	}
+	glUniformBlockBinding(shader.getShaderProgramID(), blockIndex, shadowParametersBindingPoint);
+
+	// Don't forget to activate a shader before setting uniforms
+	shader.use();
+	shader.setInt("shadowMaps", shadowMapTextureUnit);
+}
+
+// direction is the direction the sun's light travels in. All shadow maps are rendered anew if it changes
+void CascadedShadows::setSun(const glm::vec3& direction, const glm::vec3& color) {
+	const glm::vec3 normalizedDirection = glm::normalize(direction);
+	if (normalizedDirection != sunDirection) {
+		sunDirection = normalizedDirection;
+		updateSunViewMatrix();
+		for (unsigned int c = 0; c < maxCascadeCount; c++) {
+			cascades[c].hasShadowMap = false;
+		}
+	}
+	sunColor = color;
+}
+
+// Tells the shadows that a shadow caster within the given bounding sphere moved (or appeared or disappeared) this frame
+// Every cascade it may cast a shadow into has to be rendered again
+void CascadedShadows::markChanged(const glm::vec3& center, const float radius) {
+	const glm::vec3 sunSpaceCenter = glm::vec3(sunViewMatrix * glm::vec4(center, 1.0f));
+	for (unsigned int c = 0; c < shadowCascadeCount; c++) {
+		Cascade& cascade = cascades[c];
+		if (!cascade.hasShadowMap || cascade.changed) {
+			continue;
+		}
+		// The caster has to overlap the cascade as seen from the sun, and mustn't be behind it (it would cast its shadow away from the cascade)
+		const float reach = cascade.radius + radius;
+		cascade.changed = std::abs(sunSpaceCenter.x - cascade.center.x) < reach && std::abs(sunSpaceCenter.y - cascade.center.y) < reach
+			&& sunSpaceCenter.z + radius > cascade.center.z - cascade.radius;
+	}
+}
+
+// Renders the shadow maps that are outdated. drawShadowCasters(animated) should draw everything that casts shadows with the currently
+// bound shader; it is called once for the shadow casters with a model matrix and once for the cubes that are animated on the GPU
+// Should be called once per frame after the views are updated and the shadow casters are prepared, but before the scene is drawn
+void CascadedShadows::update(void (*drawShadowCasters)(const bool animated)) {
+	if (Views::getViewCount() == 0) {
+		return;
+	}
+	// The cascades are fitted to the primary view, just like the lights are binned for it
+	const Camera& camera = *Views::getView(0).camera;
+	shadowFrameNumber++;
+	shadowQuerySlot = (shadowQuerySlot + 1) % timerQueryLatency;
+	readCascadeGpuTimes();
+
+	GLint previousFramebufferID = 0, previousViewport[4];
+	bool renderStarted = false;
+	for (unsigned int c = 0; c < shadowCascadeCount; c++) {
+		glm::vec3 center;
+		float radius;
+		fitCascade(camera, c, center, radius);
+		const Cascade& cascade = cascades[c];
+		if (cascade.hasShadowMap && !cascade.changed && center == cascade.center && radius == cascade.radius) {
+			cascadeStats[c].reuses++;
+			continue;
+		}
+		//* Distant cascades take turns
+		// Until then, they keep using their outdated shadow map with the matrix it was rendered with, so it still lines up with the scene
+		// Their shadows cover so few pixels that lagging behind a few frames goes unnoticed
+		if (cascade.hasShadowMap && c >= firstTimeSlicedCascade && (shadowFrameNumber + c) % cascadeTimeSliceInterval != 0) {
+			cascadeStats[c].deferrals++;
+			continue;
+		}
+
+		if (!renderStarted) {
+			renderStarted = true;
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebufferID);
+			glGetIntegerv(GL_VIEWPORT, previousViewport);
+			glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO.getID());
+			glViewport(0, 0, shadowMapResolution, shadowMapResolution);
+			glEnable(GL_DEPTH_CLAMP);
+			glEnable(GL_POLYGON_OFFSET_FILL);
+			glPolygonOffset(depthOffsetFactor, depthOffsetUnits);
+		}
+		renderCascade(c, center, radius, drawShadowCasters);
+	}
+	if (renderStarted) {
+		glDisable(GL_DEPTH_CLAMP);
+		glDisable(GL_POLYGON_OFFSET_FILL);
+		glBindFramebuffer(GL_FRAMEBUFFER, previousFramebufferID);
+		glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+	}
+
+	uploadShadowParameters(camera.viewMatrix);
+	glActiveTexture(GL_TEXTURE0 + shadowMapTextureUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowMapTexture.getID());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+// Deletes the shadow maps and everything needed to render them. Has to be called while the OpenGL context still exists
+void CascadedShadows::shutdown() {
+	for (unsigned int slot = 0; slot < timerQueryLatency; slot++) {
+		glDeleteQueries(maxCascadeCount, cascadeStartQueryIDs[slot]);
+		glDeleteQueries(maxCascadeCount, cascadeEndQueryIDs[slot]);
+	}
+	shadowDepthShaders[0].reset();
+	shadowDepthShaders[1].reset();
+	shadowParametersBuffer.reset();
+	shadowMapTexture.reset();
+	shadowFBO.reset();
+}
+
+unsigned int CascadedShadows::getCascadeCount() {
+	return shadowCascadeCount;
+}
+
+const CascadeStats& CascadedShadows::getStats(const unsigned int cascade) {
+	CascadeStats& stats = cascadeStats[cascade];
+	stats.gpuMilliseconds = measuredRenders[cascade] > 0 ? cascadeGpuMilliseconds[cascade] / measuredRenders[cascade] : 0.0;
+	return stats;
+}
+
+void CascadedShadows::resetStats() {
+	for (unsigned int c = 0; c < maxCascadeCount; c++) {
+		cascadeStats[c].renders = 0;
+		cascadeStats[c].reuses = 0;
+		cascadeStats[c].deferrals = 0;
+		cascadeGpuMilliseconds[c] = 0.0;
+		measuredRenders[c] = 0;
+	}
+}
+
+// Prints how often every cascade was rendered or reused since the last reset, and what a render costs
+void CascadedShadows::printStats(const std::string& label) {
+	std::cout << label << " (" << shadowCascadeCount << " cascades at " << shadowMapResolution << "x" << shadowMapResolution << "):" << std::endl;
+	for (unsigned int c = 0; c < shadowCascadeCount; c++) {
+		const CascadeStats& stats = getStats(c);
+		const unsigned int frames = stats.renders + stats.reuses + stats.deferrals;
+		std::cout << "  Cascade " << c << " (up to " << stats.splitDistance << " units): rendered " << stats.renders << " times at "
+			<< stats.gpuMilliseconds << " ms GPU time each, reused " << stats.reuses << " times, deferred " << stats.deferrals
+			<< " times => cached shadow map used in " << (frames > 0 ? 100.0 * (stats.reuses + stats.deferrals) / frames : 0.0) << "% of the frames" << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#include "clock.hpp"
+
+//** Private **//
+double (*currentTimeSource)() = glfwGetTime;
+// 0 => follow the time source
+double fixedTimestep = 0.0;
+double currentTime = 0.0;	// Time at the start of the current frame
+double lastTime = 0.0;		// Time at the start of the last frame
+
+//** Public **//
+// Replaces glfwGetTime() as the source of the real time, e.g. with a high resolution timer of the OS
+void Clock::setTimeSource(double (*timeSource)()) {
+	currentTimeSource = timeSource;
+}
+
+// Every frame advances the time by the given number of seconds from now on. 0 goes back to the real time
+void Clock::useFixedTimestep(const double timestep) {
+	fixedTimestep = timestep;
+}
+
+double Clock::getFixedTimestep() {
+	return fixedTimestep;
+}
+
+// Should be called once at the start of every frame
+void Clock::beginFrame() {
+	lastTime = currentTime;
+	currentTime = fixedTimestep > 0.0 ? currentTime + fixedTimestep : currentTimeSource();
+}
+
+// Time at the start of the current frame in seconds. Everything that animates should use this so that all of the frame sees the same time
+float Clock::getTime() {
+	return (float)currentTime;
+}
+
+// Time between the start of the last frame and the start of the current frame in seconds
+float Clock::getDeltaTime() {
+	return (float)(currentTime - lastTime);
+}
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// SSE is available on every x64 CPU, so we only need the scalar code path for other architectures
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLUSTERED_LIGHTING_SSE
+#include <emmintrin.h>
+#endif
+
+#include "clusteredLighting.hpp"
+#include "glResources.hpp"
+#include "jobSystem.hpp"
+
+//** Private **//
+//* Cluster grid
+// x and y are split evenly across the screen, z (depth) is split logarithmically
+// so that clusters close to the camera aren't much deeper than they are wide
+const unsigned int clusterCountX = 16;
+const unsigned int clusterCountY = 9;
+const unsigned int clusterCountZ = 24;
+const unsigned int clusterCount = clusterCountX * clusterCountY * clusterCountZ;
+// The binning splits the depth slices into groups of this many, each of which is a job with a light index list of its own
+const unsigned int slicesPerGroup = 3;
+const unsigned int sliceGroupCount = clusterCountZ / slicesPerGroup;
+// Lights whose ranges are calculated by one job; has to be a multiple of 4 so that every SSE iteration stays within one job
+const unsigned int lightsPerJob = 1024;
+
+// Texture units 0 and 1 are used by the objects' own textures
+const int clusterGridTextureUnit = 2;
+const int lightIndicesTextureUnit = 3;
+const int lightDataTextureUnit = 4;
+const unsigned int clusterParametersBindingPoint = 1;
+
+// Same layout as the "clusters" uniform block in the shaders (std140)
+struct ClusterParameters {
+	unsigned int gridSize[4];	// Number of clusters along x, y and z
+	float mapping[4];			// Near plane distance, depth slices per log unit
+	float ambientLight[4];
+};
+
+// Screen space and depth extent of a light, in clusters. Lights outside of the frustum are marked as not visible
+struct LightRange {
+	int minX, maxX, minY, maxY, minZ, maxZ;
+	bool visible;
+};
+
+// Light positions are stored as structure of arrays so that 4 lights at a time can be transformed with SSE
+std::vector<float> lightPositionsX, lightPositionsY, lightPositionsZ, lightRadii;
+std::vector<glm::vec3> lightColors;
+std::vector<LightRange> lightRanges;
+std::vector<glm::vec4> viewSpaceLights;		// Position and radius of every light in view space
+
+// Lights that are visible this frame, in the order they are uploaded; the index lists refer to these
+std::vector<unsigned int> visibleLights;
+std::vector<float> lightData;
+
+glm::mat4 viewMatrix = glm::mat4(1.0f);
+float nearPlane = 0.1f, farPlane = 100.0f;
+float tanHalfFovX = 1.0f, tanHalfFovY = 1.0f;
+float slicesPerLogUnit = 1.0f;
+
+//* Results of the binning
+// Every job bins its groups of depth slices into the list of its first group; the grid stores offset and count for every cluster
+unsigned int clusterGrid[clusterCount * 2];
+std::vector<unsigned int> sliceGroupLightIndices[sliceGroupCount];
+unsigned int sliceGroupListOwners[sliceGroupCount];	// The group whose list holds the group's indices
+
+GLBuffer clusterGridBuffer, lightIndicesBuffer, lightDataBuffer;
+GLTexture clusterGridTexture, lightIndicesTexture, lightDataTexture;
+GLBuffer clusterParametersBuffer;
+
+int calculateDepthSlice(const float depth) {
+	if (depth <= nearPlane) {
+		return 0;
+	}
+	return std::min((int)(std::log(depth / nearPlane) * slicesPerLogUnit), (int)clusterCountZ - 1);
+}
+
+//* Phase 1: Transform the lights into view space and find the clusters they reach into
+// Every job takes a range of lights. The view space bounding box of a light's sphere is projected onto the screen:
+// the smallest x / depth ratio of the box is found at either its nearest or its farthest depth, the same goes for the largest one
+void calculateLightRanges(const unsigned int first, const unsigned int last) {
+	// Scales x / depth ratios to [0, clusterCount] across the screen
+	const float scaleX = 0.5f * clusterCountX / tanHalfFovX;
+	const float scaleY = 0.5f * clusterCountY / tanHalfFovY;
+	float minRatioX[4], maxRatioX[4], minRatioY[4], maxRatioY[4], nearestDepth[4], farthestDepth[4], viewSpace[4][4];
+
+	for (unsigned int i = first; i < last; i += 4) {
+		const unsigned int count = std::min(last - i, 4u);
+#ifdef CLUSTERED_LIGHTING_SSE
+		if (count == 4) {
+			//* Transform 4 lights at once; glm matrices are column major, so viewMatrix[column][row]
+			const __m128 x = _mm_loadu_ps(&lightPositionsX[i]);
+			const __m128 y = _mm_loadu_ps(&lightPositionsY[i]);
+			const __m128 z = _mm_loadu_ps(&lightPositionsZ[i]);
+			const __m128 radius = _mm_loadu_ps(&lightRadii[i]);
+			__m128 viewCoordinates[3];
+			for (int row = 0; row < 3; row++) {
+				viewCoordinates[row] = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(viewMatrix[0][row]), x), _mm_mul_ps(_mm_set1_ps(viewMatrix[1][row]), y)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(viewMatrix[2][row]), z), _mm_set1_ps(viewMatrix[3][row])));
+			}
+
+			//* The camera looks along -z, so the depth is the negated view space z
+			const __m128 depth = _mm_sub_ps(_mm_setzero_ps(), viewCoordinates[2]);
+			const __m128 nearest = _mm_max_ps(_mm_sub_ps(depth, radius), _mm_set1_ps(nearPlane));
+			const __m128 farthest = _mm_add_ps(depth, radius);
+			const __m128 inverseNearest = _mm_div_ps(_mm_set1_ps(1.0f), nearest);
+			const __m128 inverseFarthest = _mm_div_ps(_mm_set1_ps(1.0f), _mm_max_ps(farthest, nearest));
+
+			const __m128 minX = _mm_sub_ps(viewCoordinates[0], radius), maxX = _mm_add_ps(viewCoordinates[0], radius);
+			const __m128 minY = _mm_sub_ps(viewCoordinates[1], radius), maxY = _mm_add_ps(viewCoordinates[1], radius);
+			_mm_storeu_ps(minRatioX, _mm_min_ps(_mm_mul_ps(minX, inverseNearest), _mm_mul_ps(minX, inverseFarthest)));
+			_mm_storeu_ps(maxRatioX, _mm_max_ps(_mm_mul_ps(maxX, inverseNearest), _mm_mul_ps(maxX, inverseFarthest)));
+			_mm_storeu_ps(minRatioY, _mm_min_ps(_mm_mul_ps(minY, inverseNearest), _mm_mul_ps(minY, inverseFarthest)));
+			_mm_storeu_ps(maxRatioY, _mm_max_ps(_mm_mul_ps(maxY, inverseNearest), _mm_mul_ps(maxY, inverseFarthest)));
+			_mm_storeu_ps(nearestDepth, nearest);
+			_mm_storeu_ps(farthestDepth, farthest);
+			for (int row = 0; row < 3; row++) {
+				float values[4];
+				_mm_storeu_ps(values, viewCoordinates[row]);
+				for (int j = 0; j < 4; j++) {
+					viewSpace[j][row] = values[j];
+				}
+			}
+		}
+		else
+#endif
+		{
+			for (unsigned int j = 0; j < count; j++) {
+				const glm::vec4 view = viewMatrix * glm::vec4(lightPositionsX[i + j], lightPositionsY[i + j], lightPositionsZ[i + j], 1.0f);
+				const float radius = lightRadii[i + j];
+				const float nearest = std::max(-view.z - radius, nearPlane);
+				const float farthest = std::max(-view.z + radius, nearest);
+				minRatioX[j] = std::min((view.x - radius) / nearest, (view.x - radius) / farthest);
+				maxRatioX[j] = std::max((view.x + radius) / nearest, (view.x + radius) / farthest);
+				minRatioY[j] = std::min((view.y - radius) / nearest, (view.y - radius) / farthest);
+				maxRatioY[j] = std::max((view.y + radius) / nearest, (view.y + radius) / farthest);
+				nearestDepth[j] = nearest;
+				farthestDepth[j] = -view.z + radius;
+				viewSpace[j][0] = view.x;
+				viewSpace[j][1] = view.y;
+				viewSpace[j][2] = view.z;
+			}
+		}
+
+		//* Convert the ratios to cluster coordinates and cull lights outside of the frustum
+		for (unsigned int j = 0; j < count; j++) {
+			LightRange& range = lightRanges[i + j];
+			const float firstX = (minRatioX[j] + tanHalfFovX) * scaleX, lastX = (maxRatioX[j] + tanHalfFovX) * scaleX;
+			const float firstY = (minRatioY[j] + tanHalfFovY) * scaleY, lastY = (maxRatioY[j] + tanHalfFovY) * scaleY;
+			range.visible = farthestDepth[j] > nearPlane && nearestDepth[j] < farPlane &&
+				lastX >= 0.0f && firstX < (float)clusterCountX && lastY >= 0.0f && firstY < (float)clusterCountY;
+			if (range.visible) {
+				range.minX = std::max((int)firstX, 0);
+				range.maxX = std::min((int)lastX, (int)clusterCountX - 1);
+				range.minY = std::max((int)firstY, 0);
+				range.maxY = std::min((int)lastY, (int)clusterCountY - 1);
+				range.minZ = calculateDepthSlice(nearestDepth[j]);
+				range.maxZ = calculateDepthSlice(farthestDepth[j]);
+			}
+			viewSpaceLights[i + j] = glm::vec4(viewSpace[j][0], viewSpace[j][1], viewSpace[j][2], lightRadii[i + j]);
+		}
+	}
+}
+
+//* Phase 2: Fill the light lists of the clusters
+// Every job takes a range of groups of depth slices, so no two jobs ever write to the same cluster
+// Each job first counts the lights per cluster, then turns the counts into offsets and writes the indices
+void binSliceGroups(const unsigned int firstGroup, const unsigned int lastGroup) {
+	const unsigned int firstSlice = firstGroup * slicesPerGroup;
+	const unsigned int lastSlice = lastGroup * slicesPerGroup;
+	const unsigned int clustersPerSlice = clusterCountX * clusterCountY;
+	unsigned int* grid = &clusterGrid[firstSlice * clustersPerSlice * 2];
+	const unsigned int gridSize = (lastSlice - firstSlice) * clustersPerSlice;
+
+	for (unsigned int c = 0; c < gridSize; c++) {
+		grid[c * 2 + 1] = 0;
+	}
+	for (unsigned int v = 0; v < visibleLights.size(); v++) {
+		const LightRange& range = lightRanges[visibleLights[v]];
+		const int minZ = std::max(range.minZ, (int)firstSlice), maxZ = std::min(range.maxZ, (int)lastSlice - 1);
+		for (int z = minZ; z <= maxZ; z++) {
+			for (int y = range.minY; y <= range.maxY; y++) {
+				unsigned int* row = &grid[((z - firstSlice) * clustersPerSlice + y * clusterCountX) * 2];
+				for (int x = range.minX; x <= range.maxX; x++) {
+					row[x * 2 + 1]++;
+				}
+			}
+		}
+	}
+
+	unsigned int total = 0;
+	for (unsigned int c = 0; c < gridSize; c++) {
+		grid[c * 2] = total;
+		total += grid[c * 2 + 1];
+		grid[c * 2 + 1] = 0;
+	}
+	// The list only grows until it fits the busiest frame
+	for (unsigned int group = firstGroup; group < lastGroup; group++) {
+		sliceGroupListOwners[group] = firstGroup;
+	}
+	std::vector<unsigned int>& indices = sliceGroupLightIndices[firstGroup];
+	if (indices.size() < total) {
+		indices.resize(total);
+	}
+
+	for (unsigned int v = 0; v < visibleLights.size(); v++) {
+		const LightRange& range = lightRanges[visibleLights[v]];
+		const int minZ = std::max(range.minZ, (int)firstSlice), maxZ = std::min(range.maxZ, (int)lastSlice - 1);
+		for (int z = minZ; z <= maxZ; z++) {
+			for (int y = range.minY; y <= range.maxY; y++) {
+				unsigned int* row = &grid[((z - firstSlice) * clustersPerSlice + y * clusterCountX) * 2];
+				for (int x = range.minX; x <= range.maxX; x++) {
+					indices[row[x * 2] + row[x * 2 + 1]++] = v;
+				}
+			}
+		}
+	}
+}
+
+// Returns the number of light indices written for every group of depth slices
+void binAllLights(unsigned int (&indexCounts)[sliceGroupCount]) {
+	JobSystem::parallelFor((unsigned int)lightRanges.size(), lightsPerJob, [](const unsigned int first, const unsigned int last) {
+		calculateLightRanges(first, last);
+	});
+
+	visibleLights.clear();
+	for (unsigned int i = 0; i < lightRanges.size(); i++) {
+		if (lightRanges[i].visible) {
+			visibleLights.push_back(i);
+		}
+	}
+
+	// Without other threads, the job system runs all groups as a single range, which scans the visible lights only once
+	JobSystem::parallelFor(sliceGroupCount, 1, [](const unsigned int first, const unsigned int last) {
+		binSliceGroups(first, last);
+	});
+
+	//* The offsets of every list start at 0; shift them so that the lists can be placed behind each other
+	// The lists hold consecutive groups, so a list starts where the first of its groups does
+	const unsigned int clustersPerGroup = clusterCountX * clusterCountY * slicesPerGroup;
+	unsigned int groupOffset = 0, listOffset = 0;
+	for (unsigned int g = 0; g < sliceGroupCount; g++) {
+		const unsigned int owner = sliceGroupListOwners[g];
+		if (owner == g) {
+			listOffset = groupOffset;
+		}
+		unsigned int count = 0;
+		for (unsigned int c = g * clustersPerGroup; c < (g + 1) * clustersPerGroup; c++) {
+			clusterGrid[c * 2] += listOffset;
+			count += clusterGrid[c * 2 + 1];
+		}
+		indexCounts[g] = 0;
+		indexCounts[owner] += count;
+		groupOffset += count;
+	}
+}
+
+void createBufferTexture(const unsigned int format, GLBuffer& buffer, GLTexture& texture, const char* label) {
+	//* Buffer textures give shaders read access to large buffers through texelFetch()
+	// Unlike uniform buffers, their size is only limited by GPU memory. The texture itself holds no memory, only the buffer does
+	buffer = GLBuffer(GLMemoryCategory::Uniforms, label);
+	glBindBuffer(GL_TEXTURE_BUFFER, buffer.getID());
+	glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+	buffer.setSize(16);
+	texture = GLTexture(GLMemoryCategory::Uniforms, label);
+	glBindTexture(GL_TEXTURE_BUFFER, texture.getID());
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer.getID());
+}
+
+//** Public **//
+// The binning runs on the job system, which has to be initialized first
+void ClusteredLighting::initialize() {
+	createBufferTexture(GL_RG32UI, clusterGridBuffer, clusterGridTexture, "Light cluster grid");
+	createBufferTexture(GL_R32UI, lightIndicesBuffer, lightIndicesTexture, "Light indices");
+	createBufferTexture(GL_RGBA32F, lightDataBuffer, lightDataTexture, "Light data");
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	clusterParametersBuffer = GLBuffer(GLMemoryCategory::Uniforms, "Cluster parameters");
+	glBindBuffer(GL_UNIFORM_BUFFER, clusterParametersBuffer.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ClusterParameters), nullptr, GL_DYNAMIC_DRAW);
+	clusterParametersBuffer.setSize(sizeof(ClusterParameters));
+	glBindBufferBase(GL_UNIFORM_BUFFER, clusterParametersBindingPoint, clusterParametersBuffer.getID());
+}
+
+void ClusteredLighting::shutdown() {
+	clusterGridTexture.reset();
+	lightIndicesTexture.reset();
+	lightDataTexture.reset();
+	clusterGridBuffer.reset();
+	lightIndicesBuffer.reset();
+	lightDataBuffer.reset();
+	clusterParametersBuffer.reset();
+}
+
+// Links the shader's "clusters" uniform block and light samplers to the data of the lighting
+void ClusteredLighting::configureShader(Shader& shader) {
+	// Shaders that don't do any lighting (e.g. for the depth pre-pass) don't have the block
+	unsigned int blockIndex = glGetUniformBlockIndex(shader.getShaderProgramID(), "clusters");
+	if (blockIndex == GL_INVALID_INDEX) {
+		return;
+	}
+	glUniformBlockBinding(shader.getShaderProgramID(), blockIndex, clusterParametersBindingPoint);
+
+	// Don't forget to activate a shader before setting uniforms
+	shader.use();
+	shader.setInt("clusterGrid", clusterGridTextureUnit);
+	shader.setInt("lightIndices", lightIndicesTextureUnit);
+	shader.setInt("lightData", lightDataTextureUnit);
+}
+
+void ClusteredLighting::setLights(const std::vector<PointLight>& lights) {
+	//* Split the lights into separate arrays for positions and radii
+	const unsigned int lightCount = (unsigned int)lights.size();
+	lightPositionsX.resize(lightCount);
+	lightPositionsY.resize(lightCount);
+	lightPositionsZ.resize(lightCount);
+	lightRadii.resize(lightCount);
+	lightColors.resize(lightCount);
+	for (unsigned int i = 0; i < lightCount; i++) {
+		lightPositionsX[i] = lights[i].position.x;
+		lightPositionsY[i] = lights[i].position.y;
+		lightPositionsZ[i] = lights[i].position.z;
+		lightRadii[i] = lights[i].radius;
+		lightColors[i] = lights[i].color;
+	}
+
+	// Reserve everything the binning needs up front so that it doesn't allocate while rendering
+	lightRanges.resize(lightCount);
+	viewSpaceLights.resize(lightCount);
+	visibleLights.reserve(lightCount);
+	lightData.reserve(lightCount * 8);
+}
+
+void ClusteredLighting::setViewMatrix(const glm::mat4& newViewMatrix) {
+	viewMatrix = newViewMatrix;
+}
+
+// The frustum is taken apart from the projection matrix so that it always matches what is actually rendered
+void ClusteredLighting::setProjectionMatrix(const glm::mat4& projectionMatrix) {
+	// For a perspective projection, [0][0] = 1 / (aspect ratio * tan(fov / 2)) and [1][1] = 1 / tan(fov / 2)
+	// [2][2] and [3][2] only depend on the near and far plane distances
+	tanHalfFovX = 1.0f / projectionMatrix[0][0];
+	tanHalfFovY = 1.0f / projectionMatrix[1][1];
+	nearPlane = projectionMatrix[3][2] / (projectionMatrix[2][2] - 1.0f);
+	farPlane = projectionMatrix[3][2] / (projectionMatrix[2][2] + 1.0f);
+	slicesPerLogUnit = clusterCountZ / std::log(farPlane / nearPlane);
+}
+
+// Bins the lights for the current camera and uploads the result. Should be called once per frame before rendering
+void ClusteredLighting::update() {
+	unsigned int indexCounts[sliceGroupCount];
+	binAllLights(indexCounts);
+
+	//* Gather the data of the visible lights: view space position and radius, followed by the color
+	lightData.resize(visibleLights.size() * 8);
+	for (unsigned int v = 0; v < visibleLights.size(); v++) {
+		const glm::vec4& viewSpace = viewSpaceLights[visibleLights[v]];
+		const glm::vec3& color = lightColors[visibleLights[v]];
+		float* data = &lightData[v * 8];
+		data[0] = viewSpace.x;
+		data[1] = viewSpace.y;
+		data[2] = viewSpace.z;
+		data[3] = viewSpace.w;
+		data[4] = color.x;
+		data[5] = color.y;
+		data[6] = color.z;
+		data[7] = 0.0f;
+	}
+
+	//* Upload everything
+	// glBufferData with nullptr gives the buffer new storage ("orphaning"), so we don't have to wait for last frame's draw calls
+	glBindBuffer(GL_TEXTURE_BUFFER, clusterGridBuffer.getID());
+	glBufferData(GL_TEXTURE_BUFFER, sizeof(clusterGrid), clusterGrid, GL_STREAM_DRAW);
+	clusterGridBuffer.setSize(sizeof(clusterGrid));
+
+	unsigned int totalIndexCount = 0;
+	for (unsigned int g = 0; g < sliceGroupCount; g++) {
+		totalIndexCount += indexCounts[g];
+	}
+	glBindBuffer(GL_TEXTURE_BUFFER, lightIndicesBuffer.getID());
+	glBufferData(GL_TEXTURE_BUFFER, std::max(totalIndexCount, 1u) * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+	lightIndicesBuffer.setSize(std::max(totalIndexCount, 1u) * sizeof(unsigned int));
+	unsigned int offset = 0;
+	for (unsigned int g = 0; g < sliceGroupCount; g++) {
+		if (indexCounts[g] > 0) {
+			glBufferSubData(GL_TEXTURE_BUFFER, offset * sizeof(unsigned int), indexCounts[g] * sizeof(unsigned int), &sliceGroupLightIndices[g][0]);
+		}
+		offset += indexCounts[g];
+	}
+
+	glBindBuffer(GL_TEXTURE_BUFFER, lightDataBuffer.getID());
+	glBufferData(GL_TEXTURE_BUFFER, std::max(lightData.size(), (size_t)4) * sizeof(float), lightData.empty() ? nullptr : &lightData[0], GL_STREAM_DRAW);
+	lightDataBuffer.setSize(std::max(lightData.size(), (size_t)4) * sizeof(float));
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	//* Update the parameters the shaders need to find their cluster
+	// x and y are found from the position in the primary view's clip space, so the shaders don't need the framebuffer size
+	ClusterParameters parameters = {
+		{ clusterCountX, clusterCountY, clusterCountZ, 0 },
+		{ nearPlane, slicesPerLogUnit, 0.0f, 0.0f },
+		{ 0.3f, 0.3f, 0.3f, 0.0f },
+	};
+	glBindBuffer(GL_UNIFORM_BUFFER, clusterParametersBuffer.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ClusterParameters), &parameters);
+
+	//* Bind the buffer textures to their texture units
+	glActiveTexture(GL_TEXTURE0 + clusterGridTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, clusterGridTexture.getID());
+	glActiveTexture(GL_TEXTURE0 + lightIndicesTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, lightIndicesTexture.getID());
+	glActiveTexture(GL_TEXTURE0 + lightDataTextureUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, lightDataTexture.getID());
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void ClusteredLighting::printBenchmark() {
+	// Runs without the engine, so it starts a job system of its own with one thread per CPU core
+	JobSystem::initialize(0);
+
+	//* Fixed camera at the origin looking down -z with the same projection as the application
+	setViewMatrix(glm::mat4(1.0f));
+	setProjectionMatrix(glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f));
+
+	std::cout << "Clustered light binning benchmark (" << JobSystem::getThreadCount() << " threads, "
+		<< clusterCountX << "x" << clusterCountY << "x" << clusterCountZ << " clusters)\n";
+	std::cout << std::setw(10) << "Lights" << std::setw(10) << "Visible" << std::setw(12) << "Bin (ms)"
+		<< std::setw(16) << "Lights/cluster" << std::setw(14) << "Max/cluster" << "\n";
+
+	std::mt19937 random(1234);
+	for (unsigned int lightCount = 1024; lightCount <= 65536; lightCount *= 2) {
+		//* Spread lights evenly in a box in front of the camera
+		// The box grows with the light count so that the lights per cluster stay roughly the same
+		const float extent = 10.0f * std::cbrt(lightCount / 1024.0f);
+		std::uniform_real_distribution<float> side(-extent, extent), depth(-2.0f * extent, 0.0f), radius(1.0f, 3.0f);
+		std::vector<PointLight> lights(lightCount);
+		for (unsigned int i = 0; i < lightCount; i++) {
+			lights[i].position = glm::vec3(side(random), side(random), depth(random));
+			lights[i].radius = radius(random);
+			lights[i].color = glm::vec3(1.0f);
+		}
+		setLights(lights);
+
+		//* Warm up, then measure
+		unsigned int indexCounts[sliceGroupCount];
+		for (int i = 0; i < 5; i++) {
+			binAllLights(indexCounts);
+		}
+		const int repetitions = 50;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repetitions; i++) {
+			binAllLights(indexCounts);
+		}
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+		unsigned int occupiedClusters = 0, totalEntries = 0, maxEntries = 0;
+		for (unsigned int c = 0; c < clusterCount; c++) {
+			const unsigned int count = clusterGrid[c * 2 + 1];
+			occupiedClusters += count > 0 ? 1 : 0;
+			totalEntries += count;
+			maxEntries = std::max(maxEntries, count);
+		}
+		std::cout << std::setw(10) << lightCount << std::setw(10) << visibleLights.size()
+			<< std::setw(12) << std::fixed << std::setprecision(3) << milliseconds
+			<< std::setw(16) << std::setprecision(1) << (occupiedClusters > 0 ? (double)totalEntries / occupiedClusters : 0.0)
+			<< std::setw(14) << maxEntries << "\n";
+	}
+	std::cout << std::flush;
+	JobSystem::shutdown();
+}
\ No newline at end of file
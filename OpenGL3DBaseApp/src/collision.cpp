@@ -0,0 +1,562 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "collision.hpp"
+
+//** Private **//
+std::vector<OBB> colliders;
+// The axis-aligned bounds of the colliders, which the broadphase works with
+std::vector<AABB> colliderBounds;
+SweepAndPrune colliderSweepAndPrune;
+SpatialHash colliderSpatialHash(1.0f);
+Broadphase colliderBroadphase = Broadphase::SweepAndPrune;
+// Colliders near the sphere that moveSphere() tests
+std::vector<unsigned int> sweepCandidates;
+
+// Orders pairs by their first, then their second index, so the pairs of different broadphases can be compared
+bool comparePairs(const CollisionPair& a, const CollisionPair& b) {
+	return a.first < b.first || (a.first == b.first && a.second < b.second);
+}
+
+// Returns the size of the hash table for the given number of boxes: the next power of 2 that is at least twice as large,
+// so the bucket is a cheap bit mask and most cells get a bucket of their own
+unsigned int getBucketCount(const size_t boxCount) {
+	unsigned int bucketCount = 64;
+	while (bucketCount < 2 * boxCount) {
+		bucketCount *= 2;
+	}
+	return bucketCount;
+}
+
+//** Public **//
+//* Sweep and prune
+void SweepAndPrune::update(const std::vector<AABB>& boxes) {
+	const size_t count = boxes.size();
+	// Boxes that were removed take the order's meaning with them, and if more boxes were added than there were before,
+	// sorting them all is faster than inserting them one by one
+	if (count < entries.size() || count > 2 * entries.size()) {
+		reset();
+	}
+	const bool sortFromScratch = entries.empty();
+
+	//* A new order sweeps along the axis along which the boxes are spread out the most, as fewer of them overlap along it
+	if (sortFromScratch && count > 0) {
+		glm::vec3 sum(0.0f), squaredSum(0.0f);
+		for (const AABB& box : boxes) {
+			const glm::vec3 center = (box.minimum + box.maximum) * 0.5f;
+			sum += center;
+			squaredSum += center * center;
+		}
+		const glm::vec3 variance = squaredSum / (float)count - (sum / (float)count) * (sum / (float)count);
+		axis = variance.x >= variance.y && variance.x >= variance.z ? 0 : (variance.y >= variance.z ? 1 : 2);
+	}
+	for (size_t i = entries.size(); i < count; i++) {
+		entries.push_back({ boxes[i], (unsigned int)i });
+	}
+
+	//* Take over where the boxes are now
+	maximumExtent = 0.0f;
+	for (SweepEntry& entry : entries) {
+		entry.box = boxes[entry.index];
+		maximumExtent = std::max(maximumExtent, entry.box.maximum[axis] - entry.box.minimum[axis]);
+	}
+
+	//* Sort the boxes by their lower end
+	// The boxes were in order at the end of the last update, and moving a little only puts them behind a few of their neighbours
+	// An insertion sort moves every box back into place one neighbour at a time, which takes as many steps as boxes changed places
+	swapCount = 0;
+	if (sortFromScratch) {
+		const unsigned int sortAxis = axis;
+		std::sort(entries.begin(), entries.end(), [sortAxis](const SweepEntry& a, const SweepEntry& b) { return a.box.minimum[sortAxis] < b.box.minimum[sortAxis]; });
+	}
+	else {
+		for (size_t i = 1; i < count; i++) {
+			const SweepEntry entry = entries[i];
+			const float minimum = entry.box.minimum[axis];
+			size_t j = i;
+			while (j > 0 && entries[j - 1].box.minimum[axis] > minimum) {
+				entries[j] = entries[j - 1];
+				j--;
+			}
+			swapCount += i - j;
+			entries[j] = entry;
+		}
+	}
+
+	//* Sweep through the boxes
+	// Every box can only overlap the boxes that start before it ends, and those follow it directly in the order
+	// Those of them that also overlap along the other two axes are a pair
+	pairs.clear();
+	for (size_t i = 0; i < count; i++) {
+		const SweepEntry& entry = entries[i];
+		const float end = entry.box.maximum[axis];
+		for (size_t j = i + 1; j < count && entries[j].box.minimum[axis] <= end; j++) {
+			if (Collision::testOverlap(entry.box, entries[j].box)) {
+				pairs.push_back({ std::min(entry.index, entries[j].index), std::max(entry.index, entries[j].index) });
+			}
+		}
+	}
+}
+
+void SweepAndPrune::reset() {
+	entries.clear();
+}
+
+// Only boxes that start at most the longest box's extent before the query box can reach into it, so the search starts there
+void SweepAndPrune::query(const AABB& box, std::vector<unsigned int>& results) const {
+	const float searchStart = box.minimum[axis] - maximumExtent;
+	const unsigned int searchAxis = axis;
+	std::vector<SweepEntry>::const_iterator entry = std::lower_bound(entries.begin(), entries.end(), searchStart,
+		[searchAxis](const SweepEntry& a, const float minimum) { return a.box.minimum[searchAxis] < minimum; });
+	for (; entry != entries.end() && entry->box.minimum[axis] <= box.maximum[axis]; entry++) {
+		if (Collision::testOverlap(entry->box, box)) {
+			results.push_back(entry->index);
+		}
+	}
+}
+
+const std::vector<CollisionPair>& SweepAndPrune::getPairs() const {
+	return pairs;
+}
+
+unsigned long long SweepAndPrune::getSwapCount() const {
+	return swapCount;
+}
+
+//* Spatial hash
+SpatialHash::SpatialHash(const float cellSize) : cellSize(cellSize) {}
+
+glm::ivec3 SpatialHash::getCell(const glm::vec3& point) const {
+	return glm::ivec3(glm::floor(point / cellSize));
+}
+
+// Large primes spread neighbouring cells across the table
+unsigned int SpatialHash::getBucket(const glm::ivec3& cell) const {
+	return (((unsigned int)cell.x * 73856093u) ^ ((unsigned int)cell.y * 19349663u) ^ ((unsigned int)cell.z * 83492791u))
+		& (unsigned int)(bucketStarts.size() - 2);
+}
+
+void SpatialHash::update(const std::vector<AABB>& boxes) {
+	//* Count how many entries every bucket gets
+	// There is one more element than buckets, which ends up holding the number of entries
+	const unsigned int bucketCount = getBucketCount(boxes.size());
+	bucketStarts.assign(bucketCount + 1, 0);
+	unsigned int entryCount = 0;
+	for (const AABB& box : boxes) {
+		const glm::ivec3 firstCell = getCell(box.minimum), lastCell = getCell(box.maximum);
+		for (int z = firstCell.z; z <= lastCell.z; z++) {
+			for (int y = firstCell.y; y <= lastCell.y; y++) {
+				for (int x = firstCell.x; x <= lastCell.x; x++) {
+					bucketStarts[getBucket(glm::ivec3(x, y, z))]++;
+					entryCount++;
+				}
+			}
+		}
+	}
+
+	//* Counting sort: adding up the counts gives where every bucket ends, then every bucket is filled in from its end
+	// Afterwards, every bucket's element holds where it starts
+	for (unsigned int i = 1; i <= bucketCount; i++) {
+		bucketStarts[i] += bucketStarts[i - 1];
+	}
+	cellEntries.resize(entryCount);
+	for (size_t i = boxes.size(); i-- > 0;) {
+		const glm::ivec3 firstCell = getCell(boxes[i].minimum), lastCell = getCell(boxes[i].maximum);
+		for (int z = firstCell.z; z <= lastCell.z; z++) {
+			for (int y = firstCell.y; y <= lastCell.y; y++) {
+				for (int x = firstCell.x; x <= lastCell.x; x++) {
+					const glm::ivec3 cell(x, y, z);
+					cellEntries[--bucketStarts[getBucket(cell)]] = { cell, (unsigned int)i };
+				}
+			}
+		}
+	}
+
+	//* Test the boxes in every cell against each other
+	// Different cells may share a bucket, so the cells have to be compared. Two boxes that overlap share every cell their
+	// overlap touches; the pair is only reported by the cell that holds the overlap's lower corner, so it is found once
+	pairs.clear();
+	for (unsigned int bucket = 0; bucket < bucketCount; bucket++) {
+		const unsigned int bucketEnd = bucketStarts[bucket + 1];
+		for (unsigned int i = bucketStarts[bucket]; i < bucketEnd; i++) {
+			const CellEntry& entry = cellEntries[i];
+			for (unsigned int j = i + 1; j < bucketEnd; j++) {
+				const CellEntry& other = cellEntries[j];
+				if (other.cell != entry.cell || !Collision::testOverlap(boxes[entry.index], boxes[other.index])) {
+					continue;
+				}
+				if (getCell(glm::max(boxes[entry.index].minimum, boxes[other.index].minimum)) == entry.cell) {
+					pairs.push_back({ std::min(entry.index, other.index), std::max(entry.index, other.index) });
+				}
+			}
+		}
+	}
+}
+
+// Like pairs, every box is only reported by the cell that holds the lower corner of its overlap with the query box
+void SpatialHash::query(const std::vector<AABB>& boxes, const AABB& box, std::vector<unsigned int>& results) const {
+	if (bucketStarts.empty()) {
+		return;
+	}
+	const glm::ivec3 firstCell = getCell(box.minimum), lastCell = getCell(box.maximum);
+	for (int z = firstCell.z; z <= lastCell.z; z++) {
+		for (int y = firstCell.y; y <= lastCell.y; y++) {
+			for (int x = firstCell.x; x <= lastCell.x; x++) {
+				const glm::ivec3 cell(x, y, z);
+				const unsigned int bucket = getBucket(cell);
+				for (unsigned int i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; i++) {
+					const CellEntry& entry = cellEntries[i];
+					if (entry.cell == cell && Collision::testOverlap(boxes[entry.index], box)
+						&& getCell(glm::max(boxes[entry.index].minimum, box.minimum)) == cell) {
+						results.push_back(entry.index);
+					}
+				}
+			}
+		}
+	}
+}
+
+const std::vector<CollisionPair>& SpatialHash::getPairs() const {
+	return pairs;
+}
+
+//* Scene
+void Collision::initialize(const Broadphase broadphase, const float cellSize) {
+	colliderBroadphase = broadphase;
+	colliderSpatialHash = SpatialHash(cellSize);
+	colliderSweepAndPrune.reset();
+}
+
+void Collision::shutdown() {
+	colliders.clear();
+	colliderBounds.clear();
+	colliderSweepAndPrune.reset();
+}
+
+void Collision::setBroadphase(const Broadphase broadphase) {
+	colliderBroadphase = broadphase;
+}
+
+void Collision::setColliderCount(const unsigned int count) {
+	colliders.resize(count);
+	colliderBounds.resize(count);
+}
+
+void Collision::setCollider(const unsigned int index, const OBB& box) {
+	colliders[index] = box;
+}
+
+void Collision::update() {
+	for (size_t i = 0; i < colliders.size(); i++) {
+		colliderBounds[i] = getBounds(colliders[i]);
+	}
+	if (colliderBroadphase == Broadphase::SweepAndPrune) {
+		colliderSweepAndPrune.update(colliderBounds);
+	}
+	else {
+		colliderSpatialHash.update(colliderBounds);
+	}
+}
+
+const std::vector<CollisionPair>& Collision::getPairs() {
+	return colliderBroadphase == Broadphase::SweepAndPrune ? colliderSweepAndPrune.getPairs() : colliderSpatialHash.getPairs();
+}
+
+//* Narrowphase
+// The broadphases call this for many boxes of which only a few overlap, in no predictable pattern
+// All six comparisons are made and combined with & instead of &&, so there is no branch for the processor to guess wrong
+bool Collision::testOverlap(const AABB& a, const AABB& b) {
+	return (a.minimum.x <= b.maximum.x) & (b.minimum.x <= a.maximum.x)
+		& (a.minimum.y <= b.maximum.y) & (b.minimum.y <= a.maximum.y)
+		& (a.minimum.z <= b.maximum.z) & (b.minimum.z <= a.maximum.z);
+}
+
+// Separating axis test: two convex objects are apart if there is an axis along which their projections don't overlap
+// For two boxes, it is enough to try the 3 axes of each box and the 9 cross products of an axis of one with an axis of the other
+// Everything is calculated in the coordinate system of box a
+bool Collision::testOverlap(const OBB& a, const OBB& b) {
+	// The epsilon keeps the cross products of (nearly) parallel axes, which are (nearly) zero, from finding a separation that isn't there
+	const float epsilon = 1e-6f;
+	float rotation[3][3], absoluteRotation[3][3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			rotation[i][j] = glm::dot(a.axes[i], b.axes[j]);
+			absoluteRotation[i][j] = std::abs(rotation[i][j]) + epsilon;
+		}
+	}
+	const glm::vec3 distance = b.center - a.center;
+	const float translation[3] = { glm::dot(distance, a.axes[0]), glm::dot(distance, a.axes[1]), glm::dot(distance, a.axes[2]) };
+
+	//* The axes of box a
+	for (int i = 0; i < 3; i++) {
+		const float radiusB = b.halfExtents.x * absoluteRotation[i][0] + b.halfExtents.y * absoluteRotation[i][1] + b.halfExtents.z * absoluteRotation[i][2];
+		if (std::abs(translation[i]) > a.halfExtents[i] + radiusB) {
+			return false;
+		}
+	}
+	//* The axes of box b
+	for (int j = 0; j < 3; j++) {
+		const float radiusA = a.halfExtents.x * absoluteRotation[0][j] + a.halfExtents.y * absoluteRotation[1][j] + a.halfExtents.z * absoluteRotation[2][j];
+		const float projection = translation[0] * rotation[0][j] + translation[1] * rotation[1][j] + translation[2] * rotation[2][j];
+		if (std::abs(projection) > radiusA + b.halfExtents[j]) {
+			return false;
+		}
+	}
+	//* The cross products of axis i of box a and axis j of box b
+	for (int i = 0; i < 3; i++) {
+		const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; j++) {
+			const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			const float radiusA = a.halfExtents[i1] * absoluteRotation[i2][j] + a.halfExtents[i2] * absoluteRotation[i1][j];
+			const float radiusB = b.halfExtents[j1] * absoluteRotation[i][j2] + b.halfExtents[j2] * absoluteRotation[i][j1];
+			if (std::abs(translation[i2] * rotation[i1][j] - translation[i1] * rotation[i2][j]) > radiusA + radiusB) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Along every world axis, the box reaches as far as its three axes reach along it together
+AABB Collision::getBounds(const OBB& box) {
+	const glm::vec3 extents = glm::abs(box.axes[0]) * box.halfExtents.x + glm::abs(box.axes[1]) * box.halfExtents.y
+		+ glm::abs(box.axes[2]) * box.halfExtents.z;
+	return { box.center - extents, box.center + extents };
+}
+
+// The model matrix's first three columns are the cube's axes, scaled by the cube's size along them
+OBB Collision::getCubeBox(const glm::mat4& modelMatrix) {
+	OBB box;
+	box.center = glm::vec3(modelMatrix[3]);
+	for (int i = 0; i < 3; i++) {
+		const glm::vec3 axis(modelMatrix[i]);
+		const float length = glm::length(axis);
+		box.axes[i] = length > 0.0f ? axis / length : glm::vec3(i == 0, i == 1, i == 2);
+		box.halfExtents[i] = 0.5f * length;
+	}
+	return box;
+}
+
+// In the box's coordinate system, the sphere touches the box as soon as its center enters the box grown by the radius
+// That is a ray test against the grown box: along each axis, the ray is between the box's two sides for a while ("slab"),
+// and it is inside the box while it is between the sides of all three axes at once
+// The grown box has sharp edges and corners where the sphere's path really has rounded ones, so near those the sphere stops a
+// little early, by at most the radius times 0.7. A sphere that already starts inside the box doesn't hit it, so it can always get out again
+bool Collision::sweepSphere(const glm::vec3& start, const glm::vec3& movement, const float radius, const OBB& box, float& hitFraction, glm::vec3& hitNormal) {
+	const glm::vec3 distance = start - box.center;
+	const glm::vec3 localStart(glm::dot(distance, box.axes[0]), glm::dot(distance, box.axes[1]), glm::dot(distance, box.axes[2]));
+	const glm::vec3 localMovement(glm::dot(movement, box.axes[0]), glm::dot(movement, box.axes[1]), glm::dot(movement, box.axes[2]));
+	const glm::vec3 extents = box.halfExtents + radius;
+	if (glm::all(glm::lessThanEqual(glm::abs(localStart), extents))) {
+		return false;
+	}
+
+	float enterFraction = 0.0f, exitFraction = 1.0f;
+	int enterAxis = -1;
+	float enterSide = 0.0f;
+	for (int i = 0; i < 3; i++) {
+		if (localMovement[i] == 0.0f) {
+			// Moving alongside the slab: it never enters it if it doesn't start between its sides
+			if (std::abs(localStart[i]) > extents[i]) {
+				return false;
+			}
+			continue;
+		}
+		// The side facing the movement is entered first
+		const float side = localMovement[i] > 0.0f ? -1.0f : 1.0f;
+		const float nearFraction = (side * extents[i] - localStart[i]) / localMovement[i];
+		const float farFraction = (-side * extents[i] - localStart[i]) / localMovement[i];
+		if (nearFraction > enterFraction || enterAxis == -1) {
+			enterFraction = nearFraction;
+			enterAxis = i;
+			enterSide = side;
+		}
+		exitFraction = std::min(exitFraction, farFraction);
+	}
+	if (enterAxis == -1 || enterFraction < 0.0f || enterFraction > 1.0f || enterFraction > exitFraction) {
+		return false;
+	}
+	hitFraction = enterFraction;
+	hitNormal = box.axes[enterAxis] * enterSide;
+	return true;
+}
+
+// Moves up to where the sphere hits the closest collider, then slides the rest of the way along the collider's side
+// Sliding may run into another collider, so that is repeated a few times. The sphere stops a tiny distance before every
+// collider it hits, so it doesn't start the next step inside of it
+bool Collision::moveSphere(const glm::vec3& start, glm::vec3& movement, const float radius) {
+	const unsigned int maximumSlides = 3;
+	const float skinDistance = 0.001f;
+	glm::vec3 position = start, remainingMovement = movement;
+	bool hitAny = false;
+	for (unsigned int slide = 0; slide <= maximumSlides && remainingMovement != glm::vec3(0.0f); slide++) {
+		//* Only the colliders around the sphere's path can be hit
+		const glm::vec3 end = position + remainingMovement;
+		const AABB path = { glm::min(position, end) - radius, glm::max(position, end) + radius };
+		sweepCandidates.clear();
+		if (colliderBroadphase == Broadphase::SweepAndPrune) {
+			colliderSweepAndPrune.query(path, sweepCandidates);
+		}
+		else {
+			colliderSpatialHash.query(colliderBounds, path, sweepCandidates);
+		}
+
+		float closestFraction = 1.0f;
+		glm::vec3 closestNormal(0.0f);
+		bool hit = false;
+		for (const unsigned int candidate : sweepCandidates) {
+			float fraction;
+			glm::vec3 normal;
+			if (sweepSphere(position, remainingMovement, radius, colliders[candidate], fraction, normal) && fraction <= closestFraction) {
+				closestFraction = fraction;
+				closestNormal = normal;
+				hit = true;
+			}
+		}
+		if (!hit) {
+			position += remainingMovement;
+			break;
+		}
+		hitAny = true;
+
+		//* Move up to the collider, then take away the part of the rest of the movement that goes into it
+		const float length = glm::length(remainingMovement);
+		position += remainingMovement * std::max(closestFraction - skinDistance / length, 0.0f);
+		remainingMovement *= 1.0f - closestFraction;
+		remainingMovement -= closestNormal * std::min(glm::dot(remainingMovement, closestNormal), 0.0f);
+	}
+	if (hitAny) {
+		movement = position - start;
+	}
+	return hitAny;
+}
+
+// Moves 100K rotated boxes around and times how long each broadphase takes to find the pairs of them whose bounds overlap
+// The boxes are either crowded into a cube or spread across a flat open world, and move either a little or far every step
+// The pairs of every broadphase are compared with each other, and the last step's pairs with testing every box against every other one
+void Collision::printBenchmark() {
+	const unsigned int boxCount = 100000, steps = 30;
+	const float timestep = 1.0f / 60.0f;
+	struct Scenario {
+		const char* name;
+		glm::vec3 worldSize;
+		float speed;
+	};
+	const Scenario scenarios[] = {
+		{ "Crowded cube of 100x100x100 units, slow boxes (2 units/s)", glm::vec3(100.0f, 100.0f, 100.0f), 2.0f },
+		{ "Crowded cube of 100x100x100 units, fast boxes (60 units/s)", glm::vec3(100.0f, 100.0f, 100.0f), 60.0f },
+		{ "Open world of 1000x20x1000 units, slow boxes (2 units/s)", glm::vec3(1000.0f, 20.0f, 1000.0f), 2.0f },
+		{ "Open world of 1000x20x1000 units, fast boxes (60 units/s)", glm::vec3(1000.0f, 20.0f, 1000.0f), 60.0f },
+	};
+
+	std::cout << "Broadphase benchmark, " << boxCount << " boxes of 0.5 to 1.5 units, " << steps << " steps of " << timestep * 1000.0f << " ms" << std::endl;
+
+	std::vector<OBB> boxes(boxCount);
+	std::vector<glm::vec3> velocities(boxCount);
+	std::vector<AABB> bounds(boxCount);
+	size_t lastPairCount = 0;
+	for (const Scenario& scenario : scenarios) {
+		//* Every scenario starts out with the same boxes, only their speed differs
+		std::mt19937 generator(7);
+		std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f), sizeDistribution(0.25f, 0.75f);
+		std::normal_distribution<float> directionDistribution;
+		for (unsigned int i = 0; i < boxCount; i++) {
+			const glm::quat orientation = glm::normalize(glm::quat(directionDistribution(generator), directionDistribution(generator),
+				directionDistribution(generator), directionDistribution(generator)));
+			boxes[i].center = glm::vec3(positionDistribution(generator), positionDistribution(generator), positionDistribution(generator)) * scenario.worldSize;
+			boxes[i].halfExtents = glm::vec3(sizeDistribution(generator), sizeDistribution(generator), sizeDistribution(generator));
+			boxes[i].axes = glm::mat3_cast(orientation);
+			velocities[i] = glm::normalize(glm::vec3(directionDistribution(generator), directionDistribution(generator),
+				directionDistribution(generator))) * scenario.speed;
+			bounds[i] = getBounds(boxes[i]);
+		}
+
+		//* Each broadphase runs once before the timing starts, which sorts the boxes and allocates the memory
+		SweepAndPrune incremental, fromScratch;
+		SpatialHash spatialHash(1.5f);
+		incremental.update(bounds);
+		spatialHash.update(bounds);
+		double incrementalMilliseconds = 0.0, fromScratchMilliseconds = 0.0, spatialHashMilliseconds = 0.0, narrowphaseMilliseconds = 0.0;
+		unsigned long long swaps = 0, pairCount = 0, touchingCount = 0;
+		bool pairsMatch = true;
+		for (unsigned int step = 0; step < steps; step++) {
+			//* The boxes bounce off the sides of the world
+			for (unsigned int i = 0; i < boxCount; i++) {
+				boxes[i].center += velocities[i] * timestep;
+				for (int axis = 0; axis < 3; axis++) {
+					if (boxes[i].center[axis] < 0.0f || boxes[i].center[axis] > scenario.worldSize[axis]) {
+						velocities[i][axis] = -velocities[i][axis];
+						boxes[i].center[axis] = glm::clamp(boxes[i].center[axis], 0.0f, scenario.worldSize[axis]);
+					}
+				}
+				bounds[i] = getBounds(boxes[i]);
+			}
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			incremental.update(bounds);
+			incrementalMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			swaps += incremental.getSwapCount();
+
+			start = std::chrono::steady_clock::now();
+			fromScratch.reset();
+			fromScratch.update(bounds);
+			fromScratchMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			spatialHash.update(bounds);
+			spatialHashMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			//* Which of the pairs really touch
+			start = std::chrono::steady_clock::now();
+			for (const CollisionPair& pair : incremental.getPairs()) {
+				touchingCount += testOverlap(boxes[pair.first], boxes[pair.second]);
+			}
+			narrowphaseMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			pairCount += incremental.getPairs().size();
+
+			std::vector<CollisionPair> incrementalPairs = incremental.getPairs(), fromScratchPairs = fromScratch.getPairs(), spatialHashPairs = spatialHash.getPairs();
+			std::sort(incrementalPairs.begin(), incrementalPairs.end(), comparePairs);
+			std::sort(fromScratchPairs.begin(), fromScratchPairs.end(), comparePairs);
+			std::sort(spatialHashPairs.begin(), spatialHashPairs.end(), comparePairs);
+			pairsMatch = pairsMatch && incrementalPairs.size() == fromScratchPairs.size() && incrementalPairs.size() == spatialHashPairs.size()
+				&& std::equal(incrementalPairs.begin(), incrementalPairs.end(), fromScratchPairs.begin(),
+					[](const CollisionPair& a, const CollisionPair& b) { return a.first == b.first && a.second == b.second; })
+				&& std::equal(incrementalPairs.begin(), incrementalPairs.end(), spatialHashPairs.begin(),
+					[](const CollisionPair& a, const CollisionPair& b) { return a.first == b.first && a.second == b.second; });
+		}
+
+		std::cout << scenario.name << ": " << pairCount / steps << " pairs per step, " << touchingCount / steps << " of them touching, "
+			<< swaps / steps << " swaps per step" << std::endl;
+		std::cout << std::fixed << std::setprecision(3)
+			<< "  " << std::setw(40) << std::left << "Sweep and prune (incremental)" << std::right << std::setw(10) << incrementalMilliseconds / steps << " ms/step" << std::endl
+			<< "  " << std::setw(40) << std::left << "Sweep and prune (sorted from scratch)" << std::right << std::setw(10) << fromScratchMilliseconds / steps << " ms/step" << std::endl
+			<< "  " << std::setw(40) << std::left << "Spatial hash" << std::right << std::setw(10) << spatialHashMilliseconds / steps << " ms/step" << std::endl
+			<< "  " << std::setw(40) << std::left << "OBB narrowphase of the pairs" << std::right << std::setw(10) << narrowphaseMilliseconds / steps << " ms/step" << std::endl
+			<< std::defaultfloat;
+		if (!pairsMatch) {
+			std::cout << "Error: The broadphases found different pairs" << std::endl;
+		}
+		lastPairCount = incremental.getPairs().size();
+	}
+
+	//* Every box against every other one, for the last step only
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	unsigned long long bruteForcePairCount = 0;
+	for (unsigned int i = 0; i < boxCount; i++) {
+		for (unsigned int j = i + 1; j < boxCount; j++) {
+			bruteForcePairCount += testOverlap(bounds[i], bounds[j]);
+		}
+	}
+	const double bruteForceMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << std::fixed << std::setprecision(3) << "Testing every box against every other one: " << bruteForceMilliseconds << " ms for "
+		<< bruteForcePairCount << " pairs" << std::defaultfloat << std::endl;
+	if (bruteForcePairCount != lastPairCount) {
+		std::cout << "Error: The broadphases found " << lastPairCount << " pairs in the last step" << std::endl;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "dynamicResolution.hpp"
+#include "shaderLibrary.hpp"
+#include "window.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// GPU timer results arrive a few frames late; this many frames may be in flight before we stop issuing new queries
+const unsigned int timerQueryLatency = 4;
+// The target frame time is only aimed at to this share so that small spikes don't push the frame over budget right away
+const float budgetHeadroom = 0.9f;
+// The scale only changes if the smoothed frame time leaves this range around the aimed at time, which prevents it from flickering back and forth
+const float scaleDeadband = 0.1f;
+// Largest change of the scale per frame; going down is faster than going up as a frame over budget is worse than one below it
+const float maxScaleDecrease = 0.05f, maxScaleIncrease = 0.02f;
+// Weight of the newest frame time in the smoothed frame time
+const float gpuTimeSmoothing = 0.1f;
+// Strength of the sharpening at the lowest scales; there is nothing to sharpen at full resolution
+const float maxSharpness = 0.25f;
+
+bool dynamicResolutionEnabled = true;
+float minRenderScale = 0.5f, maxRenderScale = 1.0f, targetGpuMilliseconds = 16.0f;
+// Scale of the render resolution along each axis, so the number of pixels shrinks with its square
+float renderScale = 1.0f;
+float smoothedGpuMilliseconds = 0.0f;
+bool hasGpuTime = false;
+unsigned int renderWidth = 0, renderHeight = 0;
+
+// Timestamps at the start and end of the scene, one pair per frame in flight
+unsigned int frameStartQueryIDs[timerQueryLatency], frameEndQueryIDs[timerQueryLatency];
+bool queryPending[timerQueryLatency] = {};
+unsigned int querySlot = 0;
+bool frameQueried = false;
+
+// There is nothing to sharpen at full resolution, so the upscaling uses a variant of its shader without the sharpening
+// (keyword SHARPEN), which saves four samples per pixel. The programs belong to the ShaderLibrary
+struct UpscaleVariant {
+	Shader* shader;
+	int sourceScaleLocation, sourceTexelSizeLocation, sharpnessLocation;
+};
+// [0] => Plain upscaling, [1] => Upscaling with sharpening
+UpscaleVariant upscaleVariants[2] = {};
+// Core profile needs a bound VAO for drawing, even if the vertex shader doesn't read any vertex data
+GLVertexArray upscaleVAO;
+
+// Picks up the GPU time of the frame that used the current query slot a few frames ago, if it has arrived by now
+void readGpuTime() {
+	if (!queryPending[querySlot]) {
+		return;
+	}
+	GLint available = 0;
+	glGetQueryObjectiv(frameEndQueryIDs[querySlot], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) {
+		return;
+	}
+	GLuint64 startNanoseconds = 0, endNanoseconds = 0;
+	glGetQueryObjectui64v(frameStartQueryIDs[querySlot], GL_QUERY_RESULT, &startNanoseconds);
+	glGetQueryObjectui64v(frameEndQueryIDs[querySlot], GL_QUERY_RESULT, &endNanoseconds);
+	queryPending[querySlot] = false;
+
+	const float milliseconds = (endNanoseconds - startNanoseconds) / 1000000.0f;
+	smoothedGpuMilliseconds = hasGpuTime ? smoothedGpuMilliseconds + (milliseconds - smoothedGpuMilliseconds) * gpuTimeSmoothing : milliseconds;
+	hasGpuTime = true;
+}
+
+// Moves the scale towards the one at which the frame is expected to take the aimed at time
+void updateScale() {
+	if (!hasGpuTime || smoothedGpuMilliseconds <= 0.0f) {
+		return;
+	}
+	const float aimedMilliseconds = targetGpuMilliseconds * budgetHeadroom;
+	const float ratio = smoothedGpuMilliseconds / aimedMilliseconds;
+	if (ratio > 1.0f - scaleDeadband && ratio < 1.0f + scaleDeadband) {
+		return;
+	}
+	// The frame time is roughly proportional to the number of pixels, which grows with the square of the scale
+	const float idealScale = renderScale * std::sqrt(1.0f / ratio);
+	const float scale = std::min(std::max(idealScale, renderScale - maxScaleDecrease), renderScale + maxScaleIncrease);
+	renderScale = std::min(std::max(scale, minRenderScale), maxRenderScale);
+}
+
+//** Public **//
+// The scale is kept between minScale and maxScale (along each axis); targetMilliseconds is the GPU time a frame should take at most
+void DynamicResolution::initialize(const float minScale, const float maxScale, const float targetMilliseconds) {
+	minRenderScale = minScale;
+	maxRenderScale = maxScale;
+	targetGpuMilliseconds = targetMilliseconds;
+	renderScale = maxScale;
+	Window::getFramebufferSize(renderWidth, renderHeight);
+
+	glGenQueries(timerQueryLatency, frameStartQueryIDs);
+	glGenQueries(timerQueryLatency, frameEndQueryIDs);
+	upscaleVAO = GLVertexArray(GLMemoryCategory::Geometry, "Upscale VAO");
+
+	const std::vector<std::string> variantKeywords[2] = { {}, { "SHARPEN" } };
+	for (unsigned int i = 0; i < 2; i++) {
+		UpscaleVariant& variant = upscaleVariants[i];
+		variant.shader = &ShaderLibrary::getShader("res/shaders/upscaleShader.vert", "res/shaders/upscaleShader.frag", variantKeywords[i]);
+		variant.shader->use();
+		variant.shader->setInt("sceneTexture", 0);
+		// The other uniforms change every frame, so we look up their locations only once
+		// The plain variant has no sharpness, so its location is -1, which glUniform() ignores
+		variant.sourceScaleLocation = variant.shader->getUniformLocation("sourceScale");
+		variant.sourceTexelSizeLocation = variant.shader->getUniformLocation("sourceTexelSize");
+		variant.sharpnessLocation = variant.shader->getUniformLocation("sharpness");
+	}
+}
+
+// Should be called before anything of the frame is drawn. Picks this frame's resolution; the scene is then rendered into the scene target
+void DynamicResolution::beginFrame() {
+	unsigned int framebufferWidth, framebufferHeight;
+	Window::getFramebufferSize(framebufferWidth, framebufferHeight);
+	if (!dynamicResolutionEnabled) {
+		renderWidth = framebufferWidth;
+		renderHeight = framebufferHeight;
+		glViewport(0, 0, renderWidth, renderHeight);
+		return;
+	}
+
+	readGpuTime();
+	updateScale();
+
+	// The scene target is allocated for the largest scale and the scene is rendered into its lower left corner,
+	// so changing the scale never has to reallocate anything
+	const unsigned int sceneTargetWidth = std::max(1u, (unsigned int)std::ceil(framebufferWidth * maxRenderScale));
+	const unsigned int sceneTargetHeight = std::max(1u, (unsigned int)std::ceil(framebufferHeight * maxRenderScale));
+	renderWidth = std::max(1u, std::min((unsigned int)(framebufferWidth * renderScale + 0.5f), sceneTargetWidth));
+	renderHeight = std::max(1u, std::min((unsigned int)(framebufferHeight * renderScale + 0.5f), sceneTargetHeight));
+	glViewport(0, 0, renderWidth, renderHeight);
+
+	// If the GPU is so far behind that the slot's last result still hasn't arrived, this frame simply goes unmeasured
+	frameQueried = !queryPending[querySlot];
+	if (frameQueried) {
+		glQueryCounter(frameStartQueryIDs[querySlot], GL_TIMESTAMP);
+	}
+}
+
+// Should be called after everything of the frame is drawn, with the window's framebuffer bound. Scales the scene up to the window
+// The scene target is the texture of getSceneTargetScale() times the window's size that the scene was rendered into
+void DynamicResolution::upscale(const unsigned int sceneTextureID, const unsigned int sceneTargetWidth, const unsigned int sceneTargetHeight) {
+	if (!dynamicResolutionEnabled) {
+		return;
+	}
+	if (frameQueried) {
+		glQueryCounter(frameEndQueryIDs[querySlot], GL_TIMESTAMP);
+		queryPending[querySlot] = true;
+	}
+	querySlot = (querySlot + 1) % timerQueryLatency;
+
+	unsigned int framebufferWidth, framebufferHeight;
+	Window::getFramebufferSize(framebufferWidth, framebufferHeight);
+	glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+	//* Draw a single triangle covering the window that samples the scene target
+	// The scene covers every pixel of the window, so there is no need for depth testing or clearing
+	glDisable(GL_DEPTH_TEST);
+	const float upscaleFactor = (float)framebufferWidth / renderWidth;
+	const float sharpness = maxSharpness * std::min(std::max(upscaleFactor - 1.0f, 0.0f), 1.0f);
+	const UpscaleVariant& variant = upscaleVariants[sharpness > 0.0f ? 1 : 0];
+	variant.shader->use();
+	glUniform2f(variant.sourceScaleLocation, (float)renderWidth / sceneTargetWidth, (float)renderHeight / sceneTargetHeight);
+	glUniform2f(variant.sourceTexelSizeLocation, 1.0f / sceneTargetWidth, 1.0f / sceneTargetHeight);
+	glUniform1f(variant.sharpnessLocation, sharpness);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, sceneTextureID);
+	glBindVertexArray(upscaleVAO.getID());
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+	glEnable(GL_DEPTH_TEST);
+}
+
+// Deletes the upscaling resources. Has to be called while the OpenGL context still exists
+void DynamicResolution::shutdown() {
+	glDeleteQueries(timerQueryLatency, frameStartQueryIDs);
+	glDeleteQueries(timerQueryLatency, frameEndQueryIDs);
+	upscaleVariants[0] = upscaleVariants[1] = {};
+	upscaleVAO.reset();
+}
+
+void DynamicResolution::setEnabled(const bool enabled) {
+	dynamicResolutionEnabled = enabled;
+}
+
+bool DynamicResolution::isEnabled() {
+	return dynamicResolutionEnabled;
+}
+
+// Size of the scene target relative to the window along each axis, which is the largest scale
+float DynamicResolution::getSceneTargetScale() {
+	return maxRenderScale;
+}
+
+// Current scale of the render resolution along each axis
+float DynamicResolution::getScale() {
+	return dynamicResolutionEnabled ? renderScale : 1.0f;
+}
+
+// Smoothed GPU time of the scene (without the upscaling), as measured a few frames ago
+float DynamicResolution::getGpuMilliseconds() {
+	return smoothedGpuMilliseconds;
+}
+
+// Size the scene is rendered at this frame. Anything that works in pixels (like gl_FragCoord) should use this instead of the window size
+void DynamicResolution::getRenderSize(unsigned int& width, unsigned int& height) {
+	width = renderWidth;
+	height = renderHeight;
+}
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+#include "entities.hpp"
+#include "jobSystem.hpp"
+
+//** Private **//
+//* Components, indexed by the entity's position in the arrays
+std::vector<Transform> entityTransforms;
+std::vector<glm::vec3> entityAngularVelocities;
+std::vector<unsigned int> entityMeshIDs;
+std::vector<unsigned int> entityMaterialIDs;
+// Handle slot of the entity at each position, needed to fix up the slot when the entity is moved
+std::vector<unsigned int> entitySlots;
+
+//* Handle slots, indexed by Entity::slot
+std::vector<unsigned int> slotIndices;		// Position of the slot's entity in the component arrays
+std::vector<unsigned int> slotGenerations;	// Increased whenever the slot's entity is destroyed
+std::vector<unsigned int> freeSlots;
+
+// The entities of mesh m are found at [meshGroupStarts[m], meshGroupStarts[m + 1]); the last element is always the entity count
+std::vector<unsigned int> meshGroupStarts(1, 0);
+
+void moveEntity(const unsigned int from, const unsigned int to) {
+	entityTransforms[to] = entityTransforms[from];
+	entityAngularVelocities[to] = entityAngularVelocities[from];
+	entityMeshIDs[to] = entityMeshIDs[from];
+	entityMaterialIDs[to] = entityMaterialIDs[from];
+	entitySlots[to] = entitySlots[from];
+	slotIndices[entitySlots[to]] = to;
+}
+
+void clearEntities() {
+	entityTransforms.clear();
+	entityAngularVelocities.clear();
+	entityMeshIDs.clear();
+	entityMaterialIDs.clear();
+	entitySlots.clear();
+	slotIndices.clear();
+	slotGenerations.clear();
+	freeSlots.clear();
+	meshGroupStarts.assign(1, 0);
+}
+
+// Turns every entity by its angular velocity
+void rotateEntities(const unsigned int first, const unsigned int last, void* data) {
+	const float deltaTime = *static_cast<const float*>(data);
+	for (unsigned int i = first; i < last; i++) {
+		const float speed = glm::length(entityAngularVelocities[i]);
+		if (speed == 0.0f) {
+			continue;
+		}
+		// Quaternions have to be normalized again every now and then, or else rounding errors slowly distort the rotation
+		const glm::quat rotation = glm::angleAxis(speed * deltaTime, entityAngularVelocities[i] / speed);
+		Transforms::setLocalOrientation(entityTransforms[i], glm::normalize(rotation * Transforms::getLocalOrientation(entityTransforms[i])));
+	}
+}
+
+Entity storeEntity(const unsigned int meshID, const unsigned int materialID, const Transform transform, const glm::vec3& angularVelocity) {
+	//* Meshes that haven't been seen yet start out with an empty group at the end
+	while (meshGroupStarts.size() < meshID + 2) {
+		meshGroupStarts.push_back(meshGroupStarts.back());
+	}
+
+	//* Make room at the end of the mesh's group
+	// The free element at the end of the arrays wanders forwards: every following group moves its first entity to its end
+	unsigned int freeIndex = meshGroupStarts.back();
+	entityTransforms.emplace_back();
+	entityAngularVelocities.emplace_back();
+	entityMeshIDs.emplace_back();
+	entityMaterialIDs.emplace_back();
+	entitySlots.emplace_back();
+	for (unsigned int group = (unsigned int)meshGroupStarts.size() - 2; group > meshID; group--) {
+		if (meshGroupStarts[group] != freeIndex) {
+			moveEntity(meshGroupStarts[group], freeIndex);
+		}
+		freeIndex = meshGroupStarts[group];
+		meshGroupStarts[group]++;
+	}
+	meshGroupStarts.back()++;
+
+	//* Hand out a slot for the handle, reusing the slots of destroyed entities first
+	Entity entity;
+	if (!freeSlots.empty()) {
+		entity.slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+	else {
+		entity.slot = (unsigned int)slotIndices.size();
+		slotIndices.push_back(0);
+		slotGenerations.push_back(0);
+	}
+	entity.generation = slotGenerations[entity.slot];
+	slotIndices[entity.slot] = freeIndex;
+
+	entityTransforms[freeIndex] = transform;
+	entityAngularVelocities[freeIndex] = angularVelocity;
+	entityMeshIDs[freeIndex] = meshID;
+	entityMaterialIDs[freeIndex] = materialID;
+	entitySlots[freeIndex] = entity.slot;
+	return entity;
+}
+
+//** Public **//
+// Makes room for the given number of entities, so creating them doesn't reallocate the arrays over and over
+void Entities::reserve(const unsigned int entityCount) {
+	entityTransforms.reserve(entityCount);
+	entityAngularVelocities.reserve(entityCount);
+	entityMeshIDs.reserve(entityCount);
+	entityMaterialIDs.reserve(entityCount);
+	entitySlots.reserve(entityCount);
+	slotIndices.reserve(entityCount);
+	slotGenerations.reserve(entityCount);
+}
+
+// The entity's transform is at the top of the transform hierarchy
+Entity Entities::create(const unsigned int meshID, const unsigned int materialID, const glm::vec3& position,
+	const glm::vec3& angularVelocity, const float scale, const glm::quat& orientation) {
+	return storeEntity(meshID, materialID, Transforms::create(position, orientation, scale), angularVelocity);
+}
+
+// The entity's transform is relative to the parent's, so it follows the parent around. The parent has to outlive it
+Entity Entities::createChild(const Entity parent, const unsigned int meshID, const unsigned int materialID, const glm::vec3& position,
+	const glm::vec3& angularVelocity, const float scale, const glm::quat& orientation) {
+	if (!isAlive(parent)) {
+		std::cout << "Error: The parent of a new entity doesn't exist (anymore)" << std::endl;
+		return create(meshID, materialID, position, angularVelocity, scale, orientation);
+	}
+	const Transform parentTransform = entityTransforms[slotIndices[parent.slot]];
+	return storeEntity(meshID, materialID, Transforms::createChild(parentTransform, position, orientation, scale), angularVelocity);
+}
+
+void Entities::destroy(const Entity entity) {
+	if (!isAlive(entity)) {
+		std::cout << "Error: Tried to destroy an entity that doesn't exist (anymore)" << std::endl;
+		return;
+	}
+	const unsigned int index = slotIndices[entity.slot];
+	const unsigned int meshID = entityMeshIDs[index];
+	Transforms::destroy(entityTransforms[index]);
+
+	//* Close the gap with the last entity of the mesh's group, then the gap wanders backwards through the following groups
+	// Every following group moves its last entity to the gap just before it, until the gap reaches the end of the arrays
+	unsigned int gapIndex = index;
+	for (unsigned int group = meshID; group + 1 < meshGroupStarts.size(); group++) {
+		const unsigned int lastIndex = meshGroupStarts[group + 1] - 1;
+		if (group > meshID) {
+			if (meshGroupStarts[group] == meshGroupStarts[group + 1]) {
+				meshGroupStarts[group]--;
+				continue;
+			}
+			meshGroupStarts[group]--;
+		}
+		if (lastIndex != gapIndex) {
+			moveEntity(lastIndex, gapIndex);
+		}
+		gapIndex = lastIndex;
+	}
+	meshGroupStarts.back()--;
+	entityTransforms.pop_back();
+	entityAngularVelocities.pop_back();
+	entityMeshIDs.pop_back();
+	entityMaterialIDs.pop_back();
+	entitySlots.pop_back();
+
+	// The handle becomes invalid, and the slot can be used for a new entity
+	slotGenerations[entity.slot]++;
+	freeSlots.push_back(entity.slot);
+}
+
+bool Entities::isAlive(const Entity entity) {
+	return entity.slot < slotGenerations.size() && slotGenerations[entity.slot] == entity.generation;
+}
+
+// Current position of the entity in the component arrays. Only valid until the next entity is created or destroyed
+unsigned int Entities::getIndex(const Entity entity) {
+	return slotIndices[entity.slot];
+}
+
+unsigned int Entities::getCount() {
+	return (unsigned int)entityTransforms.size();
+}
+
+// All entities with the given mesh are found at [first, first + count) in the component arrays
+void Entities::getMeshRange(const unsigned int meshID, unsigned int& first, unsigned int& count) {
+	if (meshID + 1 >= meshGroupStarts.size()) {
+		first = count = 0;
+		return;
+	}
+	first = meshGroupStarts[meshID];
+	count = meshGroupStarts[meshID + 1] - first;
+}
+
+const Transform* Entities::getTransforms() {
+	return entityTransforms.data();
+}
+
+glm::vec3* Entities::getAngularVelocities() {
+	return entityAngularVelocities.data();
+}
+
+const unsigned int* Entities::getMeshIDs() {
+	return entityMeshIDs.data();
+}
+
+unsigned int* Entities::getMaterialIDs() {
+	return entityMaterialIDs.data();
+}
+
+// Advances the entities by the given number of seconds. Should be called once per frame before the scene is drawn
+void Entities::update(const float deltaTime) {
+	if (deltaTime == 0.0f) {
+		return;
+	}
+	float rotationTime = deltaTime;
+	JobSystem::parallelFor(getCount(), 4096, rotateEntities, &rotationTime);
+}
+
+void Entities::printBenchmark() {
+	const unsigned int entityCount = 200000;
+	const unsigned int meshCount = 8;
+	JobSystem::initialize(0);
+	clearEntities();
+	reserve(entityCount);
+
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+	std::vector<Entity> handles(entityCount);
+
+	//* Create all entities, spread across the meshes in random order so that every creation has to shift groups
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < entityCount; i++) {
+		handles[i] = create(random() % meshCount, 0, glm::vec3(coordinate(random), coordinate(random), coordinate(random)), glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	const double createSeconds = std::chrono::duration<double>(end - start).count();
+
+	//* Update them all a few times
+	const int updateCount = 10;
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < updateCount; i++) {
+		update(1.0f / 60.0f);
+	}
+	end = std::chrono::steady_clock::now();
+	const double updateMilliseconds = std::chrono::duration<double, std::milli>(end - start).count() / updateCount;
+
+	//* Destroy them in random order
+	std::shuffle(handles.begin(), handles.end(), random);
+	start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < entityCount; i++) {
+		destroy(handles[i]);
+	}
+	end = std::chrono::steady_clock::now();
+	const double destroySeconds = std::chrono::duration<double>(end - start).count();
+
+	std::cout << "Entity store with " << entityCount << " entities across " << meshCount << " meshes:" << std::endl;
+	std::cout << "  create:  " << entityCount / createSeconds << " entities per second" << std::endl;
+	std::cout << "  destroy: " << entityCount / destroySeconds << " entities per second" << std::endl;
+	std::cout << "  update:  " << updateMilliseconds << " ms for all entities on " << JobSystem::getThreadCount() << " threads" << std::endl;
+
+	clearEntities();
+	JobSystem::shutdown();
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "frameArena.hpp"
+
+//** Private **//
+std::unique_ptr<unsigned char[]> arenaMemory;
+size_t arenaCapacity = 0;
+size_t arenaOffset = 0;
+size_t arenaPeak = 0;
+// Allocations that didn't fit, counted instead of printed as the allocator mustn't do more work than necessary; see getOverflowCount()
+unsigned long long arenaOverflowCount = 0;
+
+// Allocations that didn't fit into the arena anymore. They are freed on reset and the arena grows to fit them next frame
+std::vector<void*> overflowAllocations;
+
+//** Public **//
+void FrameArena::initialize(const size_t capacityBytes) {
+	arenaMemory.reset(new unsigned char[capacityBytes]);
+	arenaCapacity = capacityBytes;
+	arenaOffset = 0;
+	overflowAllocations.reserve(64);
+}
+
+// Should be called at the top of every frame; invalidates everything that was allocated during the previous frame
+void FrameArena::reset() {
+	for (unsigned int i = 0; i < overflowAllocations.size(); i++) {
+		::operator delete(overflowAllocations[i]);
+	}
+	overflowAllocations.clear();
+
+	//* Grow the arena if the previous frame didn't fit into it
+	// This only happens until the arena has reached the size of the largest frame, after that no frame allocates anymore
+	if (arenaPeak > arenaCapacity) {
+		initialize(arenaPeak * 2);
+	}
+	arenaOffset = 0;
+}
+
+void* FrameArena::allocate(const size_t size, const size_t alignment) {
+	// Round the offset up to the next multiple of the alignment (which is always a power of 2)
+	const size_t alignedOffset = (arenaOffset + alignment - 1) & ~(alignment - 1);
+	if (alignedOffset + size > arenaCapacity) {
+		arenaOverflowCount++;
+		arenaPeak = std::max(arenaPeak, alignedOffset + size);
+		arenaOffset = alignedOffset + size;
+		// operator new returns memory that is suitably aligned for any fundamental type
+		void* memory = ::operator new(size);
+		overflowAllocations.push_back(memory);
+		return memory;
+	}
+
+	arenaOffset = alignedOffset + size;
+	arenaPeak = std::max(arenaPeak, arenaOffset);
+	return arenaMemory.get() + alignedOffset;
+}
+
+// Largest amount of memory a single frame has used so far
+size_t FrameArena::getPeakUsage() {
+	return arenaPeak;
+}
+
+// Number of allocations so far that were too large for the arena and came from the heap instead
+unsigned long long FrameArena::getOverflowCount() {
+	return arenaOverflowCount;
+}
\ No newline at end of file
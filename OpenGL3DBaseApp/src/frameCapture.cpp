@@ -0,0 +1,561 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include "frameCapture.hpp"
+#include "window.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Frames whose pixels may be on their way from the GPU at once; a frame's pixels are mapped up to this many frames after it was drawn
+const unsigned int readbackRingSize = 3;
+// Frames that may wait for the encoder thread at once
+const unsigned int encoderQueueSize = 4;
+
+struct FrameReadback {
+	GLBuffer buffer;
+	GLsync fence;				// Signals once the GPU has copied the frame into the buffer; nullptr while the buffer is free
+	unsigned int frameNumber;
+};
+
+// The pixels of a frame on their way to the encoder thread: RGBA, with the rows from bottom to top as OpenGL reads them
+struct CapturedFrame {
+	std::vector<unsigned char> pixels;
+	unsigned int frameNumber;
+};
+
+bool frameCaptureRunning = false;
+FrameCaptureFormat captureFormat = FrameCaptureFormat::Png;
+std::string capturePath;
+unsigned int captureWidth = 0, captureHeight = 0;
+FrameReadback frameReadbacks[readbackRingSize];
+// Readback the next frame goes into; the readbacks after it hold the older frames that may still be on their way
+unsigned int nextFrameReadback = 0;
+unsigned int capturedFrameCount = 0;
+
+//* Frames between the render thread and the encoder thread
+// Both lists have a fixed size, so handing a frame over never allocates. The render thread only ever holds the mutex briefly
+CapturedFrame capturedFrames[encoderQueueSize];
+CapturedFrame* freeCapturedFrames[encoderQueueSize];
+unsigned int freeCapturedFrameCount = 0;
+CapturedFrame* queuedCapturedFrames[encoderQueueSize];
+unsigned int queuedCapturedFrameFront = 0, queuedCapturedFrameCount = 0;
+std::mutex captureMutex;
+std::condition_variable capturedFrameQueued, capturedFrameFreed;
+bool stopEncoderThread = false;
+std::thread encoderThread;
+std::ofstream captureVideoFile;
+std::atomic<bool> captureWriteFailed(false);
+
+// Memory the encoder thread reuses for every frame, so that encoding and writing a frame doesn't allocate once the first frame is done
+struct EncoderScratch {
+	std::vector<unsigned char> pixels;		// The filtered scanlines of a PNG, or the planes of a Y4M frame
+	std::vector<unsigned char> compressed;
+	std::vector<unsigned char> file;
+	std::vector<int> hashHeads;
+	std::string path;
+	std::ofstream output;
+	// The file stream's buffer, which it would otherwise allocate whenever a file is opened
+	char outputBuffer[4096];
+};
+
+//* Statistics
+// Time the render thread spends queuing the copies, and handing over the frames whose copies have finished
+// On software renderers like Mesa's llvmpipe, the GPU is the CPU: the drawing that is still queued happens when the copy is queued
+double copyMilliseconds = 0.0, handOverMilliseconds = 0.0, worstCaptureMilliseconds = 0.0;
+unsigned int captureGpuStalls = 0, captureEncoderStalls = 0, skippedCaptureFrames = 0;
+
+//* PNG encoding
+// The images are compressed with deflate using its fixed Huffman codes and a simple, greedy search for repeated bytes,
+// which is fast and still makes rendered frames a lot smaller than storing them
+unsigned int pngCrcTable[256];
+// Codes of the literal and length symbols 0 to 287, bit-reversed as deflate writes Huffman codes starting with their highest bit
+unsigned int fixedLiteralCodes[288], fixedLiteralCodeLengths[288];
+const unsigned int lengthBases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const unsigned int lengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const unsigned int distanceBases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+	4097, 6145, 8193, 12289, 16385, 24577 };
+const unsigned int distanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+// Index into the tables above for every match length from 3 to 258
+unsigned char lengthSymbols[259];
+const unsigned int deflateWindowSize = 32768, matchHashBits = 15;
+
+unsigned int reverseBits(unsigned int value, const unsigned int count) {
+	unsigned int result = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		result = (result << 1) | (value & 1);
+		value >>= 1;
+	}
+	return result;
+}
+
+void prepareEncoderTables() {
+	for (unsigned int i = 0; i < 256; i++) {
+		unsigned int crc = i;
+		for (unsigned int bit = 0; bit < 8; bit++) {
+			crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+		}
+		pngCrcTable[i] = crc;
+	}
+	for (unsigned int symbol = 0; symbol < 288; symbol++) {
+		unsigned int code, length;
+		if (symbol < 144) { code = 0x30 + symbol; length = 8; }
+		else if (symbol < 256) { code = 0x190 + symbol - 144; length = 9; }
+		else if (symbol < 280) { code = symbol - 256; length = 7; }
+		else { code = 0xC0 + symbol - 280; length = 8; }
+		fixedLiteralCodes[symbol] = reverseBits(code, length);
+		fixedLiteralCodeLengths[symbol] = length;
+	}
+	for (unsigned int i = 0; i < 29; i++) {
+		const unsigned int end = i < 28 ? lengthBases[i + 1] : 259;
+		for (unsigned int length = lengthBases[i]; length < end; length++) {
+			lengthSymbols[length] = (unsigned char)i;
+		}
+	}
+}
+
+// Collects the bits of a deflate stream, starting with the lowest bit of every byte
+struct DeflateBitWriter {
+	std::vector<unsigned char>& output;
+	unsigned long long bits;
+	unsigned int bitCount;
+
+	void write(const unsigned int value, const unsigned int count) {
+		bits |= (unsigned long long)value << bitCount;
+		bitCount += count;
+		while (bitCount >= 8) {
+			output.push_back((unsigned char)bits);
+			bits >>= 8;
+			bitCount -= 8;
+		}
+	}
+	void flush() {
+		if (bitCount > 0) {
+			output.push_back((unsigned char)bits);
+		}
+		bits = 0;
+		bitCount = 0;
+	}
+};
+
+// Appends the data as a zlib stream (a deflate stream between a header and a checksum) to output
+// hashHeads is only scratch memory, kept by the caller so that it isn't allocated for every frame
+void deflate(const std::vector<unsigned char>& data, std::vector<int>& hashHeads, std::vector<unsigned char>& output) {
+	//* zlib header: deflate with a 32 KB window, no preset dictionary
+	output.push_back(0x78);
+	output.push_back(0x01);
+
+	//* A single block that uses the fixed Huffman codes
+	DeflateBitWriter writer = { output, 0, 0 };
+	writer.write(1, 1);		// Last block
+	writer.write(1, 2);		// Fixed Huffman codes
+	hashHeads.assign((size_t)1 << matchHashBits, -1);
+	const size_t size = data.size();
+	size_t position = 0;
+	while (position < size) {
+		//* Look for the last place where the next 3 bytes appeared
+		unsigned int matchLength = 0, matchDistance = 0;
+		if (position + 3 <= size) {
+			const unsigned int hash = ((data[position] << 16 | data[position + 1] << 8 | data[position + 2]) * 2654435761u) >> (32 - matchHashBits);
+			const int candidate = hashHeads[hash];
+			hashHeads[hash] = (int)position;
+			if (candidate >= 0 && position - candidate <= deflateWindowSize) {
+				const size_t maxLength = std::min<size_t>(258, size - position);
+				while (matchLength < maxLength && data[candidate + matchLength] == data[position + matchLength]) {
+					matchLength++;
+				}
+				matchDistance = (unsigned int)(position - candidate);
+			}
+		}
+
+		if (matchLength < 3) {
+			writer.write(fixedLiteralCodes[data[position]], fixedLiteralCodeLengths[data[position]]);
+			position++;
+			continue;
+		}
+
+		//* Repeat matchLength bytes from matchDistance bytes back
+		const unsigned int lengthSymbol = lengthSymbols[matchLength];
+		writer.write(fixedLiteralCodes[257 + lengthSymbol], fixedLiteralCodeLengths[257 + lengthSymbol]);
+		writer.write(matchLength - lengthBases[lengthSymbol], lengthExtraBits[lengthSymbol]);
+		unsigned int distanceSymbol = 0;
+		while (distanceSymbol < 29 && distanceBases[distanceSymbol + 1] <= matchDistance) {
+			distanceSymbol++;
+		}
+		writer.write(reverseBits(distanceSymbol, 5), 5);
+		writer.write(matchDistance - distanceBases[distanceSymbol], distanceExtraBits[distanceSymbol]);
+		// The bytes within the match can be the start of later matches as well
+		for (size_t skipped = position + 1; skipped < position + matchLength && skipped + 3 <= size; skipped++) {
+			hashHeads[((data[skipped] << 16 | data[skipped + 1] << 8 | data[skipped + 2]) * 2654435761u) >> (32 - matchHashBits)] = (int)skipped;
+		}
+		position += matchLength;
+	}
+	writer.write(fixedLiteralCodes[256], fixedLiteralCodeLengths[256]);	// End of block
+	writer.flush();
+
+	//* Adler-32 checksum of the uncompressed data
+	unsigned int a = 1, b = 0;
+	for (size_t i = 0; i < size; i++) {
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	const unsigned int checksum = b << 16 | a;
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		output.push_back((unsigned char)(checksum >> shift));
+	}
+}
+
+void writeBigEndian(std::vector<unsigned char>& output, const unsigned int value) {
+	for (int shift = 24; shift >= 0; shift -= 8) {
+		output.push_back((unsigned char)(value >> shift));
+	}
+}
+
+// Appends a PNG chunk: its length, its type, its data and the CRC of type and data
+void writePngChunk(std::vector<unsigned char>& output, const char* type, const unsigned char* data, const size_t size) {
+	writeBigEndian(output, (unsigned int)size);
+	const size_t typeStart = output.size();
+	output.insert(output.end(), type, type + 4);
+	output.insert(output.end(), data, data + size);
+	unsigned int crc = 0xFFFFFFFFu;
+	for (size_t i = typeStart; i < output.size(); i++) {
+		crc = pngCrcTable[(crc ^ output[i]) & 0xFF] ^ (crc >> 8);
+	}
+	writeBigEndian(output, crc ^ 0xFFFFFFFFu);
+}
+
+unsigned char predictPaeth(const int left, const int up, const int upLeft) {
+	const int estimate = left + up - upLeft;
+	const int leftDistance = std::abs(estimate - left), upDistance = std::abs(estimate - up), upLeftDistance = std::abs(estimate - upLeft);
+	if (leftDistance <= upDistance && leftDistance <= upLeftDistance) {
+		return (unsigned char)left;
+	}
+	return (unsigned char)(upDistance <= upLeftDistance ? up : upLeft);
+}
+
+// Runs on the encoder thread
+void writePng(const CapturedFrame& frame, EncoderScratch& scratch) {
+	//* RGB scanlines from top to bottom, each filtered with the Paeth predictor, which guesses every byte from its neighbours
+	// to the left and above. Rendered images change smoothly for the most part, so most of the bytes end up close to 0
+	const size_t rowBytes = (size_t)captureWidth * 3;
+	std::vector<unsigned char>& scanlines = scratch.pixels;
+	scanlines.resize((rowBytes + 1) * captureHeight);
+	for (unsigned int y = 0; y < captureHeight; y++) {
+		const unsigned char* row = &frame.pixels[(size_t)(captureHeight - 1 - y) * captureWidth * 4];
+		const unsigned char* rowAbove = y > 0 ? &frame.pixels[(size_t)(captureHeight - y) * captureWidth * 4] : nullptr;
+		unsigned char* scanline = &scanlines[y * (rowBytes + 1)];
+		scanline[0] = 4;
+		for (unsigned int x = 0; x < captureWidth; x++) {
+			for (unsigned int channel = 0; channel < 3; channel++) {
+				const int left = x > 0 ? row[(x - 1) * 4 + channel] : 0;
+				const int up = rowAbove ? rowAbove[x * 4 + channel] : 0;
+				const int upLeft = rowAbove && x > 0 ? rowAbove[(x - 1) * 4 + channel] : 0;
+				scanline[1 + x * 3 + channel] = (unsigned char)(row[x * 4 + channel] - predictPaeth(left, up, upLeft));
+			}
+		}
+	}
+
+	//* Signature, header (8 bits per channel, RGB), the compressed image and the end
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	std::vector<unsigned char>& file = scratch.file;
+	file.assign(signature, signature + 8);
+	const unsigned char header[13] = {
+		(unsigned char)(captureWidth >> 24), (unsigned char)(captureWidth >> 16), (unsigned char)(captureWidth >> 8), (unsigned char)captureWidth,
+		(unsigned char)(captureHeight >> 24), (unsigned char)(captureHeight >> 16), (unsigned char)(captureHeight >> 8), (unsigned char)captureHeight,
+		8, 2, 0, 0, 0 };
+	writePngChunk(file, "IHDR", header, sizeof(header));
+	scratch.compressed.clear();
+	deflate(scanlines, scratch.hashHeads, scratch.compressed);
+	writePngChunk(file, "IDAT", scratch.compressed.data(), scratch.compressed.size());
+	writePngChunk(file, "IEND", nullptr, 0);
+
+	//* The frame's number is padded to 5 digits so that the files sort in order
+	char number[16];
+	std::snprintf(number, sizeof(number), "_%05u.png", frame.frameNumber);
+	scratch.path.assign(capturePath);
+	scratch.path.append(number);
+	scratch.output.clear();
+	scratch.output.rdbuf()->pubsetbuf(scratch.outputBuffer, sizeof(scratch.outputBuffer));
+	scratch.output.open(scratch.path, std::ios::binary);
+	scratch.output.write(reinterpret_cast<const char*>(file.data()), file.size());
+	scratch.output.close();
+	if (!scratch.output && !captureWriteFailed.exchange(true)) {
+		std::cout << "Error: Could not write captured frame to " << scratch.path << std::endl;
+	}
+}
+
+// Runs on the encoder thread. Y4M stores the frames one after another, each as full resolution brightness (Y) followed by
+// the two color differences (U and V) at half the resolution along both axes (4:2:0), in the BT.601 limited range that video tools expect
+void writeY4mFrame(const CapturedFrame& frame, std::vector<unsigned char>& planes) {
+	const unsigned int chromaWidth = (captureWidth + 1) / 2, chromaHeight = (captureHeight + 1) / 2;
+	const size_t lumaSize = (size_t)captureWidth * captureHeight, chromaSize = (size_t)chromaWidth * chromaHeight;
+	planes.resize(lumaSize + 2 * chromaSize);
+	unsigned char* luma = &planes[0];
+	unsigned char* chromaU = luma + lumaSize;
+	unsigned char* chromaV = chromaU + chromaSize;
+
+	for (unsigned int y = 0; y < captureHeight; y++) {
+		const unsigned char* row = &frame.pixels[(size_t)(captureHeight - 1 - y) * captureWidth * 4];
+		for (unsigned int x = 0; x < captureWidth; x++) {
+			const int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+			luma[(size_t)y * captureWidth + x] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		}
+	}
+	//* Every color difference sample covers 2x2 pixels, whose colors are averaged
+	for (unsigned int y = 0; y < chromaHeight; y++) {
+		for (unsigned int x = 0; x < chromaWidth; x++) {
+			int r = 0, g = 0, b = 0, count = 0;
+			for (unsigned int pixelY = y * 2; pixelY < std::min(y * 2 + 2, captureHeight); pixelY++) {
+				const unsigned char* row = &frame.pixels[(size_t)(captureHeight - 1 - pixelY) * captureWidth * 4];
+				for (unsigned int pixelX = x * 2; pixelX < std::min(x * 2 + 2, captureWidth); pixelX++) {
+					r += row[pixelX * 4];
+					g += row[pixelX * 4 + 1];
+					b += row[pixelX * 4 + 2];
+					count++;
+				}
+			}
+			r /= count;
+			g /= count;
+			b /= count;
+			chromaU[(size_t)y * chromaWidth + x] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+			chromaV[(size_t)y * chromaWidth + x] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+	}
+
+	captureVideoFile << "FRAME\n";
+	captureVideoFile.write(reinterpret_cast<const char*>(planes.data()), planes.size());
+	if (!captureVideoFile && !captureWriteFailed.exchange(true)) {
+		std::cout << "Error: Could not write captured frame to " << capturePath << std::endl;
+	}
+}
+
+// Encodes and writes the frames in the order they arrive until it is told to stop and every queued frame is written
+void runEncoderThread() {
+	EncoderScratch scratch;
+	while (true) {
+		CapturedFrame* frame;
+		{
+			std::unique_lock<std::mutex> lock(captureMutex);
+			capturedFrameQueued.wait(lock, [] { return queuedCapturedFrameCount > 0 || stopEncoderThread; });
+			if (queuedCapturedFrameCount == 0) {
+				return;
+			}
+			frame = queuedCapturedFrames[queuedCapturedFrameFront];
+			queuedCapturedFrameFront = (queuedCapturedFrameFront + 1) % encoderQueueSize;
+			queuedCapturedFrameCount--;
+		}
+
+		if (captureFormat == FrameCaptureFormat::Png) {
+			writePng(*frame, scratch);
+		}
+		else {
+			writeY4mFrame(*frame, scratch.pixels);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(captureMutex);
+			freeCapturedFrames[freeCapturedFrameCount++] = frame;
+		}
+		capturedFrameFreed.notify_one();
+	}
+}
+
+// Maps the readback's buffer once the GPU has copied the frame into it and hands the pixels to the encoder thread
+// Returns false without waiting if the copy hasn't finished yet, unless wait is set
+bool collectFrameReadback(FrameReadback& readback, const bool wait) {
+	GLenum status = glClientWaitSync(readback.fence, 0, 0);
+	if (status == GL_TIMEOUT_EXPIRED) {
+		if (!wait) {
+			return false;
+		}
+		// Flushing makes sure the fence reaches the GPU, otherwise waiting for it might never end
+		do {
+			status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+		} while (status == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(readback.fence);
+	readback.fence = nullptr;
+
+	//* Take a free frame; if the encoder thread holds all of them, wait for it to finish one
+	CapturedFrame* frame;
+	{
+		std::unique_lock<std::mutex> lock(captureMutex);
+		if (freeCapturedFrameCount == 0) {
+			captureEncoderStalls++;
+			capturedFrameFreed.wait(lock, [] { return freeCapturedFrameCount > 0; });
+		}
+		frame = freeCapturedFrames[--freeCapturedFrameCount];
+	}
+
+	//* The copy has finished, so mapping the buffer doesn't wait for anything
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.getID());
+	const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame->pixels.size(), GL_MAP_READ_BIT);
+	if (pixels != nullptr) {
+		std::memcpy(frame->pixels.data(), pixels, frame->pixels.size());
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	else {
+		std::cout << "Error: Could not map the pixels of captured frame " << readback.frameNumber << std::endl;
+		std::fill(frame->pixels.begin(), frame->pixels.end(), (unsigned char)0);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	frame->frameNumber = readback.frameNumber;
+
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		queuedCapturedFrames[(queuedCapturedFrameFront + queuedCapturedFrameCount) % encoderQueueSize] = frame;
+		queuedCapturedFrameCount++;
+	}
+	capturedFrameQueued.notify_one();
+	return true;
+}
+
+// Hands over every frame whose copy has finished, oldest first so that the frames stay in order
+void collectFrameReadbacks(const bool wait) {
+	for (unsigned int i = 0; i < readbackRingSize; i++) {
+		FrameReadback& readback = frameReadbacks[(nextFrameReadback + i) % readbackRingSize];
+		if (readback.fence != nullptr && !collectFrameReadback(readback, wait)) {
+			return;
+		}
+	}
+}
+
+//** Public **//
+// The frames are captured at the window's size at the start; frames of a different size (after resizing the window) are skipped
+bool FrameCapture::start(const std::string& path, const FrameCaptureFormat format, const unsigned int framesPerSecond) {
+	stop();
+	Window::getFramebufferSize(captureWidth, captureHeight);
+	capturePath = path;
+	captureFormat = format;
+	if (format == FrameCaptureFormat::Y4m) {
+		captureVideoFile.open(path, std::ios::binary);
+		if (!captureVideoFile) {
+			std::cout << "Error: Could not open " << path << " for writing" << std::endl;
+			return false;
+		}
+		// 'C420jpeg' places each color difference sample in the middle of its 2x2 pixels, which matches the averaging
+		captureVideoFile << "YUV4MPEG2 W" << captureWidth << " H" << captureHeight << " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg\n";
+	}
+	prepareEncoderTables();
+
+	//* Every readback gets a buffer that holds a whole frame
+	// GL_STREAM_READ tells the driver that the GPU writes the buffer once and the CPU reads it, so it keeps the buffer where the CPU reads it fast
+	const size_t frameBytes = (size_t)captureWidth * captureHeight * 4;
+	for (FrameReadback& readback : frameReadbacks) {
+		readback.buffer = GLBuffer(GLMemoryCategory::Staging, "Frame capture readback");
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.getID());
+		glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+		readback.buffer.setSize(frameBytes);
+		readback.fence = nullptr;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	nextFrameReadback = 0;
+
+	for (unsigned int i = 0; i < encoderQueueSize; i++) {
+		capturedFrames[i].pixels.resize(frameBytes);
+		freeCapturedFrames[i] = &capturedFrames[i];
+	}
+	freeCapturedFrameCount = encoderQueueSize;
+	queuedCapturedFrameFront = queuedCapturedFrameCount = 0;
+
+	capturedFrameCount = 0;
+	copyMilliseconds = handOverMilliseconds = worstCaptureMilliseconds = 0.0;
+	captureGpuStalls = captureEncoderStalls = skippedCaptureFrames = 0;
+	captureWriteFailed = false;
+	stopEncoderThread = false;
+	encoderThread = std::thread(runEncoderThread);
+	frameCaptureRunning = true;
+	return true;
+}
+
+void FrameCapture::captureFrame() {
+	if (!frameCaptureRunning) {
+		return;
+	}
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	//* Hand over the earlier frames that have arrived by now
+	collectFrameReadbacks(false);
+
+	unsigned int width, height;
+	Window::getFramebufferSize(width, height);
+	if (width != captureWidth || height != captureHeight) {
+		skippedCaptureFrames++;
+	}
+	else {
+		//* The readback for this frame still holds the oldest frame if the GPU is a whole ring behind; only then do we wait for it
+		FrameReadback& readback = frameReadbacks[nextFrameReadback];
+		if (readback.fence != nullptr) {
+			captureGpuStalls++;
+			collectFrameReadback(readback, true);
+		}
+
+		//* With a pixel pack buffer bound, glReadPixels() only queues the copy on the GPU and returns right away
+		const std::chrono::steady_clock::time_point copyStart = std::chrono::steady_clock::now();
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.getID());
+		glReadPixels(0, 0, captureWidth, captureHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		readback.frameNumber = capturedFrameCount++;
+		nextFrameReadback = (nextFrameReadback + 1) % readbackRingSize;
+		copyMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - copyStart).count();
+	}
+
+	const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	handOverMilliseconds += milliseconds;
+	worstCaptureMilliseconds = std::max(worstCaptureMilliseconds, milliseconds);
+}
+
+// Also prints how much the capture cost the render thread
+void FrameCapture::stop() {
+	if (!frameCaptureRunning) {
+		return;
+	}
+	frameCaptureRunning = false;
+
+	//* Wait for the frames that are still on their way, then for the encoder thread to write them
+	collectFrameReadbacks(true);
+	{
+		std::lock_guard<std::mutex> lock(captureMutex);
+		stopEncoderThread = true;
+	}
+	capturedFrameQueued.notify_one();
+	encoderThread.join();
+
+	for (FrameReadback& readback : frameReadbacks) {
+		readback.buffer.reset();
+	}
+	for (CapturedFrame& frame : capturedFrames) {
+		std::vector<unsigned char>().swap(frame.pixels);
+	}
+	if (captureVideoFile.is_open()) {
+		captureVideoFile.close();
+	}
+
+	// The hand over is whatever the frames took apart from queuing the copies
+	handOverMilliseconds -= copyMilliseconds;
+	const unsigned int calls = std::max(capturedFrameCount + skippedCaptureFrames, 1u);
+	std::cout << "Captured " << capturedFrameCount << " frames of " << captureWidth << "x" << captureHeight << " to " << capturePath
+		<< (captureFormat == FrameCaptureFormat::Png ? "_*.png" : "") << std::endl;
+	std::cout << "Render thread per frame: " << copyMilliseconds / calls << " ms queuing the copy, " << handOverMilliseconds / calls
+		<< " ms handing over finished frames, " << worstCaptureMilliseconds << " ms at worst in total; waited for the GPU "
+		<< captureGpuStalls << " times and for the encoder " << captureEncoderStalls << " times" << std::endl;
+	if (skippedCaptureFrames > 0) {
+		std::cout << "Skipped " << skippedCaptureFrames << " frames whose size didn't match the capture's" << std::endl;
+	}
+}
+
+bool FrameCapture::isCapturing() {
+	return frameCaptureRunning;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+#include "glResources.hpp"
+
+//** Private **//
+struct GLObjectRecord {
+	GLObjectType type;
+	GLMemoryCategory category;
+	const char* label;
+	size_t bytes;
+};
+
+// Keyed by type and ID combined, as IDs are only unique per type of object
+std::unordered_map<unsigned long long, GLObjectRecord> liveObjects;
+size_t categoryMemory[GLResources::categoryCount] = {};
+
+unsigned long long makeObjectKey(const GLObjectType type, const unsigned int objectID) {
+	return ((unsigned long long)type << 32) | objectID;
+}
+
+const char* getTypeName(const GLObjectType type) {
+	switch (type) {
+	case GLObjectType::Buffer:
+		return "buffer";
+	case GLObjectType::VertexArray:
+		return "vertex array";
+	case GLObjectType::Texture:
+		return "texture";
+	case GLObjectType::Renderbuffer:
+		return "renderbuffer";
+	case GLObjectType::Framebuffer:
+		return "framebuffer";
+	default:
+		return "program";
+	}
+}
+
+const char* getCategoryName(const GLMemoryCategory category) {
+	switch (category) {
+	case GLMemoryCategory::Geometry:
+		return "Geometry";
+	case GLMemoryCategory::Instances:
+		return "Instances";
+	case GLMemoryCategory::Uniforms:
+		return "Uniforms";
+	case GLMemoryCategory::Textures:
+		return "Textures";
+	case GLMemoryCategory::RenderTargets:
+		return "Render targets";
+	case GLMemoryCategory::Staging:
+		return "Staging";
+	default:
+		return "Shaders";
+	}
+}
+
+//** Public **//
+// Generates a new object of the given type and registers it. Used by GLObject, which should be used instead of calling this directly
+unsigned int GLResources::createObject(const GLObjectType type, const GLMemoryCategory category, const char* label) {
+	unsigned int objectID = 0;
+	switch (type) {
+	case GLObjectType::Buffer:
+		glGenBuffers(1, &objectID);
+		break;
+	case GLObjectType::VertexArray:
+		glGenVertexArrays(1, &objectID);
+		break;
+	case GLObjectType::Texture:
+		glGenTextures(1, &objectID);
+		break;
+	case GLObjectType::Renderbuffer:
+		glGenRenderbuffers(1, &objectID);
+		break;
+	case GLObjectType::Framebuffer:
+		glGenFramebuffers(1, &objectID);
+		break;
+	case GLObjectType::Program:
+		// Programs are the only objects that are created one at a time and returned directly
+		objectID = glCreateProgram();
+		break;
+	}
+	liveObjects[makeObjectKey(type, objectID)] = { type, category, label, 0 };
+	return objectID;
+}
+
+void GLResources::deleteObject(const GLObjectType type, const unsigned int objectID) {
+	std::unordered_map<unsigned long long, GLObjectRecord>::iterator record = liveObjects.find(makeObjectKey(type, objectID));
+	if (record != liveObjects.end()) {
+		categoryMemory[(int)record->second.category] -= record->second.bytes;
+		liveObjects.erase(record);
+	}
+
+	//* Objects that outlive the OpenGL context (e.g. in static variables) were freed along with the context already
+	// Calling OpenGL without a context is not allowed, so they are only removed from the registry
+	if (glfwGetCurrentContext() == nullptr) {
+		return;
+	}
+	switch (type) {
+	case GLObjectType::Buffer:
+		glDeleteBuffers(1, &objectID);
+		break;
+	case GLObjectType::VertexArray:
+		glDeleteVertexArrays(1, &objectID);
+		break;
+	case GLObjectType::Texture:
+		glDeleteTextures(1, &objectID);
+		break;
+	case GLObjectType::Renderbuffer:
+		glDeleteRenderbuffers(1, &objectID);
+		break;
+	case GLObjectType::Framebuffer:
+		glDeleteFramebuffers(1, &objectID);
+		break;
+	case GLObjectType::Program:
+		glDeleteProgram(objectID);
+		break;
+	}
+}
+
+// Records how many bytes of GPU memory the object holds. OpenGL can't tell us, so this is up to the code that allocates the storage
+void GLResources::setSize(const GLObjectType type, const unsigned int objectID, const size_t bytes) {
+	std::unordered_map<unsigned long long, GLObjectRecord>::iterator record = liveObjects.find(makeObjectKey(type, objectID));
+	if (record == liveObjects.end()) {
+		std::cout << "Error: Tried to set the size of " << getTypeName(type) << " " << objectID << " which isn't registered" << std::endl;
+		return;
+	}
+	categoryMemory[(int)record->second.category] += bytes;
+	categoryMemory[(int)record->second.category] -= record->second.bytes;
+	record->second.bytes = bytes;
+}
+
+size_t GLResources::getMemory(const GLMemoryCategory category) {
+	return categoryMemory[(int)category];
+}
+
+size_t GLResources::getTotalMemory() {
+	size_t total = 0;
+	for (unsigned int i = 0; i < categoryCount; i++) {
+		total += categoryMemory[i];
+	}
+	return total;
+}
+
+unsigned int GLResources::getObjectCount() {
+	return (unsigned int)liveObjects.size();
+}
+
+// Prints the GPU memory per category and the largest objects
+void GLResources::printReport() {
+	const double megabyte = 1024.0 * 1024.0;
+	std::cout << "GPU memory: " << getTotalMemory() / megabyte << " MB in " << liveObjects.size() << " objects" << std::endl;
+	for (unsigned int i = 0; i < categoryCount; i++) {
+		std::cout << "  " << getCategoryName((GLMemoryCategory)i) << ": " << categoryMemory[i] / megabyte << " MB" << std::endl;
+	}
+
+	std::vector<const GLObjectRecord*> largestObjects;
+	for (std::unordered_map<unsigned long long, GLObjectRecord>::const_iterator i = liveObjects.begin(); i != liveObjects.end(); i++) {
+		largestObjects.push_back(&i->second);
+	}
+	std::sort(largestObjects.begin(), largestObjects.end(), [](const GLObjectRecord* a, const GLObjectRecord* b) { return a->bytes > b->bytes; });
+	std::cout << "  Largest objects:" << std::endl;
+	for (unsigned int i = 0; i < largestObjects.size() && i < 5; i++) {
+		std::cout << "    " << largestObjects[i]->label << " (" << getTypeName(largestObjects[i]->type) << "): "
+			<< largestObjects[i]->bytes / megabyte << " MB" << std::endl;
+	}
+}
+
+// Lists every object that is still alive and returns their number. Should be called once everything has been shut down
+unsigned int GLResources::reportLeaks() {
+	for (std::unordered_map<unsigned long long, GLObjectRecord>::const_iterator i = liveObjects.begin(); i != liveObjects.end(); i++) {
+		std::cout << "Error: Leaked " << getTypeName(i->second.type) << " " << (i->first & 0xFFFFFFFF) << " (" << i->second.label << ", "
+			<< i->second.bytes << " bytes)" << std::endl;
+	}
+	return (unsigned int)liveObjects.size();
+}
\ No newline at end of file
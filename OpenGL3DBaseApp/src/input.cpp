@@ -1,97 +1,213 @@
+#include <iostream>
+
 #include "input.hpp"
 #include "camera.hpp"
 #include "resourceManager.hpp"
-#include "render.hpp"
+#include "collision.hpp"
+#include "overdrawAnalysis.hpp"
+#include "dynamicResolution.hpp"
+#include "materials.hpp"
+#include "glResources.hpp"
+#include "renderGraph.hpp"
 
 //** Private **//
-bool downKeyPressed = false, upKeyPressed = false;
+struct KeyBinding {
+	int keyCode;
+	InputAction action;
+};
+
+// Several keys may be bound to the same action. The defaults follow the order of InputAction, which recordings made before
+// actions existed rely on: their key bits are the action bits of these bindings
+KeyBinding keyBindings[Input::maxKeyBindings] = {
+	{ GLFW_KEY_ESCAPE, InputAction::Quit }, { GLFW_KEY_1, InputAction::ShowWireframe }, { GLFW_KEY_2, InputAction::ShowFilled },
+	{ GLFW_KEY_3, InputAction::ToggleDepthPrepass }, { GLFW_KEY_4, InputAction::CaptureOverdraw }, { GLFW_KEY_5, InputAction::ToggleDynamicResolution },
+	{ GLFW_KEY_UP, InputAction::IncreaseBlend }, { GLFW_KEY_DOWN, InputAction::DecreaseBlend },
+	{ GLFW_KEY_W, InputAction::MoveForward }, { GLFW_KEY_S, InputAction::MoveBackward }, { GLFW_KEY_A, InputAction::MoveLeft },
+	{ GLFW_KEY_D, InputAction::MoveRight }, { GLFW_KEY_Q, InputAction::RollLeft }, { GLFW_KEY_E, InputAction::RollRight },
+	{ GLFW_KEY_SPACE, InputAction::MoveUp }, { GLFW_KEY_LEFT_SHIFT, InputAction::MoveDown },
+	{ GLFW_KEY_6, InputAction::CycleViewLayout }, { GLFW_KEY_7, InputAction::PrintMemoryReport },
+	{ GLFW_KEY_8, InputAction::ToggleTerrain }, { GLFW_KEY_9, InputAction::ToggleParticles },
+};
+unsigned int keyBindingCount = 20;
+
+// The actions of the last processed frame, to tell when an action has just been triggered
+unsigned int previousActions = 0;
 double mouse_last_x, mouse_last_y;
 bool mouse_initialize = true;
+// Mouse movement and scrolling are summed up between two frames by the callbacks
+float mouseOffsetX = 0.0f, mouseOffsetY = 0.0f;
+float scrollOffset = 0.0f;
+
+unsigned int getActionBit(const InputAction action) {
+	return 1u << (unsigned int)action;
+}
+
+// Whether a key bound to the action is held down
+bool isActionActive(const InputFrame& frame, const InputAction action) {
+	return (frame.actions & getActionBit(action)) != 0;
+}
+
+// Whether the action became active with this frame. Used for actions that should happen once per key press
+// instead of every frame until the key is released
+bool isActionTriggered(const InputFrame& frame, const InputAction action) {
+	return isActionActive(frame, action) && (previousActions & getActionBit(action)) == 0;
+}
+
+// Combines two opposing actions into an axis: 1 if only the positive one is active, -1 if only the negative one is, 0 otherwise
+float getActionAxis(const InputFrame& frame, const InputAction positive, const InputAction negative) {
+	return (isActionActive(frame, positive) ? 1.0f : 0.0f) - (isActionActive(frame, negative) ? 1.0f : 0.0f);
+}
+
+// Edits every material; the edits are uploaded together with the next frame
+void changeBlendValues(const float delta) {
+	for (unsigned int i = 0; i < Materials::getCount(); i++) {
+		Material material = Materials::get(i);
+		material.blendValue += delta;
+		Materials::edit(i, material);
+	}
+}
 
 //** Public **//
-void Input::processKeyboardInput(GLFWwindow& window, const float deltaTime) {
+// Binds the key to the action, in addition to the keys already bound to it. A key can only be bound to one action at a time
+void Input::bindKey(const int keyCode, const InputAction action) {
+	unbindKey(keyCode);
+	if (keyBindingCount == maxKeyBindings) {
+		std::cout << "Error: Can't bind more than " << maxKeyBindings << " keys" << std::endl;
+		return;
+	}
+	keyBindings[keyBindingCount++] = { keyCode, action };
+}
+
+void Input::unbindKey(const int keyCode) {
+	for (unsigned int i = 0; i < keyBindingCount; i++) {
+		if (keyBindings[i].keyCode == keyCode) {
+			keyBindings[i] = keyBindings[--keyBindingCount];
+			return;
+		}
+	}
+}
+
+// Collects what the user did since the last frame. Should be called after glfwPollEvents()
+void Input::captureFrame(GLFWwindow& window, InputFrame& frame) {
+	frame.actions = 0;
+	for (unsigned int i = 0; i < keyBindingCount; i++) {
+		if (glfwGetKey(&window, keyBindings[i].keyCode) == GLFW_PRESS) {
+			frame.actions |= getActionBit(keyBindings[i].action);
+		}
+	}
+	frame.mouseOffsetX = mouseOffsetX;
+	frame.mouseOffsetY = mouseOffsetY;
+	frame.scrollOffset = scrollOffset;
+	mouseOffsetX = mouseOffsetY = scrollOffset = 0.0f;
+}
+
+// Applies a frame of input, either captured live or replayed from a recording
+// Nothing in here may look at the window's input directly, otherwise replays wouldn't match the recording
+void Input::processFrame(GLFWwindow& window, const InputFrame& frame, const float deltaTime) {
 	// Fetch camera
 	Camera& cam = ResourceManager::giveCamera();
 	
-	// If user presses Esc, exit the application
-	if (glfwGetKey(&window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+	// Exit the application (Esc)
+	if (isActionActive(frame, InputAction::Quit)) {
 		glfwSetWindowShouldClose(&window, true);
 	}
-	// If user presses "1", display only vertex lines
-	if (glfwGetKey(&window, GLFW_KEY_1) == GLFW_PRESS) {
+	// Display only vertex lines ("1")
+	if (isActionActive(frame, InputAction::ShowWireframe)) {
 		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 	}
-	// If user presses "2", display filled vertices
-	if (glfwGetKey(&window, GLFW_KEY_2) == GLFW_PRESS) {
+	// Display filled vertices ("2")
+	if (isActionActive(frame, InputAction::ShowFilled)) {
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 	}
 
-	// If user presses up / down arrow, increase / decrease the cube shader's blend value
-	// The variables upKeyPressed / downKeyPressed are needed to avoid increasing / decreasing the value each frame until the key is released
-	if (glfwGetKey(&window, GLFW_KEY_UP) == GLFW_PRESS) {
-		if (!upKeyPressed) {
-			Render::updateBlendValue(ResourceManager::giveShaders()[1], 0.1f);
-			upKeyPressed = true;
-		}
-	}
-	if (glfwGetKey(&window, GLFW_KEY_UP) == GLFW_RELEASE) {
-		upKeyPressed = false;
+	// Increase / decrease the blend value of all materials (up / down arrow), once per key press
+	if (isActionTriggered(frame, InputAction::IncreaseBlend)) {
+		changeBlendValues(0.1f);
 	}
-	if (glfwGetKey(&window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-		if (!downKeyPressed) {
-			Render::updateBlendValue(ResourceManager::giveShaders()[1], -0.1f);
-			downKeyPressed = true;
-		}
-	}
-	if (glfwGetKey(&window, GLFW_KEY_DOWN) == GLFW_RELEASE) {
-		downKeyPressed = false;
+	if (isActionTriggered(frame, InputAction::DecreaseBlend)) {
+		changeBlendValues(-0.1f);
 	}
 
-	// Using WASD, the user can move around horizontally
-	if (glfwGetKey(&window, GLFW_KEY_W) == GLFW_PRESS) {
-		cam.cameraPosition += cam.cameraDirectionVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
+	// Toggle the depth pre-pass ("3")
+	if (isActionTriggered(frame, InputAction::ToggleDepthPrepass)) {
+		ResourceManager::setDepthPrepass(!ResourceManager::isDepthPrepassEnabled());
+	}
+	// Measure the overdraw of the next frame and save its heatmap ("4")
+	if (isActionTriggered(frame, InputAction::CaptureOverdraw)) {
+		OverdrawAnalysis::requestCapture("overdraw.ppm");
+	}
+	// Toggle the dynamic resolution ("5"); the scene is rendered at full resolution while it is off
+	if (isActionTriggered(frame, InputAction::ToggleDynamicResolution)) {
+		DynamicResolution::setEnabled(!DynamicResolution::isEnabled());
+	}
+	// Switch between a single view, picture-in-picture and split-screen ("6")
+	if (isActionTriggered(frame, InputAction::CycleViewLayout)) {
+		switch (ResourceManager::getViewLayout()) {
+		case ViewLayout::Single:
+			ResourceManager::setViewLayout(ViewLayout::PictureInPicture);
+			break;
+		case ViewLayout::PictureInPicture:
+			ResourceManager::setViewLayout(ViewLayout::SplitScreen);
+			break;
+		case ViewLayout::SplitScreen:
+			ResourceManager::setViewLayout(ViewLayout::Single);
+			break;
+		}
 	}
-	if (glfwGetKey(&window, GLFW_KEY_S) == GLFW_PRESS) {
-		cam.cameraPosition -= cam.cameraDirectionVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
+	// Print how much GPU memory is used and by what, and how the frame's render graph was compiled ("7")
+	if (isActionTriggered(frame, InputAction::PrintMemoryReport)) {
+		GLResources::printReport();
+		RenderGraph::printReport();
 	}
-	if (glfwGetKey(&window, GLFW_KEY_A) == GLFW_PRESS) {
-		cam.cameraPosition -= cam.cameraRightVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
+	// Switch between the flat floor plane and the terrain ("8")
+	if (isActionTriggered(frame, InputAction::ToggleTerrain)) {
+		ResourceManager::setTerrainEnabled(!ResourceManager::isTerrainEnabled());
 	}
-	if (glfwGetKey(&window, GLFW_KEY_D) == GLFW_PRESS) {
-		cam.cameraPosition += cam.cameraRightVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
+	// Switch the particle fountain on and off ("9")
+	if (isActionTriggered(frame, InputAction::ToggleParticles)) {
+		ResourceManager::setParticlesEnabled(!ResourceManager::areParticlesEnabled());
 	}
+	previousActions = frame.actions;
 
-	// Using Q and E, the user can "do a barrel roll"  in either direction ;)
-	if (glfwGetKey(&window, GLFW_KEY_Q) == GLFW_PRESS) {
-		cam.updateRotation(-cam.rollSpeed * deltaTime); // Negative angles rotate counter-clockwise
-		cam.updateViewMatrix();
-	}
-	if (glfwGetKey(&window, GLFW_KEY_E) == GLFW_PRESS) {
-		cam.updateRotation(cam.rollSpeed * deltaTime); // Positive angles rotate clockwise
-		cam.updateViewMatrix();
+	//* Sum up everything that moves the camera during this frame and apply it at once
+	// Using WASD, the user can move around horizontally, and using Space and Shift vertically
+	// Opposing keys cancel each other out
+	glm::vec3 localMovement = glm::vec3(getActionAxis(frame, InputAction::MoveRight, InputAction::MoveLeft),
+		getActionAxis(frame, InputAction::MoveUp, InputAction::MoveDown),
+		getActionAxis(frame, InputAction::MoveForward, InputAction::MoveBackward)) * cam.moveSpeed * deltaTime;
+	// The camera can't move through the cubes: the movement stops where it would hit one and slides along its side instead
+	// Camera::update() takes the movement along the camera's own vectors, so a shortened movement is turned back into them
+	glm::vec3 movement = cam.cameraRightVector * localMovement.x + cam.cameraUpVector * localMovement.y + cam.cameraDirectionVector * localMovement.z;
+	if (localMovement != glm::vec3(0.0f) && Collision::moveSphere(cam.cameraPosition, movement, cam.collisionRadius)) {
+		localMovement = glm::vec3(glm::dot(movement, cam.cameraRightVector), glm::dot(movement, cam.cameraUpVector), glm::dot(movement, cam.cameraDirectionVector));
 	}
+	// Using Q and E, the user can "do a barrel roll"  in either direction ;)
+	// Negative angles rotate counter-clockwise, positive angles clockwise
+	const float rollOffset = getActionAxis(frame, InputAction::RollRight, InputAction::RollLeft) * cam.rollSpeed * deltaTime;
+	// The mouse movement of all cursor events since the last frame, multiplied with the mouse sensitivity as a means of manipulating camera speed
+	cam.update(localMovement, frame.mouseOffsetX * cam.mouseSensitivity, frame.mouseOffsetY * cam.mouseSensitivity, rollOffset);
 
-	// Using Space and Shift, the user can move around vertically
-	if (glfwGetKey(&window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-		cam.cameraPosition += cam.cameraUpVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
-	}
-	if (glfwGetKey(&window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-		cam.cameraPosition -= cam.cameraUpVector * cam.moveSpeed * deltaTime;
-		cam.updateViewMatrix();
+	if (frame.scrollOffset != 0.0f) {
+		float fov = cam.fov;
+		// We subtract the offset because scrolling forward increases the yOffset, but zooming inwards means a lower FOV value
+		fov -= frame.scrollOffset;
+		// Set limits to the zoom level so that we don't get weird flips at 0° and 90°
+		if (fov < 1.0f) {
+			fov = 1.0f;
+		}
+		else if (fov > 89.0f) {
+			fov = 89.0f;
+		}
+		cam.fov = fov;
+
+		// Since the projection matrix has changed, update it
+		cam.updateProjectionMatrix();
 	}
 }
 
 // Callback function
 // x and y hold the mouse's current position
 void Input::processMouse(GLFWwindow* window, double current_x, double current_y) {
-	// Fetch camera
-	Camera& cam = ResourceManager::giveCamera();
-	
 	// On first calling, copy the current values
 	if (mouse_initialize) {
 		mouse_last_x = current_x;
@@ -99,8 +215,6 @@ void Input::processMouse(GLFWwindow* window, double current_x, double current_y)
 		mouse_initialize = false;
 	}
 	else {
-		float mouseSensitivity = cam.mouseSensitivity;
-
 		// Rotations are clockwise for positive values and counter-clockwise for negative values
 		// If the x value increases (= mouse goes to the right), our yawOffset has to be negative
 		// -> Because we are rotating around the cameraUpVector, we need a counter-clockwise rotation for the camera to move to the right
@@ -111,8 +225,9 @@ void Input::processMouse(GLFWwindow* window, double current_x, double current_y)
 		mouse_last_x = current_x;
 		mouse_last_y = current_y;
 
-		// Multiplication with the mouse sensitivity gives us a means of manipulating camera speed
-		cam.updateYawAndPitch((float)(xOffset * mouseSensitivity), (float)(yOffset * mouseSensitivity));
+		// The camera is only rotated in Input::processFrame(), so that the movement can be recorded and replayed
+		mouseOffsetX += (float)xOffset;
+		mouseOffsetY += (float)yOffset;
 	}
 }
 
@@ -120,21 +235,6 @@ void Input::processMouse(GLFWwindow* window, double current_x, double current_y)
 // xOffset and yOffset hold the scroll wheel's offset since the last callback
 // xOffset is horizontal offset, yOffset is vertical offset
 void Input::processScrollwheel(GLFWwindow* window, double xOffset, double yOffset) {
-	// Fetch camera
-	Camera& cam = ResourceManager::giveCamera();
-	
-	float fov = cam.fov;
-	// We subtract the offset because scrolling forward increases the yOffset, but zooming inwards means a lower FOV value
-	fov -= (float)yOffset;
-	// Set limits to the zoom level so that we don't get weird flips at 0 and 90
-	if (fov < 1.0f) {
-		fov = 1.0f;
-	}
-	else if (fov > 89.0f) {
-		fov = 89.0f;
-	}
-	cam.fov = fov;
-
-	// Since the projection matrix has changed, update it
-	cam.updateProjectionMatrix();
+	// The field of view is only changed in Input::processFrame(), so that the scrolling can be recorded and replayed
+	scrollOffset += (float)yOffset;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <iterator>
+
+#include "inputRecorder.hpp"
+
+//** Private **//
+//* File layout
+// Header: "OGLI" followed by the format version (uint32) and the timestep in seconds (float64)
+// Then one record per frame: action bits (uint32, one bit per InputAction), mouse x and y offset and scroll offset (float32 each) = 16 bytes
+// Values are stored in the byte order of the machine, which is little endian on everything we run on
+const char recordingMagic[4] = { 'O', 'G', 'L', 'I' };
+const unsigned int recordingVersion = 2;
+const size_t headerSize = sizeof(recordingMagic) + sizeof(unsigned int) + sizeof(double);
+const size_t frameRecordSize = sizeof(unsigned int) + 3 * sizeof(float);
+
+std::ofstream recordingFile;
+bool recording = false;
+
+// A replay is read completely on starting it, so that no file access happens while frames are measured
+std::vector<unsigned char> replayData;
+size_t replayPosition = 0;
+bool replaying = false;
+
+void encodeFrame(const InputFrame& frame, unsigned char* record) {
+	std::memcpy(record, &frame.actions, sizeof(unsigned int));
+	std::memcpy(record + 4, &frame.mouseOffsetX, sizeof(float));
+	std::memcpy(record + 8, &frame.mouseOffsetY, sizeof(float));
+	std::memcpy(record + 12, &frame.scrollOffset, sizeof(float));
+}
+
+void decodeFrame(const unsigned char* record, InputFrame& frame) {
+	std::memcpy(&frame.actions, record, sizeof(unsigned int));
+	std::memcpy(&frame.mouseOffsetX, record + 4, sizeof(float));
+	std::memcpy(&frame.mouseOffsetY, record + 8, sizeof(float));
+	std::memcpy(&frame.scrollOffset, record + 12, sizeof(float));
+}
+
+//** Public **//
+bool InputRecorder::startRecording(const std::string& path, const double timestep) {
+	stop();
+	recordingFile.open(path, std::ios::binary | std::ios::trunc);
+	if (!recordingFile) {
+		std::cout << "Error: Could not create input recording " << path << std::endl;
+		return false;
+	}
+	unsigned char header[headerSize];
+	std::memcpy(header, recordingMagic, sizeof(recordingMagic));
+	std::memcpy(header + 4, &recordingVersion, sizeof(unsigned int));
+	std::memcpy(header + 8, &timestep, sizeof(double));
+	recordingFile.write(reinterpret_cast<const char*>(header), headerSize);
+	recording = true;
+	return true;
+}
+
+// Loads the recording and returns the timestep it was recorded at
+bool InputRecorder::startReplay(const std::string& path, double& timestep) {
+	stop();
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "Error: Could not open input recording " << path << std::endl;
+		return false;
+	}
+	replayData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	unsigned int version = 0;
+	if (replayData.size() >= headerSize) {
+		std::memcpy(&version, &replayData[4], sizeof(unsigned int));
+	}
+	if (replayData.size() < headerSize || std::memcmp(&replayData[0], recordingMagic, sizeof(recordingMagic)) != 0 || version != recordingVersion) {
+		std::cout << "Error: " << path << " is not an input recording of this version" << std::endl;
+		replayData.clear();
+		return false;
+	}
+	std::memcpy(&timestep, &replayData[8], sizeof(double));
+	replayPosition = headerSize;
+	replaying = true;
+	return true;
+}
+
+void InputRecorder::stop() {
+	if (recording) {
+		recordingFile.close();
+		recording = false;
+	}
+	replaying = false;
+}
+
+bool InputRecorder::isRecording() {
+	return recording;
+}
+
+bool InputRecorder::isReplaying() {
+	return replaying;
+}
+
+void InputRecorder::recordFrame(const InputFrame& frame) {
+	if (!recording) {
+		return;
+	}
+	unsigned char record[frameRecordSize];
+	encodeFrame(frame, record);
+	recordingFile.write(reinterpret_cast<const char*>(record), frameRecordSize);
+}
+
+// Fills in the next recorded frame. Returns false once the recording is over
+bool InputRecorder::replayFrame(InputFrame& frame) {
+	if (!replaying || replayPosition + frameRecordSize > replayData.size()) {
+		return false;
+	}
+	decodeFrame(&replayData[replayPosition], frame);
+	replayPosition += frameRecordSize;
+	return true;
+}
+
+unsigned int InputRecorder::getReplayFrameCount() {
+	return replayData.size() < headerSize ? 0 : (unsigned int)((replayData.size() - headerSize) / frameRecordSize);
+}
\ No newline at end of file
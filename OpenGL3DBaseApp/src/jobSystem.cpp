@@ -0,0 +1,503 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cassert>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "jobSystem.hpp"
+
+//** Private **//
+// Has to be a power of 2 so that positions can wrap around with a bit mask
+const unsigned int jobQueueCapacity = 1024;
+// A thread may have at most jobPoolSize unfinished jobs at once; starting another one waits until one of them is finished
+const unsigned int jobPoolSize = 1024;
+// A parallel for has at most this many unfinished jobs per thread; while it has that many, its calling thread runs the next range itself
+const unsigned int parallelForJobsPerThread = 4;
+// An idle worker keeps looking for jobs this many times before it goes to sleep
+const unsigned int idleSpinCount = 64;
+// Keeps data written by different threads apart, so that they don't slow each other down by sharing a cache line
+const size_t cacheLineSize = 64;
+
+struct Job {
+	// Either a plain job or a range of a parallel for
+	void (*function)(void* data);
+	void (*rangeFunction)(const unsigned int first, const unsigned int last, void* data);
+	void* data;
+	unsigned int first, last;
+	JobCounter* counter;
+	bool mainThreadOnly;
+	unsigned int owner;	// Index of the thread whose pool the job belongs to
+	Job* next;		// Links jobs that wait for a counter or for the main thread, and free jobs
+};
+
+//* Lock-free work stealing queue (Chase-Lev deque)
+// Only the owning thread pushes and pops at the bottom, like a stack, which keeps the jobs it just created hot in its cache
+// Other threads steal from the top, taking the oldest jobs. Owner and thieves only compete (with a compare-and-swap) for the last job
+struct JobQueue {
+	std::atomic<long long> top;
+	char padding[cacheLineSize];
+	std::atomic<long long> bottom;
+	std::atomic<Job*> jobs[jobQueueCapacity];
+
+	JobQueue() : top(0), bottom(0) {}
+
+	// Returns false if the queue is full
+	bool push(Job* job) {
+		const long long b = bottom.load(std::memory_order_relaxed);
+		const long long t = top.load(std::memory_order_acquire);
+		if (b - t >= (long long)jobQueueCapacity) {
+			return false;
+		}
+		jobs[b & (jobQueueCapacity - 1)].store(job, std::memory_order_relaxed);
+		// The job has to be visible to thieves before the new bottom is
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	Job* pop() {
+		//* Take the bottom job before looking at the top, so a thief can't take it at the same time without us noticing
+		const long long b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		long long t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			// Empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		Job* job = jobs[b & (jobQueueCapacity - 1)].load(std::memory_order_relaxed);
+		if (t == b) {
+			// This is the last job, so thieves may be after it as well; whoever moves the top first gets it
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	Job* steal() {
+		long long t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const long long b = bottom.load(std::memory_order_acquire);
+		if (t >= b) {
+			return nullptr;
+		}
+		Job* job = jobs[t & (jobQueueCapacity - 1)].load(std::memory_order_relaxed);
+		// Another thief or the owner may have been faster
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+};
+
+//* Every thread allocates its jobs from its own pool, so starting a job needs no lock
+// A slot is only reused once its job is finished. Jobs may finish on any thread: the owner puts its own finished jobs
+// straight back onto its free list, other threads push them onto returnedJobs, which the owner takes over as a whole once it runs out
+struct ThreadState {
+	JobQueue queue;
+	Job jobPool[jobPoolSize];
+	Job* freeJobs;		// Only used by the owning thread
+	char padding[cacheLineSize];
+	std::atomic<Job*> returnedJobs;
+
+	ThreadState() : freeJobs(nullptr), returnedJobs(nullptr) {}
+};
+
+std::unique_ptr<ThreadState[]> threadStates;
+unsigned int jobThreadCount = 0;	// Including the main thread
+std::vector<std::thread> jobWorkers;
+std::atomic<bool> stopJobWorkers(false);
+// Index of the calling thread's state; the main thread is 0
+// Threads that the job system didn't start (e.g. the asset loader's or the frame encoder's) have no state, so they must not
+// start or wait for jobs: sharing the main thread's state would break its queue, which only its owner may push to
+const unsigned int externalThreadIndex = ~0u;
+thread_local unsigned int currentThreadIndex = externalThreadIndex;
+
+//* Idle workers sleep until a job is queued instead of burning a core
+// queuedJobCount counts the jobs in all queues; sleeping workers are only woken if there is one
+std::atomic<int> queuedJobCount(0);
+std::atomic<int> sleepingWorkerCount(0);
+std::mutex sleepMutex;
+std::condition_variable jobQueued;
+
+// Jobs for the main thread, pushed by any thread. Linked through Job::next, newest first
+std::atomic<Job*> mainThreadJobs(nullptr);
+
+// Returns nullptr if all of the thread's jobs are unfinished
+Job* allocateJob() {
+	ThreadState& state = threadStates[currentThreadIndex];
+	if (state.freeJobs == nullptr) {
+		// Only the owner ever takes the returned jobs, and it takes all of them at once, so a job can't be taken twice
+		state.freeJobs = state.returnedJobs.exchange(nullptr);
+		if (state.freeJobs == nullptr) {
+			return nullptr;
+		}
+	}
+	Job* job = state.freeJobs;
+	state.freeJobs = job->next;
+	job->owner = currentThreadIndex;
+	return job;
+}
+
+void freeJob(Job* job) {
+	ThreadState& state = threadStates[job->owner];
+	if (job->owner == currentThreadIndex) {
+		job->next = state.freeJobs;
+		state.freeJobs = job;
+		return;
+	}
+	Job* head = state.returnedJobs.load();
+	do {
+		job->next = head;
+	} while (!state.returnedJobs.compare_exchange_weak(head, job));
+}
+
+void executeJob(Job* job);
+Job* takeJob(const unsigned int threadIndex);
+bool runMainThreadJobList();
+
+// Runs other jobs until one of the thread's own jobs is finished and its slot is free again
+Job* allocateJobWaiting() {
+	Job* job = allocateJob();
+	while (job == nullptr) {
+		Job* otherJob = takeJob(currentThreadIndex);
+		if (otherJob != nullptr) {
+			executeJob(otherJob);
+		}
+		else if (currentThreadIndex != 0 || !runMainThreadJobList()) {
+			std::this_thread::yield();
+		}
+		job = allocateJob();
+	}
+	return job;
+}
+
+void queueJob(Job* job) {
+	if (job->mainThreadOnly) {
+		Job* head = mainThreadJobs.load();
+		do {
+			job->next = head;
+		} while (!mainThreadJobs.compare_exchange_weak(head, job));
+		return;
+	}
+	// Without any workers nobody else would take the job, and should the queue ever be full, it simply runs right away as well
+	// The job's slot stays taken until it is finished, so running it here is as safe as running it on a worker
+	if (jobThreadCount <= 1 || !threadStates[currentThreadIndex].queue.push(job)) {
+		executeJob(job);
+		return;
+	}
+	queuedJobCount++;
+	if (sleepingWorkerCount.load() > 0) {
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		jobQueued.notify_one();
+	}
+}
+
+// Starts the jobs that waited for the counter to reach 0
+void releaseWaitingJobs(JobCounter& counter) {
+	// Taking the whole list at once makes sure that every job is only started once, even if several threads get here
+	Job* job = counter.waitingJobs.exchange(nullptr);
+	while (job != nullptr) {
+		Job* next = job->next;
+		queueJob(job);
+		job = next;
+	}
+}
+
+void executeJob(Job* job) {
+	if (job->rangeFunction != nullptr) {
+		job->rangeFunction(job->first, job->last, job->data);
+	}
+	else {
+		job->function(job->data);
+	}
+
+	JobCounter* counter = job->counter;
+	// The job isn't needed anymore, so its slot can be reused even before its counter is updated
+	freeJob(job);
+	if (counter != nullptr) {
+		// finishingJobs keeps waiting threads from destroying the counter while we still release its waiting jobs
+		counter->finishingJobs++;
+		if (counter->pendingJobs.fetch_sub(1) == 1) {
+			releaseWaitingJobs(*counter);
+		}
+		counter->finishingJobs--;
+	}
+}
+
+// Takes a job from the thread's own queue, or steals one from another thread
+Job* takeJob(const unsigned int threadIndex) {
+	Job* job = threadStates[threadIndex].queue.pop();
+	for (unsigned int i = 1; job == nullptr && i < jobThreadCount; i++) {
+		job = threadStates[(threadIndex + i) % jobThreadCount].queue.steal();
+	}
+	if (job != nullptr) {
+		queuedJobCount--;
+	}
+	return job;
+}
+
+// Returns whether there were any jobs to run
+bool runMainThreadJobList() {
+	Job* job = mainThreadJobs.exchange(nullptr);
+	if (job == nullptr) {
+		return false;
+	}
+	// The list is newest first, so it is reversed to run the jobs in the order they were started
+	Job* reversed = nullptr;
+	while (job != nullptr) {
+		Job* next = job->next;
+		job->next = reversed;
+		reversed = job;
+		job = next;
+	}
+	while (reversed != nullptr) {
+		Job* next = reversed->next;
+		executeJob(reversed);
+		reversed = next;
+	}
+	return true;
+}
+
+void startJob(void (*function)(void*), void* data, JobCounter* counter, JobCounter* dependency, const bool mainThreadOnly) {
+	assert(currentThreadIndex != externalThreadIndex && "Jobs may only be started by the main thread and by jobs");
+	Job* job = allocateJobWaiting();
+	job->function = function;
+	job->rangeFunction = nullptr;
+	job->data = data;
+	job->counter = counter;
+	job->mainThreadOnly = mainThreadOnly;
+	if (counter != nullptr) {
+		counter->pendingJobs++;
+	}
+	if (dependency == nullptr) {
+		queueJob(job);
+		return;
+	}
+
+	//* Park the job at its dependency; whoever finishes the dependency's last job starts it
+	Job* head = dependency->waitingJobs.load();
+	do {
+		job->next = head;
+	} while (!dependency->waitingJobs.compare_exchange_weak(head, job));
+	// The dependency may have finished before the job was parked, in which case nobody else is going to start it
+	if (dependency->pendingJobs.load() == 0) {
+		releaseWaitingJobs(*dependency);
+	}
+}
+
+void jobWorkerLoop(const unsigned int threadIndex) {
+	currentThreadIndex = threadIndex;
+	unsigned int idleRounds = 0;
+	while (!stopJobWorkers.load()) {
+		Job* job = takeJob(threadIndex);
+		if (job != nullptr) {
+			executeJob(job);
+			idleRounds = 0;
+			continue;
+		}
+		if (++idleRounds < idleSpinCount) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		//* Nothing to do for a while, so sleep until a job is queued
+		// The count of sleeping workers goes up before the queued jobs are checked, and queueJob() does it the other way around,
+		// so either we see the new job or queueJob() sees us sleeping and wakes us up
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkerCount++;
+		jobQueued.wait(lock, []() { return queuedJobCount.load() > 0 || stopJobWorkers.load(); });
+		sleepingWorkerCount--;
+		idleRounds = 0;
+	}
+}
+
+// Joins the workers when the program exits; std::thread terminates the program if it is destroyed while still running
+struct JobWorkerShutdown {
+	~JobWorkerShutdown() {
+		JobSystem::shutdown();
+	}
+} jobWorkerShutdown;
+
+//* Benchmark workloads
+// Model matrices of a field of rotating objects, like Cube::prepareInstances() computes them
+void calculateBenchmarkMatrices(const unsigned int first, const unsigned int last, void* data) {
+	glm::mat4* matrices = static_cast<glm::mat4*>(data);
+	const glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f));
+	for (unsigned int i = first; i < last; i++) {
+		const glm::vec3 position((float)(i % 1024), 0.0f, (float)(i / 1024));
+		const glm::mat4 rotationMatrix = glm::toMat4(glm::angleAxis(0.001f * i, axis));
+		matrices[i] = glm::translate(glm::mat4(1.0f), position) * rotationMatrix;
+	}
+}
+
+// Many small independent jobs, which exercises the queues and stealing rather than the range splitting
+void runBenchmarkJob(void* data) {
+	float* result = static_cast<float*>(data);
+	float value = *result;
+	for (int i = 0; i < 2000; i++) {
+		value = value * 0.999f + 0.5f;
+	}
+	*result = value;
+}
+
+//** Public **//
+// Starts threadCount - 1 worker threads; the main thread is the last one and works while it waits. 0 takes one thread per CPU core
+void JobSystem::initialize(const unsigned int threadCount) {
+	shutdown();
+	jobThreadCount = threadCount > 0 ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+	threadStates.reset(new ThreadState[jobThreadCount]);
+	for (unsigned int i = 0; i < jobThreadCount; i++) {
+		for (unsigned int j = 0; j < jobPoolSize; j++) {
+			threadStates[i].jobPool[j].next = threadStates[i].freeJobs;
+			threadStates[i].freeJobs = &threadStates[i].jobPool[j];
+		}
+	}
+	currentThreadIndex = 0;
+	stopJobWorkers = false;
+	for (unsigned int i = 1; i < jobThreadCount; i++) {
+		jobWorkers.emplace_back(jobWorkerLoop, i);
+	}
+}
+
+// Stops and joins the worker threads. Jobs that haven't started yet are dropped
+void JobSystem::shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopJobWorkers = true;
+	}
+	jobQueued.notify_all();
+	for (unsigned int i = 0; i < jobWorkers.size(); i++) {
+		jobWorkers[i].join();
+	}
+	jobWorkers.clear();
+	threadStates.reset();
+	jobThreadCount = 0;
+	queuedJobCount = 0;
+	mainThreadJobs = nullptr;
+}
+
+unsigned int JobSystem::getThreadCount() {
+	return jobThreadCount;
+}
+
+// Runs the function on any thread. counter (if given) counts the job until it is finished; the job only starts once dependency (if given) is done
+void JobSystem::run(void (*function)(void* data), void* data, JobCounter* counter, JobCounter* dependency) {
+	startJob(function, data, counter, dependency, false);
+}
+
+// Same as run(), but the job runs on the main thread, which is needed for everything that calls OpenGL
+void JobSystem::runOnMainThread(void (*function)(void* data), void* data, JobCounter* counter, JobCounter* dependency) {
+	startJob(function, data, counter, dependency, true);
+}
+
+// Waits until all jobs of the counter are finished. The waiting thread runs other jobs in the meantime
+void JobSystem::wait(JobCounter& counter) {
+	assert(currentThreadIndex != externalThreadIndex && "Only the main thread and jobs may wait for jobs");
+	while (!counter.isDone()) {
+		Job* job = takeJob(currentThreadIndex);
+		if (job != nullptr) {
+			executeJob(job);
+		}
+		else if (currentThreadIndex != 0 || !runMainThreadJobList()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+// Runs the jobs that were handed to the main thread. Should be called by the main thread once per frame
+void JobSystem::runMainThreadJobs() {
+	assert(currentThreadIndex == 0 && "Main thread jobs have to run on the thread that initialized the job system");
+	runMainThreadJobList();
+}
+
+// Splits [0, count) into ranges of at most grainSize elements and calls the function for all of them in parallel
+// Returns once all ranges are done; a single range is run right away without involving any other thread
+// Ranges are only handed out as jobs while fewer than parallelForJobsPerThread per thread are unfinished, so a large count doesn't use up
+// the thread's job pool; otherwise the calling thread runs the range itself, giving the others time to catch up
+void JobSystem::parallelFor(const unsigned int count, const unsigned int grainSize,
+	void (*function)(const unsigned int first, const unsigned int last, void* data), void* data) {
+	const unsigned int rangeSize = std::max(grainSize, 1u);
+	if (count <= rangeSize || jobThreadCount <= 1) {
+		function(0, count, data);
+		return;
+	}
+	assert(currentThreadIndex != externalThreadIndex && "parallelFor() may only be called by the main thread and by jobs");
+
+	JobCounter counter;
+	const unsigned int maxJobCount = jobThreadCount * parallelForJobsPerThread;
+	for (unsigned int first = 0; first < count; first += rangeSize) {
+		const unsigned int last = std::min(first + rangeSize, count);
+		Job* job = counter.pendingJobs.load() < maxJobCount ? allocateJob() : nullptr;
+		if (job == nullptr) {
+			function(first, last, data);
+			continue;
+		}
+		job->function = nullptr;
+		job->rangeFunction = function;
+		job->data = data;
+		job->first = first;
+		job->last = last;
+		job->counter = &counter;
+		job->mainThreadOnly = false;
+		counter.pendingJobs++;
+		queueJob(job);
+	}
+	wait(counter);
+}
+
+void JobSystem::printBenchmark() {
+	const unsigned int maxThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	const unsigned int matrixCount = 1 << 20;
+	const unsigned int smallJobCount = 1000;
+	const int repetitions = 5;
+	std::vector<glm::mat4> matrices(matrixCount);
+	std::vector<float> jobResults(smallJobCount, 1.0f);
+
+	std::cout << "Job system scaling (best of " << repetitions << " runs):" << std::endl;
+	double singleThreadMatrixMilliseconds = 0.0, singleThreadJobMilliseconds = 0.0;
+	for (unsigned int threadCount = 1; threadCount <= maxThreadCount; threadCount++) {
+		initialize(threadCount);
+		double matrixMilliseconds = 0.0, jobMilliseconds = 0.0;
+		for (int repetition = 0; repetition < repetitions; repetition++) {
+			//* parallelFor over 1M model matrices in ranges of 4096
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			parallelFor(matrixCount, 4096, calculateBenchmarkMatrices, &matrices[0]);
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+			matrixMilliseconds = repetition == 0 ? milliseconds : std::min(matrixMilliseconds, milliseconds);
+
+			//* Many small jobs, started from the main thread and spread by stealing
+			start = std::chrono::steady_clock::now();
+			JobCounter counter;
+			for (unsigned int i = 0; i < smallJobCount; i++) {
+				run(runBenchmarkJob, &jobResults[i], &counter);
+			}
+			wait(counter);
+			end = std::chrono::steady_clock::now();
+			const double jobTime = std::chrono::duration<double, std::milli>(end - start).count();
+			jobMilliseconds = repetition == 0 ? jobTime : std::min(jobMilliseconds, jobTime);
+		}
+		if (threadCount == 1) {
+			singleThreadMatrixMilliseconds = matrixMilliseconds;
+			singleThreadJobMilliseconds = jobMilliseconds;
+		}
+		const double matrixSpeedup = singleThreadMatrixMilliseconds / matrixMilliseconds;
+		const double jobSpeedup = singleThreadJobMilliseconds / jobMilliseconds;
+		std::cout << "  " << threadCount << " threads: parallel for " << matrixMilliseconds << " ms (" << matrixSpeedup << "x, "
+			<< 100.0 * matrixSpeedup / threadCount << "% efficiency), " << smallJobCount << " small jobs " << jobMilliseconds << " ms ("
+			<< jobSpeedup << "x, " << 100.0 * jobSpeedup / threadCount << "% efficiency)" << std::endl;
+	}
+	shutdown();
+}
\ No newline at end of file
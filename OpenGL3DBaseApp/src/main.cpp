@@ -7,37 +7,83 @@
 #include "window.hpp"
 #include "resourceManager.hpp"
 #include "input.hpp"
+#include "frameArena.hpp"
+#include "clock.hpp"
+#include "inputRecorder.hpp"
+#include "frameCapture.hpp"
+#include "tools.hpp"
+
+int main(int argc, char* argv[]) {
+	//* Command line tools, see Tools
+	// Benchmarks and reports that don't need the scene end the program right away, the others run in the main loop
+	int exitCode = 0;
+	Tools::initialize(argc, argv);
+	if (Tools::runWithoutWindow(exitCode)) {
+		return exitCode;
+	}
+	if (!Tools::parseOptions()) {
+		return 1;
+	}
 
-int main(void) {
 	// The window is the only thing we initialize within the main function as we need to access it from here
 	GLFWwindow& window = Window::initialize();
+	if (Tools::runWithoutScene(window, exitCode)) {
+		return exitCode;
+	}
 
 	ResourceManager::initialize(window);
-	
-	float deltaTime = 0.0f;	// Time between current frame and last frame
-	float lastFrame = 0.0f; // Time of last frame
+	if (!Tools::start()) {
+		ResourceManager::shutdown();
+		glfwTerminate();
+		return 1;
+	}
 
 	// Main loop
 	while (!glfwWindowShouldClose(&window))
 	{
-		// Calculate frame times
-		float currentFrame = (float)glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-		
-		// Process the user's key presses
-		Input::processKeyboardInput(window, deltaTime);
+		// Everything that was allocated from the frame arena during the last frame is freed
+		FrameArena::reset();
+
+		// Lets the tool change the scene before the frame, or end the loop once it is done
+		if (!Tools::beginFrame()) {
+			break;
+		}
+
+		// Advance the time (the real time, or exactly one timestep when recording or replaying)
+		Clock::beginFrame();
+
 		// glfwPollEvents calls the callbacks set in Render::initialize() => Input::processMouse() and Input::processScrollwheel()
 		glfwPollEvents();
+		// Process the user's input, or the recorded input of this frame during a replay
+		InputFrame inputFrame;
+		if (InputRecorder::isReplaying()) {
+			if (!InputRecorder::replayFrame(inputFrame)) {
+				break;
+			}
+		}
+		else {
+			Input::captureFrame(window, inputFrame);
+			InputRecorder::recordFrame(inputFrame);
+		}
+		Input::processFrame(window, inputFrame, Clock::getDeltaTime());
 
 		// Render
 		ResourceManager::render();
+		// Copies the frame while it is still in the back buffer, if capturing
+		FrameCapture::captureFrame();
 		
 		// Swap buffers
 		glfwSwapBuffers(&window);
+
+		Tools::endFrame();
 	}
+	InputRecorder::stop();
+	FrameCapture::stop();
+	// Delete all OpenGL objects while the context still exists; anything left over is reported as a leak
+	ResourceManager::shutdown();
 	// Close everything. Will also free all allocated memory.
 	glfwTerminate();
 
-	return 0;
+	// Prints the results of the tool, if any
+	return Tools::finish();
 }
\ No newline at end of file
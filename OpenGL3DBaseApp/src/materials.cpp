@@ -0,0 +1,98 @@
+#include <iostream>
+#include <algorithm>
+
+#include "materials.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+const unsigned int materialsBindingPoint = 3;
+
+// One entry of the "materials" uniform block (std140): the tint in rgb and the blend value in a, so a material takes exactly one vec4
+struct MaterialData {
+	glm::vec4 tintAndBlendValue;
+};
+
+Material materials[Materials::maxMaterialCount];
+MaterialData materialData[Materials::maxMaterialCount];
+unsigned int materialCount = 0;
+GLBuffer materialsUBO;
+// Range of materials that changed since the last upload; first == end means nothing changed
+unsigned int firstChangedMaterial = 0, endChangedMaterial = 0;
+
+void storeMaterial(const unsigned int materialID, const Material& material) {
+	materials[materialID] = material;
+	// Blend values <0 or >1 don't make much sense, so prevent them from happening
+	materials[materialID].blendValue = std::min(std::max(material.blendValue, 0.0f), 1.0f);
+	materialData[materialID].tintAndBlendValue = glm::vec4(material.tint, materials[materialID].blendValue);
+
+	if (firstChangedMaterial == endChangedMaterial) {
+		firstChangedMaterial = materialID;
+		endChangedMaterial = materialID + 1;
+	}
+	else {
+		firstChangedMaterial = std::min(firstChangedMaterial, materialID);
+		endChangedMaterial = std::max(endChangedMaterial, materialID + 1);
+	}
+}
+
+//** Public **//
+void Materials::initialize() {
+	//* The table has room for all materials right away, so it never has to be reallocated
+	materialsUBO = GLBuffer(GLMemoryCategory::Uniforms, "Materials");
+	glBindBuffer(GL_UNIFORM_BUFFER, materialsUBO.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(materialData), nullptr, GL_DYNAMIC_DRAW);
+	materialsUBO.setSize(sizeof(materialData));
+	glBindBufferBase(GL_UNIFORM_BUFFER, materialsBindingPoint, materialsUBO.getID());
+}
+
+void Materials::shutdown() {
+	materialsUBO.reset();
+}
+
+// Links the shader's "materials" uniform block to the material table
+void Materials::configureShader(Shader& shader) {
+	// Shaders that don't use materials (e.g. for the depth pre-pass) don't have the block
+	unsigned int blockIndex = glGetUniformBlockIndex(shader.getShaderProgramID(), "materials");
+	if (blockIndex == GL_INVALID_INDEX) {
+		return;
+	}
+	glUniformBlockBinding(shader.getShaderProgramID(), blockIndex, materialsBindingPoint);
+}
+
+// Adds a material to the table and returns its ID, which instances use to refer to it
+unsigned int Materials::create(const Material& material) {
+	if (materialCount == maxMaterialCount) {
+		std::cout << "Error: No more than " << maxMaterialCount << " materials are supported" << std::endl;
+		return 0;
+	}
+	storeMaterial(materialCount, material);
+	return materialCount++;
+}
+
+void Materials::edit(const unsigned int materialID, const Material& material) {
+	if (materialID >= materialCount) {
+		std::cout << "Error: There is no material with ID " << materialID << std::endl;
+		return;
+	}
+	storeMaterial(materialID, material);
+}
+
+const Material& Materials::get(const unsigned int materialID) {
+	return materials[materialID];
+}
+
+unsigned int Materials::getCount() {
+	return materialCount;
+}
+
+// Uploads the materials that were created or edited since the last call with a single copy. Should be called once per frame before drawing
+void Materials::update() {
+	if (firstChangedMaterial == endChangedMaterial) {
+		return;
+	}
+	// First argument is the buffer type, second argument is the offset, third argument the data size and 4th argument a pointer to the data
+	glBindBuffer(GL_UNIFORM_BUFFER, materialsUBO.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, firstChangedMaterial * sizeof(MaterialData), (endChangedMaterial - firstChangedMaterial) * sizeof(MaterialData),
+		&materialData[firstChangedMaterial]);
+	firstChangedMaterial = endChangedMaterial = 0;
+}
\ No newline at end of file
@@ -0,0 +1,326 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "mathBenchmark.hpp"
+#include "camera.hpp"
+
+//** Private **//
+struct MathBenchmarkCase {
+	const char* name;
+	void (*run)(const unsigned int iterations);
+};
+
+struct MathBenchmarkResult {
+	std::string name;
+	double meanNanoseconds;
+	double confidenceNanoseconds;	// Half the width of the 95% confidence interval of the mean
+	double medianNanoseconds;
+	double minNanoseconds;
+	unsigned int iterations;		// Per sample
+};
+
+//* Every sample runs the case for at least this long, so that the clock's resolution doesn't matter
+const double minSampleMilliseconds = 2.0;
+const double warmupMilliseconds = 100.0;
+const unsigned int sampleCount = 30;
+// Student's t for a 95% confidence interval with sampleCount - 1 degrees of freedom
+const double confidenceT = 2.045;
+
+//* State the cases work on
+Camera* benchmarkedCamera = nullptr;
+std::vector<glm::vec3> benchmarkPositions;
+std::vector<glm::quat> benchmarkOrientations;
+std::vector<glm::vec3> benchmarkAxes;		// Normalized
+std::vector<float> benchmarkScales;
+// Every case adds its results in here so the compiler can't throw the calculations away
+volatile float mathBenchmarkSink = 0.0f;
+
+// Camera::update() as Input::processFrame() calls it while the mouse moves
+void benchmarkYawAndPitch(const unsigned int iterations) {
+	for (unsigned int i = 0; i < iterations; i++) {
+		benchmarkedCamera->update(glm::vec3(0.0f), 0.3f, -0.2f, 0.0f);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + benchmarkedCamera->viewMatrix[0][0];
+}
+
+// ... while Q or E is held
+void benchmarkRoll(const unsigned int iterations) {
+	for (unsigned int i = 0; i < iterations; i++) {
+		benchmarkedCamera->update(glm::vec3(0.0f), 0.0f, 0.0f, 0.5f);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + benchmarkedCamera->viewMatrix[0][0];
+}
+
+// ... while moving, turning and rolling all at once
+void benchmarkFullUpdate(const unsigned int iterations) {
+	for (unsigned int i = 0; i < iterations; i++) {
+		benchmarkedCamera->update(glm::vec3(0.01f, 0.0f, -0.02f), 0.3f, -0.2f, 0.5f);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + benchmarkedCamera->viewMatrix[0][0];
+}
+
+void benchmarkViewMatrix(const unsigned int iterations) {
+	for (unsigned int i = 0; i < iterations; i++) {
+		benchmarkedCamera->cameraPosition.x += 0.001f;
+		benchmarkedCamera->updateViewMatrix();
+	}
+	mathBenchmarkSink = mathBenchmarkSink + benchmarkedCamera->viewMatrix[3][0];
+}
+
+// The sequence the camera uses to rotate a vector: a quaternion from an angle and an axis, turned into a matrix, times the vector
+void benchmarkRotateThroughMatrix(const unsigned int iterations) {
+	glm::vec3 vector(1.0f, 0.0f, 0.0f);
+	const unsigned int count = (unsigned int)benchmarkAxes.size();
+	for (unsigned int i = 0; i < iterations; i++) {
+		const glm::vec3& axis = benchmarkAxes[i % count];
+		const glm::mat4 rotationMatrix = glm::toMat4(glm::angleAxis(glm::radians(0.3f), axis));
+		vector = glm::normalize(glm::vec3(rotationMatrix * glm::vec4(vector, 1.0f)));
+	}
+	mathBenchmarkSink = mathBenchmarkSink + vector.x;
+}
+
+// The same rotation applied by the quaternion directly, to tell whether going through a matrix is worth it
+void benchmarkRotateThroughQuaternion(const unsigned int iterations) {
+	glm::vec3 vector(1.0f, 0.0f, 0.0f);
+	const unsigned int count = (unsigned int)benchmarkAxes.size();
+	for (unsigned int i = 0; i < iterations; i++) {
+		const glm::vec3& axis = benchmarkAxes[i % count];
+		vector = glm::normalize(glm::angleAxis(glm::radians(0.3f), axis) * vector);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + vector.x;
+}
+
+// Combines the two rotations of a yaw and pitch step into a single matrix, as Camera::update() does for the direction vector
+void benchmarkCombinedRotation(const unsigned int iterations) {
+	glm::mat4 combinedRotationMatrix(1.0f);
+	const unsigned int count = (unsigned int)benchmarkOrientations.size();
+	for (unsigned int i = 0; i < iterations; i++) {
+		const glm::quat yawRotationQuaternion = benchmarkOrientations[i % count];
+		const glm::quat pitchRotationQuaternion = benchmarkOrientations[(i + 1) % count];
+		combinedRotationMatrix = glm::toMat4(yawRotationQuaternion * pitchRotationQuaternion);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + combinedRotationMatrix[0][0];
+}
+
+// The local matrix of a transform (and formerly the model matrix of a cube): scale, then rotate, then translate
+void benchmarkModelMatrix(const unsigned int iterations) {
+	glm::mat4 modelMatrix(1.0f);
+	const unsigned int count = (unsigned int)benchmarkPositions.size();
+	for (unsigned int i = 0; i < iterations; i++) {
+		const unsigned int index = i % count;
+		modelMatrix = glm::translate(glm::mat4(1.0f), benchmarkPositions[index]) * glm::toMat4(benchmarkOrientations[index]);
+		modelMatrix = glm::scale(modelMatrix, glm::vec3(benchmarkScales[index]));
+	}
+	mathBenchmarkSink = mathBenchmarkSink + modelMatrix[3][0];
+}
+
+// A child's world matrix: its local matrix combined with the world matrix of its parent
+void benchmarkWorldMatrix(const unsigned int iterations) {
+	glm::mat4 worldMatrix(1.0f);
+	const unsigned int count = (unsigned int)benchmarkPositions.size();
+	for (unsigned int i = 0; i < iterations; i++) {
+		const unsigned int index = i % count;
+		glm::mat4 localMatrix = glm::translate(glm::mat4(1.0f), benchmarkPositions[index]) * glm::toMat4(benchmarkOrientations[index]);
+		localMatrix = glm::scale(localMatrix, glm::vec3(benchmarkScales[index]));
+		worldMatrix = worldMatrix * localMatrix;
+		// Keep the matrix from growing without bounds
+		worldMatrix[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	mathBenchmarkSink = mathBenchmarkSink + worldMatrix[0][0];
+}
+
+double timeBatch(const MathBenchmarkCase& benchmarkCase, const unsigned int iterations) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	benchmarkCase.run(iterations);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Returns how many iterations make up a sample of the case
+unsigned int calibrate(const MathBenchmarkCase& benchmarkCase) {
+	//* Double the iterations per sample until a sample takes long enough to be timed reliably
+	unsigned int iterations = 1;
+	while (timeBatch(benchmarkCase, iterations) < minSampleMilliseconds) {
+		iterations *= 2;
+	}
+
+	//* Warm up caches, branch predictors and the CPU's clock speed before anything is recorded
+	double warmedUp = 0.0;
+	while (warmedUp < warmupMilliseconds) {
+		warmedUp += timeBatch(benchmarkCase, iterations);
+	}
+	return iterations;
+}
+
+// Calculates mean, confidence interval, median and minimum of the samples (in nanoseconds per iteration)
+MathBenchmarkResult summarize(const char* name, std::vector<double>& samples, const unsigned int iterations) {
+	double mean = 0.0;
+	for (unsigned int i = 0; i < sampleCount; i++) {
+		mean += samples[i];
+	}
+	mean /= sampleCount;
+	double variance = 0.0;
+	for (unsigned int i = 0; i < sampleCount; i++) {
+		variance += (samples[i] - mean) * (samples[i] - mean);
+	}
+	variance /= sampleCount - 1;
+	std::sort(samples.begin(), samples.end());
+
+	MathBenchmarkResult result;
+	result.name = name;
+	result.meanNanoseconds = mean;
+	result.confidenceNanoseconds = confidenceT * std::sqrt(variance / sampleCount);
+	result.medianNanoseconds = samples[sampleCount / 2];
+	result.minNanoseconds = samples.front();
+	result.iterations = iterations;
+	return result;
+}
+
+//* Results file: a header line, then one line per case with tab-separated values
+bool writeResults(const std::string& path, const std::vector<MathBenchmarkResult>& results) {
+	std::ofstream file(path);
+	if (!file) {
+		std::cout << "Error: Couldn't write the benchmark results to " << path << std::endl;
+		return false;
+	}
+	file << "case\tmean_ns\tci95_ns\tmedian_ns\tmin_ns\tsamples\titerations_per_sample\n";
+	for (const MathBenchmarkResult& result : results) {
+		file << result.name << '\t' << result.meanNanoseconds << '\t' << result.confidenceNanoseconds << '\t' << result.medianNanoseconds
+			<< '\t' << result.minNanoseconds << '\t' << sampleCount << '\t' << result.iterations << '\n';
+	}
+	return true;
+}
+
+bool readResults(const std::string& path, std::unordered_map<std::string, MathBenchmarkResult>& results) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cout << "Error: Couldn't read the benchmark baseline " << path << std::endl;
+		return false;
+	}
+	std::string line;
+	// Skip the header
+	std::getline(file, line);
+	while (std::getline(file, line)) {
+		std::istringstream fields(line);
+		MathBenchmarkResult result;
+		if (!std::getline(fields, result.name, '\t')) {
+			continue;
+		}
+		fields >> result.meanNanoseconds >> result.confidenceNanoseconds >> result.medianNanoseconds >> result.minNanoseconds;
+		if (!fields) {
+			std::cout << "Error: Malformed line in the benchmark baseline " << path << ": " << line << std::endl;
+			return false;
+		}
+		results[result.name] = result;
+	}
+	return true;
+}
+
+//** Public **//
+int MathBenchmark::run(const std::string& resultsPath, const std::string& baselinePath, const double thresholdPercent) {
+	//* Set up the state the cases work on
+	Camera camera(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f), 2.5f, 90.0f);
+	benchmarkedCamera = &camera;
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> coordinate(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	const unsigned int transformCount = 1024;
+	for (unsigned int i = 0; i < transformCount; i++) {
+		benchmarkPositions.push_back(glm::vec3(coordinate(random), coordinate(random), coordinate(random)));
+		const glm::vec3 axis = glm::normalize(glm::vec3(coordinate(random), coordinate(random), coordinate(random)) + glm::vec3(0.0f, 0.001f, 0.0f));
+		benchmarkOrientations.push_back(glm::angleAxis(angle(random), axis));
+		benchmarkAxes.push_back(axis);
+		benchmarkScales.push_back(0.5f + (coordinate(random) + 10.0f) / 20.0f);
+	}
+
+	const MathBenchmarkCase cases[] = {
+		{ "Camera::update (yaw and pitch)", benchmarkYawAndPitch },
+		{ "Camera::update (roll)", benchmarkRoll },
+		{ "Camera::update (move, yaw, pitch and roll)", benchmarkFullUpdate },
+		{ "Camera::updateViewMatrix", benchmarkViewMatrix },
+		{ "Rotate vector through angleAxis and toMat4", benchmarkRotateThroughMatrix },
+		{ "Rotate vector by angleAxis quaternion", benchmarkRotateThroughQuaternion },
+		{ "Combine two quaternions and toMat4", benchmarkCombinedRotation },
+		{ "Model matrix (translate, rotate, scale)", benchmarkModelMatrix },
+		{ "World matrix (model matrix times parent)", benchmarkWorldMatrix },
+	};
+
+	const unsigned int caseCount = sizeof(cases) / sizeof(cases[0]);
+
+	//* Measure every case
+	// The samples of all cases take turns rather than running one case after another, so that anything slowing the machine down
+	// for a while (e.g. another process or the CPU clocking down) is spread across all cases instead of skewing a single one
+	unsigned int iterations[caseCount];
+	for (unsigned int i = 0; i < caseCount; i++) {
+		iterations[i] = calibrate(cases[i]);
+	}
+	std::vector<std::vector<double>> samples(caseCount, std::vector<double>(sampleCount));
+	for (unsigned int sample = 0; sample < sampleCount; sample++) {
+		for (unsigned int i = 0; i < caseCount; i++) {
+			samples[i][sample] = timeBatch(cases[i], iterations[i]) * 1000000.0 / iterations[i];
+		}
+	}
+
+	//* Print them
+	std::vector<MathBenchmarkResult> results;
+	std::cout << "Math benchmark, mean of " << sampleCount << " samples with 95% confidence interval:" << std::endl;
+	for (unsigned int i = 0; i < caseCount; i++) {
+		results.push_back(summarize(cases[i].name, samples[i], iterations[i]));
+		const MathBenchmarkResult& result = results.back();
+		std::cout << "  " << result.name << ": " << result.meanNanoseconds << " +- " << result.confidenceNanoseconds << " ns (median "
+			<< result.medianNanoseconds << " ns, min " << result.minNanoseconds << " ns)" << std::endl;
+	}
+	benchmarkedCamera = nullptr;
+	benchmarkPositions.clear();
+	benchmarkOrientations.clear();
+	benchmarkAxes.clear();
+	benchmarkScales.clear();
+
+	if (!resultsPath.empty() && writeResults(resultsPath, results)) {
+		std::cout << "Results written to " << resultsPath << std::endl;
+	}
+	if (baselinePath.empty()) {
+		return 0;
+	}
+
+	//* Compare against the baseline
+	// Only differences that hold up at both ends of the confidence intervals count, so noise doesn't show up as a regression
+	std::unordered_map<std::string, MathBenchmarkResult> baseline;
+	if (!readResults(baselinePath, baseline)) {
+		return 1;
+	}
+	const double threshold = thresholdPercent / 100.0;
+	unsigned int regressions = 0;
+	std::cout << "Compared to " << baselinePath << " (threshold " << thresholdPercent << "%):" << std::endl;
+	for (const MathBenchmarkResult& result : results) {
+		std::unordered_map<std::string, MathBenchmarkResult>::const_iterator previous = baseline.find(result.name);
+		if (previous == baseline.end()) {
+			std::cout << "  " << result.name << ": not in the baseline" << std::endl;
+			continue;
+		}
+		const MathBenchmarkResult& before = previous->second;
+		const double change = (result.meanNanoseconds / before.meanNanoseconds - 1.0) * 100.0;
+		const bool slower = result.meanNanoseconds - result.confidenceNanoseconds > (before.meanNanoseconds + before.confidenceNanoseconds) * (1.0 + threshold);
+		const bool faster = result.meanNanoseconds + result.confidenceNanoseconds < (before.meanNanoseconds - before.confidenceNanoseconds) * (1.0 - threshold);
+		std::cout << "  " << result.name << ": " << (change >= 0.0 ? "+" : "") << change << "%"
+			<< (slower ? " REGRESSION" : faster ? " improvement" : "") << std::endl;
+		if (slower) {
+			regressions++;
+		}
+	}
+	if (regressions > 0) {
+		std::cout << "Error: " << regressions << " cases are slower than the baseline" << std::endl;
+		return 1;
+	}
+	return 0;
+}
\ No newline at end of file
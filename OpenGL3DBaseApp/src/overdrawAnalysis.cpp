@@ -0,0 +1,180 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include "overdrawAnalysis.hpp"
+#include "dynamicResolution.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Overdraw at which the heatmap reaches its hottest color
+const unsigned int heatmapMaxOverdraw = 8;
+
+bool captureRequested = false;
+bool capturing = false;
+bool hasResult = false;
+std::string requestedHeatmapPath;
+OverdrawResult lastResult;
+
+GLFramebuffer overdrawFBO;
+GLRenderbuffer overdrawColorRenderbuffer, overdrawDepthStencilRenderbuffer;
+unsigned int targetWidth = 0, targetHeight = 0;
+unsigned int timerQueryID = 0;
+// Framebuffer the frame would have been drawn to without the analysis
+int previousFramebufferID = 0;
+
+// (Re)creates the offscreen target in the size the scene is rendered at
+void prepareTarget(const unsigned int width, const unsigned int height) {
+	if (overdrawFBO.getID() != 0 && width == targetWidth && height == targetHeight) {
+		return;
+	}
+	if (overdrawFBO.getID() == 0) {
+		overdrawFBO = GLFramebuffer(GLMemoryCategory::RenderTargets, "Overdraw analysis framebuffer");
+		overdrawColorRenderbuffer = GLRenderbuffer(GLMemoryCategory::RenderTargets, "Overdraw analysis color");
+		overdrawDepthStencilRenderbuffer = GLRenderbuffer(GLMemoryCategory::RenderTargets, "Overdraw analysis depth and stencil");
+		glGenQueries(1, &timerQueryID);
+	}
+	targetWidth = width;
+	targetHeight = height;
+
+	//* Renderbuffers are images that can be rendered to but not sampled from, which is all we need here
+	// The stencil buffer holds the count; with 8 bits, it saturates at an overdraw of 255
+	glBindRenderbuffer(GL_RENDERBUFFER, overdrawColorRenderbuffer.getID());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	overdrawColorRenderbuffer.setSize((size_t)width * height * 4);
+	glBindRenderbuffer(GL_RENDERBUFFER, overdrawDepthStencilRenderbuffer.getID());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	overdrawDepthStencilRenderbuffer.setSize((size_t)width * height * 4);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, overdrawFBO.getID());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, overdrawColorRenderbuffer.getID());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, overdrawDepthStencilRenderbuffer.getID());
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cout << "Error: Overdraw analysis framebuffer is incomplete" << std::endl;
+	}
+}
+
+// Maps an overdraw count to a color going from black over blue, green and yellow to red
+void heatmapColor(const unsigned int overdraw, unsigned char* color) {
+	if (overdraw == 0) {
+		color[0] = color[1] = color[2] = 0;
+		return;
+	}
+	const float gradient[5][3] = { { 0, 0, 255 }, { 0, 255, 255 }, { 0, 255, 0 }, { 255, 255, 0 }, { 255, 0, 0 } };
+	const float position = std::min((float)(overdraw - 1) / (heatmapMaxOverdraw - 1), 1.0f) * 4.0f;
+	const int index = std::min((int)position, 3);
+	const float weight = position - index;
+	for (int c = 0; c < 3; c++) {
+		color[c] = (unsigned char)(gradient[index][c] * (1.0f - weight) + gradient[index + 1][c] * weight + 0.5f);
+	}
+}
+
+// Writes the heatmap as binary PPM, which any image viewer can open and which needs no image library
+void writeHeatmap(const std::vector<unsigned char>& counts, const std::string& path) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "Error: Could not write overdraw heatmap to " << path << std::endl;
+		return;
+	}
+	file << "P6\n" << targetWidth << " " << targetHeight << "\n255\n";
+	std::vector<unsigned char> row(targetWidth * 3);
+	// OpenGL's rows start at the bottom, PPM's at the top
+	for (int y = (int)targetHeight - 1; y >= 0; y--) {
+		for (unsigned int x = 0; x < targetWidth; x++) {
+			heatmapColor(counts[(size_t)y * targetWidth + x], &row[x * 3]);
+		}
+		file.write(reinterpret_cast<const char*>(&row[0]), row.size());
+	}
+}
+
+//** Public **//
+// Analyzes the next frame and writes its heatmap to the given path
+void OverdrawAnalysis::requestCapture(const std::string& heatmapPath) {
+	captureRequested = true;
+	requestedHeatmapPath = heatmapPath;
+}
+
+// Should be called before anything of the frame is drawn. Redirects rendering into the offscreen target if a capture was requested
+void OverdrawAnalysis::beginFrame() {
+	if (!captureRequested) {
+		return;
+	}
+	captureRequested = false;
+	capturing = true;
+
+	unsigned int width, height;
+	DynamicResolution::getRenderSize(width, height);
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebufferID);
+	prepareTarget(width, height);
+	glBindFramebuffer(GL_FRAMEBUFFER, overdrawFBO.getID());
+	glClearStencil(0);
+	glClear(GL_STENCIL_BUFFER_BIT);
+
+	//* Count every fragment that passes the depth test (= every fragment that writes the pixel)
+	// The stencil test itself always passes; the 3 arguments of glStencilOp are the actions for a failed stencil test,
+	// a failed depth test and a passed depth test
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 0, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+	glStencilMask(0xFF);
+
+	glBeginQuery(GL_TIME_ELAPSED, timerQueryID);
+}
+
+// Should be called after everything of the frame is drawn. Evaluates the counts and shows the frame in the window as usual
+void OverdrawAnalysis::endFrame() {
+	if (!capturing) {
+		return;
+	}
+	capturing = false;
+	glEndQuery(GL_TIME_ELAPSED);
+	glDisable(GL_STENCIL_TEST);
+
+	//* Read back the counts
+	// This waits for the GPU to finish the frame, which is fine for an analysis
+	std::vector<unsigned char> counts((size_t)targetWidth * targetHeight);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, targetWidth, targetHeight, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, &counts[0]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	GLuint64 elapsedNanoseconds = 0;
+	glGetQueryObjectui64v(timerQueryID, GL_QUERY_RESULT, &elapsedNanoseconds);
+
+	unsigned long long fragmentWrites = 0, coveredPixels = 0;
+	unsigned int maxOverdraw = 0;
+	for (size_t i = 0; i < counts.size(); i++) {
+		fragmentWrites += counts[i];
+		coveredPixels += counts[i] > 0 ? 1 : 0;
+		maxOverdraw = std::max(maxOverdraw, (unsigned int)counts[i]);
+	}
+	lastResult.averageOverdraw = coveredPixels > 0 ? (double)fragmentWrites / coveredPixels : 0.0;
+	lastResult.maxOverdraw = maxOverdraw;
+	lastResult.coverage = (double)coveredPixels / counts.size();
+	lastResult.fragmentWrites = fragmentWrites;
+	lastResult.gpuMilliseconds = elapsedNanoseconds / 1000000.0;
+	hasResult = true;
+	writeHeatmap(counts, requestedHeatmapPath);
+
+	//* Copy the rendered image to where it would have gone otherwise (the window or the dynamic resolution's target)
+	// so that the frame doesn't go missing
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, overdrawFBO.getID());
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previousFramebufferID);
+	glBlitFramebuffer(0, 0, targetWidth, targetHeight, 0, 0, targetWidth, targetHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebufferID);
+}
+
+// Deletes the offscreen target. Has to be called while the OpenGL context still exists
+void OverdrawAnalysis::shutdown() {
+	if (timerQueryID != 0) {
+		glDeleteQueries(1, &timerQueryID);
+		timerQueryID = 0;
+	}
+	overdrawDepthStencilRenderbuffer.reset();
+	overdrawColorRenderbuffer.reset();
+	overdrawFBO.reset();
+}
+
+bool OverdrawAnalysis::getLastResult(OverdrawResult& result) {
+	result = lastResult;
+	return hasResult;
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "particles.hpp"
+#include "shaders.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Binding point 0 holds the views' matrices (see Views::initialize()), 1 to 3 the lighting, the shadows and the materials
+const unsigned int matricesBindingPoint = 0, emitterBindingPoint = 4;
+
+// A particle as it is stored in the buffers; the age counts up from 0, and the particle is dead once it reaches the lifetime
+struct Particle {
+	glm::vec4 positionAndAge;
+	glm::vec4 velocityAndLifetime;
+};
+
+// Mirrors the "emitter" uniform block of the particle shaders (std140 layout)
+struct EmitterParameters {
+	glm::vec4 positionAndRadius;
+	glm::vec4 velocityAndSpread;
+	glm::vec4 accelerationAndDrag;
+	glm::vec4 startColor;
+	glm::vec4 endColor;
+	glm::vec4 lifetimeSizeAndTimestep;	// Minimum and maximum lifetime, size, seconds simulated by the current update
+	glm::uvec4 emission;				// First particle that may be reborn this update, number of them, number of particles, update number
+};
+
+std::unique_ptr<Shader> particleUpdateShader, particleRenderShader;
+// Two buffers that take turns: the update reads one and writes the other. Each has a VAO that reads from it
+GLBuffer particleBuffers[2];
+GLVertexArray particleVAOs[2];
+GLBuffer emitterUBO;
+// The buffer that holds the current state of the particles
+unsigned int currentParticleBuffer = 0;
+unsigned int particleCount = 0;
+
+ParticleEmitter particleEmitter = {};
+EmitterParameters emitterParameters = {};
+// Particles that were due to be born but didn't make up a whole particle yet
+float emissionAccumulator = 0.0f;
+unsigned int emissionStart = 0;
+// Update 0 kills every particle, as the buffers' contents are undefined until then
+unsigned int updateNumber = 0;
+
+void configureParticleShader(Shader& shader) {
+	const unsigned int programID = shader.getShaderProgramID();
+	unsigned int blockIndex = glGetUniformBlockIndex(programID, "matrices");
+	if (blockIndex != GL_INVALID_INDEX) {
+		glUniformBlockBinding(programID, blockIndex, matricesBindingPoint);
+	}
+	glUniformBlockBinding(programID, glGetUniformBlockIndex(programID, "emitter"), emitterBindingPoint);
+}
+
+//** Public **//
+void ParticleSystem::initialize(const unsigned int count) {
+	particleCount = std::max(count, 1u);
+
+	//* Shaders
+	// The update shader writes the particle's new state into the other buffer, in the same layout as Particle
+	const std::vector<const char*> feedbackOutputs = { "positionAndAge", "velocityAndLifetime" };
+	particleUpdateShader.reset(new Shader("res/shaders/particleUpdate.vert", feedbackOutputs));
+	particleRenderShader.reset(new Shader("res/shaders/particle.vert", "res/shaders/particle.frag"));
+	configureParticleShader(*particleUpdateShader);
+	configureParticleShader(*particleRenderShader);
+
+	//* Buffers
+	// Their contents don't matter as the first update kills every particle, so there is nothing to upload
+	for (unsigned int i = 0; i < 2; i++) {
+		particleBuffers[i] = GLBuffer(GLMemoryCategory::Instances, "Particles");
+		particleVAOs[i] = GLVertexArray(GLMemoryCategory::Instances, "Particles");
+		glBindVertexArray(particleVAOs[i].getID());
+		glBindBuffer(GL_ARRAY_BUFFER, particleBuffers[i].getID());
+		glBufferData(GL_ARRAY_BUFFER, particleCount * sizeof(Particle), nullptr, GL_DYNAMIC_COPY);
+		particleBuffers[i].setSize(particleCount * sizeof(Particle));
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, positionAndAge));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Particle), (void*)offsetof(Particle, velocityAndLifetime));
+		glEnableVertexAttribArray(1);
+	}
+	glBindVertexArray(0);
+
+	emitterUBO = GLBuffer(GLMemoryCategory::Uniforms, "Particle emitter");
+	glBindBuffer(GL_UNIFORM_BUFFER, emitterUBO.getID());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(EmitterParameters), nullptr, GL_DYNAMIC_DRAW);
+	emitterUBO.setSize(sizeof(EmitterParameters));
+	glBindBufferBase(GL_UNIFORM_BUFFER, emitterBindingPoint, emitterUBO.getID());
+
+	currentParticleBuffer = 0;
+	emissionAccumulator = 0.0f;
+	emissionStart = 0;
+	updateNumber = 0;
+}
+
+void ParticleSystem::shutdown() {
+	particleUpdateShader.reset();
+	particleRenderShader.reset();
+	for (unsigned int i = 0; i < 2; i++) {
+		particleVAOs[i].reset();
+		particleBuffers[i].reset();
+	}
+	emitterUBO.reset();
+	particleCount = 0;
+}
+
+// Takes effect with the next update; particles that are alive already keep moving as they were born
+void ParticleSystem::setEmitter(const ParticleEmitter& emitter) {
+	particleEmitter = emitter;
+	emitterParameters.positionAndRadius = glm::vec4(emitter.position, emitter.radius);
+	emitterParameters.velocityAndSpread = glm::vec4(emitter.velocity, emitter.velocitySpread);
+	emitterParameters.accelerationAndDrag = glm::vec4(emitter.acceleration, emitter.drag);
+	emitterParameters.startColor = emitter.startColor;
+	emitterParameters.endColor = emitter.endColor;
+	emitterParameters.lifetimeSizeAndTimestep = glm::vec4(emitter.minimumLifetime, emitter.maximumLifetime, emitter.size, 0.0f);
+}
+
+// Moves the particles on by the given time, kills the ones that reached their lifetime and lets the emitter give birth to new ones
+void ParticleSystem::update(const float deltaTime) {
+	//* The particles that may be born this update follow the ones of the last update
+	emissionAccumulator += particleEmitter.emissionRate * deltaTime;
+	const unsigned int emittedCount = (unsigned int)std::min(emissionAccumulator, (float)particleCount);
+	emissionAccumulator = std::min(emissionAccumulator - (float)emittedCount, 1.0f);
+	emitterParameters.lifetimeSizeAndTimestep.w = deltaTime;
+	emitterParameters.emission = glm::uvec4(emissionStart, emittedCount, particleCount, updateNumber);
+	emissionStart = (emissionStart + emittedCount) % particleCount;
+	// The update number also seeds the random numbers; 0 is left out after wrapping around as it kills every particle
+	updateNumber = updateNumber == 0xFFFFFFFFu ? 1 : updateNumber + 1;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, emitterUBO.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(EmitterParameters), &emitterParameters);
+
+	//* Run every particle through the update shader once, writing the results into the other buffer
+	// Nothing is drawn, so rasterization is switched off entirely
+	particleUpdateShader->use();
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(particleVAOs[currentParticleBuffer].getID());
+	// The VAO is also used for drawing, where every particle is an instance
+	glVertexAttribDivisor(0, 0);
+	glVertexAttribDivisor(1, 0);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particleBuffers[1 - currentParticleBuffer].getID());
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, particleCount);
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(0);
+
+	currentParticleBuffer = 1 - currentParticleBuffer;
+}
+
+// Draws the particles into all views of the current pass
+// They are see-through, so they are tested against the scene's depth without writing to it
+void ParticleSystem::render(const unsigned int viewCount) {
+	particleRenderShader->use();
+	glBindVertexArray(particleVAOs[currentParticleBuffer].getID());
+	glVertexAttribDivisor(0, viewCount);
+	glVertexAttribDivisor(1, viewCount);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	glDepthMask(GL_FALSE);
+	// Every particle is a quad of 4 vertices whose corners the vertex shader derives from the vertex ID
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, particleCount * viewCount);
+	glDepthMask(GL_TRUE);
+	glDisable(GL_BLEND);
+	glBindVertexArray(0);
+}
+
+// Times the update of increasing numbers of particles once all of them are alive, both on the GPU (timer queries) and by the wall clock
+// The throughput is taken from the wall clock time, which includes everything from issuing the steps to their results being ready
+void ParticleSystem::printBenchmark() {
+	const unsigned int particleCounts[] = { 1 << 16, 1 << 18, 1 << 20, 1 << 22 };
+	const unsigned int warmupSteps = 120, timedSteps = 60;
+	const float timestep = 1.0f / 60.0f;
+
+	std::cout << "GPU particle simulation benchmark (" << glGetString(GL_RENDERER) << "), " << timedSteps << " steps of "
+		<< timestep * 1000.0f << " ms after " << warmupSteps << " warmup steps" << std::endl;
+	std::cout << std::setw(12) << "Particles" << std::setw(16) << "GPU (ms/step)" << std::setw(16) << "Wall (ms/step)"
+		<< std::setw(20) << "Million particles/s" << std::endl;
+
+	unsigned int queryID;
+	glGenQueries(1, &queryID);
+	for (const unsigned int count : particleCounts) {
+		initialize(count);
+		//* A fountain whose particles live 1 to 2 seconds; the emission rate keeps the whole buffer busy
+		ParticleEmitter emitter = {};
+		emitter.radius = 0.2f;
+		emitter.velocity = glm::vec3(0.0f, 6.0f, 0.0f);
+		emitter.velocitySpread = 2.0f;
+		emitter.acceleration = glm::vec3(0.0f, -9.81f, 0.0f);
+		emitter.drag = 0.1f;
+		emitter.minimumLifetime = 1.0f;
+		emitter.maximumLifetime = 2.0f;
+		emitter.emissionRate = count / emitter.maximumLifetime;
+		emitter.size = 0.02f;
+		emitter.startColor = glm::vec4(1.0f);
+		emitter.endColor = glm::vec4(0.0f);
+		setEmitter(emitter);
+
+		for (unsigned int step = 0; step < warmupSteps; step++) {
+			update(timestep);
+		}
+		glFinish();
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		glBeginQuery(GL_TIME_ELAPSED, queryID);
+		for (unsigned int step = 0; step < timedSteps; step++) {
+			update(timestep);
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+		glFinish();
+		const double wallMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / timedSteps;
+		GLuint64 gpuNanoseconds = 0;
+		glGetQueryObjectui64v(queryID, GL_QUERY_RESULT, &gpuNanoseconds);
+		const double gpuMilliseconds = gpuNanoseconds / 1000000.0 / timedSteps;
+
+		std::cout << std::setw(12) << count << std::fixed << std::setprecision(3) << std::setw(16) << gpuMilliseconds
+			<< std::setw(16) << wallMilliseconds << std::setprecision(1) << std::setw(20) << count / wallMilliseconds / 1000.0
+			<< std::defaultfloat << std::endl;
+		shutdown();
+	}
+	glDeleteQueries(1, &queryID);
+}
\ No newline at end of file
@@ -1,136 +1,111 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 
 #include <glm/gtx/quaternion.hpp>
 
-// Seems strange, but this is the correct way of including stb_image.h
-#define STB_IMAGE_IMPLEMENTATION
+// The implementation of stb_image.h is compiled in textureStreamer.cpp, here we only need its declarations
 #include "STB/stb_image.h"
 
 #include "render.hpp"
 #include "input.hpp"
+#include "textureStreamer.hpp"
+#include "uploadManager.hpp"
+#include "resourceManager.hpp"
+#include "frameArena.hpp"
+#include "dynamicResolution.hpp"
+#include "clock.hpp"
+#include "views.hpp"
+#include "cascadedShadows.hpp"
+#include "entities.hpp"
+#include "transforms.hpp"
+#include "glResources.hpp"
+#include "assetLoader.hpp"
 
 //** Private **//
-float blendValue;
-
-void loadTexture(const std::string& texturePath, unsigned int& textureID) {
-	int width, height, numberOfColorChannels;
-	unsigned int rgbType = 0;
-	//* Load the image from file
-	// 1st argument takes a const char* to the filepath
-	// 2nd, 3rd and 4th argument take pointers to store width, height and number of color channels in
-	// 5th argument can be used to force number of 8-bit components per pixel. We don't need that, so we leave it at 0
-	// As much as I hate it, stbi_load actually requires you to store a raw pointer, there's no way around it
-	// Otherwise you won't be able to call stbi_image_free later on
-	unsigned char* imageData = stbi_load(texturePath.c_str(), &width, &height, &numberOfColorChannels, 0);
-	// 3 color channels means no alpha channel, 4 means there is one
-	switch (numberOfColorChannels) {
-	case 3:
-		rgbType = GL_RGB;
-		break;
-	case 4:
-		rgbType = GL_RGBA;
-		break;
-	default:
-		std::cout << "Error: Image's color channels were not properly recognized." << "\n";
-		std::cout << "Image has " << numberOfColorChannels << " color channels." << std::endl;
-
-		if (numberOfColorChannels < 0) {
-			std::cout << "Are you sure the specified file exists?\n" << std::endl;
-		}
-	}
+// What the instance buffer of the cubes stores for every instance
+struct CubeInstance {
+	glm::mat4 modelMatrix;
+	unsigned int materialID;
+};
+// The model matrix takes up locations 2 to 5, the material ID location 6
+const unsigned int firstInstanceAttribute = 2, instanceAttributeCount = 5;
+// Animated cubes use the material ID at location 6 as well, followed by their animation parameters at locations 7 to 9
+const unsigned int firstAnimatedAttribute = 6, animatedAttributeCount = 4;
+// Distance from a cube's center to its corners
+const float cubeBoundingRadius = 0.87f;
+
+// VAOs whose vertex data (and index data) has arrived on the GPU
+std::vector<unsigned int> residentVAOs;
+
+bool isResident(const unsigned int VAO_ID) {
+	return std::find(residentVAOs.begin(), residentVAOs.end(), VAO_ID) != residentVAOs.end();
+}
 
-	//* Generate a new empty texture. First argument is the number of textures to create
-	// Second argument is a pointer to store the assigned ID in
-	glGenTextures(1, &textureID);
-	// Tells OpenGL which texture we are currently working with. First argument specifies the texture type, second one takes the ID
-	glBindTexture(GL_TEXTURE_2D, textureID);
-
-	//* Set texture wrapping to "Mirror" on both axes (-> S-axe and T-axe which correspond to x and y)
-	// First argument is texture type, second argument the parameter to modify, third argument the desired value of the parameter
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-	// Set texture filtering to "Linear"
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// Set mipmapping to "Linear / Linear"
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-
-	//* Fill the empty texture with the previously loaded image data
-	if (imageData) {
-		// First argument is the texture type, second one is for setting mipmap levels manually which we don't want to do -> leave at 0
-		// Third argument tells OpenGL the format the texture is to be stored in, 4th and 5th argument should be self-explanatory
-		// 6th argument has to be 0 at all times (specifies border width; legacy)
-		// 7th argument specifies the format of the source image
-		// 8th argument specifies the datatype of the source image; since we stored it as unsigned char (-> byte), this has to be GL_UNSIGNED_BYTE
-		// 9th argument is a pointer to the actual image data
-		glTexImage2D(GL_TEXTURE_2D, 0, rgbType, width, height, 0, rgbType, GL_UNSIGNED_BYTE, imageData);
-		// This function automatically creates mipmaps for the current texture
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cout << "Error: Failed to load texture\n" << std::endl;
-	}
+// Returns a callback for the upload manager that marks the VAO as ready to be drawn
+std::function<void()> markResident(const unsigned int VAO_ID) {
+	return [VAO_ID]() { residentVAOs.push_back(VAO_ID); };
+}
 
-	// Free the image from memory
-	stbi_image_free(imageData);
+// Stops drawing the VAO, e.g. because its object is destroyed
+void forgetResident(const unsigned int VAO_ID) {
+	std::vector<unsigned int>::iterator resident = std::find(residentVAOs.begin(), residentVAOs.end(), VAO_ID);
+	if (resident != residentVAOs.end()) {
+		residentVAOs.erase(resident);
+	}
 }
 
-void create_VAO_VBO(const std::vector<float>& vertices, unsigned int& VAO_ID) {
+void create_VAO_VBO(const std::vector<float>& vertices, GLVertexArray& VAO, GLBuffer& VBO, const char* label) {
 	//* Create a vertex array object (VAO) that tells OpenGL how to interpret vertex buffer array (VBO) data (see down below)
-	// First argument defines number of VAOs created, seconds takes a pointer to store the assigned VAO ID in
-	glGenVertexArrays(1, &VAO_ID);
+	// The GLVertexArray generates the VAO, stores its assigned ID and deletes it again once the object that owns it is gone
+	// The label shows up in the GPU memory report
+	VAO = GLVertexArray(GLMemoryCategory::Geometry, label);
 
 	//* Create a VBO that stores our data
-	// Since we won't change the vertex data, there is no need for us to store the VBO ID permanently
-	unsigned int VBO_ID;
-	// First argument defines number of VBOs created, seconds takes a pointer to store the assigned VBO ID in
-	glGenBuffers(1, &VBO_ID);
+	// We never change the vertex data, but still have to keep the VBO around so that it is deleted along with the object
+	VBO = GLBuffer(GLMemoryCategory::Geometry, label);
 
 	//* Copy our data into the VBO
 	// This function tells OpenGL which VAO we are currently working with. First argument is the VAO ID
-	glBindVertexArray(VAO_ID);
+	glBindVertexArray(VAO.getID());
 	// Same for the VBO
 	// First argument tells OpenGL which type of buffer it has to deal with, second argument is the VBO ID
-	glBindBuffer(GL_ARRAY_BUFFER, VBO_ID);
-	// Here the actual data copying happens
-	// First argument is the buffer type, second argument the size of the data, third argument a pointer to the data
+	glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+	// The upload manager allocates the buffer right away, but copies the data over the next frames so that loading doesn't stall rendering
 	// Note that since we are passing a std::vector, we need to give a pointer to the first item
-	// 4th argument tells OpenGL how to handle the data. "Static draw" specifies that the data is set only once and used many times
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+	// The VAO may only be drawn once the data has arrived, which the upload manager tells us by calling the given function
+	UploadManager::uploadBuffer(VBO.getID(), &vertices[0], vertices.size() * sizeof(float), markResident(VAO.getID()));
 }
 
-void create_VAO_VBO_EBO(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, unsigned int& VAO_ID) {
+void create_VAO_VBO_EBO(const std::vector<float>& vertices, const std::vector<unsigned int>& indices, GLVertexArray& VAO, GLBuffer& VBO, GLBuffer& EBO,
+	const char* label) {
 	//* Create an element buffer object (EBO) -> manages objects comprised of overlapping vertices that are specified with indices
-	// Since we won't change the index data, there is no need for us to store the EBO ID permanently
-	unsigned int EBO_ID;
-	// First argument defines number of EBOs created, seconds takes a pointer to store the assigned EBO ID in
-	glGenBuffers(1, &EBO_ID);
+	// Like the VBO, we never change the index data, but keep the EBO around so that it is deleted along with the object
+	EBO = GLBuffer(GLMemoryCategory::Geometry, label);
 
 	//* Create a vertex array object (VAO) that tells OpenGL how to interpret vertex buffer array (VBO) data (see down below)
-	// First argument defines number of VAOs created, seconds takes a pointer to store the assigned VAO ID in
-	glGenVertexArrays(1, &VAO_ID);
+	// The GLVertexArray generates the VAO, stores its assigned ID and deletes it again once the object that owns it is gone
+	VAO = GLVertexArray(GLMemoryCategory::Geometry, label);
 
 	//* Create a VBO that stores our data
-	// Since we won't change the vertex data, there is no need for us to store the VBO ID permanently
-	unsigned int VBO_ID;
-	// First argument defines number of VBOs created, seconds takes a pointer to store the assigned VBO ID in
-	glGenBuffers(1, &VBO_ID);
+	VBO = GLBuffer(GLMemoryCategory::Geometry, label);
 
 	//* Copy our data into the VBO
 	// This function tells OpenGL which VAO we are currently working with. First argument is the VAO ID
-	glBindVertexArray(VAO_ID);
+	glBindVertexArray(VAO.getID());
 	// Same for the VBO
 	// First argument tells OpenGL which type of buffer it has to deal with, second argument is the VBO ID
-	glBindBuffer(GL_ARRAY_BUFFER, VBO_ID);
-	// Here the actual data copying happens
-	// First argument is the buffer type, second argument the size of the data, third argument a pointer to the data
+	glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+	// The upload manager allocates the buffer right away, but copies the data over the next frames so that loading doesn't stall rendering
 	// Note that since we are passing a std::vector, we need to give a pointer to the first item
-	// 4th argument tells OpenGL how to handle the data. "Static draw" specifies that the data is set only once and used many times
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+	UploadManager::uploadBuffer(VBO.getID(), &vertices[0], vertices.size() * sizeof(float), nullptr);
 
 	//* Copy our indices into an element buffer for OpenGL to use
-	// Same as for the VBO
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO_ID);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(float), &indices[0], GL_STATIC_DRAW);
+	// Same as for the VBO; binding the EBO while the VAO is bound stores it in the VAO
+	// Uploads complete in order, so once the indices have arrived, the vertices have as well
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+	UploadManager::uploadBuffer(EBO.getID(), &indices[0], indices.size() * sizeof(unsigned int), markResident(VAO.getID()));
 }
 
 //** Public **//
@@ -148,8 +123,14 @@ Triangle::Triangle(const std::vector<float>& vertices) {
 	initializeVAO(vertices);
 }
 
+// The VAO and VBO delete themselves; only the list of resident VAOs has to forget about the VAO as its ID may be reused
+Triangle::~Triangle() {
+	forgetResident(VAO.getID());
+	UploadManager::cancelBufferUploads(VBO.getID());
+}
+
 void Triangle::initializeVAO(const std::vector<float>& vertices) {
-	create_VAO_VBO(vertices, VAO_ID);
+	create_VAO_VBO(vertices, VAO, VBO, "Triangle");
 
 	//* Tell OpenGL how our vertex data is organised
 	// First argument is the location where the specified set of data is stored in the vertex shaders
@@ -175,10 +156,15 @@ void Triangle::initializeVAO(const std::vector<float>& vertices) {
 }
 
 void Triangle::render() {
+	// Skip drawing until the vertex data has arrived on the GPU
+	if (!isResident(VAO.getID())) {
+		return;
+	}
+
 	//* Do the rendering
 	// Tells OpenGL that it is working with this triangle's VAO
 	// Remember that all that OpenGL needs is an VAO; it contains the necessary pointers to VBOs
-	glBindVertexArray(VAO_ID);
+	glBindVertexArray(VAO.getID());
 	// Draw the triangle
 	// First argument is the type of object to draw
 	// The second one is the starting index of the array (so in this case 0)
@@ -191,9 +177,18 @@ Rectangle::Rectangle(const std::string& texture1Path, const std::string& texture
 	initializeVAO();
 }
 
+Rectangle::~Rectangle() {
+	forgetResident(VAO.getID());
+	UploadManager::cancelBufferUploads(VBO.getID());
+	UploadManager::cancelBufferUploads(EBO.getID());
+	TextureStreamer::unloadTexture(texture1ID);
+	TextureStreamer::unloadTexture(texture2ID);
+}
+
 void Rectangle::initializeTextures(const std::string& texture1Path, const std::string& texture2Path) {
-	loadTexture(texture1Path, texture1ID);
-	loadTexture(texture2Path, texture2ID);
+	// Textures are managed by the texture streamer which only keeps the mip levels in GPU memory that are actually needed
+	texture1ID = TextureStreamer::loadTexture(texture1Path);
+	texture2ID = TextureStreamer::loadTexture(texture2Path);
 }
 
 void Rectangle::initializeVAO() {
@@ -210,7 +205,7 @@ void Rectangle::initializeVAO() {
 		1, 2, 3,	// second triangle
 	};
 
-	create_VAO_VBO_EBO(vertices, indices, VAO_ID);
+	create_VAO_VBO_EBO(vertices, indices, VAO, VBO, EBO, "Rectangle");
 
 	//* Tell OpenGL how our vertex data is organised
 	// First argument is the location where the specified set of data is stored in the vertex shaders
@@ -241,6 +236,17 @@ void Rectangle::initializeVAO() {
 }
 
 void Rectangle::render() {
+	// Skip drawing until both vertex data and textures have arrived on the GPU
+	if (!isResident(VAO.getID()) || !TextureStreamer::isResident(texture1ID) || !TextureStreamer::isResident(texture2ID)) {
+		return;
+	}
+
+	//* Request the full resolution from the texture streamer as the rectangle is drawn in screen space
+	unsigned int renderWidth, renderHeight;
+	DynamicResolution::getRenderSize(renderWidth, renderHeight);
+	TextureStreamer::requestScreenSize(texture1ID, (float)std::max(renderWidth, renderHeight));
+	TextureStreamer::requestScreenSize(texture2ID, (float)std::max(renderWidth, renderHeight));
+
 	//* Bind textures to their corresponding texture units
 	// Tells OpenGL which texture slot to use (there is a max of 16 texture slots to be used at once, GL_TEXTURE0 through GL_TEXTURE15)
 	glActiveTexture(GL_TEXTURE0);
@@ -254,7 +260,7 @@ void Rectangle::render() {
 	//* Do the rendering
 	// Tells OpenGL that it is working with this rectangle's VAO
 	// Remember that all that OpenGL needs is an VAO; it contains the necessary pointers to both VBOs and EBOs
-	glBindVertexArray(VAO_ID);
+	glBindVertexArray(VAO.getID());
 	// Draw the rectangle; glDrawElements is used here because it uses EBOs stored in the VAO
 	// -> used for objects comprised of overlapping vertices that are specified with indices
 	// First argument is the type of object to draw (in thise case still GL_TRIANGLES as our rectangle is comprised of two triangles)
@@ -264,14 +270,48 @@ void Rectangle::render() {
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
 
-Cube::Cube(const std::string& texture1Path, const std::string& texture2Path) {
+Cube::Cube(const std::string& texture1Path, const std::string& texture2Path) : instanceCapacity(0), instanceCount(0), shadowCasterCount(0),
+	animatedInstanceCount(0), animatedBounds(0.0f), animatedInstancesVisible(false), loadedInBackground(false), vertexBufferID(0), vertexCount(36) {
 	initializeTextures(texture1Path, texture2Path);
 	initializeVAO();
 }
 
+// Loads the mesh and both textures through the asset loader's thread, which doesn't hold up rendering even for large batches of cubes
+// The cube is drawn with the placeholder texture until its textures have arrived, and not at all until its mesh has
+Cube::Cube(const std::string& meshPath, const std::string& texture1Path, const std::string& texture2Path) : instanceCapacity(0), instanceCount(0),
+	shadowCasterCount(0), animatedInstanceCount(0), animatedBounds(0.0f), animatedInstancesVisible(false), loadedInBackground(true), vertexCount(0) {
+	texture1ID = AssetLoader::loadTexture(texture1Path);
+	texture2ID = AssetLoader::loadTexture(texture2Path);
+	vertexBufferID = AssetLoader::loadMesh(meshPath);
+
+	// VAOs aren't shared between contexts, so the VAO is created here. It can only point to the vertices once they have arrived
+	// (see Cube::prepareInstances()), but the instances are ours from the start
+	VAO = GLVertexArray(GLMemoryCategory::Geometry, "Background loaded cube");
+	glBindVertexArray(VAO.getID());
+	initializeInstanceAttributes();
+}
+
+Cube::~Cube() {
+	forgetResident(VAO.getID());
+	forgetResident(animatedVAO.getID());
+	// A cube that is destroyed right after it was created may still have uploads in flight
+	UploadManager::cancelBufferUploads(VBO.getID());
+	UploadManager::cancelBufferUploads(animatedInstanceVBO.getID());
+	if (loadedInBackground) {
+		AssetLoader::unloadTexture(texture1ID);
+		AssetLoader::unloadTexture(texture2ID);
+		AssetLoader::unloadMesh(vertexBufferID);
+	}
+	else {
+		TextureStreamer::unloadTexture(texture1ID);
+		TextureStreamer::unloadTexture(texture2ID);
+	}
+}
+
 void Cube::initializeTextures(const std::string& texture1Path, const std::string& texture2Path) {
-	loadTexture(texture1Path, texture1ID);
-	loadTexture(texture2Path, texture2ID);
+	// Textures are managed by the texture streamer which only keeps the mip levels in GPU memory that are actually needed
+	texture1ID = TextureStreamer::loadTexture(texture1Path);
+	texture2ID = TextureStreamer::loadTexture(texture2Path);
 }
 
 void Cube::initializeVAO() {
@@ -319,7 +359,17 @@ void Cube::initializeVAO() {
 		-0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
 	};
 
-	create_VAO_VBO(vertices, VAO_ID);
+	create_VAO_VBO(vertices, VAO, VBO, "Cube");
+	vertexBufferID = VBO.getID();
+
+	initializeVertexAttributes();
+	initializeInstanceAttributes();
+}
+
+void Cube::initializeVertexAttributes() {
+	// The attributes read from the buffer that is bound to GL_ARRAY_BUFFER while they are specified
+	glBindVertexArray(VAO.getID());
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
 
 	//* Tell OpenGL how our vertex data is organised
 	// First argument is the location where the specified set of data is stored in the vertex shaders
@@ -344,66 +394,272 @@ void Cube::initializeVAO() {
 	glEnableVertexAttribArray(1);
 }
 
-void Cube::calculateModelMatrix(const Shader& shader, const glm::vec3& cubePosition) {
-	glm::mat4 translationMatrix = glm::mat4(1.0f); // Start off with an identity matrix
-	translationMatrix = glm::translate(translationMatrix, cubePosition); // Translate by the given vector
+void Cube::initializeInstanceAttributes() {
+	//* Create a second VBO for the model matrices and material IDs, one of each per instance
+	// Its data changes every frame, so it is filled in Cube::prepareInstances()
+	instanceVBO = GLBuffer(GLMemoryCategory::Instances, "Cube instances");
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.getID());
+	// A mat4 is too large for a single vertex attribute, so it is split into its 4 columns at locations 2 to 5
+	for (unsigned int column = 0; column < 4; column++) {
+		glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(CubeInstance), (void*)(offsetof(CubeInstance, modelMatrix) + column * sizeof(glm::vec4)));
+		glEnableVertexAttribArray(2 + column);
+	}
+	// The material ID is an integer; glVertexAttribIPointer() hands it to the shader as it is instead of converting it to a float
+	glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(CubeInstance), (void*)offsetof(CubeInstance, materialID));
+	glEnableVertexAttribArray(6);
+}
+
+void Cube::requestTextureResolution(const glm::vec3* cubePositions, const unsigned int cubeCount) {
+	const Camera& cam = ResourceManager::giveCamera();
+	// With a lowered render resolution, lower resolution mip levels suffice as well
+	unsigned int renderWidth, renderHeight;
+	DynamicResolution::getRenderSize(renderWidth, renderHeight);
+
+	//* Estimate the on-screen size of the closest cube
+	// A face of our cube is 1 unit wide. At a distance d, the visible height of the scene is 2 * d * tan(fov / 2) units
+	// which is spread across all of the rendered rows
+	float closestDistance = -1.0f;
+	// The animated cubes aren't looked at one by one; the edge of the sphere around them is as close as any of them can be
+	if (animatedInstanceCount > 0) {
+		closestDistance = std::max(glm::length(glm::vec3(animatedBounds) - cam.cameraPosition) - animatedBounds.w, 0.0f);
+	}
+	for (unsigned int i = 0; i < cubeCount; i++) {
+		// Subtract half the cube's size since its closest face may be nearer than its center
+		float distance = glm::length(cubePositions[i] - cam.cameraPosition) - 0.5f;
+		if (closestDistance < 0.0f || distance < closestDistance) {
+			closestDistance = distance;
+		}
+	}
+	if (closestDistance < 0.0f) {
+		return;
+	}
+	// Don't go below the near plane
+	closestDistance = std::max(closestDistance, 0.1f);
+	float screenSize = renderHeight / (2.0f * closestDistance * std::tan(glm::radians(cam.fov) / 2.0f));
+
+	TextureStreamer::requestScreenSize(texture1ID, screenSize);
+	TextureStreamer::requestScreenSize(texture2ID, screenSize);
+}
+
+// Replaces the cubes that are animated on the GPU. Their parameters are uploaded once and never touched again by the CPU
+// The vertex shader builds their model matrices from the parameters and the frame's time (see Views::update())
+void Cube::setAnimatedInstances(const std::vector<AnimatedCubeInstance>& instances) {
+	// Nothing is drawn until the new cubes have arrived on the GPU
+	forgetResident(animatedVAO.getID());
+	UploadManager::cancelBufferUploads(animatedInstanceVBO.getID());
+	animatedInstanceCount = (unsigned int)instances.size();
+	if (instances.empty()) {
+		animatedVAO.reset();
+		animatedInstanceVBO.reset();
+		return;
+	}
+
+	//* A sphere around all cubes, which stands in for them in culling, shadows and texture streaming
+	glm::vec3 center(0.0f);
+	for (const AnimatedCubeInstance& instance : instances) {
+		center += instance.position;
+	}
+	center /= (float)instances.size();
+	float radius = 0.0f;
+	for (const AnimatedCubeInstance& instance : instances) {
+		radius = std::max(radius, glm::length(instance.position - center) + cubeBoundingRadius * instance.scale);
+	}
+	animatedBounds = glm::vec4(center, radius);
+
+	//* Set up the second VAO: the same vertices as the cube's own VAO, but different instance data
+	animatedVAO = GLVertexArray(GLMemoryCategory::Geometry, "Animated cubes");
+	glBindVertexArray(animatedVAO.getID());
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferID);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+
+	//* The instance buffer is static, so it is uploaded only once instead of every frame
+	// Position and speed as well as axis and phase are packed into a vec4 each (locations 7 and 8), the scale follows at location 9
+	// The model matrix at locations 2 to 5 isn't enabled in this VAO; these cubes are drawn with the shaders' ANIMATED variant,
+	// which reads the animation parameters instead, see renderAnimatedInstances()
+	animatedInstanceVBO = GLBuffer(GLMemoryCategory::Instances, "Animated cube instances");
+	glBindBuffer(GL_ARRAY_BUFFER, animatedInstanceVBO.getID());
+	glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(AnimatedCubeInstance), (void*)offsetof(AnimatedCubeInstance, materialID));
+	glEnableVertexAttribArray(6);
+	glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(AnimatedCubeInstance), (void*)offsetof(AnimatedCubeInstance, position));
+	glEnableVertexAttribArray(7);
+	glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(AnimatedCubeInstance), (void*)offsetof(AnimatedCubeInstance, rotationAxis));
+	glEnableVertexAttribArray(8);
+	glVertexAttribPointer(9, 1, GL_FLOAT, GL_FALSE, sizeof(AnimatedCubeInstance), (void*)offsetof(AnimatedCubeInstance, scale));
+	glEnableVertexAttribArray(9);
+	// Uploads complete in order, so once the instances have arrived, the cube's vertices have as well
+	UploadManager::uploadBuffer(animatedInstanceVBO.getID(), instances.data(), instances.size() * sizeof(AnimatedCubeInstance),
+		markResident(animatedVAO.getID()));
+}
+
+// Collects the model matrices of all cubes with the given mesh ID in the entity store and uploads them along with the cubes' materials
+// Should be called once per frame after the transforms have been updated, no matter how many views or passes draw the cubes
+void Cube::prepareInstances(const unsigned int meshID) {
+	//* The cubes are a contiguous range of the entity store's component arrays
+	unsigned int firstCube, cubeCount;
+	Entities::getMeshRange(meshID, firstCube, cubeCount);
+	const Transform* cubeTransforms = Entities::getTransforms() + firstCube;
+	const unsigned int* materialIDs = Entities::getMaterialIDs() + firstCube;
+
+	//* Vertices loaded in the background can be pointed to once they have arrived
+	// Binding their buffer in this context is also what makes the loader thread's upload visible to it
+	if (loadedInBackground && !isResident(VAO.getID()) && AssetLoader::isMeshResident(vertexBufferID, vertexCount)) {
+		initializeVertexAttributes();
+		residentVAOs.push_back(VAO.getID());
+	}
+
+	//* The model matrices translate the cubes to their positions in the world and rotate them
+	// They are the world matrices of the cubes' transforms, which Transforms::update() only recalculates for the cubes that moved
+	// Visible cubes come first in the instance buffer, so the views only draw those. Cubes no view can see still cast shadows
+	// into the views, so they are added to the end for the shadow maps; the bounding sphere of a cube reaches its corners
+	// They are only needed for this frame, so they are stored in the frame arena which doesn't cost a heap allocation
+	const float boundingRadius = cubeBoundingRadius;
+	CubeInstance* instances = FrameArena::allocateArray<CubeInstance>(cubeCount);
+	glm::vec3* cubePositions = FrameArena::allocateArray<glm::vec3>(cubeCount);
+	instanceCount = 0;
+	shadowCasterCount = cubeCount;
+	unsigned int invisibleIndex = shadowCasterCount;
+	// Until the cube can be drawn, its shadow maps are kept outdated so that it shows up in them as soon as it can
+	const bool drawable = isResident(VAO.getID());
+	for (unsigned int i = 0; i < cubeCount; i++) {
+		const glm::mat4& modelMatrix = Transforms::getWorldMatrix(cubeTransforms[i]);
+		cubePositions[i] = glm::vec3(modelMatrix[3]);
+		// The longest axis of the model matrix tells how much the cube is scaled, including the scale of its parents
+		const float radius = boundingRadius * std::max(glm::length(glm::vec3(modelMatrix[0])), std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+
+		CubeInstance& instance = Views::isVisible(cubePositions[i], radius) ? instances[instanceCount++] : instances[--invisibleIndex];
+		instance.modelMatrix = modelMatrix;
+		instance.materialID = materialIDs[i];
+
+		//* Shadow maps around cubes that moved have to be rendered again
+		if (Transforms::hasChanged(cubeTransforms[i]) || !drawable) {
+			CascadedShadows::markChanged(cubePositions[i], radius);
+		}
+	}
 
-	//* Rotate the cubes at different speeds
-	// We'll use quaternions for rotations as they save at least 50% computation time over Euler rotations
-	// Note, and this is very important: Quaternions do, in any case, need a normalized vector! Or else they will behave very weirdly
-	// Make the angle differ between cubes by using the given translation vector's x value for calculating
-	float angle = 20.0f * (cubePosition[0] + 1);
-	// glm::angleAxis creates a quaternion that stores a rotation
-	// First argument is the angle by which to rotate and second argument is the (normalized!) vector to be rotated around
-	// Since the given vector is no unit vector, it has to be normalized
-	glm::quat rotationQuaternion = glm::angleAxis((float)glfwGetTime() * glm::radians(angle), glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f)));
-	// We calculate a rotation matrix from the quaternion
-	glm::mat4 rotationMatrix = glm::toMat4(rotationQuaternion);
-	glm::mat4 modelMatrix = translationMatrix * rotationMatrix;
+	//* The animated cubes cost the same few operations per frame, no matter how many there are
+	// They are treated as a whole: drawn if any view sees the sphere around them, and their shadows are outdated while the time runs
+	if (animatedInstanceCount > 0) {
+		animatedInstancesVisible = Views::isVisible(glm::vec3(animatedBounds), animatedBounds.w);
+		if (Clock::getDeltaTime() != 0.0f || !isResident(animatedVAO.getID())) {
+			CascadedShadows::markChanged(glm::vec3(animatedBounds), animatedBounds.w);
+		}
+	}
 
-	// Update the model matrix
-	shader.setMat4("modelMatrix", modelMatrix);
+	//* Tell the texture streamer which resolution our textures need
+	// The asset loader always loads the full resolution
+	if (!loadedInBackground) {
+		requestTextureResolution(cubePositions, cubeCount);
+	}
 
-	// Theoretically, it would be possible to store the model matrices for each object locally and only recalculate it if the object is altered in any way
-	// However, in a typical video game scene (which has millions of vertices), this would consume tremendous amounts of RAM
-	// compared to storing only the object's coordinates
+	//* Copy them into the instance buffer
+	// Allocating the buffer anew (with nullptr) each frame lets the driver hand us fresh memory instead of waiting for the GPU
+	// to finish drawing with last frame's matrices ("orphaning")
+	instanceCapacity = std::max(instanceCapacity, shadowCasterCount);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.getID());
+	glBufferData(GL_ARRAY_BUFFER, std::max(instanceCapacity, 1u) * sizeof(CubeInstance), nullptr, GL_STREAM_DRAW);
+	instanceVBO.setSize(std::max(instanceCapacity, 1u) * sizeof(CubeInstance));
+	if (shadowCasterCount > 0) {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, shadowCasterCount * sizeof(CubeInstance), instances);
+	}
 }
 
-void Cube::renderMultiple(const Shader& shader, const std::vector<glm::vec3>& cubePositions) {
+// Binds the cube's textures for drawing, returns false if they haven't arrived on the GPU yet
+// Textures from the asset loader are replaced by its placeholder texture in the meantime instead
+bool Cube::bindTextures() {
+	if (!loadedInBackground && (!TextureStreamer::isResident(texture1ID) || !TextureStreamer::isResident(texture2ID))) {
+		return false;
+	}
+
 	//* Bind textures to their corresponding texture units
 	// Tells OpenGL which texture slot to use (there is a max of 16 texture slots to be used at once, GL_TEXTURE0 through GL_TEXTURE15)
 	glActiveTexture(GL_TEXTURE0);
 	// Tells OpenGL which texture to fill into the slot
 	// First argument is the texture type, second argument the texture's assigned ID
-	glBindTexture(GL_TEXTURE_2D, texture1ID);
+	glBindTexture(GL_TEXTURE_2D, loadedInBackground ? AssetLoader::getTexture(texture1ID) : texture1ID);
 	// Same for the second texture
 	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, texture2ID);
+	glBindTexture(GL_TEXTURE_2D, loadedInBackground ? AssetLoader::getTexture(texture2ID) : texture2ID);
+	return true;
+}
+
+// Draws the cubes prepared this frame into all views of the current pass with a single draw call
+void Cube::renderInstances(const unsigned int viewCount) {
+	// Skip drawing until both vertex data and textures have arrived on the GPU
+	if (instanceCount == 0 || !isResident(VAO.getID()) || !bindTextures()) {
+		return;
+	}
 
 	//* Prepare OpenGL for rendering our cube object
 	// Tells OpenGL that it is working with this rectangle's VAO
 	// Remember that all that OpenGL needs is an VAO; it contains the necessary pointers to VBOs
-	glBindVertexArray(VAO_ID);
-
-	//* Do the rendering 
-	// The previous steps had to be done only once because the VAO and textures used don't change when we re-use the same object multiple times
-	// No we use the same base cube object to render multiple different cubes scattered throughout the scene
-	for (unsigned int i = 0; i < cubePositions.size(); i++) {
-		//* Update the model matrix to translate the cube to another position in the world and rotate it
-		calculateModelMatrix(shader, cubePositions[i]);
-		
-		//* Draw the cube
-		// First argument is the type of object to draw, in this case triangles as our cube is still comprised of those
-		// The second one is the starting index of the array (so in this case 0)
-		// The third one is the amount of vertices of the object (a cube has two triangles with 3 vertices each per side, so 2 * 3 * 6 = 36)
-		glDrawArrays(GL_TRIANGLES, 0, 36);
+	glBindVertexArray(VAO.getID());
+
+	//* Every cube is drawn once per view
+	// The divisor tells OpenGL to move on to the next model matrix and material only every viewCount instances, so consecutive
+	// instances are the same cube in different views (the vertex shader picks the view from the instance number)
+	for (unsigned int attribute = firstInstanceAttribute; attribute < firstInstanceAttribute + instanceAttributeCount; attribute++) {
+		glVertexAttribDivisor(attribute, viewCount);
+	}
+
+	//* Do the rendering
+	// First argument is the type of object to draw, in this case triangles as our cube is still comprised of those
+	// The second one is the starting index of the array (so in this case 0)
+	// The third one is the amount of vertices of the object (a cube has two triangles with 3 vertices each per side, so 2 * 3 * 6 = 36)
+	// The 4th one is the number of instances to draw
+	glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount * viewCount);
+}
+
+// Draws the cubes that are animated on the GPU the same way; expects the ANIMATED variant of the cube shader to be in use
+void Cube::renderAnimatedInstances(const unsigned int viewCount) {
+	if (!animatedInstancesVisible || !isResident(VAO.getID()) || !isResident(animatedVAO.getID()) || !bindTextures()) {
+		return;
+	}
+	glBindVertexArray(animatedVAO.getID());
+	for (unsigned int attribute = firstAnimatedAttribute; attribute < firstAnimatedAttribute + animatedAttributeCount; attribute++) {
+		glVertexAttribDivisor(attribute, viewCount);
+	}
+	glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, animatedInstanceCount * viewCount);
+}
+
+// Draws the depth of all cubes prepared this frame, visible or not, into the shadow map that is being rendered
+void Cube::renderShadowCasters() {
+	// Textures aren't needed for the depth, only the vertex data
+	if (shadowCasterCount == 0 || !isResident(VAO.getID())) {
+		return;
 	}
+	// Every cube is drawn once
+	glBindVertexArray(VAO.getID());
+	for (unsigned int attribute = firstInstanceAttribute; attribute < firstInstanceAttribute + instanceAttributeCount; attribute++) {
+		glVertexAttribDivisor(attribute, 1);
+	}
+	glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, shadowCasterCount);
+}
+
+// Same for the cubes that are animated on the GPU; expects the ANIMATED variant of the shadow depth shader to be in use
+void Cube::renderAnimatedShadowCasters() {
+	if (!isResident(VAO.getID()) || !isResident(animatedVAO.getID())) {
+		return;
+	}
+	glBindVertexArray(animatedVAO.getID());
+	for (unsigned int attribute = firstAnimatedAttribute; attribute < firstAnimatedAttribute + animatedAttributeCount; attribute++) {
+		glVertexAttribDivisor(attribute, 1);
+	}
+	glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, animatedInstanceCount);
 }
 
 Plane::Plane() {
 	initializeVAO();
 }
 
+Plane::~Plane() {
+	forgetResident(VAO.getID());
+	UploadManager::cancelBufferUploads(VBO.getID());
+	UploadManager::cancelBufferUploads(EBO.getID());
+}
+
 void Plane::initializeVAO() {
 	std::vector<float> vertices = {
 		// positions; note that we have to use four coordinates x, y, z, w to simulate infinity
@@ -424,7 +680,7 @@ void Plane::initializeVAO() {
 		0, 4, 1,
 	};
 
-	create_VAO_VBO_EBO(vertices, indices, VAO_ID);
+	create_VAO_VBO_EBO(vertices, indices, VAO, VBO, EBO, "Plane");
 
 	//* Tell OpenGL how our vertex data is organised
 	// First argument is the location where the specified set of data is stored in the vertex shaders
@@ -444,18 +700,24 @@ void Plane::initializeVAO() {
 	glEnableVertexAttribArray(0);
 }
 
-void Plane::render() {
+void Plane::render(const unsigned int viewCount) {
+	// Skip drawing until the vertex data has arrived on the GPU
+	if (!isResident(VAO.getID())) {
+		return;
+	}
+
 	//* Do the rendering
 	// Tells OpenGL that it is working with this rectangle's VAO
 	// Remember that all that OpenGL needs is an VAO; it contains the necessary pointers to both VBOs and EBOs
-	glBindVertexArray(VAO_ID);
-	// Draw the rectangle; glDrawElements is used here because it uses EBOs stored in the VAO
+	glBindVertexArray(VAO.getID());
+	// Draw the plane; glDrawElementsInstanced is the instanced version of glDrawElements which uses EBOs stored in the VAO
 	// -> used for objects comprised of overlapping vertices that are specified with indices
-	// First argument is the type of object to draw (in thise case still GL_TRIANGLES as our rectangle is comprised of two triangles)
-	// Second argument is the number of indices we want to draw, so in this case 6 
+	// First argument is the type of object to draw (in thise case still GL_TRIANGLES as our plane is comprised of four triangles)
+	// Second argument is the number of indices we want to draw, so in this case 12
 	// Third argument is the data type of the indices
 	// 4th argument can be used to specify an offset for the EBO; since our data starts at 0 in the EBO, we can leave it at that
-	glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0);
+	// 5th argument is the number of instances, one per view of the current pass
+	glDrawElementsInstanced(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0, viewCount);
 }
 
 void Render::initialize(GLFWwindow& window) {
@@ -482,20 +744,4 @@ void Render::initialize(GLFWwindow& window) {
 void Render::clearWindow() {
 	// Clears both the color buffer and the depth buffer so that the values of the previous frame get discarded
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-}
-
-void Render::updateBlendValue(const Shader& shader, const float delta) {
-	blendValue += delta;
-	// Blend values <0 or >1 don't make much sense, so prevent them from happening
-	if (blendValue > 1.0f) {
-		blendValue = 1.0f;
-	}
-	else if (blendValue < 0.0f) {
-		blendValue = 0.0f;
-	}
-
-	//* Send the updated value to the shader
-	// Don't forget to activate a shader before setting uniforms
-	shader.use();
-	shader.setFloat("blendValue", blendValue);
 }
\ No newline at end of file
@@ -0,0 +1,773 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "renderGraph.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+enum class GraphResourceKind {
+	RenderTarget,
+	Buffer,
+	ImportedRenderTarget,	// Rendered into through a framebuffer that lives outside of the graph, e.g. the window's (0)
+	Imported,				// Only orders the passes; the passes access it on their own
+};
+
+struct GraphResource {
+	const char* name;
+	GraphResourceKind kind;
+	RenderTargetDescription description;	// Render targets only
+	size_t bytes;							// Buffers only
+	unsigned int framebufferID;				// Imported render targets only
+	bool used;								// Whether a pass that wasn't culled uses it
+	unsigned int firstUse, lastUse;			// First and last position in the compiled order of a pass that uses it
+	int physicalIndex;						// Texture or buffer that backs a transient resource, -1 if there is none
+};
+
+struct GraphPass {
+	const char* name;
+	void (*execute)(void* data);
+	void* data;
+	std::vector<RenderGraphResource> reads, writes;
+	// Written as well; they make up the pass' framebuffer, color attachments in the order they were added
+	std::vector<RenderGraphResource> attachments;
+	bool culled;
+	int framebufferIndex;	// -1 if the pass has no attachments and renders wherever it wants
+};
+
+// A texture or buffer that backs one or more transient resources whose lifetimes don't overlap
+struct PhysicalResource {
+	GraphResourceKind kind;
+	RenderTargetDescription description;
+	size_t bytes;
+	unsigned int freeAfter;		// Last position in the compiled order that uses it
+	unsigned int width, height;	// Size the texture is allocated in
+	GLTexture texture;
+	GLBuffer buffer;
+};
+
+struct GraphFramebuffer {
+	const char* passName;		// First pass that renders into it, for error messages
+	std::vector<RenderGraphResource> attachments;
+	bool imported;
+	unsigned int importedFramebufferID;
+	GLFramebuffer framebuffer;
+};
+
+std::vector<GraphResource> graphResources;
+std::vector<GraphPass> graphPasses;
+// Passes that weren't culled, in the order they run
+std::vector<unsigned int> graphOrder;
+std::vector<PhysicalResource> physicalResources;
+std::vector<GraphFramebuffer> graphFramebuffers;
+unsigned int referenceWidth = 1, referenceHeight = 1;
+// Set whenever the textures and buffers have to be (re)allocated before the next execute()
+bool physicalResourcesOutdated = true;
+// Number of times the framebuffer changes in a frame, in the compiled order and in the order the passes were added
+unsigned int compiledFramebufferChanges = 0, declaredFramebufferChanges = 0;
+
+bool isDepthStencilFormat(const unsigned int internalFormat) {
+	return internalFormat == GL_DEPTH24_STENCIL8 || internalFormat == GL_DEPTH32F_STENCIL8;
+}
+
+bool isDepthFormat(const unsigned int internalFormat) {
+	return isDepthStencilFormat(internalFormat) || internalFormat == GL_DEPTH_COMPONENT16 ||
+		internalFormat == GL_DEPTH_COMPONENT24 || internalFormat == GL_DEPTH_COMPONENT32F;
+}
+
+unsigned int getBytesPerPixel(const unsigned int internalFormat) {
+	switch (internalFormat) {
+	case GL_R8:
+		return 1;
+	case GL_RG8:
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16:
+		return 2;
+	case GL_RGBA8:
+	case GL_RGB10_A2:
+	case GL_R11F_G11F_B10F:
+	case GL_RG16F:
+	case GL_R32F:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32F:
+	case GL_DEPTH24_STENCIL8:
+		return 4;
+	case GL_RGBA16F:
+	case GL_RG32F:
+	case GL_DEPTH32F_STENCIL8:
+		return 8;
+	case GL_RGBA32F:
+		return 16;
+	default:
+		std::cout << "Error: Render graph doesn't know the size of format " << internalFormat << ", assuming 4 bytes per pixel" << std::endl;
+		return 4;
+	}
+}
+
+void calculateTargetSize(const RenderTargetDescription& description, unsigned int& width, unsigned int& height) {
+	width = std::max(1u, (unsigned int)std::ceil(referenceWidth * description.scale));
+	height = std::max(1u, (unsigned int)std::ceil(referenceHeight * description.scale));
+}
+
+size_t calculateTargetBytes(const RenderTargetDescription& description) {
+	unsigned int width, height;
+	calculateTargetSize(description, width, height);
+	return (size_t)width * height * getBytesPerPixel(description.internalFormat);
+}
+
+size_t calculatePhysicalBytes(const PhysicalResource& physical) {
+	return physical.kind == GraphResourceKind::RenderTarget ? calculateTargetBytes(physical.description) : physical.bytes;
+}
+
+bool isTransient(const GraphResource& resource) {
+	return resource.kind == GraphResourceKind::RenderTarget || resource.kind == GraphResourceKind::Buffer;
+}
+
+// Counts how often the framebuffer changes when the passes run in the given order
+unsigned int countFramebufferChanges(const std::vector<unsigned int>& order, const std::vector<int>& passFramebuffers) {
+	unsigned int changes = 0;
+	int currentFramebuffer = -1;
+	for (unsigned int i = 0; i < order.size(); i++) {
+		const int framebuffer = passFramebuffers[order[i]];
+		if (framebuffer >= 0 && framebuffer != currentFramebuffer) {
+			changes++;
+			currentFramebuffer = framebuffer;
+		}
+	}
+	return changes;
+}
+
+// Whether two passes can render without switching framebuffers in between, which is the case if their attachments are backed by the same textures
+bool haveSameFramebuffer(const std::vector<RenderGraphResource>& attachments, const GraphFramebuffer& framebuffer) {
+	if (attachments.size() != framebuffer.attachments.size()) {
+		return false;
+	}
+	for (unsigned int i = 0; i < attachments.size(); i++) {
+		const GraphResource& resource = graphResources[attachments[i]];
+		const GraphResource& other = graphResources[framebuffer.attachments[i]];
+		if (resource.kind != other.kind) {
+			return false;
+		}
+		if (resource.kind == GraphResourceKind::ImportedRenderTarget ? resource.framebufferID != other.framebufferID : resource.physicalIndex != other.physicalIndex) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//* Compiling
+// A pass is culled if nothing uses what it writes. Imported resources are always used, so going backwards from them
+// every pass whose output is read by a pass that is kept (or that writes an imported resource) is kept as well
+void cullPasses() {
+	std::vector<bool> resourceNeeded(graphResources.size(), false);
+	for (unsigned int r = 0; r < graphResources.size(); r++) {
+		resourceNeeded[r] = !isTransient(graphResources[r]);
+	}
+	for (int p = (int)graphPasses.size() - 1; p >= 0; p--) {
+		GraphPass& pass = graphPasses[p];
+		bool needed = false;
+		for (unsigned int i = 0; i < pass.writes.size(); i++) {
+			needed = needed || resourceNeeded[pass.writes[i]];
+		}
+		for (unsigned int i = 0; i < pass.attachments.size(); i++) {
+			needed = needed || resourceNeeded[pass.attachments[i]];
+		}
+		pass.culled = !needed;
+		if (needed) {
+			for (unsigned int i = 0; i < pass.reads.size(); i++) {
+				resourceNeeded[pass.reads[i]] = true;
+			}
+		}
+	}
+}
+
+// Passes run in any order that keeps what they read and write in the order they were added: a pass that reads a resource comes after
+// the pass that wrote it last, and a pass that writes a resource comes after the passes that used it before
+// Among the passes whose dependencies are done, the next one is preferably one that doesn't need another framebuffer
+void orderPasses(const std::vector<int>& passFramebuffers) {
+	const unsigned int passCount = (unsigned int)graphPasses.size();
+	std::vector<std::vector<unsigned int>> successors(passCount);
+	std::vector<unsigned int> dependencyCounts(passCount, 0);
+	std::vector<int> lastWriters(graphResources.size(), -1);
+	std::vector<std::vector<unsigned int>> readersSinceWrite(graphResources.size());
+	auto addDependency = [&](const unsigned int before, const unsigned int after) {
+		if (before == after || std::find(successors[before].begin(), successors[before].end(), after) != successors[before].end()) {
+			return;
+		}
+		successors[before].push_back(after);
+		dependencyCounts[after]++;
+	};
+	auto addWrite = [&](const unsigned int pass, const RenderGraphResource resource) {
+		if (lastWriters[resource] >= 0) {
+			addDependency(lastWriters[resource], pass);
+		}
+		for (unsigned int i = 0; i < readersSinceWrite[resource].size(); i++) {
+			addDependency(readersSinceWrite[resource][i], pass);
+		}
+		lastWriters[resource] = pass;
+		readersSinceWrite[resource].clear();
+	};
+	for (unsigned int p = 0; p < passCount; p++) {
+		const GraphPass& pass = graphPasses[p];
+		if (pass.culled) {
+			continue;
+		}
+		for (unsigned int i = 0; i < pass.reads.size(); i++) {
+			if (lastWriters[pass.reads[i]] >= 0) {
+				addDependency(lastWriters[pass.reads[i]], p);
+			}
+			readersSinceWrite[pass.reads[i]].push_back(p);
+		}
+		for (unsigned int i = 0; i < pass.writes.size(); i++) {
+			addWrite(p, pass.writes[i]);
+		}
+		for (unsigned int i = 0; i < pass.attachments.size(); i++) {
+			addWrite(p, pass.attachments[i]);
+		}
+	}
+
+	//* Pick the passes one by one
+	// Ready passes are kept in the order they were added, which is the order used whenever the framebuffer has to change anyway
+	std::vector<unsigned int> readyPasses;
+	for (unsigned int p = 0; p < passCount; p++) {
+		if (!graphPasses[p].culled && dependencyCounts[p] == 0) {
+			readyPasses.push_back(p);
+		}
+	}
+	graphOrder.clear();
+	int currentFramebuffer = -1;
+	while (!readyPasses.empty()) {
+		unsigned int chosen = 0;
+		for (unsigned int i = 0; i < readyPasses.size(); i++) {
+			const int framebuffer = passFramebuffers[readyPasses[i]];
+			if (framebuffer < 0 || framebuffer == currentFramebuffer) {
+				chosen = i;
+				break;
+			}
+		}
+		const unsigned int pass = readyPasses[chosen];
+		readyPasses.erase(readyPasses.begin() + chosen);
+		graphOrder.push_back(pass);
+		if (passFramebuffers[pass] >= 0) {
+			currentFramebuffer = passFramebuffers[pass];
+		}
+		for (unsigned int i = 0; i < successors[pass].size(); i++) {
+			const unsigned int successor = successors[pass][i];
+			if (--dependencyCounts[successor] == 0) {
+				readyPasses.insert(std::lower_bound(readyPasses.begin(), readyPasses.end(), successor), successor);
+			}
+		}
+	}
+}
+
+// Transient resources are backed by the first texture or buffer that is free by the time they are first used
+// Render targets need one with the same format and size; buffers can use any buffer, which then grows to the largest size it backs
+void assignPhysicalResources() {
+	for (unsigned int r = 0; r < graphResources.size(); r++) {
+		graphResources[r].used = false;
+		graphResources[r].physicalIndex = -1;
+	}
+	for (unsigned int position = 0; position < graphOrder.size(); position++) {
+		const GraphPass& pass = graphPasses[graphOrder[position]];
+		const std::vector<RenderGraphResource>* accessLists[3] = { &pass.reads, &pass.writes, &pass.attachments };
+		for (unsigned int list = 0; list < 3; list++) {
+			for (unsigned int i = 0; i < accessLists[list]->size(); i++) {
+				GraphResource& resource = graphResources[(*accessLists[list])[i]];
+				if (!resource.used) {
+					resource.used = true;
+					resource.firstUse = position;
+				}
+				resource.lastUse = position;
+			}
+		}
+	}
+
+	std::vector<unsigned int> transientResources;
+	for (unsigned int r = 0; r < graphResources.size(); r++) {
+		if (graphResources[r].used && isTransient(graphResources[r])) {
+			transientResources.push_back(r);
+		}
+	}
+	std::stable_sort(transientResources.begin(), transientResources.end(), [](const unsigned int a, const unsigned int b) {
+		return graphResources[a].firstUse < graphResources[b].firstUse;
+	});
+
+	physicalResources.clear();
+	for (unsigned int i = 0; i < transientResources.size(); i++) {
+		GraphResource& resource = graphResources[transientResources[i]];
+		int chosen = -1;
+		for (unsigned int p = 0; p < physicalResources.size() && chosen < 0; p++) {
+			const PhysicalResource& physical = physicalResources[p];
+			if (physical.kind != resource.kind || physical.freeAfter >= resource.firstUse) {
+				continue;
+			}
+			if (resource.kind == GraphResourceKind::Buffer ||
+				(physical.description.internalFormat == resource.description.internalFormat && physical.description.scale == resource.description.scale)) {
+				chosen = (int)p;
+			}
+		}
+		if (chosen < 0) {
+			physicalResources.emplace_back();
+			PhysicalResource& physical = physicalResources.back();
+			physical.kind = resource.kind;
+			physical.description = resource.description;
+			physical.bytes = 0;
+			physical.width = physical.height = 0;
+			chosen = (int)physicalResources.size() - 1;
+		}
+		PhysicalResource& physical = physicalResources[chosen];
+		physical.freeAfter = resource.lastUse;
+		physical.bytes = std::max(physical.bytes, resource.bytes);
+		resource.physicalIndex = chosen;
+	}
+}
+
+// Passes whose attachments are backed by the same textures share a framebuffer
+void assignFramebuffers() {
+	graphFramebuffers.clear();
+	for (unsigned int p = 0; p < graphPasses.size(); p++) {
+		GraphPass& pass = graphPasses[p];
+		pass.framebufferIndex = -1;
+		if (pass.culled || pass.attachments.empty()) {
+			continue;
+		}
+		for (unsigned int f = 0; f < graphFramebuffers.size() && pass.framebufferIndex < 0; f++) {
+			if (haveSameFramebuffer(pass.attachments, graphFramebuffers[f])) {
+				pass.framebufferIndex = (int)f;
+			}
+		}
+		if (pass.framebufferIndex >= 0) {
+			continue;
+		}
+		graphFramebuffers.emplace_back();
+		GraphFramebuffer& framebuffer = graphFramebuffers.back();
+		framebuffer.passName = pass.name;
+		framebuffer.attachments = pass.attachments;
+		const GraphResource& firstAttachment = graphResources[pass.attachments[0]];
+		framebuffer.imported = firstAttachment.kind == GraphResourceKind::ImportedRenderTarget;
+		framebuffer.importedFramebufferID = firstAttachment.framebufferID;
+		if (framebuffer.imported && pass.attachments.size() > 1) {
+			std::cout << "Error: Pass " << pass.name << " renders into an imported render target, which can't be combined with other attachments" << std::endl;
+		}
+		pass.framebufferIndex = (int)graphFramebuffers.size() - 1;
+	}
+}
+
+//* Executing
+void allocatePhysicalResources() {
+	for (unsigned int p = 0; p < physicalResources.size(); p++) {
+		PhysicalResource& physical = physicalResources[p];
+		if (physical.kind == GraphResourceKind::Buffer) {
+			if (physical.buffer.getID() == 0) {
+				physical.buffer = GLBuffer(GLMemoryCategory::RenderTargets, "Render graph buffer");
+				// GL_COPY_WRITE_BUFFER isn't used for anything else, so binding the buffer there doesn't disturb any other state
+				glBindBuffer(GL_COPY_WRITE_BUFFER, physical.buffer.getID());
+				glBufferData(GL_COPY_WRITE_BUFFER, physical.bytes, nullptr, GL_DYNAMIC_COPY);
+				physical.buffer.setSize(physical.bytes);
+			}
+			continue;
+		}
+
+		unsigned int width, height;
+		calculateTargetSize(physical.description, width, height);
+		if (physical.texture.getID() != 0 && width == physical.width && height == physical.height) {
+			continue;
+		}
+		if (physical.texture.getID() == 0) {
+			physical.texture = GLTexture(GLMemoryCategory::RenderTargets, "Render graph target");
+		}
+		physical.width = width;
+		physical.height = height;
+
+		//* The pixel format only describes the (absent) initial data, but it still has to fit the internal format
+		const unsigned int internalFormat = physical.description.internalFormat;
+		unsigned int pixelFormat = GL_RGBA, pixelType = GL_FLOAT;
+		if (internalFormat == GL_DEPTH24_STENCIL8) {
+			pixelFormat = GL_DEPTH_STENCIL;
+			pixelType = GL_UNSIGNED_INT_24_8;
+		}
+		else if (internalFormat == GL_DEPTH32F_STENCIL8) {
+			pixelFormat = GL_DEPTH_STENCIL;
+			pixelType = GL_FLOAT_32_UNSIGNED_INT_24_8_REV;
+		}
+		else if (isDepthFormat(internalFormat)) {
+			pixelFormat = GL_DEPTH_COMPONENT;
+		}
+		glBindTexture(GL_TEXTURE_2D, physical.texture.getID());
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, pixelFormat, pixelType, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		physical.texture.setSize(calculatePhysicalBytes(physical));
+	}
+
+	//* Attach the textures to the framebuffers
+	// Reallocating a texture keeps it attached, but attaching everything again is cheap and keeps this simple
+	for (unsigned int f = 0; f < graphFramebuffers.size(); f++) {
+		GraphFramebuffer& framebuffer = graphFramebuffers[f];
+		if (framebuffer.imported) {
+			continue;
+		}
+		if (framebuffer.framebuffer.getID() == 0) {
+			framebuffer.framebuffer = GLFramebuffer(GLMemoryCategory::RenderTargets, "Render graph framebuffer");
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.framebuffer.getID());
+		GLenum drawBuffers[8];
+		unsigned int colorCount = 0;
+		for (unsigned int i = 0; i < framebuffer.attachments.size(); i++) {
+			const GraphResource& resource = graphResources[framebuffer.attachments[i]];
+			const unsigned int textureID = physicalResources[resource.physicalIndex].texture.getID();
+			if (isDepthStencilFormat(resource.description.internalFormat)) {
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, textureID, 0);
+			}
+			else if (isDepthFormat(resource.description.internalFormat)) {
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textureID, 0);
+			}
+			else if (colorCount < 8) {
+				glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + colorCount, GL_TEXTURE_2D, textureID, 0);
+				drawBuffers[colorCount] = GL_COLOR_ATTACHMENT0 + colorCount;
+				colorCount++;
+			}
+		}
+		// A framebuffer with only a depth attachment has nothing to draw the color to
+		if (colorCount > 0) {
+			glDrawBuffers(colorCount, drawBuffers);
+			glReadBuffer(GL_COLOR_ATTACHMENT0);
+		}
+		else {
+			glDrawBuffer(GL_NONE);
+			glReadBuffer(GL_NONE);
+		}
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			std::cout << "Error: Render graph framebuffer of pass " << framebuffer.passName << " is incomplete" << std::endl;
+		}
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	physicalResourcesOutdated = false;
+}
+
+//** Public **//
+// Removes all passes and resources, e.g. to build the graph anew
+void RenderGraph::clear() {
+	graphResources.clear();
+	graphPasses.clear();
+	graphOrder.clear();
+	physicalResources.clear();
+	graphFramebuffers.clear();
+	physicalResourcesOutdated = true;
+	compiledFramebufferChanges = declaredFramebufferChanges = 0;
+}
+
+// The name has to outlive the graph (e.g. a string literal)
+RenderGraphResource RenderGraph::createRenderTarget(const char* name, const RenderTargetDescription& description) {
+	GraphResource resource = {};
+	resource.name = name;
+	resource.kind = GraphResourceKind::RenderTarget;
+	resource.description = description;
+	resource.physicalIndex = -1;
+	graphResources.push_back(resource);
+	return (RenderGraphResource)graphResources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::createBuffer(const char* name, const size_t bytes) {
+	GraphResource resource = {};
+	resource.name = name;
+	resource.kind = GraphResourceKind::Buffer;
+	resource.bytes = bytes;
+	resource.physicalIndex = -1;
+	graphResources.push_back(resource);
+	return (RenderGraphResource)graphResources.size() - 1;
+}
+
+// A render target owned by someone else that passes render into through the given framebuffer, e.g. the window (framebuffer 0)
+RenderGraphResource RenderGraph::importRenderTarget(const char* name, const unsigned int framebufferID) {
+	GraphResource resource = {};
+	resource.name = name;
+	resource.kind = GraphResourceKind::ImportedRenderTarget;
+	resource.framebufferID = framebufferID;
+	resource.physicalIndex = -1;
+	graphResources.push_back(resource);
+	return (RenderGraphResource)graphResources.size() - 1;
+}
+
+// Anything owned by someone else that passes read or write on their own, e.g. the shadow maps. Only used to order the passes
+RenderGraphResource RenderGraph::importResource(const char* name) {
+	GraphResource resource = {};
+	resource.name = name;
+	resource.kind = GraphResourceKind::Imported;
+	resource.physicalIndex = -1;
+	graphResources.push_back(resource);
+	return (RenderGraphResource)graphResources.size() - 1;
+}
+
+// execute is called with data every frame the pass runs, with the pass' framebuffer bound if it has attachments
+RenderGraphPass RenderGraph::addPass(const char* name, void (*execute)(void* data), void* data) {
+	GraphPass pass;
+	pass.name = name;
+	pass.execute = execute;
+	pass.data = data;
+	pass.culled = false;
+	pass.framebufferIndex = -1;
+	graphPasses.push_back(std::move(pass));
+	return (RenderGraphPass)graphPasses.size() - 1;
+}
+
+void RenderGraph::read(const RenderGraphPass pass, const RenderGraphResource resource) {
+	graphPasses[pass].reads.push_back(resource);
+}
+
+// For resources the pass writes on its own, e.g. buffers or textures rendered into through a framebuffer of its own
+void RenderGraph::write(const RenderGraphPass pass, const RenderGraphResource resource) {
+	graphPasses[pass].writes.push_back(resource);
+}
+
+// For render targets the pass renders into; the graph binds them as the pass' framebuffer before it runs
+void RenderGraph::writeAttachment(const RenderGraphPass pass, const RenderGraphResource resource) {
+	const GraphResourceKind kind = graphResources[resource].kind;
+	if (kind != GraphResourceKind::RenderTarget && kind != GraphResourceKind::ImportedRenderTarget) {
+		std::cout << "Error: " << graphResources[resource].name << " is not a render target and can't be attached to pass " << graphPasses[pass].name << std::endl;
+		return;
+	}
+	graphPasses[pass].attachments.push_back(resource);
+}
+
+// Culls and orders the passes and assigns textures and buffers to the transient resources. Has to be called after the graph changed
+void RenderGraph::compile() {
+	cullPasses();
+
+	//* Passes with the same attachments render into the same framebuffer
+	// Which textures back the attachments is only known after ordering, so the passes are ordered by their attachments
+	std::vector<int> passFramebuffers(graphPasses.size(), -1);
+	std::vector<unsigned int> attachmentOwners;
+	for (unsigned int p = 0; p < graphPasses.size(); p++) {
+		if (graphPasses[p].culled || graphPasses[p].attachments.empty()) {
+			continue;
+		}
+		for (unsigned int i = 0; i < attachmentOwners.size() && passFramebuffers[p] < 0; i++) {
+			if (graphPasses[attachmentOwners[i]].attachments == graphPasses[p].attachments) {
+				passFramebuffers[p] = (int)i;
+			}
+		}
+		if (passFramebuffers[p] < 0) {
+			passFramebuffers[p] = (int)attachmentOwners.size();
+			attachmentOwners.push_back(p);
+		}
+	}
+	orderPasses(passFramebuffers);
+
+	std::vector<unsigned int> declaredOrder;
+	for (unsigned int p = 0; p < graphPasses.size(); p++) {
+		if (!graphPasses[p].culled) {
+			declaredOrder.push_back(p);
+		}
+	}
+	compiledFramebufferChanges = countFramebufferChanges(graphOrder, passFramebuffers);
+	declaredFramebufferChanges = countFramebufferChanges(declaredOrder, passFramebuffers);
+
+	assignPhysicalResources();
+	assignFramebuffers();
+	physicalResourcesOutdated = true;
+}
+
+// Size that the render targets' scales refer to, usually the window's framebuffer size. Render targets are reallocated if it changes
+void RenderGraph::setReferenceSize(const unsigned int width, const unsigned int height) {
+	if (width != referenceWidth || height != referenceHeight) {
+		referenceWidth = width;
+		referenceHeight = height;
+		physicalResourcesOutdated = true;
+	}
+}
+
+// Runs the passes that weren't culled in the compiled order
+void RenderGraph::execute() {
+	if (physicalResourcesOutdated) {
+		allocatePhysicalResources();
+	}
+	for (unsigned int i = 0; i < graphOrder.size(); i++) {
+		const GraphPass& pass = graphPasses[graphOrder[i]];
+		if (pass.framebufferIndex >= 0) {
+			const GraphFramebuffer& framebuffer = graphFramebuffers[pass.framebufferIndex];
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.imported ? framebuffer.importedFramebufferID : framebuffer.framebuffer.getID());
+		}
+		pass.execute(pass.data);
+	}
+}
+
+// Texture that backs a transient render target this frame, 0 if it was culled. Other transient render targets may use it at other times
+unsigned int RenderGraph::getTexture(const RenderGraphResource resource) {
+	const GraphResource& graphResource = graphResources[resource];
+	if (graphResource.kind != GraphResourceKind::RenderTarget || graphResource.physicalIndex < 0) {
+		return 0;
+	}
+	return physicalResources[graphResource.physicalIndex].texture.getID();
+}
+
+// Buffer that backs a transient buffer this frame, 0 if it was culled. It may be larger than requested if it is shared
+unsigned int RenderGraph::getBuffer(const RenderGraphResource resource) {
+	const GraphResource& graphResource = graphResources[resource];
+	if (graphResource.kind != GraphResourceKind::Buffer || graphResource.physicalIndex < 0) {
+		return 0;
+	}
+	return physicalResources[graphResource.physicalIndex].buffer.getID();
+}
+
+void RenderGraph::getSize(const RenderGraphResource resource, unsigned int& width, unsigned int& height) {
+	width = height = 0;
+	if (graphResources[resource].kind == GraphResourceKind::RenderTarget) {
+		calculateTargetSize(graphResources[resource].description, width, height);
+	}
+}
+
+// Deletes all textures, buffers and framebuffers of the graph. Has to be called while the OpenGL context still exists
+void RenderGraph::shutdown() {
+	clear();
+}
+
+// Prints which passes were culled, the order they run in and how much memory the transient resources take with and without sharing
+void RenderGraph::printReport() {
+	unsigned int culledCount = 0;
+	for (unsigned int p = 0; p < graphPasses.size(); p++) {
+		culledCount += graphPasses[p].culled ? 1 : 0;
+	}
+	std::cout << "Render graph: " << graphPasses.size() << " passes, " << culledCount << " culled" << std::endl;
+	for (unsigned int p = 0; p < graphPasses.size(); p++) {
+		if (graphPasses[p].culled) {
+			std::cout << "  Culled: " << graphPasses[p].name << std::endl;
+		}
+	}
+	std::cout << "  Order: ";
+	for (unsigned int i = 0; i < graphOrder.size(); i++) {
+		std::cout << (i > 0 ? ", " : "") << graphPasses[graphOrder[i]].name;
+	}
+	std::cout << std::endl;
+	std::cout << "  Framebuffer changes: " << compiledFramebufferChanges << " (" << declaredFramebufferChanges << " in the order the passes were added)" << std::endl;
+
+	//* Without aliasing, every transient resource needs memory of its own for the whole frame
+	size_t bytesWithoutAliasing = 0, bytesWithAliasing = 0;
+	unsigned int transientCount = 0;
+	for (unsigned int r = 0; r < graphResources.size(); r++) {
+		const GraphResource& resource = graphResources[r];
+		if (resource.physicalIndex >= 0) {
+			bytesWithoutAliasing += resource.kind == GraphResourceKind::RenderTarget ? calculateTargetBytes(resource.description) : resource.bytes;
+			transientCount++;
+		}
+	}
+	for (unsigned int p = 0; p < physicalResources.size(); p++) {
+		bytesWithAliasing += calculatePhysicalBytes(physicalResources[p]);
+	}
+	const double megabyte = 1024.0 * 1024.0;
+	std::cout << "  Peak transient memory at " << referenceWidth << "x" << referenceHeight << ": " << bytesWithoutAliasing / megabyte
+		<< " MB without aliasing, " << bytesWithAliasing / megabyte << " MB with aliasing (" << transientCount << " resources in "
+		<< physicalResources.size() << " textures and buffers)" << std::endl;
+	for (unsigned int p = 0; p < physicalResources.size(); p++) {
+		unsigned int sharingCount = 0;
+		for (unsigned int r = 0; r < graphResources.size(); r++) {
+			sharingCount += graphResources[r].physicalIndex == (int)p ? 1 : 0;
+		}
+		if (sharingCount < 2) {
+			continue;
+		}
+		std::cout << "  Shared:";
+		for (unsigned int r = 0; r < graphResources.size(); r++) {
+			if (graphResources[r].physicalIndex == (int)p) {
+				std::cout << " " << graphResources[r].name << ";";
+			}
+		}
+		std::cout << std::endl;
+	}
+}
+
+void RenderGraph::printExampleReport() {
+	clear();
+	setReferenceSize(1920, 1080);
+	// The passes of the example only exist to be compiled, so they do nothing
+	void (*const executeExamplePass)(void*) = [](void*) {};
+
+	//* Resources of a deferred renderer with ambient occlusion, depth of field, bloom and a UI
+	const RenderGraphResource window = importRenderTarget("Window", 0);
+	const RenderGraphResource shadowMaps = importResource("Shadow maps");
+	const RenderGraphResource albedo = createRenderTarget("G-buffer albedo", { GL_RGBA8, 1.0f });
+	const RenderGraphResource normals = createRenderTarget("G-buffer normals", { GL_RGBA16F, 1.0f });
+	const RenderGraphResource depth = createRenderTarget("Depth", { GL_DEPTH24_STENCIL8, 1.0f });
+	const RenderGraphResource ui = createRenderTarget("UI", { GL_RGBA8, 1.0f });
+	const RenderGraphResource ambientOcclusion = createRenderTarget("Ambient occlusion", { GL_R8, 0.5f });
+	const RenderGraphResource blurredAmbientOcclusion = createRenderTarget("Blurred ambient occlusion", { GL_R8, 0.5f });
+	// One list of up to 64 light indices per 16x16 pixel tile
+	const RenderGraphResource lightList = createBuffer("Light list", (1920 / 16) * (1080 / 16 + 1) * 64 * sizeof(unsigned int));
+	const RenderGraphResource hdrColor = createRenderTarget("HDR color", { GL_RGBA16F, 1.0f });
+	const RenderGraphResource depthOfField = createRenderTarget("Depth of field", { GL_RGBA16F, 1.0f });
+	const RenderGraphResource debugNormals = createRenderTarget("Debug normals", { GL_RGBA8, 1.0f });
+	const RenderGraphResource bloom = createRenderTarget("Bloom", { GL_RGBA16F, 0.5f });
+	const RenderGraphResource bloomHorizontal = createRenderTarget("Bloom horizontal blur", { GL_RGBA16F, 0.5f });
+	const RenderGraphResource bloomVertical = createRenderTarget("Bloom vertical blur", { GL_RGBA16F, 0.5f });
+	const RenderGraphResource histogram = createBuffer("Luminance histogram", 256 * sizeof(unsigned int));
+	const RenderGraphResource ldrColor = createRenderTarget("LDR color", { GL_RGBA8, 1.0f });
+
+	//* Passes, in the order one would naturally write them down
+	RenderGraphPass pass = addPass("G-buffer", executeExamplePass);
+	writeAttachment(pass, albedo);
+	writeAttachment(pass, normals);
+	writeAttachment(pass, depth);
+	pass = addPass("Shadow maps", executeExamplePass);
+	write(pass, shadowMaps);
+	pass = addPass("UI text", executeExamplePass);
+	writeAttachment(pass, ui);
+	pass = addPass("Ambient occlusion", executeExamplePass);
+	read(pass, depth);
+	read(pass, normals);
+	writeAttachment(pass, ambientOcclusion);
+	pass = addPass("Ambient occlusion blur", executeExamplePass);
+	read(pass, ambientOcclusion);
+	read(pass, depth);
+	writeAttachment(pass, blurredAmbientOcclusion);
+	pass = addPass("Light culling", executeExamplePass);
+	read(pass, depth);
+	write(pass, lightList);
+	pass = addPass("Lighting", executeExamplePass);
+	read(pass, albedo);
+	read(pass, normals);
+	read(pass, depth);
+	read(pass, blurredAmbientOcclusion);
+	read(pass, shadowMaps);
+	read(pass, lightList);
+	writeAttachment(pass, hdrColor);
+	// Adds to the UI text, so it has to run after it, but the framebuffer is the same
+	pass = addPass("UI icons", executeExamplePass);
+	writeAttachment(pass, ui);
+	// Nothing reads its output, so it is culled
+	pass = addPass("Debug normals", executeExamplePass);
+	read(pass, normals);
+	writeAttachment(pass, debugNormals);
+	pass = addPass("Depth of field", executeExamplePass);
+	read(pass, hdrColor);
+	read(pass, depth);
+	writeAttachment(pass, depthOfField);
+	pass = addPass("Bloom downsample", executeExamplePass);
+	read(pass, depthOfField);
+	writeAttachment(pass, bloom);
+	pass = addPass("Bloom horizontal blur", executeExamplePass);
+	read(pass, bloom);
+	writeAttachment(pass, bloomHorizontal);
+	pass = addPass("Bloom vertical blur", executeExamplePass);
+	read(pass, bloomHorizontal);
+	writeAttachment(pass, bloomVertical);
+	pass = addPass("Luminance histogram", executeExamplePass);
+	read(pass, depthOfField);
+	write(pass, histogram);
+	pass = addPass("Tonemapping", executeExamplePass);
+	read(pass, depthOfField);
+	read(pass, bloomVertical);
+	read(pass, histogram);
+	read(pass, ui);
+	writeAttachment(pass, ldrColor);
+	pass = addPass("Anti-aliasing", executeExamplePass);
+	read(pass, ldrColor);
+	writeAttachment(pass, window);
+
+	compile();
+	printReport();
+	clear();
+}
\ No newline at end of file
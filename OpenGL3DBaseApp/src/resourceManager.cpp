@@ -1,66 +1,113 @@
 #include <memory>
+#include <random>
+#include <string>
+#include <cmath>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include "resourceManager.hpp"
 #include "render.hpp"
+#include "textureStreamer.hpp"
+#include "uploadManager.hpp"
+#include "frameArena.hpp"
+#include "objectPool.hpp"
+#include "clusteredLighting.hpp"
+#include "overdrawAnalysis.hpp"
+#include "dynamicResolution.hpp"
+#include "views.hpp"
+#include "cascadedShadows.hpp"
+#include "materials.hpp"
+#include "jobSystem.hpp"
+#include "entities.hpp"
+#include "transforms.hpp"
+#include "clock.hpp"
+#include "glResources.hpp"
+#include "renderGraph.hpp"
+#include "window.hpp"
+#include "assetLoader.hpp"
+#include "terrain.hpp"
+#include "particles.hpp"
+#include "shaderLibrary.hpp"
+#include "collision.hpp"
 
 //** Private **//
-unsigned int UBO_ID;
-
 // Due to C++ immediately defining object declarations (which is very inflexible), we use smart pointers to store camera and floor plane
 std::unique_ptr<Camera> cam;
+// Second camera that looks down onto the scene from above, shown next to or on top of the main camera's view
+std::unique_ptr<Camera> overviewCam;
 std::unique_ptr<Plane> plane;
+ViewLayout viewLayout = ViewLayout::Single;
 
-std::vector<Shader> shaders;
-std::vector<Cube> cubes;
-std::vector<std::vector<glm::vec3>> objectPositions;
+// The programs belong to the ShaderLibrary
+std::vector<Shader*> shaders;
+// Cubes are allocated from a pool so that adding and removing them at runtime doesn't allocate each time
+ObjectPool<Cube> cubePool(16);
+std::vector<Cube*> cubes;
+// The cubes that are animated on the GPU have the first colliders, which never change
+unsigned int animatedCubeColliderCount = 0;
+bool depthPrepass = false;
+// Draws the terrain in place of the floor plane
+bool terrainEnabled = false;
+// Simulates and draws the particle fountain
+bool particlesEnabled = false;
+
+// The frame's render graph is built anew whenever dynamic resolution is switched on or off, as that adds or removes the scene target
+bool frameGraphBuilt = false, frameGraphDynamicResolution = false;
+RenderGraphResource sceneColor;
 
 void prepareShaders() {
 	//* Prepare all needed shaders 
+	// The depth pre-pass shaders use the DEPTH_ONLY variant of the same vertex shaders, which leaves out all outputs that are
+	// only needed for shading, and a fragment shader that does nothing
+	// The cubes that are animated on the GPU use the ANIMATED variants of the cube shaders, which take animation parameters instead of a model matrix
+	const std::vector<std::string> depthOnly = { "DEPTH_ONLY" };
+	const std::vector<std::string> animated = { "ANIMATED" }, animatedDepthOnly = { "ANIMATED", "DEPTH_ONLY" };
 	shaders = {
 		// [0] => Plane shader, [1] = Cube shader
-		Shader("res/shaders/planeShader.vert", "res/shaders/planeShader.frag"),
-		Shader("res/shaders/cubeShader.vert", "res/shaders/cubeShader.frag"),
+		&ShaderLibrary::getShader("res/shaders/planeShader.vert", "res/shaders/planeShader.frag"),
+		&ShaderLibrary::getShader("res/shaders/cubeShader.vert", "res/shaders/cubeShader.frag"),
+		// [2] => Plane depth pre-pass shader, [3] => Cube depth pre-pass shader
+		&ShaderLibrary::getShader("res/shaders/planeShader.vert", "res/shaders/depthOnly.frag", depthOnly),
+		&ShaderLibrary::getShader("res/shaders/cubeShader.vert", "res/shaders/depthOnly.frag", depthOnly),
+		// [4] => Terrain shader, [5] => Terrain depth pre-pass shader
+		&ShaderLibrary::getShader("res/shaders/terrain.vert", "res/shaders/terrain.frag"),
+		&ShaderLibrary::getShader("res/shaders/terrain.vert", "res/shaders/depthOnly.frag", depthOnly),
+		// [6] => Animated cube shader, [7] => Animated cube depth pre-pass shader
+		&ShaderLibrary::getShader("res/shaders/cubeShader.vert", "res/shaders/cubeShader.frag", animated),
+		&ShaderLibrary::getShader("res/shaders/cubeShader.vert", "res/shaders/depthOnly.frag", animatedDepthOnly),
 	};
 
 	//* Initialize the uniforms
 	// Don't forget to activate a shader before setting uniforms
-	shaders[1].use();
+	shaders[1]->use();
 	// Note that we don't give the stored textureID that OpenGL assigned because those have nothing to do with this
 	// This basically tells OpenGL "Use the first assigned texture (0) as uniform texture0, second one (1) as texture1, etc"
 	// Note that OpenGL starts counting at 0, which is why we do the same in our shaders to reduce room for error
-	shaders[1].setInt("texture0", 0);
-	shaders[1].setInt("texture1", 1);
-
-	//* Set initial blend value
-	Render::updateBlendValue(shaders[1], 0.5f);
-
-	//* Initialize a uniform buffer object (UBO) that manages uniforms across all shaders
-	// Saving the need to set the same uniforms for each shader individually
-	// We'll use this to share view matrix and projection matrix between shaders
-	// First argument is the number of buffers to create, second argument a pointer to store the assigned ID in
-	glGenBuffers(1, &UBO_ID);
-	// Tells OpenGL we are currently working with this UBO
-	glBindBuffer(GL_UNIFORM_BUFFER, UBO_ID);
-	// Here the actual data copying happens
-	// First argument is the buffer type, second argument is the sice of the UBO (we are storing two 4x4 matrices = 2 * 64 bytes)
-	// Third argument is a pointer to the data, but since we don't have any data yet, we give nullptr
-	// 4th argument tells OpenGL how to handle the data. "Static draw" specifies that the data is set only once and used many times
-	glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_STATIC_DRAW);
-	// Link the UBO to binding point 0
-	// The binding point is a kind of register that tells each shader where to look for the UBO that needs to be used
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, UBO_ID);
+	shaders[1]->setInt("texture0", 0);
+	shaders[1]->setInt("texture1", 1);
+	shaders[6]->use();
+	shaders[6]->setInt("texture0", 0);
+	shaders[6]->setInt("texture1", 1);
 
 	//* Configure the shaders to link to our UBO
 	unsigned int shaderUniformBlockIndex;
 	for (unsigned int i = 0; i < shaders.size(); i++) {
 		// Get the shader's uniform block index that stores the "matrices" uniform block
-		shaderUniformBlockIndex = glGetUniformBlockIndex(shaders[i].getShaderProgramID(), "matrices");
-		// Link the shader's "matrices" uniform block index to binding point 0 (where we linked the UBO earlier)
-		glUniformBlockBinding(shaders[i].getShaderProgramID(), shaderUniformBlockIndex, 0);
+		shaderUniformBlockIndex = glGetUniformBlockIndex(shaders[i]->getShaderProgramID(), "matrices");
+		// Link the shader's "matrices" uniform block index to binding point 0 (where Views::initialize() linked the UBO)
+		glUniformBlockBinding(shaders[i]->getShaderProgramID(), shaderUniformBlockIndex, 0);
 
 		// Now, when a shader wants to access a uniform contained in the "matrices" uniform block, it will fetch the data from
 		// the UBO that is linked to binding point 0. Now every time we want to update the view matrix or projection matrix,
 		// we'll update the UBO instead of the shaders. Since our UBO is linked to binding point 0, the shaders can then fetch the data from it
+
+		// Same for the lighting data, the shadows and the materials which are shared between all shaders
+		ClusteredLighting::configureShader(*shaders[i]);
+		CascadedShadows::configureShader(*shaders[i]);
+		Materials::configureShader(*shaders[i]);
+		Terrain::configureShader(*shaders[i]);
 	}
 }
 
@@ -68,96 +115,501 @@ void prepareObjects() {
 	plane.reset(new Plane());
 	
 	cubes = {
-		Cube("res/images/dummyImage1.png", "res/images/dummyImage2.png"),
-		Cube("res/images/dummyImage3.png", "res/images/dummyImage4.png"),
-		Cube("res/images/dummyImage5.png", "res/images/dummyImage6.png"),
+		cubePool.create("res/images/dummyImage1.png", "res/images/dummyImage2.png"),
+		cubePool.create("res/images/dummyImage3.png", "res/images/dummyImage4.png"),
+		cubePool.create("res/images/dummyImage5.png", "res/images/dummyImage6.png"),
 	};
 
-	objectPositions = {
-		{ // [0] => Cube positions for cubes[0]
-			glm::vec3(0.0f,  0.0f,  0.0f),
-			glm::vec3(2.0f,  5.0f, -15.0f),
-			glm::vec3(-1.5f, -2.2f, -2.5f),
-			glm::vec3(-3.8f, -2.0f, -12.3f),
-			glm::vec3(2.4f, -0.4f, -3.5f),
-			glm::vec3(-1.7f,  3.0f, -7.5f),
-			glm::vec3(1.3f, -2.0f, -2.5f),
-			glm::vec3(1.5f,  2.0f, -2.5f),
-			glm::vec3(1.5f,  0.2f, -1.5f),
-			glm::vec3(-1.3f,  1.0f, -1.5f),
-		},
-		{ // [1] => Cube positions for cubes[1]
-			glm::vec3(3.0f, 2.0f, 0.0f),
-		},
-		{ // [2] => Cube positions for cubes[2]
-			glm::vec3(-2.0f, 0.5f, 0.5f),
-		},
+	//* Give the cubes different materials
+	// Cubes of the same kind share their textures, so they are still drawn with a single draw call no matter which material they use
+	const unsigned int plainMaterial = Materials::create({ 0.5f, glm::vec3(1.0f, 1.0f, 1.0f) });
+	const unsigned int warmMaterial = Materials::create({ 0.2f, glm::vec3(1.0f, 0.75f, 0.55f) });
+	const unsigned int coolMaterial = Materials::create({ 0.8f, glm::vec3(0.6f, 0.8f, 1.0f) });
+
+	//* Add the cubes to the entity store; the mesh ID is the index of the cube kind in cubes
+	struct CubeDescription {
+		unsigned int meshID;
+		glm::vec3 position;
+		unsigned int materialID;
+	};
+	const CubeDescription cubeDescriptions[] = {
+		// Mesh 0 => cubes[0]
+		{ 0, glm::vec3(0.0f,  0.0f,  0.0f), plainMaterial },
+		{ 0, glm::vec3(2.0f,  5.0f, -15.0f), warmMaterial },
+		{ 0, glm::vec3(-1.5f, -2.2f, -2.5f), coolMaterial },
+		{ 0, glm::vec3(-3.8f, -2.0f, -12.3f), plainMaterial },
+		{ 0, glm::vec3(2.4f, -0.4f, -3.5f), warmMaterial },
+		{ 0, glm::vec3(-1.7f,  3.0f, -7.5f), coolMaterial },
+		{ 0, glm::vec3(1.3f, -2.0f, -2.5f), plainMaterial },
+		{ 0, glm::vec3(1.5f,  2.0f, -2.5f), warmMaterial },
+		{ 0, glm::vec3(1.5f,  0.2f, -1.5f), coolMaterial },
+		{ 0, glm::vec3(-1.3f,  1.0f, -1.5f), plainMaterial },
+		// Mesh 1 => cubes[1]
+		{ 1, glm::vec3(3.0f, 2.0f, 0.0f), warmMaterial },
+		// Mesh 2 => cubes[2]
+		{ 2, glm::vec3(-2.0f, 0.5f, 0.5f), coolMaterial },
 	};
+	// All cubes spin around the same axis at different speeds; the further right a cube starts out, the faster it spins
+	// A cube that only spins in place is a function of the time alone, so it is animated on the GPU: its parameters are uploaded
+	// once, and the CPU doesn't touch it again. The cube on the right carries another cube around, so it has to stay an entity
+	// whose transform the hierarchy can follow
+	const glm::vec3 rotationAxis = glm::normalize(glm::vec3(1.0f, 0.3f, 0.5f));
+	std::vector<AnimatedCubeInstance> animatedCubes[3];
+	Entity rightCube = {};
+	for (const CubeDescription& cube : cubeDescriptions) {
+		const float rotationSpeed = glm::radians(20.0f * (cube.position.x + 1.0f));
+		if (cube.meshID == 1) {
+			rightCube = Entities::create(cube.meshID, cube.materialID, cube.position, rotationAxis * rotationSpeed);
+		}
+		else {
+			animatedCubes[cube.meshID].push_back({ cube.position, rotationSpeed, rotationAxis, 0.0f, 1.0f, cube.materialID });
+		}
+	}
+	animatedCubeColliderCount = 0;
+	for (unsigned int i = 0; i < cubes.size(); i++) {
+		cubes[i]->setAnimatedInstances(animatedCubes[i]);
+		animatedCubeColliderCount += (unsigned int)animatedCubes[i].size();
+	}
+
+	//* Colliders of the animated cubes
+	// Only the GPU knows how far they have turned, so each of them collides as the box around the sphere that holds the cube
+	// in every rotation. The sphere's radius is half the cube's diagonal, and as the box doesn't turn, it is set once and for all
+	Collision::setColliderCount(animatedCubeColliderCount);
+	unsigned int collider = 0;
+	for (unsigned int i = 0; i < cubes.size(); i++) {
+		for (const AnimatedCubeInstance& instance : animatedCubes[i]) {
+			OBB box;
+			box.center = instance.position;
+			box.halfExtents = glm::vec3(0.5f * std::sqrt(3.0f) * instance.scale);
+			box.axes = glm::mat3(1.0f);
+			Collision::setCollider(collider++, box);
+		}
+	}
+
+	//* A small cube is attached to the side of the cube on the right
+	// Its transform is relative to the one of its parent, so it is carried around by the parent's rotation without spinning on its own
+	Entities::createChild(rightCube, 2, plainMaterial, glm::vec3(0.0f, 1.2f, 0.0f), glm::vec3(0.0f), 0.3f);
+}
+
+// Moves the entities' colliders to where they are drawn this frame; they come after the colliders of the animated cubes, which stay put
+void updateColliders() {
+	const unsigned int entityCount = Entities::getCount();
+	Collision::setColliderCount(animatedCubeColliderCount + entityCount);
+	unsigned int collider = animatedCubeColliderCount;
+	const Transform* transforms = Entities::getTransforms();
+	for (unsigned int i = 0; i < entityCount; i++) {
+		Collision::setCollider(collider++, Collision::getCubeBox(Transforms::getWorldMatrix(transforms[i])));
+	}
+	Collision::update();
+}
+
+// Everything that only has to be done once per frame no matter how many views see the scene
+void prepareScene() {
+	// Turn the cubes by how much time has passed since the last frame, then calculate the world matrices of everything that moved
+	// The cubes that are animated on the GPU only need the frame's time, which Views::update() uploads
+	Entities::update(Clock::getDeltaTime());
+	Transforms::update();
+	// The camera collides with the cubes where they are drawn this frame during the next frame's input
+	updateColliders();
+
+	// cubes[i] draws the entities with mesh ID i
+	for (unsigned int i = 0; i < cubes.size(); i++) {
+		cubes[i]->prepareInstances(i);
+	}
+
+	// The terrain's level of detail follows the main camera in every view
+	if (terrainEnabled) {
+		Terrain::update(cam->cameraPosition);
+	}
+
+	// The particles are simulated once per frame on the GPU, no matter how many views draw them
+	if (particlesEnabled) {
+		ParticleSystem::update(Clock::getDeltaTime());
+	}
+}
+
+// Draws the scene into all views of the current pass
+void drawScene(const Shader& planeShader, const Shader& cubeShader, const Shader& animatedCubeShader, const Shader& terrainShader, const unsigned int viewCount) {
+	// Process plane or terrain
+	if (terrainEnabled) {
+		terrainShader.use();
+		Terrain::render(terrainShader, viewCount);
+	}
+	else {
+		planeShader.use();
+		plane->render(viewCount);
+	}
+
+	// Process cubes
+	cubeShader.use();
+	for (Cube* cube : cubes) {
+		cube->renderInstances(viewCount);
+	}
+	// The cubes that are animated on the GPU take the cube shader's ANIMATED variant
+	animatedCubeShader.use();
+	for (Cube* cube : cubes) {
+		cube->renderAnimatedInstances(viewCount);
+	}
+}
+
+// Draws everything that casts shadows into the shadow map that is being rendered, either the cubes that are animated on the GPU or the rest
+void drawShadowCasters(const bool animated) {
+	for (Cube* cube : cubes) {
+		if (animated) {
+			cube->renderAnimatedShadowCasters();
+		}
+		else {
+			cube->renderShadowCasters();
+		}
+	}
+}
+
+//* Passes of the frame's render graph
+// Renders the shadow maps that are outdated; the others are reused from earlier frames
+void executeShadowPass(void*) {
+	CascadedShadows::update(drawShadowCasters);
+}
+
+// Renders all views into the scene target (or straight into the window)
+void executeScenePass(void*) {
+	// Redirects the frame into the overdraw analysis' target if a capture was requested
+	OverdrawAnalysis::beginFrame();
+
+	//* Render all views
+	// Views whose viewports don't overlap are drawn together in one pass; e.g. split-screen takes a single pass
+	// while picture-in-picture takes two as the small view is drawn on top of the large one
+	for (unsigned int pass = 0; pass < Views::getPassCount(); pass++) {
+		// This clears the buffers of the pass' viewports
+		const unsigned int viewCount = Views::beginPass(pass);
+
+		//* Depth pre-pass
+		// First, only the depth of all opaque geometry is drawn. The shading pass then only draws fragments whose depth is
+		// equal to what was drawn here, so every pixel is shaded exactly once instead of once for every surface drawn on top of each other
+		if (depthPrepass) {
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			// The pre-pass mustn't count towards the overdraw
+			glStencilMask(0x00);
+			drawScene(*shaders[2], *shaders[3], *shaders[7], *shaders[5], viewCount);
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glStencilMask(0xFF);
+
+			// The depth buffer is complete already, so there is no need to write to it again
+			glDepthFunc(GL_EQUAL);
+			glDepthMask(GL_FALSE);
+		}
+
+		//* Shading pass
+		drawScene(*shaders[0], *shaders[1], *shaders[6], *shaders[4], viewCount);
+
+		if (depthPrepass) {
+			glDepthFunc(GL_LESS);
+			glDepthMask(GL_TRUE);
+		}
+
+		// The particles are see-through, so they come after everything opaque and are left out of the depth pre-pass
+		if (particlesEnabled) {
+			ParticleSystem::render(viewCount);
+		}
+	}
+	Views::endPasses();
+
+	OverdrawAnalysis::endFrame();
+}
+
+// Scales the scene target up to the window
+void executeUpscalePass(void*) {
+	unsigned int sceneTargetWidth, sceneTargetHeight;
+	RenderGraph::getSize(sceneColor, sceneTargetWidth, sceneTargetHeight);
+	DynamicResolution::upscale(RenderGraph::getTexture(sceneColor), sceneTargetWidth, sceneTargetHeight);
+}
+
+void buildFrameGraph() {
+	RenderGraph::clear();
+	const RenderGraphResource window = RenderGraph::importRenderTarget("Window", 0);
+	// The shadow maps are cached across frames, so they belong to the shadows rather than the graph
+	const RenderGraphResource shadowMaps = RenderGraph::importResource("Shadow maps");
+
+	const RenderGraphPass shadowPass = RenderGraph::addPass("Shadow maps", executeShadowPass);
+	RenderGraph::write(shadowPass, shadowMaps);
+
+	const RenderGraphPass scenePass = RenderGraph::addPass("Scene", executeScenePass);
+	RenderGraph::read(scenePass, shadowMaps);
+	if (DynamicResolution::isEnabled()) {
+		//* The scene target is as large as the largest scale; the scene is rendered into its lower left corner
+		// The color is a texture as the upscaling samples from it, with bilinear filtering in between the pixels
+		const float scale = DynamicResolution::getSceneTargetScale();
+		sceneColor = RenderGraph::createRenderTarget("Scene color", { GL_RGBA8, scale });
+		const RenderGraphResource sceneDepth = RenderGraph::createRenderTarget("Scene depth and stencil", { GL_DEPTH24_STENCIL8, scale });
+		RenderGraph::writeAttachment(scenePass, sceneColor);
+		RenderGraph::writeAttachment(scenePass, sceneDepth);
+
+		const RenderGraphPass upscalePass = RenderGraph::addPass("Upscale", executeUpscalePass);
+		RenderGraph::read(upscalePass, sceneColor);
+		RenderGraph::writeAttachment(upscalePass, window);
+	}
+	else {
+		RenderGraph::writeAttachment(scenePass, window);
+	}
+	RenderGraph::compile();
+
+	frameGraphBuilt = true;
+	frameGraphDynamicResolution = DynamicResolution::isEnabled();
+}
+
+void prepareLights() {
+	//* Scatter lots of small colored lights around the cubes
+	// A fixed seed gives us the same scene on every start
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> x(-8.0f, 8.0f), y(-3.0f, 6.0f), z(-18.0f, 4.0f), radius(1.0f, 2.5f), hue(0.0f, 6.0f);
+
+	std::vector<PointLight> lights(2048);
+	for (unsigned int i = 0; i < lights.size(); i++) {
+		lights[i].position = glm::vec3(x(random), y(random), z(random));
+		lights[i].radius = radius(random);
+		// Fully saturated colors of random hue
+		const float h = hue(random);
+		glm::vec3 color = glm::clamp(glm::vec3(std::abs(h - 3.0f) - 1.0f, 2.0f - std::abs(h - 2.0f), 2.0f - std::abs(h - 4.0f)), 0.0f, 1.0f);
+		lights[i].color = color * 0.25f;
+	}
+	ClusteredLighting::setLights(lights);
 }
 
 //** Public **//
 void ResourceManager::initialize(GLFWwindow& window) {
 	// Initialize key settings
 	Render::initialize(window);
+
+	// One thread per CPU core (including this one) runs the jobs of the engine, e.g. loading textures and calculating model matrices
+	JobSystem::initialize(0);
+
+	// Buffer and texture data is copied to the GPU through a 16 MB staging buffer, at most 4 MB per frame
+	// Anything larger is spread across multiple frames instead of stalling a single one
+	UploadManager::initialize(16 * 1024 * 1024, 4 * 1024 * 1024);
+
+	// Textures may occupy at most 64 MB of GPU memory
+	// Higher resolution mip levels are evicted in least recently used order once the budget is exceeded
+	// Textures are block compressed on loading using the best format the GPU supports
+	TextureStreamer::initialize(64 * 1024 * 1024, CompressionQuality::High);
+
+	// Assets that are added while the scene is running are loaded by a thread with a second OpenGL context
+	// Nothing of it shows up in the frame time of the main thread but taking the finished assets over
+	AssetLoader::initialize(window);
+
+	// Memory for data that only lives for a single frame, reset at the top of the frame loop
+	// 1 MB is plenty for now; the arena grows on its own should a frame ever need more
+	FrameArena::initialize(1024 * 1024);
+
+	// Point lights are binned into a grid of clusters across the view frustum, so each fragment only processes nearby lights
+	ClusteredLighting::initialize();
+
+	// The sun casts shadows through 4 cascades of 2048x2048 texels up to 50 units away from the camera
+	// The 2 distant cascades are rendered every 4th frame at most, taking turns
+	CascadedShadows::initialize(2048, 4, 50.0f, 4);
+
+	// Material parameters of all objects live in a single table that the shaders index with the object's material ID
+	Materials::initialize();
+
+	// The scene is rendered at 50% to 100% of the window's resolution (along each axis), whichever keeps the GPU below 16 ms per frame
+	DynamicResolution::initialize(0.5f, 1.0f, 16.0f);
+
+	// Hilly terrain of 1024x1024 units that can be shown in place of the floor plane
+	// Its detailed heightmap tiles are streamed into 32 slots of an atlas around the camera
+	Terrain::initialize(1024.0f, 32);
+
+	// A fountain of 1M particles that are simulated and drawn entirely on the GPU
+	// They live 1.5 to 3 seconds, so the emitter may give birth to a third of them per second
+	ParticleSystem::initialize(1 << 20);
+	ParticleEmitter fountain = {};
+	fountain.position = glm::vec3(4.0f, -0.1f, -6.0f);
+	fountain.radius = 0.1f;
+	fountain.velocity = glm::vec3(0.0f, 5.0f, 0.0f);
+	fountain.velocitySpread = 1.5f;
+	fountain.acceleration = glm::vec3(0.0f, -4.0f, 0.0f);
+	fountain.drag = 0.2f;
+	fountain.minimumLifetime = 1.5f;
+	fountain.maximumLifetime = 3.0f;
+	fountain.emissionRate = (1 << 20) / fountain.maximumLifetime;
+	fountain.size = 0.015f;
+	fountain.startColor = glm::vec4(1.0f, 0.8f, 0.4f, 0.15f);
+	fountain.endColor = glm::vec4(0.8f, 0.2f, 0.1f, 0.0f);
+	ParticleSystem::setEmitter(fountain);
+
+	// The camera can't fly through the cubes. They barely move, so keeping them sorted for sweep and prune costs next to nothing
+	// The spatial hash's cells would be 2 units across, a little more than a turned cube's bounds
+	Collision::initialize(Broadphase::SweepAndPrune, 2.0f);
 	
 	// Create a camera
 	cam.reset(new Camera(
 		glm::vec3(0.0f, 0.0f, 3.0f),
 		glm::vec3(0.0f, 0.0f, 0.0f),
 		2.5f, 150.0f));
+	overviewCam.reset(new Camera(
+		glm::vec3(0.0f, 14.0f, 2.0f),
+		glm::vec3(0.0f, 0.0f, -6.0f),
+		2.5f, 150.0f));
+
+	// Holds the matrices of all views and shares them with the shaders
+	Views::initialize();
 
 	// Prepare shaders and objects
 	prepareShaders();
 	prepareObjects();
+	prepareLights();
 
-	// Set initial view matrix and projection matrix
-	// Note that since the matrices are stored in a uniform buffer object (UBO), this has to be done after shader creation
-	// since the UBO is generated in prepareShaders() and cannot be filled with data if it doesn't exist yet
+	// Set initial view matrices; the projection matrices are set by the views as they depend on the shape of the viewport
 	cam->updateViewMatrix();
-	cam->updateProjectionMatrix();
+	overviewCam->updateViewMatrix();
+	setViewLayout(ViewLayout::Single);
+}
+
+// Deletes all objects and the OpenGL resources of every system, then reports anything that is still alive as a leak
+// Has to be called before the window is closed as deleting OpenGL objects needs the context
+void ResourceManager::shutdown() {
+	// Workers may still be decoding textures; they have to be stopped before the textures are gone
+	JobSystem::shutdown();
+
+	for (unsigned int i = 0; i < cubes.size(); i++) {
+		cubePool.destroy(cubes[i]);
+	}
+	cubes.clear();
+	plane.reset();
+	shaders.clear();
+	animatedCubeColliderCount = 0;
+	Collision::shutdown();
+	Terrain::shutdown();
+	ParticleSystem::shutdown();
+
+	// Stops the loader thread before its assets are deleted
+	AssetLoader::shutdown();
+	TextureStreamer::shutdown();
+	UploadManager::shutdown();
+	ClusteredLighting::shutdown();
+	CascadedShadows::shutdown();
+	Materials::shutdown();
+	DynamicResolution::shutdown();
+	OverdrawAnalysis::shutdown();
+	RenderGraph::shutdown();
+	frameGraphBuilt = false;
+	Views::shutdown();
+	ShaderLibrary::clear();
+
+	GLResources::reportLeaks();
+}
+
+// Waits until everything that is loading has arrived: textures that are being decoded, queued uploads and the asset loader's assets
+// How far loading gets within a frame depends on the speed of the machine, so replays and captures call this before their first frame
+// to render the same frames every time
+void ResourceManager::finishLoading() {
+	while (TextureStreamer::getPendingCount() > 0 || !UploadManager::isIdle() || AssetLoader::getPendingCount() > 0) {
+		JobSystem::runMainThreadJobs();
+		UploadManager::update();
+		AssetLoader::update();
+		// The fences only signal once their commands have actually been sent to the GPU, which otherwise happens when the frame is swapped
+		glFlush();
+		std::this_thread::yield();
+	}
 }
 
 void ResourceManager::render() {
-	// This clears the buffers
-	Render::clearWindow();
+	// Pick this frame's resolution; the render graph renders the scene into an offscreen target of that size
+	DynamicResolution::beginFrame();
+	// Upload the matrices of all views; this comes first as the lights are binned for the primary view
+	Views::update();
 
-	// Process plane
-	shaders[0].use();
-	plane->render();
+	// Finish the jobs that other threads handed to the main thread, e.g. uploading textures once they are decoded
+	JobSystem::runMainThreadJobs();
+	// Stream in (or evict) texture mip levels depending on what was drawn last frame
+	TextureStreamer::update();
+	// Copy this frame's share of the queued uploads to the GPU
+	UploadManager::update();
+	// Take over the assets that the loader thread has finished
+	AssetLoader::update();
+	// Upload the materials that were edited since the last frame
+	Materials::update();
+	// Sort the lights into the clusters of the current view
+	ClusteredLighting::update();
 
-	// Process cubes
-	shaders[1].use();
-	cubes[0].renderMultiple(shaders[1], objectPositions[0]);
-	cubes[1].renderMultiple(shaders[1], objectPositions[1]);
-	cubes[2].renderMultiple(shaders[1], objectPositions[2]);
+	// Calculate the transforms of all objects once for all views
+	prepareScene();
+
+	//* Render the shadow maps, the scene and (with dynamic resolution) the upscaling through the render graph
+	if (!frameGraphBuilt || frameGraphDynamicResolution != DynamicResolution::isEnabled()) {
+		buildFrameGraph();
+	}
+	unsigned int framebufferWidth, framebufferHeight;
+	Window::getFramebufferSize(framebufferWidth, framebufferHeight);
+	RenderGraph::setReferenceSize(framebufferWidth, framebufferHeight);
+	RenderGraph::execute();
+}
+
+// Adds the given number of cube kinds whose mesh and textures are loaded in the background, one cube of each kind
+// They are lined up in rows far behind the other cubes and show up one after another as their assets arrive
+void ResourceManager::addBackgroundLoadedCubes(const unsigned int count) {
+	const unsigned int material = Materials::create({ 0.5f, glm::vec3(1.0f, 1.0f, 1.0f) });
+	const unsigned int cubesPerRow = 12;
+	for (unsigned int i = 0; i < count; i++) {
+		// Every kind loads its own copies of the demo images, like different assets would
+		const std::string texture1Path = "res/images/dummyImage" + std::to_string(1 + (2 * i) % 6) + ".png";
+		const std::string texture2Path = "res/images/dummyImage" + std::to_string(2 + (2 * i) % 6) + ".png";
+		cubes.push_back(cubePool.create("res/meshes/cube.obj", texture1Path, texture2Path));
+
+		const glm::vec3 position(((float)(i % cubesPerRow) - (cubesPerRow - 1) / 2.0f) * 2.0f, 1.0f + (float)(i / cubesPerRow % 6) * 2.0f,
+			-25.0f - (float)(i / (cubesPerRow * 6)) * 3.0f);
+		Entities::create((unsigned int)cubes.size() - 1, material, position, glm::vec3(0.0f, glm::radians(30.0f), 0.0f));
+	}
+}
+
+// Arranges the main camera's view and the overview camera's view in the window
+void ResourceManager::setViewLayout(const ViewLayout layout) {
+	viewLayout = layout;
+	Views::clearViews();
+	switch (layout) {
+	case ViewLayout::Single:
+		Views::addView(*cam, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		break;
+	case ViewLayout::PictureInPicture:
+		Views::addView(*cam, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		Views::addView(*overviewCam, glm::vec4(0.7f, 0.7f, 0.28f, 0.28f));
+		break;
+	case ViewLayout::SplitScreen:
+		Views::addView(*cam, glm::vec4(0.0f, 0.0f, 0.5f, 1.0f));
+		Views::addView(*overviewCam, glm::vec4(0.5f, 0.0f, 0.5f, 1.0f));
+		break;
+	}
+}
+
+ViewLayout ResourceManager::getViewLayout() {
+	return viewLayout;
+}
+
+void ResourceManager::setDepthPrepass(const bool enabled) {
+	depthPrepass = enabled;
+}
+
+bool ResourceManager::isDepthPrepassEnabled() {
+	return depthPrepass;
+}
+
+void ResourceManager::setTerrainEnabled(const bool enabled) {
+	terrainEnabled = enabled;
+}
+
+bool ResourceManager::isTerrainEnabled() {
+	return terrainEnabled;
+}
+
+void ResourceManager::setParticlesEnabled(const bool enabled) {
+	particlesEnabled = enabled;
+}
+
+bool ResourceManager::areParticlesEnabled() {
+	return particlesEnabled;
 }
 
 Camera& ResourceManager::giveCamera() {
 	return *cam;
 }
 
-const std::vector<Shader>& ResourceManager::giveShaders() {
+const std::vector<Shader*>& ResourceManager::giveShaders() {
 	return shaders;
-}
-
-void ResourceManager::setViewMatrix(const glm::mat4& viewMatrix) {
-	// Note that we aren't passing the updated matrix to a shader, but to our uniform buffer object (UBO) so that it gets updated across all shaders
-	// Tells OpenGL we are currently working with this uniform buffer object (UBO)
-	glBindBuffer(GL_UNIFORM_BUFFER, UBO_ID);
-	// Copy the data into the UBO
-	// First argument is the buffer type
-	// Second argument is the offset (view matrix occupies bytes 0-63, projection matrix 64-127)
-	// Third argument is the data size (= 64 bytes) and 4th argument a pointer to the data
-	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &viewMatrix);
-}
-
-void ResourceManager::setProjectionMatrix(const glm::mat4& projectionMatrix) {
-	// Note that we aren't passing the updated matrix to a shader, but to our uniform buffer object (UBO) so that it gets updated across all shaders
-	// Tells OpenGL we are currently working with this uniform buffer object (UBO)
-	glBindBuffer(GL_UNIFORM_BUFFER, UBO_ID);
-	// Copy the data into the UBO
-	// First argument is the buffer type
-	// Second argument is the offset (view matrix occupies bytes 0-63, projection matrix 64-127)
-	// Third argument is the data size (= 64 bytes) and 4th argument a pointer to the data
-	glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &projectionMatrix);
 }
\ No newline at end of file
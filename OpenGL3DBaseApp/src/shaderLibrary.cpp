@@ -0,0 +1,238 @@
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+
+#include "shaderLibrary.hpp"
+
+#ifdef EMBED_SHADERS
+#include "embeddedShaders.hpp"
+#endif
+
+//** Private **//
+// Every shader file the application uses; these are the ones writeEmbeddedSources() puts into the header
+// The files in res/shaders/include aren't listed as they end up inside the shaders that include them
+const char* const shaderPaths[] = {
+	"res/shaders/planeShader.vert", "res/shaders/planeShader.frag",
+	"res/shaders/cubeShader.vert", "res/shaders/cubeShader.frag",
+	"res/shaders/terrain.vert", "res/shaders/terrain.frag",
+	"res/shaders/depthOnly.frag", "res/shaders/shadowDepth.vert",
+	"res/shaders/upscaleShader.vert", "res/shaders/upscaleShader.frag",
+	"res/shaders/particleUpdate.vert", "res/shaders/particle.vert", "res/shaders/particle.frag",
+};
+
+// Preprocessed sources by path
+std::unordered_map<std::string, std::string> shaderSources;
+// Compiled programs by their shaders and keywords, see getPermutationKey()
+std::unordered_map<std::string, std::unique_ptr<Shader>> shaderPermutations;
+
+// Reads a shader's source code from file
+bool readShaderFile(const std::string& path, std::string& code) {
+	//* Read the shader from file
+	try {
+		std::ifstream shaderFile;
+
+		//* Try reading the file contents
+		// Set the ifstream to throw exceptions for failbit (logical error) and badbit (read error)
+		// failbit is set for example if the file does not exist or one tries to read beyond the end of a file
+		// badbit is set if an error while reading occurs that causes the loss of the stream's integrity
+		shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+
+		// Open the file
+		shaderFile.open(path);
+
+		// Store the file contents
+		std::stringstream shaderStream;
+		shaderStream << shaderFile.rdbuf();
+
+		// Close the file
+		shaderFile.close();
+
+		// Convert filestream into string
+		// Note: std::stringstream.str() returns std::string
+		code = shaderStream.str();
+	}
+	catch (const std::ifstream::failure& e)
+	{
+		std::cout << "Error: Shader could not successfully read file " << path << "\n" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Returns the directory of the path including its last slash, which is where the files it includes are looked for
+std::string getDirectory(const std::string& path) {
+	const size_t slash = path.find_last_of("/\\");
+	return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+// Appends the file's source to result, replacing every #include "file" line with the source of that file
+// includedPaths holds the files that are already part of the shader; they aren't included again, which also stops files that include each other
+// The #line directives keep the line numbers of compile errors right. Every file gets a number of its own in the order it is included,
+// with the shader itself being 0, so an error in "2(12)" is on line 12 of the second included file
+bool resolveIncludes(const std::string& path, std::vector<std::string>& includedPaths, std::string& result) {
+	const size_t fileNumber = includedPaths.size();
+	includedPaths.push_back(path);
+	std::string code;
+	if (!readShaderFile(path, code)) {
+		return false;
+	}
+
+	bool success = true;
+	std::istringstream lines(code);
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(lines, line)) {
+		lineNumber++;
+		const size_t directiveStart = line.find_first_not_of(" \t");
+		if (directiveStart == std::string::npos || line.compare(directiveStart, 8, "#include") != 0) {
+			result += line;
+			result += '\n';
+			continue;
+		}
+
+		const size_t nameStart = line.find('"', directiveStart + 8);
+		const size_t nameEnd = nameStart == std::string::npos ? std::string::npos : line.find('"', nameStart + 1);
+		if (nameEnd == std::string::npos) {
+			std::cout << "Error: Shader " << path << " has an #include without a file name in line " << lineNumber << std::endl;
+			success = false;
+		}
+		else {
+			const std::string includePath = getDirectory(path) + line.substr(nameStart + 1, nameEnd - nameStart - 1);
+			if (std::find(includedPaths.begin(), includedPaths.end(), includePath) == includedPaths.end()) {
+				result += "#line 1 " + std::to_string(includedPaths.size()) + "\n";
+				success = resolveIncludes(includePath, includedPaths, result) && success;
+				result += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileNumber) + "\n";
+				continue;
+			}
+		}
+		// An empty line in place of the directive keeps the following lines' numbers
+		result += '\n';
+	}
+	return success;
+}
+
+// Keywords are sorted so that the same keywords in a different order find the same program
+std::string getPermutationKey(const std::string& vertexPath, const std::string& fragmentPath, std::vector<std::string> keywords) {
+	std::sort(keywords.begin(), keywords.end());
+	std::string key = vertexPath + "|" + fragmentPath;
+	for (const std::string& keyword : keywords) {
+		key += "|" + keyword;
+	}
+	return key;
+}
+
+//** Public **//
+const std::string& ShaderLibrary::getSource(const std::string& path) {
+	std::unordered_map<std::string, std::string>::const_iterator cachedSource = shaderSources.find(path);
+	if (cachedSource != shaderSources.end()) {
+		return cachedSource->second;
+	}
+	std::string& source = shaderSources[path];
+
+#ifdef EMBED_SHADERS
+	for (const EmbeddedShaderSource& embeddedSource : embeddedShaderSources) {
+		if (path == embeddedSource.path) {
+			source = embeddedSource.source;
+			return source;
+		}
+	}
+	// Shaders that were added after the header was written are still read from file
+#endif
+
+	std::vector<std::string> includedPaths;
+	resolveIncludes(path, includedPaths, source);
+	return source;
+}
+
+std::string ShaderLibrary::specialize(const std::string& source, const std::vector<std::string>& keywords) {
+	if (keywords.empty()) {
+		return source;
+	}
+
+	//* Nothing may come before the #version line, so the defines go right after it
+	size_t insertPosition = 0;
+	const size_t versionStart = source.find("#version");
+	if (versionStart != std::string::npos) {
+		const size_t versionEnd = source.find('\n', versionStart);
+		insertPosition = versionEnd == std::string::npos ? source.size() : versionEnd + 1;
+	}
+	std::string result = source.substr(0, insertPosition);
+	if (!result.empty() && result.back() != '\n') {
+		result += '\n';
+	}
+	for (const std::string& keyword : keywords) {
+		result += "#define " + keyword + "\n";
+	}
+	// The shader's lines keep their numbers in compile errors
+	result += "#line " + std::to_string(std::count(source.begin(), source.begin() + insertPosition, '\n') + 1) + " 0\n";
+	result += source.substr(insertPosition);
+	return result;
+}
+
+Shader& ShaderLibrary::getShader(const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& keywords) {
+	std::unique_ptr<Shader>& shader = shaderPermutations[getPermutationKey(vertexPath, fragmentPath, keywords)];
+	if (!shader) {
+		shader.reset(new Shader(vertexPath, fragmentPath, keywords));
+	}
+	return *shader;
+}
+
+void ShaderLibrary::clear() {
+	shaderPermutations.clear();
+	shaderSources.clear();
+}
+
+// Writes a header that holds the path and the preprocessed source of every shader as constexpr data
+// The sources are always read from the shader files, even if the program itself was built with embedded shaders
+bool ShaderLibrary::writeEmbeddedSources(const std::string& outputPath) {
+	std::ofstream output(outputPath);
+	if (!output) {
+		std::cout << "Error: Could not open " << outputPath << " for writing" << std::endl;
+		return false;
+	}
+	output << "// Generated by \"OpenGL3DBaseApp --embed-shaders\", don't edit it by hand\n"
+		<< "// The preprocessed sources of all shaders; they are compiled into the program if EMBED_SHADERS is defined, see ShaderLibrary\n"
+		<< "#pragma once\n\n"
+		<< "struct EmbeddedShaderSource {\n\tconst char* path;\n\tconst char* source;\n};\n\n"
+		<< "constexpr EmbeddedShaderSource embeddedShaderSources[] = {\n";
+
+	size_t totalSize = 0;
+	for (const char* path : shaderPaths) {
+		std::string source;
+		std::vector<std::string> includedPaths;
+		if (!resolveIncludes(path, includedPaths, source)) {
+			return false;
+		}
+		totalSize += source.size();
+
+		//* Every line becomes a string literal of its own, which the compiler joins back together
+		output << "\t{ \"" << path << "\",\n";
+		std::istringstream lines(source);
+		std::string line;
+		while (std::getline(lines, line)) {
+			output << "\t\t\"";
+			for (const char character : line) {
+				switch (character) {
+				case '\\': output << "\\\\"; break;
+				case '"': output << "\\\""; break;
+				case '\t': output << "\\t"; break;
+				case '\r': break;
+				default: output << character; break;
+				}
+			}
+			output << "\\n\"\n";
+		}
+		output << "\t},\n";
+	}
+	output << "};\n";
+	if (!output) {
+		std::cout << "Error: Could not write " << outputPath << std::endl;
+		return false;
+	}
+
+	std::cout << "Embedded " << sizeof(shaderPaths) / sizeof(shaderPaths[0]) << " shaders (" << totalSize << " bytes) into " << outputPath << std::endl;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,655 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+#include "terrain.hpp"
+#include "views.hpp"
+#include "uploadManager.hpp"
+#include "jobSystem.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+//* Level of detail
+// Every node is drawn as a grid of this many quads per side. Where only some of a node's children are selected, the others are
+// drawn at the node's level as quarters of the node, using a grid with half as many quads so that the spacing of the vertices stays the same
+const unsigned int gridResolution = 32;
+// Nodes of the finest level (0) are this large; every level up, they are twice as large
+const float leafNodeSize = 8.0f;
+// Nodes of level 0 are used up to this distance from the camera; every level up, the distance doubles
+const float leafLodRange = 16.0f;
+// Vertices start morphing into the next coarser level once they are this far through their level's range
+const float morphStartRatio = 0.66f;
+const unsigned int maxLodLevelCount = 16;
+
+//* Heights
+// The terrain is flat at the base height around the scene in the middle; the hills further out rise up to hillHeight above it
+const float terrainBaseHeight = -3.0f, hillHeight = 30.0f;
+const float flatRadius = 24.0f, hillRadius = 96.0f;
+// Octaves of noise in the coarse heightmap and in the detailed tiles; every octave adds details half the size of the previous one
+const unsigned int coarseOctaves = 5, detailOctaves = 8;
+// Distance between the samples of the coarse heightmap
+const float coarseSampleSpacing = 2.0f;
+
+//* Detailed tiles
+// A tile covers tileSize x tileSize units with tileResolution + 1 samples per side, so neighbouring tiles share the samples of their edge
+const float tileSize = 64.0f;
+const unsigned int tileResolution = 256;
+const unsigned int tileSamples = tileResolution + 1;
+// The atlas holds the resident tiles in rows of this many slots
+const unsigned int atlasColumns = 8;
+// At most this many tiles are generated at once, so the jobs don't crowd out everything else
+const unsigned int maxTileLoadsInFlight = 4;
+
+// Texture units 0 and 1 are used by the objects' textures, 2 to 5 by the lighting and the shadows
+const int coarseHeightsTextureUnit = 6, tileAtlasTextureUnit = 7, tileTableTextureUnit = 8;
+
+struct TerrainTile {
+	int slot;							// Slot of the atlas that holds the tile, -1 if it has none
+	bool loading, resident;
+	unsigned long long lastUsedFrame;	// Last frame a selected node needed the tile
+};
+
+// A tile that is being generated, owned by the jobs that load it
+struct TileLoad {
+	unsigned int tileIndex;
+	int slot;
+	unsigned int generation;
+	std::vector<float> heights;
+};
+
+// Lowest and highest point of a node, so that it can be tested against the camera's distance and the view frusta
+struct NodeBounds {
+	float minimumHeight, maximumHeight;
+};
+
+float terrainSize = 0.0f;
+unsigned int lodLevelCount = 0;
+// Levels whose vertices are closer together than the samples of the coarse heightmap, which need the detailed tiles
+unsigned int detailLevelCount = 0;
+float lodRanges[maxLodLevelCount];
+// Distances at which the vertices of each level start and finish morphing into the next coarser level
+glm::vec2 morphRanges[maxLodLevelCount];
+// Bounds of every node of every level, row by row
+std::vector<std::vector<NodeBounds>> nodeBounds;
+
+GLTexture coarseHeightsTexture, tileAtlasTexture, tileTableTexture;
+GLVertexArray fullGridVAO, halfGridVAO;
+GLBuffer fullGridVBO, fullGridEBO, halfGridVBO, halfGridEBO, terrainInstanceVBO;
+unsigned int fullGridIndexCount = 0, halfGridIndexCount = 0, terrainInstanceCapacity = 0;
+// Set once the grids and the coarse heightmap have arrived on the GPU
+bool terrainResident = false;
+
+unsigned int tilesPerSide = 0;
+std::vector<TerrainTile> terrainTiles;
+// The tile in each slot of the atlas, -1 for free slots
+std::vector<int> atlasSlots;
+unsigned int tileLoadsInFlight = 0;
+// Tiles that finish loading after the terrain was shut down (or set up anew) are thrown away
+unsigned int terrainGeneration = 0;
+unsigned long long terrainFrameCounter = 0;
+
+//* Selection of the current frame
+// Every selected node is stored as its corner (x, z), its size and its level, which is exactly what the instance buffer holds
+std::vector<glm::vec4> selectedFullNodes, selectedPartialNodes;
+// Missing tiles that the selected nodes need
+std::vector<unsigned int> requestedTiles;
+glm::vec3 selectionCameraPosition;
+bool (*selectionVisibilityTest)(const glm::vec3& center, const float radius) = nullptr;
+
+//* Height function
+// Random value in [0, 1] for each point of the integer lattice
+float hashLatticePoint(const int x, const int z) {
+	unsigned int hash = (unsigned int)x * 374761393u + (unsigned int)z * 668265263u;
+	hash = (hash ^ (hash >> 13)) * 1274126177u;
+	return (float)(hash ^ (hash >> 16)) / 4294967295.0f;
+}
+
+// Value noise: the random values of the lattice points, smoothly interpolated in between
+float calculateValueNoise(const float x, const float z) {
+	const float cellX = std::floor(x), cellZ = std::floor(z);
+	float u = x - cellX, v = z - cellZ;
+	u = u * u * (3.0f - 2.0f * u);
+	v = v * v * (3.0f - 2.0f * v);
+	const int latticeX = (int)cellX, latticeZ = (int)cellZ;
+	const float front = glm::mix(hashLatticePoint(latticeX, latticeZ), hashLatticePoint(latticeX + 1, latticeZ), u);
+	const float back = glm::mix(hashLatticePoint(latticeX, latticeZ + 1), hashLatticePoint(latticeX + 1, latticeZ + 1), u);
+	return glm::mix(front, back, v);
+}
+
+// Height of the terrain at a position, with the given number of octaves of detail
+// The heightmaps are generated instead of read from files, but they are used exactly the same way
+float calculateTerrainHeight(const float x, const float z, const unsigned int octaves) {
+	float noise = 0.0f, amplitude = 0.5f, frequency = 1.0f / 96.0f;
+	for (unsigned int octave = 0; octave < octaves; octave++) {
+		noise += amplitude * calculateValueNoise(x * frequency, z * frequency);
+		amplitude *= 0.5f;
+		frequency *= 2.0f;
+	}
+
+	//* The hills fade in with the distance from the middle, so the scene stands on flat ground
+	const float distance = std::sqrt(x * x + z * z);
+	const float hills = glm::clamp((distance - flatRadius) / (hillRadius - flatRadius), 0.0f, 1.0f);
+	return terrainBaseHeight + noise * hillHeight * hills * hills * (3.0f - 2.0f * hills);
+}
+
+//* Quadtree
+unsigned int getNodesPerSide(const unsigned int level) {
+	return (unsigned int)(terrainSize / leafNodeSize) >> level;
+}
+
+// Sets up the levels of detail for a terrain of the given size, which has to be leafNodeSize times a power of two
+void setUpLevels(const float size) {
+	terrainSize = size;
+	lodLevelCount = 1;
+	while (leafNodeSize * (float)(1u << (lodLevelCount - 1)) < size) {
+		lodLevelCount++;
+	}
+
+	float previousRange = 0.0f;
+	detailLevelCount = 0;
+	for (unsigned int level = 0; level < lodLevelCount; level++) {
+		lodRanges[level] = leafLodRange * (float)(1u << level);
+		morphRanges[level] = glm::vec2(previousRange + (lodRanges[level] - previousRange) * morphStartRatio, lodRanges[level]);
+		previousRange = lodRanges[level];
+
+		// Vertices of a level are as far apart as its nodes are large divided by the grid's resolution
+		if (leafNodeSize * (float)(1u << level) / (float)gridResolution < coarseSampleSpacing) {
+			detailLevelCount = level + 1;
+		}
+	}
+}
+
+// Samples the coarse heightmap of the whole terrain and derives the bounds of every node from it
+void buildHeights(std::vector<float>& coarseHeights) {
+	const unsigned int samplesPerSide = (unsigned int)(terrainSize / coarseSampleSpacing) + 1;
+	coarseHeights.resize(samplesPerSide * samplesPerSide);
+	for (unsigned int z = 0; z < samplesPerSide; z++) {
+		for (unsigned int x = 0; x < samplesPerSide; x++) {
+			coarseHeights[z * samplesPerSide + x] = calculateTerrainHeight(
+				-terrainSize / 2.0f + (float)x * coarseSampleSpacing, -terrainSize / 2.0f + (float)z * coarseSampleSpacing, coarseOctaves);
+		}
+	}
+
+	//* Leaves span the coarse samples they cover
+	// The margin covers the octaves that only the detailed tiles have (which add less than hillHeight / 2^coarseOctaves)
+	// plus how far the curves of the coarse octaves may reach past the samples
+	const float margin = hillHeight * std::pow(0.5f, (float)coarseOctaves - 1.0f);
+	const unsigned int samplesPerLeaf = (unsigned int)(leafNodeSize / coarseSampleSpacing);
+	nodeBounds.assign(lodLevelCount, std::vector<NodeBounds>());
+	unsigned int nodesPerSide = getNodesPerSide(0);
+	nodeBounds[0].resize(nodesPerSide * nodesPerSide);
+	for (unsigned int nodeZ = 0; nodeZ < nodesPerSide; nodeZ++) {
+		for (unsigned int nodeX = 0; nodeX < nodesPerSide; nodeX++) {
+			NodeBounds bounds = { coarseHeights[nodeZ * samplesPerLeaf * samplesPerSide + nodeX * samplesPerLeaf], 0.0f };
+			bounds.maximumHeight = bounds.minimumHeight;
+			for (unsigned int z = nodeZ * samplesPerLeaf; z <= (nodeZ + 1) * samplesPerLeaf; z++) {
+				for (unsigned int x = nodeX * samplesPerLeaf; x <= (nodeX + 1) * samplesPerLeaf; x++) {
+					bounds.minimumHeight = std::min(bounds.minimumHeight, coarseHeights[z * samplesPerSide + x]);
+					bounds.maximumHeight = std::max(bounds.maximumHeight, coarseHeights[z * samplesPerSide + x]);
+				}
+			}
+			bounds.minimumHeight -= margin;
+			bounds.maximumHeight += margin;
+			nodeBounds[0][nodeZ * nodesPerSide + nodeX] = bounds;
+		}
+	}
+
+	//* Every other node spans its 4 children
+	for (unsigned int level = 1; level < lodLevelCount; level++) {
+		const unsigned int childrenPerSide = nodesPerSide;
+		nodesPerSide /= 2;
+		nodeBounds[level].resize(nodesPerSide * nodesPerSide);
+		for (unsigned int nodeZ = 0; nodeZ < nodesPerSide; nodeZ++) {
+			for (unsigned int nodeX = 0; nodeX < nodesPerSide; nodeX++) {
+				NodeBounds bounds = nodeBounds[level - 1][nodeZ * 2 * childrenPerSide + nodeX * 2];
+				for (unsigned int child = 1; child < 4; child++) {
+					const NodeBounds& childBounds = nodeBounds[level - 1][(nodeZ * 2 + child / 2) * childrenPerSide + nodeX * 2 + child % 2];
+					bounds.minimumHeight = std::min(bounds.minimumHeight, childBounds.minimumHeight);
+					bounds.maximumHeight = std::max(bounds.maximumHeight, childBounds.maximumHeight);
+				}
+				nodeBounds[level][nodeZ * nodesPerSide + nodeX] = bounds;
+			}
+		}
+	}
+}
+
+bool intersectsSphere(const glm::vec3& minimumCorner, const glm::vec3& maximumCorner, const glm::vec3& center, const float radius) {
+	const glm::vec3 closestPoint = glm::clamp(center, minimumCorner, maximumCorner);
+	const glm::vec3 offset = closestPoint - center;
+	return glm::dot(offset, offset) <= radius * radius;
+}
+
+//* Selects the nodes to draw within the given node, see "Continuous Distance-Dependent Level of Detail for Rendering Heightmaps" by Filip Strugar
+// Returns false if the node is out of its level's range, in which case its parent has to cover its area
+bool selectNode(const unsigned int level, const unsigned int nodeX, const unsigned int nodeZ) {
+	const float size = leafNodeSize * (float)(1u << level);
+	const NodeBounds& bounds = nodeBounds[level][nodeZ * getNodesPerSide(level) + nodeX];
+	const glm::vec3 minimumCorner(-terrainSize / 2.0f + (float)nodeX * size, bounds.minimumHeight, -terrainSize / 2.0f + (float)nodeZ * size);
+	const glm::vec3 maximumCorner(minimumCorner.x + size, bounds.maximumHeight, minimumCorner.z + size);
+
+	if (!intersectsSphere(minimumCorner, maximumCorner, selectionCameraPosition, lodRanges[level])) {
+		return false;
+	}
+	// Nodes that no view can see are dealt with by leaving them out
+	const glm::vec3 center = (minimumCorner + maximumCorner) * 0.5f;
+	if (!selectionVisibilityTest(center, glm::length(maximumCorner - center))) {
+		return true;
+	}
+
+	const glm::vec4 node(minimumCorner.x, minimumCorner.z, size, (float)level);
+	if (level == 0 || !intersectsSphere(minimumCorner, maximumCorner, selectionCameraPosition, lodRanges[level - 1])) {
+		selectedFullNodes.push_back(node);
+		return true;
+	}
+
+	//* Partly within the range of the next finer level
+	// The children that are within it select themselves; the others are drawn at this level
+	const float childSize = size / 2.0f;
+	for (unsigned int child = 0; child < 4; child++) {
+		const unsigned int childX = child % 2, childZ = child / 2;
+		if (!selectNode(level - 1, nodeX * 2 + childX, nodeZ * 2 + childZ)) {
+			selectedPartialNodes.push_back(glm::vec4(node.x + (float)childX * childSize, node.y + (float)childZ * childSize, childSize, (float)level));
+		}
+	}
+	return true;
+}
+
+unsigned long long countSelectedVertices() {
+	const unsigned long long fullGridVertices = (gridResolution + 1) * (gridResolution + 1);
+	const unsigned long long halfGridVertices = (gridResolution / 2 + 1) * (gridResolution / 2 + 1);
+	return selectedFullNodes.size() * fullGridVertices + selectedPartialNodes.size() * halfGridVertices;
+}
+
+//* Tiles
+// Tells the shaders which slot of the atlas holds the tile, or -1 if it isn't resident
+// A single texel isn't worth a trip through the upload manager
+void setTileTableEntry(const unsigned int tileIndex, const float slot) {
+	glBindTexture(GL_TEXTURE_2D, tileTableTexture.getID());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, tileIndex % tilesPerSide, tileIndex / tilesPerSide, 1, 1, GL_RED, GL_FLOAT, &slot);
+}
+
+// Runs on the main thread once the tile is resident
+void completeTileLoad(const unsigned int tileIndex, const unsigned int generation) {
+	if (generation != terrainGeneration) {
+		return;
+	}
+	TerrainTile& tile = terrainTiles[tileIndex];
+	tile.loading = false;
+	tile.resident = true;
+	tileLoadsInFlight--;
+	setTileTableEntry(tileIndex, (float)tile.slot);
+}
+
+// Runs on the main thread once the tile is generated: copies it into its slot of the atlas
+void uploadTile(void* data) {
+	TileLoad* load = static_cast<TileLoad*>(data);
+	if (load->generation == terrainGeneration) {
+		const unsigned int tileIndex = load->tileIndex, generation = load->generation;
+		UploadManager::uploadTextureRegion(tileAtlasTexture.getID(), 0,
+			(load->slot % atlasColumns) * tileSamples, (load->slot / atlasColumns) * tileSamples, tileSamples, tileSamples,
+			GL_RED, GL_FLOAT, &load->heights[0], load->heights.size() * sizeof(float),
+			[tileIndex, generation]() { completeTileLoad(tileIndex, generation); });
+	}
+	delete load;
+}
+
+// Runs on a worker thread
+void generateTile(void* data) {
+	TileLoad* load = static_cast<TileLoad*>(data);
+	const float originX = -terrainSize / 2.0f + (float)(load->tileIndex % tilesPerSide) * tileSize;
+	const float originZ = -terrainSize / 2.0f + (float)(load->tileIndex / tilesPerSide) * tileSize;
+	const float spacing = tileSize / (float)tileResolution;
+	load->heights.resize(tileSamples * tileSamples);
+	for (unsigned int z = 0; z < tileSamples; z++) {
+		for (unsigned int x = 0; x < tileSamples; x++) {
+			load->heights[z * tileSamples + x] = calculateTerrainHeight(originX + (float)x * spacing, originZ + (float)z * spacing, detailOctaves);
+		}
+	}
+	JobSystem::runOnMainThread(uploadTile, load);
+}
+
+// Returns a free slot of the atlas, or evicts the resident tile that was used longest ago
+// Returns -1 if every slot is either loading or holds a tile that is needed this frame
+int findFreeSlot() {
+	int evictedSlot = -1;
+	unsigned long long oldestFrame = terrainFrameCounter;
+	for (unsigned int slot = 0; slot < atlasSlots.size(); slot++) {
+		if (atlasSlots[slot] < 0) {
+			return (int)slot;
+		}
+		const TerrainTile& tile = terrainTiles[atlasSlots[slot]];
+		if (tile.resident && tile.lastUsedFrame < oldestFrame) {
+			oldestFrame = tile.lastUsedFrame;
+			evictedSlot = (int)slot;
+		}
+	}
+
+	if (evictedSlot >= 0) {
+		TerrainTile& tile = terrainTiles[atlasSlots[evictedSlot]];
+		tile.resident = false;
+		tile.slot = -1;
+		setTileTableEntry(atlasSlots[evictedSlot], -1.0f);
+		atlasSlots[evictedSlot] = -1;
+	}
+	return evictedSlot;
+}
+
+// Marks the tiles that the selected nodes of the detailed levels need as used, and starts generating the closest missing ones
+void requestTiles() {
+	requestedTiles.clear();
+	for (const std::vector<glm::vec4>* nodes : { &selectedFullNodes, &selectedPartialNodes }) {
+		for (const glm::vec4& node : *nodes) {
+			if ((unsigned int)node.w >= detailLevelCount) {
+				continue;
+			}
+			// Nodes of the detailed levels are never larger than a tile, so each of them lies within a single tile
+			const unsigned int tileIndex = (unsigned int)((node.y + terrainSize / 2.0f) / tileSize) * tilesPerSide
+				+ (unsigned int)((node.x + terrainSize / 2.0f) / tileSize);
+			TerrainTile& tile = terrainTiles[tileIndex];
+			if (tile.lastUsedFrame != terrainFrameCounter) {
+				tile.lastUsedFrame = terrainFrameCounter;
+				if (!tile.resident && !tile.loading) {
+					requestedTiles.push_back(tileIndex);
+				}
+			}
+		}
+	}
+
+	//* The closest tiles come first
+	std::sort(requestedTiles.begin(), requestedTiles.end(), [](const unsigned int a, const unsigned int b) {
+		const glm::vec2 camera(selectionCameraPosition.x + terrainSize / 2.0f, selectionCameraPosition.z + terrainSize / 2.0f);
+		const glm::vec2 centerA(((float)(a % tilesPerSide) + 0.5f) * tileSize, ((float)(a / tilesPerSide) + 0.5f) * tileSize);
+		const glm::vec2 centerB(((float)(b % tilesPerSide) + 0.5f) * tileSize, ((float)(b / tilesPerSide) + 0.5f) * tileSize);
+		return glm::length(centerA - camera) < glm::length(centerB - camera);
+	});
+
+	for (const unsigned int tileIndex : requestedTiles) {
+		if (tileLoadsInFlight >= maxTileLoadsInFlight) {
+			break;
+		}
+		const int slot = findFreeSlot();
+		if (slot < 0) {
+			break;
+		}
+		TerrainTile& tile = terrainTiles[tileIndex];
+		tile.loading = true;
+		tile.slot = slot;
+		atlasSlots[slot] = (int)tileIndex;
+		tileLoadsInFlight++;
+
+		TileLoad* load = new TileLoad();
+		load->tileIndex = tileIndex;
+		load->slot = slot;
+		load->generation = terrainGeneration;
+		JobSystem::run(generateTile, load);
+	}
+}
+
+//* Grid meshes
+// A grid of resolution x resolution quads over [0, 1] in x and z, with the instance buffer's node as its second attribute
+void createGrid(const unsigned int resolution, GLVertexArray& VAO, GLBuffer& VBO, GLBuffer& EBO, unsigned int& indexCount, const char* label,
+	const std::function<void()>& onComplete) {
+	std::vector<float> vertices;
+	vertices.reserve((resolution + 1) * (resolution + 1) * 2);
+	for (unsigned int z = 0; z <= resolution; z++) {
+		for (unsigned int x = 0; x <= resolution; x++) {
+			vertices.push_back((float)x / (float)resolution);
+			vertices.push_back((float)z / (float)resolution);
+		}
+	}
+	std::vector<unsigned int> indices;
+	indices.reserve(resolution * resolution * 6);
+	for (unsigned int z = 0; z < resolution; z++) {
+		for (unsigned int x = 0; x < resolution; x++) {
+			const unsigned int corner = z * (resolution + 1) + x;
+			indices.insert(indices.end(), { corner, corner + resolution + 1, corner + 1, corner + 1, corner + resolution + 1, corner + resolution + 2 });
+		}
+	}
+	indexCount = (unsigned int)indices.size();
+
+	EBO = GLBuffer(GLMemoryCategory::Geometry, label);
+	VAO = GLVertexArray(GLMemoryCategory::Geometry, label);
+	VBO = GLBuffer(GLMemoryCategory::Geometry, label);
+	glBindVertexArray(VAO.getID());
+	glBindBuffer(GL_ARRAY_BUFFER, VBO.getID());
+	UploadManager::uploadBuffer(VBO.getID(), &vertices[0], vertices.size() * sizeof(float), nullptr);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.getID());
+	UploadManager::uploadBuffer(EBO.getID(), &indices[0], indices.size() * sizeof(unsigned int), onComplete);
+
+	// The nodes are per instance; the divisor is set when drawing as it depends on the number of views
+	glBindBuffer(GL_ARRAY_BUFFER, terrainInstanceVBO.getID());
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(0);
+}
+
+// Creates a single channel float texture with linear filtering that doesn't repeat
+void createHeightTexture(GLTexture& texture, const char* label, const unsigned int width, const unsigned int height, const void* data, const GLint filter) {
+	texture = GLTexture(GLMemoryCategory::Textures, label);
+	glBindTexture(GL_TEXTURE_2D, texture.getID());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, data);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	texture.setSize(width * height * sizeof(float));
+}
+
+//* Report
+// The report either looks all around the camera up to the far plane, or sees the whole terrain at once
+const float reportViewDistance = 100.0f;
+
+bool isWithinReportViewDistance(const glm::vec3& center, const float radius) {
+	return glm::length(center - selectionCameraPosition) - radius <= reportViewDistance;
+}
+
+bool isAlwaysVisible(const glm::vec3&, const float) {
+	return true;
+}
+
+// Selects the nodes a number of times with the given visibility test and returns the average time of a selection in microseconds
+double timeSelection(bool (*visibilityTest)(const glm::vec3& center, const float radius)) {
+	selectionVisibilityTest = visibilityTest;
+	const unsigned int repetitions = 100;
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < repetitions; i++) {
+		selectedFullNodes.clear();
+		selectedPartialNodes.clear();
+		selectNode(lodLevelCount - 1, 0, 0);
+	}
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repetitions;
+}
+
+//** Public **//
+void Terrain::initialize(const float size, const unsigned int tileCacheSize) {
+	//* The quadtree needs a power of two number of leaves per side, and the tiles have to fit in evenly
+	float roundedSize = std::max(leafNodeSize, tileSize);
+	while (roundedSize < size) {
+		roundedSize *= 2.0f;
+	}
+	if (roundedSize != size) {
+		std::cout << "Error: The terrain's size has to be a power of two of at least " << tileSize << " units, rounded "
+			<< size << " up to " << roundedSize << std::endl;
+	}
+	setUpLevels(roundedSize);
+	std::vector<float> coarseHeights;
+	buildHeights(coarseHeights);
+
+	//* Instanced grids
+	// The instance buffer is created first so that the grids' VAOs can point at it
+	terrainInstanceVBO = GLBuffer(GLMemoryCategory::Instances, "Terrain nodes");
+	terrainInstanceCapacity = 0;
+	createGrid(gridResolution, fullGridVAO, fullGridVBO, fullGridEBO, fullGridIndexCount, "Terrain grid", nullptr);
+	createGrid(gridResolution / 2, halfGridVAO, halfGridVBO, halfGridEBO, halfGridIndexCount, "Terrain half grid", nullptr);
+
+	//* Heights
+	// The coarse heightmap goes through the upload manager like the grids; uploads complete in order, so the terrain can be drawn once it has arrived
+	const unsigned int samplesPerSide = (unsigned int)(terrainSize / coarseSampleSpacing) + 1;
+	createHeightTexture(coarseHeightsTexture, "Terrain coarse heightmap", samplesPerSide, samplesPerSide, nullptr, GL_LINEAR);
+	terrainResident = false;
+	UploadManager::uploadTextureRegion(coarseHeightsTexture.getID(), 0, 0, 0, samplesPerSide, samplesPerSide, GL_RED, GL_FLOAT,
+		&coarseHeights[0], coarseHeights.size() * sizeof(float), []() { terrainResident = true; });
+
+	const unsigned int atlasRows = (tileCacheSize + atlasColumns - 1) / atlasColumns;
+	createHeightTexture(tileAtlasTexture, "Terrain tile atlas", atlasColumns * tileSamples, atlasRows * tileSamples, nullptr, GL_LINEAR);
+	tilesPerSide = (unsigned int)(terrainSize / tileSize);
+	const std::vector<float> emptyTileTable(tilesPerSide * tilesPerSide, -1.0f);
+	createHeightTexture(tileTableTexture, "Terrain tile table", tilesPerSide, tilesPerSide, &emptyTileTable[0], GL_NEAREST);
+
+	terrainTiles.assign(tilesPerSide * tilesPerSide, { -1, false, false, 0 });
+	atlasSlots.assign(tileCacheSize, -1);
+	tileLoadsInFlight = 0;
+
+	//* Room for the selection, so that it doesn't allocate while the camera moves around
+	selectedFullNodes.reserve(1024);
+	selectedPartialNodes.reserve(1024);
+	requestedTiles.reserve(terrainTiles.size());
+}
+
+void Terrain::shutdown() {
+	// Tiles that are still being generated or uploaded are thrown away once they are done
+	terrainGeneration++;
+	terrainResident = false;
+	// Uploads that haven't arrived yet would otherwise go to whichever objects get these IDs next
+	UploadManager::cancelBufferUploads(fullGridVBO.getID());
+	UploadManager::cancelBufferUploads(fullGridEBO.getID());
+	UploadManager::cancelBufferUploads(halfGridVBO.getID());
+	UploadManager::cancelBufferUploads(halfGridEBO.getID());
+	UploadManager::cancelTextureUploads(coarseHeightsTexture.getID());
+	UploadManager::cancelTextureUploads(tileAtlasTexture.getID());
+	fullGridVAO.reset();
+	halfGridVAO.reset();
+	fullGridVBO.reset();
+	fullGridEBO.reset();
+	halfGridVBO.reset();
+	halfGridEBO.reset();
+	terrainInstanceVBO.reset();
+	coarseHeightsTexture.reset();
+	tileAtlasTexture.reset();
+	tileTableTexture.reset();
+	terrainTiles.clear();
+	atlasSlots.clear();
+	nodeBounds.clear();
+	selectedFullNodes.clear();
+	selectedPartialNodes.clear();
+}
+
+// Points the shader's height textures to the terrain's texture units
+void Terrain::configureShader(Shader& shader) {
+	// Only the terrain's shaders sample the heights
+	if (glGetUniformLocation(shader.getShaderProgramID(), "coarseHeights") == -1) {
+		return;
+	}
+	// Don't forget to activate a shader before setting uniforms
+	shader.use();
+	shader.setInt("coarseHeights", coarseHeightsTextureUnit);
+	shader.setInt("tileAtlas", tileAtlasTextureUnit);
+	shader.setInt("tileTable", tileTableTextureUnit);
+}
+
+// Selects the nodes to draw for this frame by their distance from the given position, and requests the tiles they need
+// Has to be called after Views::update() as the nodes are culled against the views
+void Terrain::update(const glm::vec3& cameraPosition) {
+	terrainFrameCounter++;
+	selectedFullNodes.clear();
+	selectedPartialNodes.clear();
+	selectionCameraPosition = cameraPosition;
+	selectionVisibilityTest = Views::isVisible;
+	selectNode(lodLevelCount - 1, 0, 0);
+	requestTiles();
+
+	//* Upload the selected nodes, the full ones first
+	// The buffer is orphaned every frame like the cubes' instance buffers
+	const unsigned int nodeCount = (unsigned int)(selectedFullNodes.size() + selectedPartialNodes.size());
+	terrainInstanceCapacity = std::max(terrainInstanceCapacity, std::max(nodeCount, 1u));
+	glBindBuffer(GL_ARRAY_BUFFER, terrainInstanceVBO.getID());
+	glBufferData(GL_ARRAY_BUFFER, terrainInstanceCapacity * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+	terrainInstanceVBO.setSize(terrainInstanceCapacity * sizeof(glm::vec4));
+	if (!selectedFullNodes.empty()) {
+		glBufferSubData(GL_ARRAY_BUFFER, 0, selectedFullNodes.size() * sizeof(glm::vec4), selectedFullNodes.data());
+	}
+	if (!selectedPartialNodes.empty()) {
+		glBufferSubData(GL_ARRAY_BUFFER, selectedFullNodes.size() * sizeof(glm::vec4), selectedPartialNodes.size() * sizeof(glm::vec4),
+			selectedPartialNodes.data());
+	}
+}
+
+// Draws the selected nodes into all views of the current pass, with the given shader in use
+void Terrain::render(const Shader& shader, const unsigned int viewCount) {
+	if (!terrainResident) {
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + coarseHeightsTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, coarseHeightsTexture.getID());
+	glActiveTexture(GL_TEXTURE0 + tileAtlasTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, tileAtlasTexture.getID());
+	glActiveTexture(GL_TEXTURE0 + tileTableTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, tileTableTexture.getID());
+	glActiveTexture(GL_TEXTURE0);
+
+	//* The same code serves the shading pass and the depth pre-pass, so the uniforms are looked up in the shader that is in use
+	glUniform3fv(shader.getUniformLocation("lodCameraPosition"), 1, &selectionCameraPosition[0]);
+	glUniform2fv(shader.getUniformLocation("morphRanges"), lodLevelCount, &morphRanges[0][0]);
+	glUniform4f(shader.getUniformLocation("terrainLayout"), terrainSize, tileSize, (float)atlasColumns, (float)detailLevelCount);
+	const int gridDimensionLocation = shader.getUniformLocation("gridDimension");
+
+	//* One instance per node and view
+	if (!selectedFullNodes.empty()) {
+		glUniform1f(gridDimensionLocation, (float)gridResolution);
+		glBindVertexArray(fullGridVAO.getID());
+		glVertexAttribDivisor(1, viewCount);
+		glDrawElementsInstanced(GL_TRIANGLES, fullGridIndexCount, GL_UNSIGNED_INT, 0, (GLsizei)(selectedFullNodes.size() * viewCount));
+	}
+	// The partial nodes follow the full ones in the instance buffer
+	if (!selectedPartialNodes.empty()) {
+		glUniform1f(gridDimensionLocation, (float)(gridResolution / 2));
+		glBindVertexArray(halfGridVAO.getID());
+		glBindBuffer(GL_ARRAY_BUFFER, terrainInstanceVBO.getID());
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(selectedFullNodes.size() * sizeof(glm::vec4)));
+		glVertexAttribDivisor(1, viewCount);
+		glDrawElementsInstanced(GL_TRIANGLES, halfGridIndexCount, GL_UNSIGNED_INT, 0, (GLsizei)(selectedPartialNodes.size() * viewCount));
+	}
+	glBindVertexArray(0);
+}
+
+// Selects the nodes around a camera standing in the middle of terrains of different sizes, and compares the vertices that are drawn
+// with a uniform grid of the finest level's vertex spacing across the whole terrain
+void Terrain::printReport() {
+	const float vertexSpacing = leafNodeSize / (float)gridResolution;
+	std::cout << "CDLOD terrain: " << gridResolution << "x" << gridResolution << " quads per node, leaves of " << leafNodeSize
+		<< " units (vertex spacing " << vertexSpacing << "), level ranges doubling from " << leafLodRange << " units" << std::endl;
+	std::cout << "Camera 2 units above the middle; vertices per frame with everything within " << reportViewDistance
+		<< " units in view (far plane) and with the whole terrain in view" << std::endl;
+	std::cout << std::setw(8) << "Size" << std::setw(8) << "Levels" << std::setw(14) << "Far plane" << std::setw(14) << "Whole terrain"
+		<< std::setw(16) << "Uniform grid" << std::setw(10) << "Ratio" << std::setw(16) << "Selection (us)" << std::endl;
+
+	const float sizes[] = { 256.0f, 512.0f, 1024.0f, 2048.0f, 4096.0f };
+	for (const float size : sizes) {
+		setUpLevels(size);
+		std::vector<float> coarseHeights;
+		buildHeights(coarseHeights);
+		selectionCameraPosition = glm::vec3(0.0f, terrainBaseHeight + 2.0f, 0.0f);
+
+		timeSelection(isWithinReportViewDistance);
+		const unsigned long long farPlaneVertices = countSelectedVertices();
+		const double microseconds = timeSelection(isAlwaysVisible);
+		const unsigned long long wholeTerrainVertices = countSelectedVertices();
+
+		// The ratio compares the uniform grid with the worst case, where all of the terrain is in view
+		const unsigned long long uniformGridSamples = (unsigned long long)(size / vertexSpacing) + 1;
+		const unsigned long long uniformGridVertices = uniformGridSamples * uniformGridSamples;
+		std::cout << std::setw(8) << (unsigned int)size << std::setw(8) << lodLevelCount << std::setw(14) << farPlaneVertices
+			<< std::setw(14) << wholeTerrainVertices << std::setw(16) << uniformGridVertices << std::fixed << std::setprecision(1)
+			<< std::setw(9) << (double)uniformGridVertices / (double)wholeTerrainVertices << "x" << std::setw(16) << microseconds
+			<< std::defaultfloat << std::endl;
+	}
+	nodeBounds.clear();
+	selectedFullNodes.clear();
+	selectedPartialNodes.clear();
+	terrainSize = 0.0f;
+}
\ No newline at end of file
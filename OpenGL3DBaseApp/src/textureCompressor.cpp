@@ -0,0 +1,1235 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// SSE2 is available on every x64 CPU, so we only need the scalar code path for other architectures
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_COMPRESSOR_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "STB/stb_image.h"
+
+#include "textureCompressor.hpp"
+#include "jobSystem.hpp"
+
+// Not every GLAD build contains the compression extensions, so we define the enums ourselves if needed
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+
+//** Private **//
+// All formats work on blocks of 4x4 pixels. Pixels inside a block are always stored as RGBA, row by row
+struct Block {
+	unsigned char pixels[16][4];
+};
+
+const int bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+const int bc7Weights2Bit[4] = { 0, 21, 43, 64 };
+
+const int etcModifierTable[8][4] = {
+	{ 2, 8, -2, -8 }, { 5, 17, -5, -17 }, { 9, 29, -9, -29 }, { 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 },
+};
+
+const int eacModifierTable[16][8] = {
+	{ -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+	{ -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+	{ -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+	{ -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+int clampByte(const int value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+size_t getBlockSize(const CompressedFormat format) {
+	return (format == CompressedFormat::BC1 || format == CompressedFormat::ETC2_RGB) ? 8 : 16;
+}
+
+// Copies a 4x4 block out of the image. Blocks that stick out of the image repeat its last row / column
+void fetchBlock(const unsigned char* imageData, const int width, const int height, const int numberOfColorChannels,
+	const int blockX, const int blockY, Block& block) {
+	for (int y = 0; y < 4; y++) {
+		const int sourceY = std::min(blockY * 4 + y, height - 1);
+		for (int x = 0; x < 4; x++) {
+			const int sourceX = std::min(blockX * 4 + x, width - 1);
+			const unsigned char* sourcePixel = imageData + ((size_t)sourceY * width + sourceX) * numberOfColorChannels;
+			unsigned char* pixel = block.pixels[y * 4 + x];
+			pixel[0] = sourcePixel[0];
+			pixel[1] = numberOfColorChannels > 1 ? sourcePixel[1] : sourcePixel[0];
+			pixel[2] = numberOfColorChannels > 2 ? sourcePixel[2] : sourcePixel[0];
+			pixel[3] = numberOfColorChannels > 3 ? sourcePixel[3] : 255;
+		}
+	}
+}
+
+void storeBlock(const Block& block, const int width, const int height, const int blockX, const int blockY, unsigned char* rgbaData) {
+	for (int y = 0; y < 4 && blockY * 4 + y < height; y++) {
+		for (int x = 0; x < 4 && blockX * 4 + x < width; x++) {
+			std::memcpy(rgbaData + ((size_t)(blockY * 4 + y) * width + blockX * 4 + x) * 4, block.pixels[y * 4 + x], 4);
+		}
+	}
+}
+
+//* Palette search
+// This is the hot loop of every encoder: for each of the 16 pixels, find the closest of up to 16 palette colors
+// With SSE2, the squared distances to two palette entries are computed per instruction using 16 bit lanes
+void findClosestPaletteIndices(const Block& block, const int palette[][4], const int paletteSize, const int channelCount, int indices[16], int& totalError) {
+	totalError = 0;
+#ifdef TEXTURE_COMPRESSOR_SSE2
+	// Palette entries are packed pairwise into 16 bit lanes: [r0 g0 b0 a0 r1 g1 b1 a1]
+	// Channels that are ignored are zeroed on both sides so they don't contribute to the distance
+	__m128i packedPalette[8];
+	for (int i = 0; i < paletteSize; i += 2) {
+		const int* second = (i + 1 < paletteSize) ? palette[i + 1] : palette[i];
+		packedPalette[i / 2] = _mm_setr_epi16(
+			(short)palette[i][0], (short)palette[i][1], (short)palette[i][2], (short)(channelCount > 3 ? palette[i][3] : 0),
+			(short)second[0], (short)second[1], (short)second[2], (short)(channelCount > 3 ? second[3] : 0));
+	}
+	for (int p = 0; p < 16; p++) {
+		const unsigned char* pixel = block.pixels[p];
+		const short alpha = (short)(channelCount > 3 ? pixel[3] : 0);
+		const __m128i packedPixel = _mm_setr_epi16(pixel[0], pixel[1], pixel[2], alpha, pixel[0], pixel[1], pixel[2], alpha);
+		int bestError = 0x7FFFFFFF, bestIndex = 0;
+		for (int i = 0; i < paletteSize; i += 2) {
+			const __m128i difference = _mm_sub_epi16(packedPalette[i / 2], packedPixel);
+			// madd squares the differences and sums neighbouring lanes: [rr+gg, bb+aa, rr+gg, bb+aa] for both entries
+			const __m128i squared = _mm_madd_epi16(difference, difference);
+			const __m128i summed = _mm_add_epi32(squared, _mm_shuffle_epi32(squared, _MM_SHUFFLE(2, 3, 0, 1)));
+			const int error0 = _mm_cvtsi128_si32(summed);
+			const int error1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(summed, _MM_SHUFFLE(2, 2, 2, 2)));
+			if (error0 < bestError) {
+				bestError = error0;
+				bestIndex = i;
+			}
+			if (i + 1 < paletteSize && error1 < bestError) {
+				bestError = error1;
+				bestIndex = i + 1;
+			}
+		}
+		indices[p] = bestIndex;
+		totalError += bestError;
+	}
+#else
+	for (int p = 0; p < 16; p++) {
+		const unsigned char* pixel = block.pixels[p];
+		int bestError = 0x7FFFFFFF, bestIndex = 0;
+		for (int i = 0; i < paletteSize; i++) {
+			int error = 0;
+			for (int c = 0; c < channelCount; c++) {
+				const int difference = palette[i][c] - pixel[c];
+				error += difference * difference;
+			}
+			if (error < bestError) {
+				bestError = error;
+				bestIndex = i;
+			}
+		}
+		indices[p] = bestIndex;
+		totalError += bestError;
+	}
+#endif
+}
+
+//* Endpoint search
+// Finds the line through color space that the pixels of a block are spread out along the most
+// Fast quality uses the bounding box diagonal, high quality the principal axis of the pixels' covariance matrix
+void findEndpoints(const Block& block, const int channelCount, const CompressionQuality quality, float endpoint0[4], float endpoint1[4]) {
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+	float maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int p = 0; p < 16; p++) {
+		for (int c = 0; c < channelCount; c++) {
+			const float value = block.pixels[p][c];
+			mean[c] += value / 16.0f;
+			minimum[c] = std::min(minimum[c], value);
+			maximum[c] = std::max(maximum[c], value);
+		}
+	}
+
+	if (quality == CompressionQuality::Fast) {
+		//* The bounding box has several diagonals; pick the one that matches the direction the pixels are spread along
+		// A channel that falls while the widest channel rises gets its minimum and maximum swapped
+		int widestChannel = 0;
+		for (int c = 1; c < channelCount; c++) {
+			if (maximum[c] - minimum[c] > maximum[widestChannel] - minimum[widestChannel]) {
+				widestChannel = c;
+			}
+		}
+		for (int c = 0; c < channelCount; c++) {
+			float covariance = 0.0f;
+			for (int p = 0; p < 16; p++) {
+				covariance += (block.pixels[p][widestChannel] - mean[widestChannel]) * (block.pixels[p][c] - mean[c]);
+			}
+			// Inset the bounding box by 1/16 of its size since the extremes are rarely hit by the interpolated colors
+			const float inset = (maximum[c] - minimum[c]) / 16.0f;
+			endpoint0[c] = maximum[c] - inset;
+			endpoint1[c] = minimum[c] + inset;
+			if (covariance < 0.0f) {
+				std::swap(endpoint0[c], endpoint1[c]);
+			}
+		}
+		return;
+	}
+
+	float covariance[4][4] = {};
+	for (int p = 0; p < 16; p++) {
+		for (int i = 0; i < channelCount; i++) {
+			for (int j = 0; j < channelCount; j++) {
+				covariance[i][j] += (block.pixels[p][i] - mean[i]) * (block.pixels[p][j] - mean[j]);
+			}
+		}
+	}
+
+	//* Power iteration converges towards the eigenvector with the largest eigenvalue = the principal axis
+	float axis[4];
+	for (int c = 0; c < channelCount; c++) {
+		axis[c] = maximum[c] - minimum[c];
+	}
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float length = 0.0f;
+		for (int i = 0; i < channelCount; i++) {
+			for (int j = 0; j < channelCount; j++) {
+				next[i] += covariance[i][j] * axis[j];
+			}
+			length = std::max(length, std::fabs(next[i]));
+		}
+		if (length < 1e-6f) {
+			break;
+		}
+		for (int c = 0; c < channelCount; c++) {
+			axis[c] = next[c] / length;
+		}
+	}
+	float axisLength = 0.0f;
+	for (int c = 0; c < channelCount; c++) {
+		axisLength += axis[c] * axis[c];
+	}
+	if (axisLength < 1e-6f) {
+		// All pixels have the same color
+		for (int c = 0; c < channelCount; c++) {
+			endpoint0[c] = endpoint1[c] = mean[c];
+		}
+		return;
+	}
+	axisLength = std::sqrt(axisLength);
+
+	//* Project the pixels onto the axis; the extreme projections become the endpoints
+	float minimumProjection = 0.0f, maximumProjection = 0.0f;
+	for (int p = 0; p < 16; p++) {
+		float projection = 0.0f;
+		for (int c = 0; c < channelCount; c++) {
+			projection += (block.pixels[p][c] - mean[c]) * axis[c] / axisLength;
+		}
+		minimumProjection = std::min(minimumProjection, projection);
+		maximumProjection = std::max(maximumProjection, projection);
+	}
+	for (int c = 0; c < channelCount; c++) {
+		endpoint0[c] = std::min(std::max(mean[c] + axis[c] / axisLength * maximumProjection, 0.0f), 255.0f);
+		endpoint1[c] = std::min(std::max(mean[c] + axis[c] / axisLength * minimumProjection, 0.0f), 255.0f);
+	}
+}
+
+// Given the chosen palette indices and their interpolation weights (0 = endpoint0, 1 = endpoint1),
+// solves for the endpoints that minimize the squared error of the block
+bool refineEndpoints(const Block& block, const int channelCount, const int indices[16], const float weights[], float endpoint0[4], float endpoint1[4]) {
+	float alpha2 = 0.0f, beta2 = 0.0f, alphaBeta = 0.0f;
+	float alphaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, betaX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int p = 0; p < 16; p++) {
+		const float beta = weights[indices[p]];
+		const float alpha = 1.0f - beta;
+		alpha2 += alpha * alpha;
+		beta2 += beta * beta;
+		alphaBeta += alpha * beta;
+		for (int c = 0; c < channelCount; c++) {
+			alphaX[c] += alpha * block.pixels[p][c];
+			betaX[c] += beta * block.pixels[p][c];
+		}
+	}
+	const float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+	if (std::fabs(determinant) < 1e-6f) {
+		return false;
+	}
+	for (int c = 0; c < channelCount; c++) {
+		endpoint0[c] = std::min(std::max((alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+		endpoint1[c] = std::min(std::max((betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+//* BC1
+unsigned short packRGB565(const float color[4]) {
+	const int r = clampByte((int)(color[0] * 31.0f / 255.0f + 0.5f));
+	const int g = clampByte((int)(color[1] * 63.0f / 255.0f + 0.5f));
+	const int b = clampByte((int)(color[2] * 31.0f / 255.0f + 0.5f));
+	return (unsigned short)((std::min(r, 31) << 11) | (std::min(g, 63) << 5) | std::min(b, 31));
+}
+
+void unpackRGB565(const unsigned short packed, int color[4]) {
+	const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+	color[3] = 255;
+}
+
+void buildBC1Palette(const unsigned short color0, const unsigned short color1, int palette[4][4]) {
+	unpackRGB565(color0, palette[0]);
+	unpackRGB565(color1, palette[1]);
+	for (int c = 0; c < 4; c++) {
+		if (color0 > color1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		else {
+			// Three color mode, which our encoder only produces for single colored blocks
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+}
+
+void encodeBC1(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	// Maps palette indices to interpolation weights, see buildBC1Palette()
+	const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	float endpoint0[4], endpoint1[4];
+	findEndpoints(block, 3, quality, endpoint0, endpoint1);
+
+	unsigned short bestColor0 = 0, bestColor1 = 0;
+	int bestIndices[16] = {};
+	int bestError = 0x7FFFFFFF;
+	const int iterations = quality == CompressionQuality::High ? 3 : 1;
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		unsigned short color0 = packRGB565(endpoint0);
+		unsigned short color1 = packRGB565(endpoint1);
+		// Four color mode requires color0 > color1
+		if (color0 < color1) {
+			std::swap(color0, color1);
+			std::swap(endpoint0, endpoint1);
+		}
+		int palette[4][4], indices[16], error;
+		buildBC1Palette(color0, color1, palette);
+		findClosestPaletteIndices(block, palette, color0 == color1 ? 1 : 4, 3, indices, error);
+		if (error < bestError) {
+			bestError = error;
+			bestColor0 = color0;
+			bestColor1 = color1;
+			std::memcpy(bestIndices, indices, sizeof(indices));
+		}
+		if (color0 == color1 || !refineEndpoints(block, 3, indices, weights, endpoint0, endpoint1)) {
+			break;
+		}
+	}
+
+	output[0] = (unsigned char)(bestColor0 & 0xFF);
+	output[1] = (unsigned char)(bestColor0 >> 8);
+	output[2] = (unsigned char)(bestColor1 & 0xFF);
+	output[3] = (unsigned char)(bestColor1 >> 8);
+	unsigned int packedIndices = 0;
+	for (int p = 0; p < 16; p++) {
+		packedIndices |= (unsigned int)bestIndices[p] << (2 * p);
+	}
+	for (int i = 0; i < 4; i++) {
+		output[4 + i] = (unsigned char)(packedIndices >> (8 * i));
+	}
+}
+
+void decodeBC1(const unsigned char* input, Block& block) {
+	const unsigned short color0 = (unsigned short)(input[0] | (input[1] << 8));
+	const unsigned short color1 = (unsigned short)(input[2] | (input[3] << 8));
+	int palette[4][4];
+	buildBC1Palette(color0, color1, palette);
+	const unsigned int packedIndices = input[4] | (input[5] << 8) | (input[6] << 16) | ((unsigned int)input[7] << 24);
+	for (int p = 0; p < 16; p++) {
+		const int index = (packedIndices >> (2 * p)) & 3;
+		for (int c = 0; c < 3; c++) {
+			block.pixels[p][c] = (unsigned char)palette[index][c];
+		}
+		block.pixels[p][3] = (color0 <= color1 && index == 3) ? 0 : 255;
+	}
+}
+
+//* BC4 (the alpha half of BC3)
+void buildBC4Palette(const int alpha0, const int alpha1, int palette[8]) {
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	if (alpha0 > alpha1) {
+		for (int i = 1; i < 7; i++) {
+			palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+		}
+	}
+	else {
+		for (int i = 1; i < 5; i++) {
+			palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+void encodeBC4Alpha(const Block& block, unsigned char* output) {
+	int minimum = 255, maximum = 0;
+	for (int p = 0; p < 16; p++) {
+		minimum = std::min(minimum, (int)block.pixels[p][3]);
+		maximum = std::max(maximum, (int)block.pixels[p][3]);
+	}
+	int palette[8];
+	buildBC4Palette(maximum, minimum, palette);
+
+	output[0] = (unsigned char)maximum;
+	output[1] = (unsigned char)minimum;
+	unsigned long long packedIndices = 0;
+	for (int p = 0; p < 16; p++) {
+		int bestIndex = 0, bestError = 256;
+		for (int i = 0; i < (maximum > minimum ? 8 : 1); i++) {
+			const int error = std::abs(palette[i] - block.pixels[p][3]);
+			if (error < bestError) {
+				bestError = error;
+				bestIndex = i;
+			}
+		}
+		packedIndices |= (unsigned long long)bestIndex << (3 * p);
+	}
+	for (int i = 0; i < 6; i++) {
+		output[2 + i] = (unsigned char)(packedIndices >> (8 * i));
+	}
+}
+
+void decodeBC4Alpha(const unsigned char* input, Block& block) {
+	int palette[8];
+	buildBC4Palette(input[0], input[1], palette);
+	unsigned long long packedIndices = 0;
+	for (int i = 0; i < 6; i++) {
+		packedIndices |= (unsigned long long)input[2 + i] << (8 * i);
+	}
+	for (int p = 0; p < 16; p++) {
+		block.pixels[p][3] = (unsigned char)palette[(packedIndices >> (3 * p)) & 7];
+	}
+}
+
+void encodeBC3(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	encodeBC4Alpha(block, output);
+	encodeBC1(block, quality, output + 8);
+}
+
+void decodeBC3(const unsigned char* input, Block& block) {
+	decodeBC1(input + 8, block);
+	decodeBC4Alpha(input, block);
+}
+
+//* BC7
+// BC7 has 8 modes, of which we use two:
+// Mode 6 stores a single pair of RGBA endpoints with 7 bits per channel plus a shared lowest bit ("p-bit") per endpoint,
+// and 4 bit indices. It is the mode most encoders pick for smooth, opaque image content
+// Mode 5 stores color and alpha separately (7 bit color endpoints, 8 bit alpha endpoints, 2 bit indices each),
+// which works better where transparency doesn't follow the color
+class BitWriter {
+private:
+	unsigned char* output;
+	int position;
+public:
+	BitWriter(unsigned char* output) : output(output), position(0) {
+		std::memset(output, 0, 16);
+	}
+	void write(const unsigned int value, const int bitCount) {
+		for (int i = 0; i < bitCount; i++, position++) {
+			output[position / 8] |= (unsigned char)(((value >> i) & 1) << (position % 8));
+		}
+	}
+};
+
+class BitReader {
+private:
+	const unsigned char* input;
+	int position;
+public:
+	BitReader(const unsigned char* input) : input(input), position(0) {}
+	unsigned int read(const int bitCount) {
+		unsigned int value = 0;
+		for (int i = 0; i < bitCount; i++, position++) {
+			value |= (unsigned int)((input[position / 8] >> (position % 8)) & 1) << i;
+		}
+		return value;
+	}
+};
+
+// Quantizes an endpoint to 7 bits per channel and picks the p-bit that loses the least precision
+void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit) {
+	int bestError = 0x7FFFFFFF;
+	for (int p = 0; p < 2; p++) {
+		int candidate[4], error = 0;
+		for (int c = 0; c < 4; c++) {
+			candidate[c] = std::min(std::max((int)((endpoint[c] - p) / 2.0f + 0.5f), 0), 127);
+			const int difference = ((candidate[c] << 1) | p) - (int)(endpoint[c] + 0.5f);
+			error += difference * difference;
+		}
+		if (error < bestError) {
+			bestError = error;
+			pBit = p;
+			std::memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+void buildBC7Palette(const int quantized0[4], const int pBit0, const int quantized1[4], const int pBit1, int palette[16][4]) {
+	for (int c = 0; c < 4; c++) {
+		const int color0 = (quantized0[c] << 1) | pBit0;
+		const int color1 = (quantized1[c] << 1) | pBit1;
+		for (int i = 0; i < 16; i++) {
+			palette[i][c] = ((64 - bc7Weights[i]) * color0 + bc7Weights[i] * color1 + 32) >> 6;
+		}
+	}
+}
+
+int encodeBC7Mode6(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	float weights[16];
+	for (int i = 0; i < 16; i++) {
+		weights[i] = bc7Weights[i] / 64.0f;
+	}
+	float endpoint0[4], endpoint1[4];
+	findEndpoints(block, 4, quality, endpoint0, endpoint1);
+
+	int bestQuantized0[4] = {}, bestQuantized1[4] = {}, bestPBit0 = 0, bestPBit1 = 0, bestIndices[16] = {};
+	int bestError = 0x7FFFFFFF;
+	const int iterations = quality == CompressionQuality::High ? 3 : 1;
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		int quantized0[4], quantized1[4], pBit0, pBit1, palette[16][4], indices[16], error;
+		quantizeBC7Endpoint(endpoint0, quantized0, pBit0);
+		quantizeBC7Endpoint(endpoint1, quantized1, pBit1);
+		buildBC7Palette(quantized0, pBit0, quantized1, pBit1, palette);
+		findClosestPaletteIndices(block, palette, 16, 4, indices, error);
+		if (error < bestError) {
+			bestError = error;
+			std::memcpy(bestQuantized0, quantized0, sizeof(quantized0));
+			std::memcpy(bestQuantized1, quantized1, sizeof(quantized1));
+			bestPBit0 = pBit0;
+			bestPBit1 = pBit1;
+			std::memcpy(bestIndices, indices, sizeof(indices));
+		}
+		if (error == 0 || !refineEndpoints(block, 4, indices, weights, endpoint0, endpoint1)) {
+			break;
+		}
+	}
+
+	//* The first pixel's index is stored with only 3 bits, so its highest bit has to be 0
+	// If it isn't, swapping the endpoints mirrors all indices which clears it
+	if (bestIndices[0] >= 8) {
+		std::swap(bestQuantized0, bestQuantized1);
+		std::swap(bestPBit0, bestPBit1);
+		for (int p = 0; p < 16; p++) {
+			bestIndices[p] = 15 - bestIndices[p];
+		}
+	}
+
+	BitWriter writer(output);
+	// The mode is encoded as a 1 following as many 0 bits as the mode's number
+	writer.write(1 << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		writer.write(bestQuantized0[c], 7);
+		writer.write(bestQuantized1[c], 7);
+	}
+	writer.write(bestPBit0, 1);
+	writer.write(bestPBit1, 1);
+	writer.write(bestIndices[0], 3);
+	for (int p = 1; p < 16; p++) {
+		writer.write(bestIndices[p], 4);
+	}
+	return bestError;
+}
+
+int encodeBC7Mode5(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	float weights[4];
+	for (int i = 0; i < 4; i++) {
+		weights[i] = bc7Weights2Bit[i] / 64.0f;
+	}
+
+	//* Color: same approach as in mode 6, but without p-bits
+	float endpoint0[4], endpoint1[4];
+	findEndpoints(block, 3, quality, endpoint0, endpoint1);
+	int bestColor0[3] = {}, bestColor1[3] = {}, bestColorIndices[16] = {};
+	int bestColorError = 0x7FFFFFFF;
+	const int iterations = quality == CompressionQuality::High ? 3 : 1;
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		int color0[3], color1[3], palette[4][4], indices[16], error;
+		for (int c = 0; c < 3; c++) {
+			color0[c] = std::min(std::max((int)(endpoint0[c] * 127.0f / 255.0f + 0.5f), 0), 127);
+			color1[c] = std::min(std::max((int)(endpoint1[c] * 127.0f / 255.0f + 0.5f), 0), 127);
+			// 7 bit values are expanded to 8 bits by repeating their highest bit
+			const int expanded0 = (color0[c] << 1) | (color0[c] >> 6);
+			const int expanded1 = (color1[c] << 1) | (color1[c] >> 6);
+			for (int i = 0; i < 4; i++) {
+				palette[i][c] = ((64 - bc7Weights2Bit[i]) * expanded0 + bc7Weights2Bit[i] * expanded1 + 32) >> 6;
+			}
+		}
+		findClosestPaletteIndices(block, palette, 4, 3, indices, error);
+		if (error < bestColorError) {
+			bestColorError = error;
+			std::memcpy(bestColor0, color0, sizeof(color0));
+			std::memcpy(bestColor1, color1, sizeof(color1));
+			std::memcpy(bestColorIndices, indices, sizeof(indices));
+		}
+		if (error == 0 || !refineEndpoints(block, 3, indices, weights, endpoint0, endpoint1)) {
+			break;
+		}
+	}
+
+	//* Alpha: the extremes of the block are used as endpoints
+	int alpha0 = 0, alpha1 = 255;
+	for (int p = 0; p < 16; p++) {
+		alpha0 = std::max(alpha0, (int)block.pixels[p][3]);
+		alpha1 = std::min(alpha1, (int)block.pixels[p][3]);
+	}
+	int alphaPalette[4], alphaIndices[16], alphaError = 0;
+	for (int i = 0; i < 4; i++) {
+		alphaPalette[i] = ((64 - bc7Weights2Bit[i]) * alpha0 + bc7Weights2Bit[i] * alpha1 + 32) >> 6;
+	}
+	for (int p = 0; p < 16; p++) {
+		int bestPixelError = 0x7FFFFFFF;
+		for (int i = 0; i < 4; i++) {
+			const int difference = alphaPalette[i] - block.pixels[p][3];
+			if (difference * difference < bestPixelError) {
+				bestPixelError = difference * difference;
+				alphaIndices[p] = i;
+			}
+		}
+		alphaError += bestPixelError;
+	}
+
+	//* Both index sets store the first pixel's index with only 1 bit
+	if (bestColorIndices[0] >= 2) {
+		std::swap(bestColor0, bestColor1);
+		for (int p = 0; p < 16; p++) {
+			bestColorIndices[p] = 3 - bestColorIndices[p];
+		}
+	}
+	if (alphaIndices[0] >= 2) {
+		std::swap(alpha0, alpha1);
+		for (int p = 0; p < 16; p++) {
+			alphaIndices[p] = 3 - alphaIndices[p];
+		}
+	}
+
+	BitWriter writer(output);
+	writer.write(1 << 5, 6);
+	// Rotation 0 means that no channels are swapped with alpha
+	writer.write(0, 2);
+	for (int c = 0; c < 3; c++) {
+		writer.write(bestColor0[c], 7);
+		writer.write(bestColor1[c], 7);
+	}
+	writer.write(alpha0, 8);
+	writer.write(alpha1, 8);
+	for (int p = 0; p < 16; p++) {
+		writer.write(bestColorIndices[p], p == 0 ? 1 : 2);
+	}
+	for (int p = 0; p < 16; p++) {
+		writer.write(alphaIndices[p], p == 0 ? 1 : 2);
+	}
+	return bestColorError + alphaError;
+}
+
+void encodeBC7(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	bool constantAlpha = true;
+	for (int p = 1; p < 16; p++) {
+		constantAlpha = constantAlpha && block.pixels[p][3] == block.pixels[0][3];
+	}
+	const int mode6Error = encodeBC7Mode6(block, quality, output);
+	if (constantAlpha || mode6Error == 0) {
+		return;
+	}
+
+	// Try separate alpha and keep whichever mode comes closer to the source block
+	unsigned char mode5Output[16];
+	if (encodeBC7Mode5(block, quality, mode5Output) < mode6Error) {
+		std::memcpy(output, mode5Output, 16);
+	}
+}
+
+void decodeBC7Mode5(const unsigned char* input, Block& block) {
+	BitReader reader(input);
+	reader.read(6);
+	const int rotation = (int)reader.read(2);
+	int color0[3], color1[3];
+	for (int c = 0; c < 3; c++) {
+		color0[c] = (int)reader.read(7);
+		color1[c] = (int)reader.read(7);
+		color0[c] = (color0[c] << 1) | (color0[c] >> 6);
+		color1[c] = (color1[c] << 1) | (color1[c] >> 6);
+	}
+	const int alpha0 = (int)reader.read(8);
+	const int alpha1 = (int)reader.read(8);
+	for (int p = 0; p < 16; p++) {
+		const int index = (int)reader.read(p == 0 ? 1 : 2);
+		for (int c = 0; c < 3; c++) {
+			block.pixels[p][c] = (unsigned char)(((64 - bc7Weights2Bit[index]) * color0[c] + bc7Weights2Bit[index] * color1[c] + 32) >> 6);
+		}
+	}
+	for (int p = 0; p < 16; p++) {
+		const int index = (int)reader.read(p == 0 ? 1 : 2);
+		block.pixels[p][3] = (unsigned char)(((64 - bc7Weights2Bit[index]) * alpha0 + bc7Weights2Bit[index] * alpha1 + 32) >> 6);
+		// A rotation swaps alpha with one of the color channels after decoding
+		if (rotation > 0) {
+			std::swap(block.pixels[p][3], block.pixels[p][rotation - 1]);
+		}
+	}
+}
+
+void decodeBC7(const unsigned char* input, Block& block) {
+	// The mode is the number of zero bits before the first 1; the bits after it already belong to the block
+	if ((input[0] & 0x3F) == (1 << 5)) {
+		decodeBC7Mode5(input, block);
+		return;
+	}
+	BitReader reader(input);
+	if (reader.read(7) != (1 << 6)) {
+		// Only modes 5 and 6 are produced by our encoder, everything else decodes to magenta to make it stand out
+		for (int p = 0; p < 16; p++) {
+			block.pixels[p][0] = 255;
+			block.pixels[p][1] = 0;
+			block.pixels[p][2] = 255;
+			block.pixels[p][3] = 255;
+		}
+		return;
+	}
+	int quantized0[4], quantized1[4];
+	for (int c = 0; c < 4; c++) {
+		quantized0[c] = (int)reader.read(7);
+		quantized1[c] = (int)reader.read(7);
+	}
+	const int pBit0 = (int)reader.read(1);
+	const int pBit1 = (int)reader.read(1);
+	int palette[16][4];
+	buildBC7Palette(quantized0, pBit0, quantized1, pBit1, palette);
+	for (int p = 0; p < 16; p++) {
+		const int index = (int)reader.read(p == 0 ? 3 : 4);
+		for (int c = 0; c < 4; c++) {
+			block.pixels[p][c] = (unsigned char)palette[index][c];
+		}
+	}
+}
+
+//* ETC2
+// We produce the "individual" and "differential" modes that ETC2 inherited from ETC1. The block is split into two halves
+// (2x4 or 4x2 depending on the flip bit), each with its own base color and a table of brightness offsets
+// In ETC2, pixel indices are stored column by column, so pixel (x, y) has the index x * 4 + y
+int findETCSubblockError(const Block& block, const int flip, const int subblock, const int baseColor[3], int& bestTable, int pixelIndices[16]) {
+	//* The modifiers shift all three channels by the same amount, so (ignoring clamping) the best modifier for a pixel
+	// is the one closest to the pixel's average offset from the base color. That saves us from trying all four
+	int averageOffsets[16];
+	for (int p = 0; p < 16; p++) {
+		averageOffsets[p] = (block.pixels[p][0] + block.pixels[p][1] + block.pixels[p][2] - baseColor[0] - baseColor[1] - baseColor[2]) / 3;
+	}
+
+	int bestError = 0x7FFFFFFF;
+	int tableIndices[16];
+	for (int table = 0; table < 8; table++) {
+		int error = 0;
+		for (int p = 0; p < 16 && error < bestError; p++) {
+			const int x = p % 4, y = p / 4;
+			if ((flip ? y / 2 : x / 2) != subblock) {
+				continue;
+			}
+			int modifier = 0, smallestDistance = 0x7FFFFFFF;
+			for (int i = 0; i < 4; i++) {
+				const int distance = std::abs(etcModifierTable[table][i] - averageOffsets[p]);
+				if (distance < smallestDistance) {
+					smallestDistance = distance;
+					modifier = i;
+				}
+			}
+			tableIndices[p] = modifier;
+			for (int c = 0; c < 3; c++) {
+				const int difference = clampByte(baseColor[c] + etcModifierTable[table][modifier]) - block.pixels[p][c];
+				error += difference * difference;
+			}
+		}
+		if (error < bestError) {
+			bestError = error;
+			bestTable = table;
+			for (int p = 0; p < 16; p++) {
+				const int x = p % 4, y = p / 4;
+				if ((flip ? y / 2 : x / 2) == subblock) {
+					pixelIndices[p] = tableIndices[p];
+				}
+			}
+		}
+	}
+	return bestError;
+}
+
+int expandETCColor(const int value, const int bits) {
+	return bits == 4 ? (value << 4) | value : (value << 3) | (value >> 2);
+}
+
+// Tries the given quantized base color and, for high quality, its neighbours along each channel
+// Returns the best error for the subblock and updates the base color, table and pixel indices accordingly
+int searchETCBaseColor(const Block& block, const int flip, const int subblock, const int bits, const bool searchNeighbours,
+	int quantized[3], int& bestTable, int pixelIndices[16]) {
+	const int maximum = (1 << bits) - 1;
+	const int center[3] = { quantized[0], quantized[1], quantized[2] };
+	const int offsets[7][3] = { { 0, 0, 0 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	int bestError = 0x7FFFFFFF;
+	for (int i = 0; i < (searchNeighbours ? 7 : 1); i++) {
+		const int candidate[3] = { center[0] + offsets[i][0], center[1] + offsets[i][1], center[2] + offsets[i][2] };
+		if (candidate[0] < 0 || candidate[1] < 0 || candidate[2] < 0 ||
+			candidate[0] > maximum || candidate[1] > maximum || candidate[2] > maximum) {
+			continue;
+		}
+		const int baseColor[3] = { expandETCColor(candidate[0], bits), expandETCColor(candidate[1], bits), expandETCColor(candidate[2], bits) };
+		int table, indices[16];
+		const int error = findETCSubblockError(block, flip, subblock, baseColor, table, indices);
+		if (error < bestError) {
+			bestError = error;
+			bestTable = table;
+			std::memcpy(quantized, candidate, sizeof(candidate));
+			for (int p = 0; p < 16; p++) {
+				const int x = p % 4, y = p / 4;
+				if ((flip ? y / 2 : x / 2) == subblock) {
+					pixelIndices[p] = indices[p];
+				}
+			}
+		}
+	}
+	return bestError;
+}
+
+void encodeETC2RGB(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	const bool searchNeighbours = quality == CompressionQuality::High;
+	unsigned long long bestBits = 0;
+	int bestError = 0x7FFFFFFF;
+
+	for (int flip = 0; flip < 2; flip++) {
+		//* Average color of both halves
+		float average[2][3] = {};
+		for (int p = 0; p < 16; p++) {
+			const int x = p % 4, y = p / 4;
+			const int subblock = flip ? y / 2 : x / 2;
+			for (int c = 0; c < 3; c++) {
+				average[subblock][c] += block.pixels[p][c] / 8.0f;
+			}
+		}
+
+		for (int differential = 0; differential < 2; differential++) {
+			const int bits = differential ? 5 : 4;
+			int quantized[2][3], tables[2], pixelIndices[16], error = 0;
+			for (int subblock = 0; subblock < 2; subblock++) {
+				for (int c = 0; c < 3; c++) {
+					quantized[subblock][c] = (int)(average[subblock][c] * ((1 << bits) - 1) / 255.0f + 0.5f);
+				}
+				error += searchETCBaseColor(block, flip, subblock, bits, searchNeighbours, quantized[subblock], tables[subblock], pixelIndices);
+			}
+			// In differential mode, the second color is stored as a 3 bit signed offset from the first one
+			// Offsets outside of [-4; 3] would turn the block into one of the other ETC2 modes, so we can't use those
+			bool valid = true;
+			if (differential) {
+				for (int c = 0; c < 3; c++) {
+					const int delta = quantized[1][c] - quantized[0][c];
+					valid = valid && delta >= -4 && delta <= 3;
+				}
+			}
+			if (!valid || error >= bestError) {
+				continue;
+			}
+			bestError = error;
+
+			//* Pack the block; ETC2 is stored big endian
+			unsigned long long blockBits = 0;
+			for (int c = 0; c < 3; c++) {
+				unsigned long long channel;
+				if (differential) {
+					channel = ((unsigned long long)quantized[0][c] << 3) | ((quantized[1][c] - quantized[0][c]) & 7);
+				}
+				else {
+					channel = ((unsigned long long)quantized[0][c] << 4) | quantized[1][c];
+				}
+				blockBits |= channel << (56 - 8 * c);
+			}
+			blockBits |= (unsigned long long)tables[0] << 37;
+			blockBits |= (unsigned long long)tables[1] << 34;
+			blockBits |= (unsigned long long)differential << 33;
+			blockBits |= (unsigned long long)flip << 32;
+			for (int p = 0; p < 16; p++) {
+				const int x = p % 4, y = p / 4;
+				const int bit = x * 4 + y;
+				// Modifier indices 0-3 map to the table columns [+a, +b, -a, -b], stored as separate most and least significant bits
+				blockBits |= (unsigned long long)(pixelIndices[p] >> 1) << (16 + bit);
+				blockBits |= (unsigned long long)(pixelIndices[p] & 1) << bit;
+			}
+			bestBits = blockBits;
+		}
+	}
+
+	for (int i = 0; i < 8; i++) {
+		output[i] = (unsigned char)(bestBits >> (56 - 8 * i));
+	}
+}
+
+void decodeETC2RGB(const unsigned char* input, Block& block) {
+	unsigned long long blockBits = 0;
+	for (int i = 0; i < 8; i++) {
+		blockBits = (blockBits << 8) | input[i];
+	}
+	const int differential = (int)((blockBits >> 33) & 1);
+	const int flip = (int)((blockBits >> 32) & 1);
+	const int tables[2] = { (int)((blockBits >> 37) & 7), (int)((blockBits >> 34) & 7) };
+	int baseColors[2][3];
+	for (int c = 0; c < 3; c++) {
+		const int channel = (int)((blockBits >> (56 - 8 * c)) & 0xFF);
+		if (differential) {
+			const int color0 = channel >> 3;
+			// Sign extend the 3 bit offset
+			const int delta = ((channel & 7) ^ 4) - 4;
+			baseColors[0][c] = expandETCColor(color0, 5);
+			baseColors[1][c] = expandETCColor((color0 + delta) & 31, 5);
+		}
+		else {
+			baseColors[0][c] = expandETCColor(channel >> 4, 4);
+			baseColors[1][c] = expandETCColor(channel & 15, 4);
+		}
+	}
+	for (int p = 0; p < 16; p++) {
+		const int x = p % 4, y = p / 4;
+		const int bit = x * 4 + y;
+		const int subblock = flip ? y / 2 : x / 2;
+		const int modifier = (int)((((blockBits >> (16 + bit)) & 1) << 1) | ((blockBits >> bit) & 1));
+		for (int c = 0; c < 3; c++) {
+			block.pixels[p][c] = (unsigned char)clampByte(baseColors[subblock][c] + etcModifierTable[tables[subblock]][modifier]);
+		}
+		block.pixels[p][3] = 255;
+	}
+}
+
+//* EAC (the alpha half of ETC2 RGBA)
+void encodeEACAlpha(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	int minimum = 255, maximum = 0;
+	for (int p = 0; p < 16; p++) {
+		minimum = std::min(minimum, (int)block.pixels[p][3]);
+		maximum = std::max(maximum, (int)block.pixels[p][3]);
+	}
+	const int base = (minimum + maximum + 1) / 2;
+
+	unsigned long long bestBits = 0;
+	int bestError = 0x7FFFFFFF;
+	for (int table = 0; table < 16; table++) {
+		//* The multiplier scales the table so that it spans the block's alpha range
+		// High quality additionally tries the neighbouring multipliers
+		const int tableRange = eacModifierTable[table][7] - eacModifierTable[table][3];
+		const int estimatedMultiplier = std::min(std::max((maximum - minimum + tableRange / 2) / tableRange, 1), 15);
+		const int multiplierRadius = quality == CompressionQuality::High ? 1 : 0;
+		for (int multiplier = std::max(estimatedMultiplier - multiplierRadius, 1); multiplier <= std::min(estimatedMultiplier + multiplierRadius, 15); multiplier++) {
+			unsigned long long blockBits = ((unsigned long long)base << 56) | ((unsigned long long)multiplier << 52) | ((unsigned long long)table << 48);
+			int error = 0;
+			for (int p = 0; p < 16 && error < bestError; p++) {
+				int bestPixelError = 256, bestIndex = 0;
+				for (int i = 0; i < 8; i++) {
+					const int pixelError = std::abs(clampByte(base + eacModifierTable[table][i] * multiplier) - block.pixels[p][3]);
+					if (pixelError < bestPixelError) {
+						bestPixelError = pixelError;
+						bestIndex = i;
+					}
+				}
+				error += bestPixelError * bestPixelError;
+				const int x = p % 4, y = p / 4;
+				blockBits |= (unsigned long long)bestIndex << (45 - 3 * (x * 4 + y));
+			}
+			if (error < bestError) {
+				bestError = error;
+				bestBits = blockBits;
+			}
+		}
+	}
+
+	for (int i = 0; i < 8; i++) {
+		output[i] = (unsigned char)(bestBits >> (56 - 8 * i));
+	}
+}
+
+void decodeEACAlpha(const unsigned char* input, Block& block) {
+	unsigned long long blockBits = 0;
+	for (int i = 0; i < 8; i++) {
+		blockBits = (blockBits << 8) | input[i];
+	}
+	const int base = (int)(blockBits >> 56);
+	const int multiplier = (int)((blockBits >> 52) & 15);
+	const int table = (int)((blockBits >> 48) & 15);
+	for (int p = 0; p < 16; p++) {
+		const int x = p % 4, y = p / 4;
+		const int index = (int)((blockBits >> (45 - 3 * (x * 4 + y))) & 7);
+		block.pixels[p][3] = (unsigned char)clampByte(base + eacModifierTable[table][index] * multiplier);
+	}
+}
+
+void encodeETC2RGBA(const Block& block, const CompressionQuality quality, unsigned char* output) {
+	encodeEACAlpha(block, quality, output);
+	encodeETC2RGB(block, quality, output + 8);
+}
+
+void decodeETC2RGBA(const unsigned char* input, Block& block) {
+	decodeETC2RGB(input + 8, block);
+	decodeEACAlpha(input, block);
+}
+
+void encodeBlock(const Block& block, const CompressedFormat format, const CompressionQuality quality, unsigned char* output) {
+	switch (format) {
+	case CompressedFormat::BC1:
+		encodeBC1(block, quality, output);
+		break;
+	case CompressedFormat::BC3:
+		encodeBC3(block, quality, output);
+		break;
+	case CompressedFormat::BC7:
+		encodeBC7(block, quality, output);
+		break;
+	case CompressedFormat::ETC2_RGB:
+		encodeETC2RGB(block, quality, output);
+		break;
+	case CompressedFormat::ETC2_RGBA:
+		encodeETC2RGBA(block, quality, output);
+		break;
+	default:
+		break;
+	}
+}
+
+void decodeBlock(const unsigned char* input, const CompressedFormat format, Block& block) {
+	switch (format) {
+	case CompressedFormat::BC1:
+		decodeBC1(input, block);
+		break;
+	case CompressedFormat::BC3:
+		decodeBC3(input, block);
+		break;
+	case CompressedFormat::BC7:
+		decodeBC7(input, block);
+		break;
+	case CompressedFormat::ETC2_RGB:
+		decodeETC2RGB(input, block);
+		break;
+	case CompressedFormat::ETC2_RGBA:
+		decodeETC2RGBA(input, block);
+		break;
+	default:
+		break;
+	}
+}
+
+bool hasExtension(const char* extensionName) {
+	int extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (int i = 0; i < extensionCount; i++) {
+		const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if (extension != nullptr && std::strcmp(extension, extensionName) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool hasVersion(const int major, const int minor) {
+	int contextMajor = 0, contextMinor = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+	glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+	return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+const char* getFormatName(const CompressedFormat format) {
+	switch (format) {
+	case CompressedFormat::BC1:
+		return "BC1";
+	case CompressedFormat::BC3:
+		return "BC3";
+	case CompressedFormat::BC7:
+		return "BC7";
+	case CompressedFormat::ETC2_RGB:
+		return "ETC2 RGB";
+	case CompressedFormat::ETC2_RGBA:
+		return "ETC2 RGBA";
+	default:
+		return "None";
+	}
+}
+
+//** Public **//
+// Picks the best format the current OpenGL context supports. Requires a current context
+CompressedFormat TextureCompressor::chooseFormat(const bool hasAlpha, const CompressionQuality quality) {
+	//* Candidates in order of preference
+	// BC7 gives the best quality but takes the longest to encode, so it is only used for high quality
+	// Without alpha, BC1 needs half the memory of BC3 / BC7, so it is preferred for fast compression
+	CompressedFormat candidates[3];
+	if (quality == CompressionQuality::High) {
+		candidates[0] = CompressedFormat::BC7;
+		candidates[1] = hasAlpha ? CompressedFormat::BC3 : CompressedFormat::BC1;
+	}
+	else {
+		candidates[0] = hasAlpha ? CompressedFormat::BC3 : CompressedFormat::BC1;
+		candidates[1] = CompressedFormat::BC7;
+	}
+	candidates[2] = hasAlpha ? CompressedFormat::ETC2_RGBA : CompressedFormat::ETC2_RGB;
+
+	for (int i = 0; i < 3; i++) {
+		if (isSupported(candidates[i])) {
+			return candidates[i];
+		}
+	}
+	return CompressedFormat::None;
+}
+
+bool TextureCompressor::isSupported(const CompressedFormat format) {
+	switch (format) {
+	case CompressedFormat::BC1:
+	case CompressedFormat::BC3:
+		return hasExtension("GL_EXT_texture_compression_s3tc");
+	case CompressedFormat::BC7:
+		// BPTC is core since OpenGL 4.2
+		return hasVersion(4, 2) || hasExtension("GL_ARB_texture_compression_bptc");
+	case CompressedFormat::ETC2_RGB:
+	case CompressedFormat::ETC2_RGBA:
+		// ETC2 is core since OpenGL 4.3 (though desktop drivers often decompress it on the CPU)
+		return hasVersion(4, 3) || hasExtension("GL_ARB_ES3_compatibility");
+	default:
+		return true;
+	}
+}
+
+unsigned int TextureCompressor::getInternalFormat(const CompressedFormat format) {
+	switch (format) {
+	case CompressedFormat::BC1:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case CompressedFormat::BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case CompressedFormat::BC7:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	case CompressedFormat::ETC2_RGB:
+		return GL_COMPRESSED_RGB8_ETC2;
+	case CompressedFormat::ETC2_RGBA:
+		return GL_COMPRESSED_RGBA8_ETC2_EAC;
+	default:
+		return 0;
+	}
+}
+
+size_t TextureCompressor::calculateCompressedSize(const int width, const int height, const CompressedFormat format) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+bool TextureCompressor::hasTranslucentPixels(const unsigned char* imageData, const int width, const int height, const int numberOfColorChannels) {
+	if (numberOfColorChannels < 4) {
+		return false;
+	}
+	for (size_t i = 0; i < (size_t)width * height; i++) {
+		if (imageData[i * 4 + 3] != 255) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TextureCompressor::compress(const unsigned char* imageData, const int width, const int height, const int numberOfColorChannels,
+	const CompressedFormat format, const CompressionQuality quality, std::vector<unsigned char>& compressedData) {
+	const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	const size_t blockSize = getBlockSize(format);
+	compressedData.resize(calculateCompressedSize(width, height, format));
+	unsigned char* output = compressedData.data();
+
+	//* Blocks are independent of each other, so rows of blocks are split between the threads of the job system
+	// compress() is mostly called by jobs itself, which is fine as waiting for the rows runs other jobs in the meantime
+	// Each range holds at least 256 blocks, as small mip levels aren't worth handing out
+	const unsigned int rowsPerRange = (unsigned int)std::max(256 / blocksX, 1);
+	JobSystem::parallelFor((unsigned int)blocksY, rowsPerRange, [=](const unsigned int firstRow, const unsigned int lastRow) {
+		Block block;
+		for (int blockY = (int)firstRow; blockY < (int)lastRow; blockY++) {
+			for (int blockX = 0; blockX < blocksX; blockX++) {
+				fetchBlock(imageData, width, height, numberOfColorChannels, blockX, blockY, block);
+				encodeBlock(block, format, quality, output + ((size_t)blockY * blocksX + blockX) * blockSize);
+			}
+		}
+	});
+}
+
+void TextureCompressor::decompress(const std::vector<unsigned char>& compressedData, const int width, const int height,
+	const CompressedFormat format, std::vector<unsigned char>& rgbaData) {
+	const int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	const size_t blockSize = getBlockSize(format);
+	rgbaData.resize((size_t)width * height * 4);
+
+	Block block;
+	for (int blockY = 0; blockY < blocksY; blockY++) {
+		for (int blockX = 0; blockX < blocksX; blockX++) {
+			decodeBlock(&compressedData[((size_t)blockY * blocksX + blockX) * blockSize], format, block);
+			storeBlock(block, width, height, blockX, blockY, rgbaData.data());
+		}
+	}
+}
+
+void TextureCompressor::printReport(const std::vector<std::string>& imagePaths) {
+	const CompressedFormat formats[5] = { CompressedFormat::BC1, CompressedFormat::BC3, CompressedFormat::BC7, CompressedFormat::ETC2_RGB, CompressedFormat::ETC2_RGBA };
+	const CompressionQuality qualities[2] = { CompressionQuality::Fast, CompressionQuality::High };
+
+	// Runs without the engine, so it starts a job system of its own with one thread per CPU core
+	JobSystem::initialize(0);
+	std::cout << "Texture compression report (" << JobSystem::getThreadCount() << " threads)\n";
+	std::cout << std::left << std::setw(32) << "Image" << std::setw(11) << "Format" << std::setw(9) << "Quality"
+		<< std::right << std::setw(12) << "MPixels/s" << std::setw(11) << "PSNR (dB)" << std::setw(10) << "Ratio" << "\n";
+
+	for (unsigned int i = 0; i < imagePaths.size(); i++) {
+		int width, height, numberOfColorChannels;
+		unsigned char* imageData = stbi_load(imagePaths[i].c_str(), &width, &height, &numberOfColorChannels, 0);
+		if (!imageData) {
+			std::cout << "Error: Failed to load " << imagePaths[i] << "\n";
+			continue;
+		}
+		const size_t uncompressedSize = (size_t)width * height * numberOfColorChannels;
+
+		for (int f = 0; f < 5; f++) {
+			// Formats without alpha would compare unfairly on images with alpha and vice versa
+			const bool formatHasAlpha = formats[f] == CompressedFormat::BC3 || formats[f] == CompressedFormat::ETC2_RGBA;
+			if (formatHasAlpha != (numberOfColorChannels == 4) && formats[f] != CompressedFormat::BC7) {
+				continue;
+			}
+			for (int q = 0; q < 2; q++) {
+				std::vector<unsigned char> compressedData, decompressedData;
+				auto start = std::chrono::steady_clock::now();
+				compress(imageData, width, height, numberOfColorChannels, formats[f], qualities[q], compressedData);
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				decompress(compressedData, width, height, formats[f], decompressedData);
+
+				//* Peak signal to noise ratio over all channels of the source image
+				double squaredError = 0.0;
+				for (size_t p = 0; p < (size_t)width * height; p++) {
+					for (int c = 0; c < numberOfColorChannels; c++) {
+						const double difference = (double)imageData[p * numberOfColorChannels + c] - decompressedData[p * 4 + c];
+						squaredError += difference * difference;
+					}
+				}
+				const double meanSquaredError = squaredError / uncompressedSize;
+				const double psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.99;
+
+				std::cout << std::left << std::setw(32) << imagePaths[i] << std::setw(11) << getFormatName(formats[f])
+					<< std::setw(9) << (qualities[q] == CompressionQuality::Fast ? "Fast" : "High") << std::right << std::fixed
+					<< std::setw(12) << std::setprecision(1) << width * (double)height / seconds / 1e6
+					<< std::setw(11) << std::setprecision(2) << psnr
+					<< std::setw(9) << std::setprecision(1) << (double)uncompressedSize / compressedData.size() << "x\n";
+			}
+		}
+		stbi_image_free(imageData);
+	}
+	std::cout << std::endl;
+	JobSystem::shutdown();
+}
\ No newline at end of file
@@ -0,0 +1,508 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+// Seems strange, but this is the correct way of including stb_image.h
+#define STB_IMAGE_IMPLEMENTATION
+#include "STB/stb_image.h"
+
+#include "textureStreamer.hpp"
+#include "textureCompressor.hpp"
+#include "uploadManager.hpp"
+#include "jobSystem.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Mip levels with a width and height of at most this many pixels form the "mip tail"
+// The tail is uploaded on loading and never evicted, so every texture is always renderable (if blurry)
+const unsigned int mipTailSize = 64;
+
+struct MipLevel {
+	int width, height;
+	std::vector<unsigned char> imageData;	// Block compressed if the texture has a compressed format
+};
+
+struct StreamedTexture {
+	unsigned int textureID;
+	GLTexture glTexture;	// Owns the texture with the ID above, empty while the texture is being decoded in a TextureLoad
+	size_t residentBytes;	// Bytes of the mip levels that are allocated on the GPU
+	unsigned int rgbType;
+	int numberOfColorChannels;
+	CompressedFormat compressedFormat;
+	std::vector<MipLevel> mipLevels;
+
+	int tailBaseLevel;		// Coarsest level that is not part of the mip tail (= first level that is always resident)
+	int residentBaseLevel;	// Finest mip level that is resident and visible to the sampler (= GL_TEXTURE_BASE_LEVEL)
+	int pendingLevel;		// Mip level whose upload is still in flight, -1 if none
+	bool tailResident;		// Whether the mip tail has arrived on the GPU, the texture mustn't be sampled before that
+	bool decoding;			// Whether the image is still being decoded by the job system
+	bool unloadRequested;	// Unloaded while decoding; the texture is deleted once the decode is done
+
+	int requestedLevel;		// Finest mip level requested by the objects drawn this frame
+	unsigned long long lastUsedFrame;
+};
+
+std::vector<StreamedTexture> textures;
+size_t memoryBudget;
+CompressionQuality compressionQuality;
+size_t residentMemory = 0;
+unsigned long long frameCounter = 0;
+
+size_t calculateLevelSize(const StreamedTexture& texture, const int level) {
+	return texture.mipLevels[level].imageData.size();
+}
+
+StreamedTexture* findTexture(const unsigned int textureID) {
+	for (unsigned int i = 0; i < textures.size(); i++) {
+		if (textures[i].textureID == textureID) {
+			return &textures[i];
+		}
+	}
+	return nullptr;
+}
+
+void eraseTexture(const StreamedTexture* texture) {
+	UploadManager::cancelTextureUploads(texture->textureID);
+	residentMemory -= texture->residentBytes;
+	textures.erase(textures.begin() + (texture - &textures[0]));
+}
+
+// Builds the complete mip chain on the CPU so that single levels can be uploaded (and dropped again) later on
+// This replaces glGenerateMipmap() which would need the full resolution image to be resident on the GPU
+void generateMipChain(StreamedTexture& texture) {
+	const int channels = texture.numberOfColorChannels;
+
+	while (texture.mipLevels.back().width > 1 || texture.mipLevels.back().height > 1) {
+		const MipLevel& source = texture.mipLevels.back();
+		MipLevel destination;
+		destination.width = source.width > 1 ? source.width / 2 : 1;
+		destination.height = source.height > 1 ? source.height / 2 : 1;
+		destination.imageData.resize((size_t)destination.width * destination.height * channels);
+
+		//* Simple 2x2 box filter
+		// For odd sizes, the last row / column of the source is dropped which is the same thing most drivers do
+		for (int y = 0; y < destination.height; y++) {
+			const int sourceY0 = std::min(y * 2, source.height - 1);
+			const int sourceY1 = std::min(y * 2 + 1, source.height - 1);
+			for (int x = 0; x < destination.width; x++) {
+				const int sourceX0 = std::min(x * 2, source.width - 1);
+				const int sourceX1 = std::min(x * 2 + 1, source.width - 1);
+				for (int c = 0; c < channels; c++) {
+					const unsigned int sum =
+						source.imageData[((size_t)sourceY0 * source.width + sourceX0) * channels + c] +
+						source.imageData[((size_t)sourceY0 * source.width + sourceX1) * channels + c] +
+						source.imageData[((size_t)sourceY1 * source.width + sourceX0) * channels + c] +
+						source.imageData[((size_t)sourceY1 * source.width + sourceX1) * channels + c];
+					destination.imageData[((size_t)y * destination.width + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+
+		texture.mipLevels.push_back(std::move(destination));
+	}
+}
+
+// Block compressed data is handed to OpenGL as is, together with its internal format
+// Uncompressed data is described by its pixel format (GL_RGB or GL_RGBA), which we also use as the internal format
+unsigned int getInternalFormat(const StreamedTexture& texture) {
+	return texture.compressedFormat != CompressedFormat::None ? TextureCompressor::getInternalFormat(texture.compressedFormat) : texture.rgbType;
+}
+
+// Hands a level to the upload manager which copies it to the GPU in the background
+// Its storage is allocated right away, so it counts towards the memory budget from now on
+void uploadLevel(StreamedTexture& texture, const int level, const std::function<void()>& onComplete) {
+	const MipLevel& mipLevel = texture.mipLevels[level];
+	const bool compressed = texture.compressedFormat != CompressedFormat::None;
+	UploadManager::uploadTexture(texture.textureID, level, mipLevel.width, mipLevel.height, getInternalFormat(texture), compressed,
+		&mipLevel.imageData[0], mipLevel.imageData.size(), onComplete);
+
+	residentMemory += calculateLevelSize(texture, level);
+	texture.residentBytes += calculateLevelSize(texture, level);
+	texture.glTexture.setSize(texture.residentBytes);
+}
+
+// Drops the finest resident level of a texture from GPU memory
+void evictLevel(StreamedTexture& texture) {
+	const int level = texture.residentBaseLevel;
+
+	//* First, stop the sampler from reading from the level, then free it
+	// Levels below GL_TEXTURE_BASE_LEVEL are ignored for texture completeness, so re-specifying one with a size of 0x0 is legal
+	// and releases its storage. The level keeps the internal format of the other levels, so block compressed textures
+	// re-specify it as an empty compressed image
+	glBindTexture(GL_TEXTURE_2D, texture.textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+	if (texture.compressedFormat != CompressedFormat::None) {
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, getInternalFormat(texture), 0, 0, 0, 0, nullptr);
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, level, texture.rgbType, 0, 0, 0, texture.rgbType, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	texture.residentBaseLevel = level + 1;
+	residentMemory -= calculateLevelSize(texture, level);
+	texture.residentBytes -= calculateLevelSize(texture, level);
+	texture.glTexture.setSize(texture.residentBytes);
+}
+
+// Called by the upload manager once a streamed in level has arrived on the GPU; lets the sampler use it
+void completeUpload(const unsigned int textureID, const int level) {
+	StreamedTexture* texture = findTexture(textureID);
+	if (texture == nullptr) {
+		return;
+	}
+
+	texture->residentBaseLevel = level;
+	texture->pendingLevel = -1;
+
+	// Only now that the data is resident, the level is unclamped for sampling
+	glBindTexture(GL_TEXTURE_2D, texture->textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture->residentBaseLevel);
+}
+
+// Returns the texture that has gone unused the longest and still has a level that may be evicted, nullptr if there is none
+// Levels that are requested by objects of the current frame are never evicted, otherwise they would be streamed in again right away
+StreamedTexture* findEvictionCandidate(const StreamedTexture* excludedTexture) {
+	StreamedTexture* candidate = nullptr;
+	for (unsigned int i = 0; i < textures.size(); i++) {
+		StreamedTexture& texture = textures[i];
+		if (&texture == excludedTexture || texture.pendingLevel >= 0 || texture.residentBaseLevel >= texture.tailBaseLevel) {
+			continue;
+		}
+		if (texture.lastUsedFrame == frameCounter && texture.residentBaseLevel >= texture.requestedLevel) {
+			continue;
+		}
+		if (candidate == nullptr || texture.lastUsedFrame < candidate->lastUsedFrame) {
+			candidate = &texture;
+		}
+	}
+	return candidate;
+}
+
+// Evicts least recently used levels until the given amount of bytes additionally fits into the memory budget
+bool makeRoom(const size_t requiredBytes, const StreamedTexture* excludedTexture) {
+	while (residentMemory + requiredBytes > memoryBudget) {
+		StreamedTexture* candidate = findEvictionCandidate(excludedTexture);
+		if (candidate == nullptr) {
+			return false;
+		}
+		evictLevel(*candidate);
+	}
+	return true;
+}
+
+// A texture that is being decoded on a worker thread, owned by the jobs that load it
+// The OpenGL texture itself stays with the placeholder in textures, as only the main thread may delete it
+struct TextureLoad {
+	std::string texturePath;
+	unsigned int textureID;
+	StreamedTexture texture;
+	CompressedFormat opaqueFormat, translucentFormat;
+	bool failed;
+};
+
+// Loads that haven't been taken over by the main thread yet; shutdown() deletes those whose jobs were dropped
+std::vector<TextureLoad*> textureLoads;
+
+// Runs on the main thread once the texture is decoded: takes it over and uploads its mip tail
+void finishTextureLoad(void* data) {
+	TextureLoad* load = static_cast<TextureLoad*>(data);
+	textureLoads.erase(std::find(textureLoads.begin(), textureLoads.end(), load));
+	StreamedTexture* texture = findTexture(load->textureID);
+	// The texture was unloaded while it was being decoded, so nobody is waiting for it anymore
+	if (texture->unloadRequested) {
+		eraseTexture(texture);
+		delete load;
+		return;
+	}
+	if (load->failed) {
+		// Without any image data, the texture stays empty
+		texture->decoding = false;
+		delete load;
+		return;
+	}
+	load->texture.glTexture = std::move(texture->glTexture);
+	*texture = std::move(load->texture);
+	delete load;
+
+	//* Upload only the mip tail
+	// The texture becomes usable once its last (= coarsest) level has arrived as uploads complete in order
+	texture->tailBaseLevel = (int)texture->mipLevels.size() - 1;
+	while (texture->tailBaseLevel > 0 &&
+		texture->mipLevels[texture->tailBaseLevel - 1].width <= (int)mipTailSize &&
+		texture->mipLevels[texture->tailBaseLevel - 1].height <= (int)mipTailSize) {
+		texture->tailBaseLevel--;
+	}
+	texture->tailResident = false;
+	texture->decoding = false;
+	const unsigned int textureID = texture->textureID;
+	for (int level = texture->tailBaseLevel; level < (int)texture->mipLevels.size() - 1; level++) {
+		uploadLevel(*texture, level, nullptr);
+	}
+	uploadLevel(*texture, (int)texture->mipLevels.size() - 1, [textureID]() {
+		StreamedTexture* texture = findTexture(textureID);
+		if (texture != nullptr) {
+			texture->tailResident = true;
+		}
+	});
+
+	//* Clamp the sampler to the resident levels
+	// GL_TEXTURE_BASE_LEVEL is the finest level the sampler may use, GL_TEXTURE_MAX_LEVEL the coarsest one
+	glBindTexture(GL_TEXTURE_2D, texture->textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, texture->tailBaseLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)texture->mipLevels.size() - 1);
+
+	texture->residentBaseLevel = texture->tailBaseLevel;
+	texture->pendingLevel = -1;
+	texture->requestedLevel = texture->tailBaseLevel;
+	texture->lastUsedFrame = 0;
+}
+
+// Runs on a worker thread: everything that doesn't need OpenGL, i.e. decoding, building the mip chain and compressing
+void decodeTexture(void* data) {
+	TextureLoad* load = static_cast<TextureLoad*>(data);
+	StreamedTexture& texture = load->texture;
+	int width, height;
+
+	//* Load the image from file
+	// 1st argument takes a const char* to the filepath
+	// 2nd, 3rd and 4th argument take pointers to store width, height and number of color channels in
+	// 5th argument can be used to force number of 8-bit components per pixel. We don't need that, so we leave it at 0
+	// As much as I hate it, stbi_load actually requires you to store a raw pointer, there's no way around it
+	// Otherwise you won't be able to call stbi_image_free later on
+	unsigned char* imageData = stbi_load(load->texturePath.c_str(), &width, &height, &texture.numberOfColorChannels, 0);
+	// 3 color channels means no alpha channel, 4 means there is one
+	switch (texture.numberOfColorChannels) {
+	case 3:
+		texture.rgbType = GL_RGB;
+		break;
+	case 4:
+		texture.rgbType = GL_RGBA;
+		break;
+	default:
+		std::cout << "Error: Image's color channels were not properly recognized." << "\n";
+		std::cout << "Image has " << texture.numberOfColorChannels << " color channels." << std::endl;
+
+		if (texture.numberOfColorChannels < 0) {
+			std::cout << "Are you sure the specified file exists?\n" << std::endl;
+		}
+	}
+
+	if (!imageData || texture.rgbType == 0) {
+		std::cout << "Error: Failed to load texture\n" << std::endl;
+		stbi_image_free(imageData);
+		load->failed = true;
+		JobSystem::runOnMainThread(finishTextureLoad, load);
+		return;
+	}
+
+	//* Keep a CPU copy of the full mip chain; the GPU only ever holds the part of it that is actually needed
+	MipLevel baseLevel;
+	baseLevel.width = width;
+	baseLevel.height = height;
+	baseLevel.imageData.assign(imageData, imageData + (size_t)width * height * texture.numberOfColorChannels);
+	texture.mipLevels.push_back(std::move(baseLevel));
+	// Free the image from memory
+	stbi_image_free(imageData);
+	generateMipChain(texture);
+
+	//* Block compress all levels if the GPU supports a suitable format, otherwise they are kept uncompressed
+	// RGBA images whose alpha channel is fully opaque are treated like RGB images as that allows for smaller formats
+	const MipLevel& fullResolution = texture.mipLevels[0];
+	bool hasAlpha = TextureCompressor::hasTranslucentPixels(&fullResolution.imageData[0], width, height, texture.numberOfColorChannels);
+	texture.compressedFormat = hasAlpha ? load->translucentFormat : load->opaqueFormat;
+	if (texture.compressedFormat != CompressedFormat::None) {
+		for (unsigned int level = 0; level < texture.mipLevels.size(); level++) {
+			MipLevel& mipLevel = texture.mipLevels[level];
+			std::vector<unsigned char> compressedData;
+			TextureCompressor::compress(&mipLevel.imageData[0], mipLevel.width, mipLevel.height, texture.numberOfColorChannels,
+				texture.compressedFormat, compressionQuality, compressedData);
+			mipLevel.imageData.swap(compressedData);
+		}
+	}
+
+	// Uploading needs OpenGL, so the main thread takes over from here
+	JobSystem::runOnMainThread(finishTextureLoad, load);
+}
+
+//** Public **//
+void TextureStreamer::initialize(const size_t memoryBudgetBytes, const CompressionQuality quality) {
+	memoryBudget = memoryBudgetBytes;
+	compressionQuality = quality;
+}
+
+// Starts loading a texture and returns its ID right away; the image is decoded, mipmapped and compressed by the job system
+// The texture can be bound immediately, but isResident() only returns true once its mip tail has been uploaded
+unsigned int TextureStreamer::loadTexture(const std::string& texturePath) {
+	StreamedTexture texture;
+	texture.rgbType = 0;
+	texture.numberOfColorChannels = 0;
+	texture.compressedFormat = CompressedFormat::None;
+	texture.tailBaseLevel = 0;
+	texture.residentBaseLevel = 0;
+	texture.pendingLevel = -1;
+	texture.tailResident = false;
+	texture.decoding = true;
+	texture.unloadRequested = false;
+	texture.requestedLevel = 0;
+	texture.lastUsedFrame = 0;
+	texture.residentBytes = 0;
+
+	//* Generate a new empty texture
+	// The GLTexture stores the assigned ID and deletes the texture once it is unloaded
+	texture.glTexture = GLTexture(GLMemoryCategory::Textures, "Streamed texture");
+	texture.textureID = texture.glTexture.getID();
+	// Tells OpenGL which texture we are currently working with. First argument specifies the texture type, second one takes the ID
+	glBindTexture(GL_TEXTURE_2D, texture.textureID);
+
+	//* Set texture wrapping to "Mirror" on both axes (-> S-axe and T-axe which correspond to x and y)
+	// First argument is texture type, second argument the parameter to modify, third argument the desired value of the parameter
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+	// Set texture filtering to "Linear"
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// Set mipmapping to "Linear / Linear"
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+
+	//* Hand the rest to a worker thread
+	// Choosing the compressed format asks OpenGL for the supported extensions, so that is done here for both cases
+	TextureLoad* load = new TextureLoad();
+	load->texturePath = texturePath;
+	load->textureID = texture.textureID;
+	load->texture.textureID = texture.textureID;
+	load->texture.rgbType = 0;
+	load->texture.numberOfColorChannels = 0;
+	load->texture.residentBytes = 0;
+	load->opaqueFormat = TextureCompressor::chooseFormat(false, compressionQuality);
+	load->translucentFormat = TextureCompressor::chooseFormat(true, compressionQuality);
+	load->failed = false;
+
+	const unsigned int textureID = texture.textureID;
+	textures.push_back(std::move(texture));
+	textureLoads.push_back(load);
+	JobSystem::run(decodeTexture, load);
+	return textureID;
+}
+
+// Called by every object using the texture each frame. The largest requested size wins
+void TextureStreamer::requestScreenSize(const unsigned int textureID, const float screenSizeInPixels) {
+	StreamedTexture* texture = findTexture(textureID);
+	if (texture == nullptr || texture->mipLevels.empty()) {
+		return;
+	}
+
+	// The texture's largest side should roughly map to one texel per pixel; every halving of the on-screen size allows for one coarser level
+	const MipLevel& baseLevel = texture->mipLevels[0];
+	const float largestSide = (float)std::max(baseLevel.width, baseLevel.height);
+	int level = 0;
+	if (screenSizeInPixels > 0.0f && screenSizeInPixels < largestSide) {
+		level = (int)std::floor(std::log2(largestSide / screenSizeInPixels));
+	}
+	else if (screenSizeInPixels <= 0.0f) {
+		level = texture->tailBaseLevel;
+	}
+	level = std::min(level, texture->tailBaseLevel);
+
+	if (texture->lastUsedFrame != frameCounter) {
+		texture->lastUsedFrame = frameCounter;
+		texture->requestedLevel = level;
+	}
+	else if (level < texture->requestedLevel) {
+		texture->requestedLevel = level;
+	}
+}
+
+// Processes the requests of the last frame. Should be called once per frame before rendering
+void TextureStreamer::update() {
+	//* Stream in the next finer level of the textures that need it most
+	// A texture that has gone unused for a frame does not request anything, so it only keeps what it has until it is evicted
+	while (true) {
+		StreamedTexture* mostNeeded = nullptr;
+		int largestDeficit = 0;
+		for (unsigned int i = 0; i < textures.size(); i++) {
+			StreamedTexture& texture = textures[i];
+			if (!texture.tailResident || texture.pendingLevel >= 0 || texture.lastUsedFrame != frameCounter) {
+				continue;
+			}
+			int deficit = texture.residentBaseLevel - texture.requestedLevel;
+			if (deficit > largestDeficit) {
+				largestDeficit = deficit;
+				mostNeeded = &texture;
+			}
+		}
+		if (mostNeeded == nullptr) {
+			break;
+		}
+
+		//* Levels are streamed in one at a time from coarse to fine
+		// That way, a texture improves gradually and never waits for a large level while a smaller one would already help
+		const int level = mostNeeded->residentBaseLevel - 1;
+		const size_t levelSize = calculateLevelSize(*mostNeeded, level);
+		// Don't queue more than the upload manager gets through in a frame, so that next frame's requests can still take priority
+		if (UploadManager::getQueuedBytes() >= UploadManager::getUploadBudget()) {
+			break;
+		}
+		if (!makeRoom(levelSize, mostNeeded)) {
+			// Nothing can be evicted anymore without hurting the current frame; clamp the request to what fits
+			mostNeeded->requestedLevel = mostNeeded->residentBaseLevel;
+			continue;
+		}
+
+		//* Upload the level, but keep the sampler clamped to the previous one while it is in flight
+		const unsigned int textureID = mostNeeded->textureID;
+		uploadLevel(*mostNeeded, level, [textureID, level]() { completeUpload(textureID, level); });
+		mostNeeded->pendingLevel = level;
+	}
+
+	//* Enforce the budget in case it has been lowered in the meantime
+	makeRoom(0, nullptr);
+
+	// Requests are collected anew for the following frame
+	frameCounter++;
+}
+
+// Deletes a texture along with its CPU copy. Its ID must not be used anymore afterwards
+// Uploads that are still in flight find the texture gone and are dropped
+void TextureStreamer::unloadTexture(const unsigned int textureID) {
+	StreamedTexture* texture = findTexture(textureID);
+	if (texture == nullptr) {
+		return;
+	}
+	//* A texture that is still being decoded can't be deleted yet: its ID could be handed out again right away,
+	// and the decoded image would then be taken for the new texture
+	if (texture->decoding) {
+		texture->unloadRequested = true;
+		return;
+	}
+	eraseTexture(texture);
+}
+
+// Deletes all textures. Has to be called while the OpenGL context still exists, after JobSystem::shutdown() has dropped the jobs
+// of the loads that are still in flight
+void TextureStreamer::shutdown() {
+	for (TextureLoad* load : textureLoads) {
+		delete load;
+	}
+	textureLoads.clear();
+	textures.clear();
+	residentMemory = 0;
+}
+
+void TextureStreamer::setMemoryBudget(const size_t memoryBudgetBytes) {
+	memoryBudget = memoryBudgetBytes;
+}
+
+// A texture must not be sampled before its mip tail has arrived on the GPU
+bool TextureStreamer::isResident(const unsigned int textureID) {
+	StreamedTexture* texture = findTexture(textureID);
+	return texture != nullptr && !texture->decoding && (texture->tailResident || texture->mipLevels.empty());
+}
+
+// Textures whose decoding hasn't finished yet; their mip tails are queued with the upload manager once it has
+unsigned int TextureStreamer::getPendingCount() {
+	return (unsigned int)textureLoads.size();
+}
+
+size_t TextureStreamer::getResidentMemory() {
+	return residentMemory;
+}
\ No newline at end of file
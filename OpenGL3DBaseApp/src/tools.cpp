@@ -0,0 +1,410 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "tools.hpp"
+#include "resourceManager.hpp"
+#include "textureCompressor.hpp"
+#include "frameArena.hpp"
+#include "allocationCounter.hpp"
+#include "clusteredLighting.hpp"
+#include "overdrawAnalysis.hpp"
+#include "jobSystem.hpp"
+#include "entities.hpp"
+#include "transforms.hpp"
+#include "dynamicResolution.hpp"
+#include "clock.hpp"
+#include "inputRecorder.hpp"
+#include "cascadedShadows.hpp"
+#include "renderGraph.hpp"
+#include "mathBenchmark.hpp"
+#include "assetLoader.hpp"
+#include "terrain.hpp"
+#include "particles.hpp"
+#include "shaderLibrary.hpp"
+#include "frameCapture.hpp"
+#include "collision.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// The command line without the program's name and without --capture and its arguments; the first one selects the tool
+std::vector<std::string> toolArguments;
+std::string toolCapturePath;
+FrameCaptureFormat toolCaptureFormat = FrameCaptureFormat::Png;
+
+// Frames rendered so far; the reports and checks start after a warmup in which textures are streamed in and uploads complete
+const unsigned int warmupFrames = 200;
+unsigned int toolFrameNumber = 0;
+std::chrono::steady_clock::time_point toolFrameStart;
+
+//* --check-frame-allocations
+unsigned int checkedFrames = 0;
+unsigned long long allocationsBeforeCheck = 0, arenaOverflowsBeforeCheck = 0;
+
+//* --overdraw-report
+bool overdrawReport = false;
+
+//* --shadow-report
+bool shadowReport = false;
+const unsigned int shadowReportFrames = 120;
+
+//* --replay
+std::vector<double> replayFrameMilliseconds;
+
+//* --asset-streaming-benchmark
+unsigned int streamedCubeCount = 0;
+const unsigned int streamingReportFrames = 120;
+bool streamingStarted = false, streamingFinished = false;
+unsigned int streamingFinishedFrame = 0;
+double streamingSeconds = 0.0;
+size_t streamedBytes = 0;
+std::chrono::steady_clock::time_point streamingStart;
+std::vector<double> frameMillisecondsBeforeStreaming, frameMillisecondsWhileStreaming, frameMillisecondsAfterStreaming;
+
+// Returns the tool's argument at the given index, or an empty string if there are fewer arguments
+const std::string& getToolArgument(const unsigned int index) {
+	static const std::string missing;
+	return index < toolArguments.size() ? toolArguments[index] : missing;
+}
+
+bool isTool(const char* name) {
+	return getToolArgument(0) == name;
+}
+
+void printOverdrawResult(const std::string& label) {
+	OverdrawResult result;
+	if (!OverdrawAnalysis::getLastResult(result)) {
+		return;
+	}
+	std::cout << label << ": average overdraw " << result.averageOverdraw << ", max overdraw " << result.maxOverdraw
+		<< ", coverage " << result.coverage * 100.0 << "%, " << result.fragmentWrites << " fragment writes, "
+		<< result.gpuMilliseconds << " ms GPU time" << std::endl;
+}
+
+// Prints average, median, 99th percentile and worst frame time of a replay or of a part of a benchmark
+void printFrameTimes(const std::string& label, std::vector<double>& frameMilliseconds) {
+	if (frameMilliseconds.empty()) {
+		return;
+	}
+	double total = 0.0;
+	for (unsigned int i = 0; i < frameMilliseconds.size(); i++) {
+		total += frameMilliseconds[i];
+	}
+	std::sort(frameMilliseconds.begin(), frameMilliseconds.end());
+	std::cout << label << " " << frameMilliseconds.size() << " frames in " << total / 1000.0 << " s: average " << total / frameMilliseconds.size()
+		<< " ms, median " << frameMilliseconds[frameMilliseconds.size() / 2] << " ms, 99th percentile "
+		<< frameMilliseconds[(frameMilliseconds.size() * 99) / 100] << " ms, worst " << frameMilliseconds.back() << " ms" << std::endl;
+}
+
+// Time source that stands still, used to stop all animations
+double frozenTime() {
+	return 0.0;
+}
+
+//** Public **//
+// Splits the command line into the tool's arguments and the capture's
+void Tools::initialize(const int argc, char* argv[]) {
+	// --capture <path> [png|y4m] writes every frame to disk, as PNG files named <path>_00000.png etc. (default) or as a Y4M video at the path
+	// It can follow the options that open a window, e.g. --replay <file> for golden images
+	int toolArgumentEnd = argc;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (std::string(argv[i]) == "--capture") {
+			toolCapturePath = argv[i + 1];
+			if (i + 2 < argc && std::string(argv[i + 2]) == "y4m") {
+				toolCaptureFormat = FrameCaptureFormat::Y4m;
+			}
+			toolArgumentEnd = i;
+			break;
+		}
+	}
+	if (toolArgumentEnd > 1) {
+		toolArguments.assign(argv + 1, argv + toolArgumentEnd);
+	}
+}
+
+// Runs the tool if it doesn't need a window; returns false if there is none to run, otherwise the program should end with exitCode
+bool Tools::runWithoutWindow(int& exitCode) {
+	exitCode = 0;
+
+	// --texture-compression-report [images...] compresses the given images (or the demo images) with every format and
+	// prints encode throughput and PSNR
+	if (isTool("--texture-compression-report")) {
+		std::vector<std::string> imagePaths(toolArguments.begin() + 1, toolArguments.end());
+		if (imagePaths.empty()) {
+			for (int i = 1; i <= 6; i++) {
+				imagePaths.push_back("res/images/dummyImage" + std::to_string(i) + ".png");
+			}
+		}
+		TextureCompressor::printReport(imagePaths);
+	}
+	// --light-binning-benchmark bins increasing numbers of point lights into the light clusters and prints the time it takes
+	else if (isTool("--light-binning-benchmark")) {
+		ClusteredLighting::printBenchmark();
+	}
+	// --job-system-benchmark runs the same parallel workloads on 1 up to all CPU cores and prints how well they scale
+	else if (isTool("--job-system-benchmark")) {
+		JobSystem::printBenchmark();
+	}
+	// --entity-benchmark creates, updates and destroys a few hundred thousand entities and prints how many it gets through per second
+	else if (isTool("--entity-benchmark")) {
+		Entities::printBenchmark();
+	}
+	// --transform-benchmark updates a large transform hierarchy after changing more and more of it and prints the time each update takes
+	else if (isTool("--transform-benchmark")) {
+		Transforms::printBenchmark();
+	}
+	// --render-graph-report compiles the frame of an example deferred renderer and prints which passes are culled, the order they run in
+	// and how much memory the transient render targets take with and without aliasing
+	else if (isTool("--render-graph-report")) {
+		RenderGraph::printExampleReport();
+	}
+	// --math-benchmark [results file] [baseline file] [threshold in %] times the camera and transform math, optionally writes the results
+	// and compares them against the results of an earlier run. Fails if a case got slower than the baseline by more than the threshold (default: 5%)
+	else if (isTool("--math-benchmark")) {
+		exitCode = MathBenchmark::run(getToolArgument(1), getToolArgument(2), toolArguments.size() > 3 ? std::stod(toolArguments[3]) : 5.0);
+	}
+	// --terrain-report selects the terrain's levels of detail around a camera in the middle of terrains from 256 to 4096 units across
+	// and prints the vertices drawn per frame next to the vertices of a uniform grid with the same detail up close
+	else if (isTool("--terrain-report")) {
+		Terrain::printReport();
+	}
+	// --collision-benchmark moves 100K boxes around, slowly and fast, and prints how long finding the overlapping pairs takes with
+	// sweep and prune, the spatial hash and by testing every box against every other one
+	else if (isTool("--collision-benchmark")) {
+		Collision::printBenchmark();
+	}
+	// --embed-shaders [header] writes the preprocessed sources of all shaders into the given header (default: include/embeddedShaders.hpp)
+	// Building with EMBED_SHADERS defined afterwards compiles them into the program, which then reads no shader files at startup
+	else if (isTool("--embed-shaders")) {
+		exitCode = ShaderLibrary::writeEmbeddedSources(toolArguments.size() > 1 ? toolArguments[1] : "include/embeddedShaders.hpp") ? 0 : 1;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+// Reads the options of the tools that run the scene, before the window opens. Returns false if one of them can't be used
+bool Tools::parseOptions() {
+	// --check-frame-allocations [frames] runs the scene and fails if any of the given number of frames allocates heap memory
+	// Allocations are only counted in builds with CHECK_ALLOCATIONS defined, see AllocationCounter
+	if (isTool("--check-frame-allocations")) {
+		if (!AllocationCounter::isEnabled()) {
+			std::cout << "Error: Checking the frame allocations needs a build with CHECK_ALLOCATIONS defined" << std::endl;
+			return false;
+		}
+		checkedFrames = toolArguments.size() > 1 ? (unsigned int)std::stoul(toolArguments[1]) : 100;
+	}
+
+	// --overdraw-report renders the scene once without and once with depth pre-pass and reports the overdraw of both
+	// The heatmaps are written to overdraw.ppm and overdraw_prepass.ppm
+	overdrawReport = isTool("--overdraw-report");
+
+	// --shadow-report [resolution] [cascades] renders the scene in three situations and reports how often every shadow cascade
+	// was rendered and reused, and what a render costs: animated cubes, everything standing still, and a moving camera
+	shadowReport = isTool("--shadow-report");
+	if (shadowReport) {
+		Clock::useFixedTimestep(1.0 / 60.0);
+	}
+
+	// --record <file> [timestep] records the input of every frame to the given file
+	// The session runs at a fixed timestep (default: 1/60 s per frame) so that a replay can reproduce it exactly
+	if (isTool("--record") && toolArguments.size() > 1) {
+		const double timestep = toolArguments.size() > 2 ? std::stod(toolArguments[2]) : 1.0 / 60.0;
+		if (!InputRecorder::startRecording(toolArguments[1], timestep)) {
+			return false;
+		}
+		Clock::useFixedTimestep(timestep);
+	}
+	// --replay <file> plays a recording back at the timestep it was recorded with, then prints the measured frame times
+	// Live input is ignored and the dynamic resolution stays off, so every replay renders the same frames
+	if (isTool("--replay") && toolArguments.size() > 1) {
+		double timestep;
+		if (!InputRecorder::startReplay(toolArguments[1], timestep)) {
+			return false;
+		}
+		Clock::useFixedTimestep(timestep);
+		replayFrameMilliseconds.reserve(InputRecorder::getReplayFrameCount());
+	}
+
+	// --asset-streaming-benchmark [cubes] adds the given number of cubes (default: 100) whose meshes and textures are loaded by the
+	// asset loader's thread, and prints the frame times before, while and after they stream in
+	if (isTool("--asset-streaming-benchmark")) {
+		streamedCubeCount = toolArguments.size() > 1 ? (unsigned int)std::stoul(toolArguments[1]) : 100;
+	}
+	return true;
+}
+
+// Runs the tool if it needs an OpenGL context but not the scene; returns false if there is none to run, otherwise the program
+// should end with exitCode
+bool Tools::runWithoutScene(GLFWwindow& window, int& exitCode) {
+	exitCode = 0;
+
+	// --particle-benchmark simulates 64K up to 4M particles on the GPU and prints the time a simulation step takes
+	// Nothing is drawn, so the window stays hidden
+	if (isTool("--particle-benchmark")) {
+		glfwHideWindow(&window);
+		ParticleSystem::printBenchmark();
+		GLResources::reportLeaks();
+		glfwTerminate();
+		return true;
+	}
+	return false;
+}
+
+// Applies the options that need the scene, once it is initialized. Returns false if the session can't start
+bool Tools::start() {
+	if (InputRecorder::isReplaying()) {
+		DynamicResolution::setEnabled(false);
+	}
+	if (shadowReport && toolArguments.size() > 1) {
+		CascadedShadows::setOptions((unsigned int)std::stoul(toolArguments[1]),
+			toolArguments.size() > 2 ? (unsigned int)std::stoul(toolArguments[2]) : CascadedShadows::getCascadeCount());
+	}
+	if (!toolCapturePath.empty()) {
+		// Recordings and replays run at a fixed timestep, which is then also the video's frame rate
+		const double timestep = Clock::getFixedTimestep();
+		if (!FrameCapture::start(toolCapturePath, toolCaptureFormat, timestep > 0.0 ? (unsigned int)std::lround(1.0 / timestep) : 60)) {
+			return false;
+		}
+	}
+	// Replays and captures start with everything loaded, otherwise their first frames would depend on how fast textures decode
+	if (InputRecorder::isReplaying() || !toolCapturePath.empty()) {
+		ResourceManager::finishLoading();
+	}
+	toolFrameStart = std::chrono::steady_clock::now();
+	return true;
+}
+
+// Should be called at the top of every frame, before the time advances. Returns false once the tool is done and the main loop should end
+bool Tools::beginFrame() {
+	if (checkedFrames > 0) {
+		if (toolFrameNumber == warmupFrames) {
+			allocationsBeforeCheck = AllocationCounter::getAllocationCount();
+			arenaOverflowsBeforeCheck = FrameArena::getOverflowCount();
+		}
+		else if (toolFrameNumber == warmupFrames + checkedFrames) {
+			return false;
+		}
+	}
+	if (overdrawReport) {
+		if (toolFrameNumber == warmupFrames) {
+			ResourceManager::setDepthPrepass(false);
+			OverdrawAnalysis::requestCapture("overdraw.ppm");
+		}
+		else if (toolFrameNumber == warmupFrames + 1) {
+			printOverdrawResult("Without depth pre-pass");
+			ResourceManager::setDepthPrepass(true);
+			OverdrawAnalysis::requestCapture("overdraw_prepass.ppm");
+		}
+		else if (toolFrameNumber == warmupFrames + 2) {
+			printOverdrawResult("With depth pre-pass");
+			return false;
+		}
+	}
+	if (shadowReport) {
+		if (toolFrameNumber == warmupFrames) {
+			CascadedShadows::resetStats();
+		}
+		else if (toolFrameNumber == warmupFrames + shadowReportFrames) {
+			CascadedShadows::printStats("Animated cubes, camera standing still");
+			CascadedShadows::resetStats();
+			// Stop the time, which stops the cubes from rotating
+			Clock::useFixedTimestep(0.0);
+			Clock::setTimeSource(frozenTime);
+		}
+		else if (toolFrameNumber == warmupFrames + 2 * shadowReportFrames) {
+			CascadedShadows::printStats("Everything standing still");
+			CascadedShadows::resetStats();
+		}
+		else if (toolFrameNumber == warmupFrames + 3 * shadowReportFrames) {
+			CascadedShadows::printStats("Still cubes, camera moving sideways at 3 units per second");
+			return false;
+		}
+		// In the last part, the camera moves sideways
+		if (toolFrameNumber >= warmupFrames + 2 * shadowReportFrames) {
+			Camera& camera = ResourceManager::giveCamera();
+			camera.cameraPosition += camera.cameraRightVector * (3.0f / 60.0f);
+			camera.updateViewMatrix();
+		}
+	}
+	if (streamedCubeCount > 0) {
+		if (toolFrameNumber == warmupFrames + streamingReportFrames) {
+			ResourceManager::addBackgroundLoadedCubes(streamedCubeCount);
+			streamingStart = std::chrono::steady_clock::now();
+			streamingStarted = true;
+		}
+		else if (streamingStarted && !streamingFinished && AssetLoader::getPendingCount() == 0) {
+			streamingSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - streamingStart).count();
+			streamedBytes = AssetLoader::getResidentMemory();
+			streamingFinished = true;
+			streamingFinishedFrame = toolFrameNumber;
+		}
+		else if (streamingFinished && toolFrameNumber == streamingFinishedFrame + streamingReportFrames) {
+			return false;
+		}
+	}
+	toolFrameNumber++;
+	return true;
+}
+
+// Should be called at the end of every frame, after the buffers were swapped; measures the frame for the replay and the benchmarks
+void Tools::endFrame() {
+	if (!InputRecorder::isReplaying() && streamedCubeCount == 0) {
+		return;
+	}
+	std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+	const double frameMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - toolFrameStart).count();
+	toolFrameStart = frameEnd;
+	if (InputRecorder::isReplaying()) {
+		replayFrameMilliseconds.push_back(frameMilliseconds);
+	}
+	// Frames count towards the part of the benchmark they started in
+	else if (toolFrameNumber > warmupFrames) {
+		std::vector<double>& part = !streamingStarted ? frameMillisecondsBeforeStreaming :
+			!streamingFinished ? frameMillisecondsWhileStreaming : frameMillisecondsAfterStreaming;
+		part.push_back(frameMilliseconds);
+	}
+}
+
+// Prints the results of the tool after the main loop has ended and everything is shut down; returns the program's exit code
+int Tools::finish() {
+	printFrameTimes("Replayed", replayFrameMilliseconds);
+
+	if (streamedCubeCount > 0) {
+		if (!streamingFinished) {
+			std::cout << "Error: The window was closed before all assets had arrived" << std::endl;
+			return 1;
+		}
+		std::cout << "Streamed in " << streamedCubeCount << " cubes (" << 3 * streamedCubeCount << " assets, " << streamedBytes / (1024.0 * 1024.0)
+			<< " MB on the GPU) in " << streamingSeconds << " s" << std::endl;
+		printFrameTimes("Before streaming:", frameMillisecondsBeforeStreaming);
+		printFrameTimes("While streaming:", frameMillisecondsWhileStreaming);
+		printFrameTimes("After streaming:", frameMillisecondsAfterStreaming);
+	}
+
+	if (checkedFrames > 0) {
+		if (toolFrameNumber < warmupFrames + checkedFrames) {
+			std::cout << "Error: The window was closed before all frames could be checked" << std::endl;
+			return 1;
+		}
+		unsigned long long allocations = AllocationCounter::getAllocationCount() - allocationsBeforeCheck;
+		std::cout << allocations << " heap allocations in " << checkedFrames << " frames after a warmup of " << warmupFrames << " frames" << std::endl;
+		// Frame arena allocations that didn't fit come from the heap as well, so they are part of the count above
+		unsigned long long arenaOverflows = FrameArena::getOverflowCount() - arenaOverflowsBeforeCheck;
+		if (arenaOverflows > 0) {
+			std::cout << "Error: " << arenaOverflows << " frame arena allocations didn't fit into the arena" << std::endl;
+		}
+		if (allocations > 0) {
+			std::cout << "Error: The frame loop allocates heap memory in its steady state" << std::endl;
+			return 1;
+		}
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,424 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "transforms.hpp"
+#include "jobSystem.hpp"
+
+//** Private **//
+const unsigned int noParentSlot = 0xFFFFFFFF;
+// Levels in which at least 1 / denseLevelFraction of the transforms may have changed are calculated in one pass over the whole level
+const unsigned int denseLevelFraction = 4;
+
+//* Nodes, ordered by their depth in the hierarchy
+std::vector<glm::vec3> localPositions;
+std::vector<glm::quat> localOrientations;
+std::vector<float> localScales;
+std::vector<unsigned int> parentSlots;		// Slot of the parent's handle, noParentSlot for transforms at the top of the hierarchy
+std::vector<glm::mat4> worldMatrices;
+std::vector<unsigned char> dirtyFlags;		// Whether the world matrix has to be calculated in the next update (= the node is on its level's dirty list)
+std::vector<unsigned char> changedFlags;	// Whether the world matrix changed in the last update
+std::vector<unsigned int> nodeSlots;
+
+//* Handle slots, indexed by Transform::slot
+std::vector<unsigned int> transformSlotNodes;
+std::vector<unsigned int> transformSlotGenerations;
+std::vector<unsigned int> transformSlotLevels;
+std::vector<unsigned int> transformChildCounts;
+// The children of a transform form a list: the first child's slot, then every child links to its next sibling (noParentSlot ends the list)
+std::vector<unsigned int> firstChildSlots;
+std::vector<unsigned int> nextSiblingSlots;
+std::vector<unsigned int> freeTransformSlots;
+
+// The transforms at depth d are found at [levelStarts[d], levelStarts[d + 1]); the last element is always the transform count
+std::vector<unsigned int> levelStarts(1, 0);
+//* Per level, the slots of the transforms that have to be calculated in the next update and of those that changed in the last one
+// The update only visits these, so it takes time proportional to what changed instead of to the size of the hierarchy
+// Every transform is on its level's dirty list at most once, so the lists never need more room than the level has transforms;
+// they are sized up front, which lets jobs append to them at the same time with nothing but an atomic counter
+std::vector<unsigned int> levelDirtySlots[Transforms::maxDepth];
+std::atomic<unsigned int> levelDirtyCounts[Transforms::maxDepth];
+std::vector<unsigned int> levelChangedSlots[Transforms::maxDepth];
+unsigned int levelChangedCounts[Transforms::maxDepth];
+
+void moveNode(const unsigned int from, const unsigned int to) {
+	localPositions[to] = localPositions[from];
+	localOrientations[to] = localOrientations[from];
+	localScales[to] = localScales[from];
+	parentSlots[to] = parentSlots[from];
+	worldMatrices[to] = worldMatrices[from];
+	dirtyFlags[to] = dirtyFlags[from];
+	changedFlags[to] = changedFlags[from];
+	nodeSlots[to] = nodeSlots[from];
+	transformSlotNodes[nodeSlots[to]] = to;
+}
+
+void resizeNodes(const size_t nodeCount) {
+	localPositions.resize(nodeCount);
+	localOrientations.resize(nodeCount);
+	localScales.resize(nodeCount);
+	parentSlots.resize(nodeCount);
+	worldMatrices.resize(nodeCount);
+	dirtyFlags.resize(nodeCount);
+	changedFlags.resize(nodeCount);
+	nodeSlots.resize(nodeCount);
+}
+
+// Puts the transform on its level's dirty list, unless it is on it already
+void markDirty(const unsigned int slot) {
+	const unsigned int index = transformSlotNodes[slot];
+	if (dirtyFlags[index]) {
+		return;
+	}
+	dirtyFlags[index] = 1;
+	const unsigned int level = transformSlotLevels[slot];
+	levelDirtySlots[level][levelDirtyCounts[level].fetch_add(1, std::memory_order_relaxed)] = slot;
+}
+
+// Takes the slot off a list by moving the list's last slot into its place
+void removeListedSlot(std::vector<unsigned int>& slots, unsigned int& count, const unsigned int slot) {
+	for (unsigned int i = 0; i < count; i++) {
+		if (slots[i] == slot) {
+			slots[i] = slots[--count];
+			return;
+		}
+	}
+}
+
+Transform insertTransform(const unsigned int level, const unsigned int parentSlot, const glm::vec3& position, const glm::quat& orientation, const float scale) {
+	//* Levels that don't exist yet start out empty at the end
+	while (levelStarts.size() < level + 2) {
+		levelStarts.push_back(levelStarts.back());
+	}
+
+	//* Make room at the end of the level
+	// The same as for entities and their meshes: every following level moves its first node to its end
+	unsigned int freeIndex = levelStarts.back();
+	resizeNodes(freeIndex + 1);
+	for (unsigned int following = (unsigned int)levelStarts.size() - 2; following > level; following--) {
+		if (levelStarts[following] != freeIndex) {
+			moveNode(levelStarts[following], freeIndex);
+		}
+		freeIndex = levelStarts[following];
+		levelStarts[following]++;
+	}
+	levelStarts.back()++;
+
+	//* Hand out a slot for the handle
+	Transform transform;
+	if (!freeTransformSlots.empty()) {
+		transform.slot = freeTransformSlots.back();
+		freeTransformSlots.pop_back();
+	}
+	else {
+		transform.slot = (unsigned int)transformSlotNodes.size();
+		transformSlotNodes.push_back(0);
+		transformSlotGenerations.push_back(0);
+		transformSlotLevels.push_back(0);
+		transformChildCounts.push_back(0);
+		firstChildSlots.push_back(noParentSlot);
+		nextSiblingSlots.push_back(noParentSlot);
+	}
+	transform.generation = transformSlotGenerations[transform.slot];
+	transformSlotNodes[transform.slot] = freeIndex;
+	transformSlotLevels[transform.slot] = level;
+	transformChildCounts[transform.slot] = 0;
+	firstChildSlots[transform.slot] = noParentSlot;
+	nextSiblingSlots[transform.slot] = noParentSlot;
+	if (parentSlot != noParentSlot) {
+		nextSiblingSlots[transform.slot] = firstChildSlots[parentSlot];
+		firstChildSlots[parentSlot] = transform.slot;
+	}
+
+	//* The level's lists need room for one more transform
+	const unsigned int levelSize = levelStarts[level + 1] - levelStarts[level];
+	levelDirtySlots[level].resize(levelSize);
+	levelChangedSlots[level].resize(levelSize);
+
+	localPositions[freeIndex] = position;
+	localOrientations[freeIndex] = orientation;
+	localScales[freeIndex] = scale;
+	parentSlots[freeIndex] = parentSlot;
+	worldMatrices[freeIndex] = glm::mat4(1.0f);
+	dirtyFlags[freeIndex] = 0;
+	changedFlags[freeIndex] = 0;
+	nodeSlots[freeIndex] = transform.slot;
+	markDirty(transform.slot);
+	return transform;
+}
+
+void calculateWorldMatrix(const unsigned int i) {
+	const unsigned int parentSlot = parentSlots[i];
+	dirtyFlags[i] = 0;
+	changedFlags[i] = 1;
+
+	//* Scale first, then rotate, then translate (matrices are applied from right to left)
+	// Quaternions save at least 50% computation time over Euler rotations, but they do, in any case, need to be normalized!
+	glm::mat4 localMatrix = glm::translate(glm::mat4(1.0f), localPositions[i]) * glm::toMat4(localOrientations[i]);
+	localMatrix = glm::scale(localMatrix, glm::vec3(localScales[i]));
+	// The parent's world matrix is already up to date as parents are always on an earlier level
+	worldMatrices[i] = parentSlot != noParentSlot ? worldMatrices[transformSlotNodes[parentSlot]] * localMatrix : localMatrix;
+}
+
+// Puts the children of the transforms at [first, last) of the level's changed list on the next level's dirty list
+void markChildrenDirty(const unsigned int level, const unsigned int first, const unsigned int last) {
+	for (unsigned int listIndex = first; listIndex < last; listIndex++) {
+		for (unsigned int child = firstChildSlots[levelChangedSlots[level][listIndex]]; child != noParentSlot; child = nextSiblingSlots[child]) {
+			markDirty(child);
+		}
+	}
+}
+
+// Calculates the world matrices of the transforms at [first, last) of the level's dirty list
+void calculateDirtyTransforms(const unsigned int level, const unsigned int first, const unsigned int last) {
+	for (unsigned int listIndex = first; listIndex < last; listIndex++) {
+		calculateWorldMatrix(transformSlotNodes[levelDirtySlots[level][listIndex]]);
+	}
+}
+
+// Calculates the world matrices of the nodes in [first, last) that were edited or whose parent changed, going through them in the
+// order they are stored in, and puts them on the level's changed list
+void calculateChangedNodes(const unsigned int level, const unsigned int first, const unsigned int last, std::atomic<unsigned int>& changedCount) {
+	unsigned int rangeChangedCount = 0;
+	for (unsigned int i = first; i < last; i++) {
+		const unsigned int parentSlot = parentSlots[i];
+		if (dirtyFlags[i] || (parentSlot != noParentSlot && changedFlags[transformSlotNodes[parentSlot]])) {
+			calculateWorldMatrix(i);
+			rangeChangedCount++;
+		}
+	}
+	// Room on the list is taken for the whole range at once
+	unsigned int listIndex = changedCount.fetch_add(rangeChangedCount, std::memory_order_relaxed);
+	for (unsigned int i = first; i < last; i++) {
+		if (changedFlags[i]) {
+			levelChangedSlots[level][listIndex++] = nodeSlots[i];
+		}
+	}
+}
+
+//** Public **//
+// Creates a transform at the top of the hierarchy
+Transform Transforms::create(const glm::vec3& position, const glm::quat& orientation, const float scale) {
+	return insertTransform(0, noParentSlot, position, orientation, scale);
+}
+
+// Creates a transform relative to the given one. It follows its parent around, so the parent has to outlive it
+Transform Transforms::createChild(const Transform parent, const glm::vec3& position, const glm::quat& orientation, const float scale) {
+	if (!isAlive(parent)) {
+		std::cout << "Error: The parent of a new transform doesn't exist (anymore)" << std::endl;
+		return create(position, orientation, scale);
+	}
+	const unsigned int level = transformSlotLevels[parent.slot] + 1;
+	if (level >= maxDepth) {
+		std::cout << "Error: Transform hierarchies may be at most " << maxDepth << " levels deep" << std::endl;
+		return create(position, orientation, scale);
+	}
+	transformChildCounts[parent.slot]++;
+	return insertTransform(level, parent.slot, position, orientation, scale);
+}
+
+void Transforms::destroy(const Transform transform) {
+	if (!isAlive(transform)) {
+		std::cout << "Error: Tried to destroy a transform that doesn't exist (anymore)" << std::endl;
+		return;
+	}
+	if (transformChildCounts[transform.slot] > 0) {
+		std::cout << "Error: A transform can't be destroyed while it still has children" << std::endl;
+		return;
+	}
+	const unsigned int index = transformSlotNodes[transform.slot];
+	const unsigned int level = transformSlotLevels[transform.slot];
+	if (parentSlots[index] != noParentSlot) {
+		//* Unlink it from its parent's children
+		const unsigned int parentSlot = parentSlots[index];
+		transformChildCounts[parentSlot]--;
+		unsigned int* link = &firstChildSlots[parentSlot];
+		while (*link != transform.slot) {
+			link = &nextSiblingSlots[*link];
+		}
+		*link = nextSiblingSlots[transform.slot];
+	}
+
+	//* Its slot mustn't stay on the level's lists, as it may be handed out again
+	if (dirtyFlags[index]) {
+		unsigned int dirtyCount = levelDirtyCounts[level].load(std::memory_order_relaxed);
+		removeListedSlot(levelDirtySlots[level], dirtyCount, transform.slot);
+		levelDirtyCounts[level].store(dirtyCount, std::memory_order_relaxed);
+	}
+	if (changedFlags[index]) {
+		removeListedSlot(levelChangedSlots[level], levelChangedCounts[level], transform.slot);
+	}
+
+	//* Close the gap, moving the last node of every following level forwards (see Entities::destroy())
+	unsigned int gapIndex = index;
+	for (unsigned int following = level; following + 1 < levelStarts.size(); following++) {
+		const unsigned int lastIndex = levelStarts[following + 1] - 1;
+		if (following > level) {
+			if (levelStarts[following] == levelStarts[following + 1]) {
+				levelStarts[following]--;
+				continue;
+			}
+			levelStarts[following]--;
+		}
+		if (lastIndex != gapIndex) {
+			moveNode(lastIndex, gapIndex);
+		}
+		gapIndex = lastIndex;
+	}
+	levelStarts.back()--;
+	resizeNodes(levelStarts.back());
+
+	transformSlotGenerations[transform.slot]++;
+	freeTransformSlots.push_back(transform.slot);
+}
+
+bool Transforms::isAlive(const Transform transform) {
+	return transform.slot < transformSlotGenerations.size() && transformSlotGenerations[transform.slot] == transform.generation;
+}
+
+const glm::vec3& Transforms::getLocalPosition(const Transform transform) {
+	return localPositions[transformSlotNodes[transform.slot]];
+}
+
+const glm::quat& Transforms::getLocalOrientation(const Transform transform) {
+	return localOrientations[transformSlotNodes[transform.slot]];
+}
+
+float Transforms::getLocalScale(const Transform transform) {
+	return localScales[transformSlotNodes[transform.slot]];
+}
+
+//* Editing a transform only marks it; its world matrix (and those of its children) is calculated in the next update
+// Different transforms may be edited from different jobs at the same time
+void Transforms::setLocalPosition(const Transform transform, const glm::vec3& position) {
+	localPositions[transformSlotNodes[transform.slot]] = position;
+	markDirty(transform.slot);
+}
+
+void Transforms::setLocalOrientation(const Transform transform, const glm::quat& orientation) {
+	localOrientations[transformSlotNodes[transform.slot]] = orientation;
+	markDirty(transform.slot);
+}
+
+void Transforms::setLocalScale(const Transform transform, const float scale) {
+	localScales[transformSlotNodes[transform.slot]] = scale;
+	markDirty(transform.slot);
+}
+
+// As of the last update
+const glm::mat4& Transforms::getWorldMatrix(const Transform transform) {
+	return worldMatrices[transformSlotNodes[transform.slot]];
+}
+
+// Whether the world matrix changed in the last update
+bool Transforms::hasChanged(const Transform transform) {
+	return changedFlags[transformSlotNodes[transform.slot]] != 0;
+}
+
+// Calculates the world matrices of everything that changed since the last call. Should be called once per frame after all edits
+void Transforms::update() {
+	const unsigned int levelCount = (unsigned int)levelStarts.size() - 1;
+
+	//* Forget what changed in the last update
+	for (unsigned int level = 0; level < levelCount; level++) {
+		for (unsigned int i = 0; i < levelChangedCounts[level]; i++) {
+			changedFlags[transformSlotNodes[levelChangedSlots[level][i]]] = 0;
+		}
+		levelChangedCounts[level] = 0;
+	}
+
+	for (unsigned int level = 0; level < levelCount; level++) {
+		// Levels in which nothing was edited and whose parents didn't change either are skipped right away
+		const unsigned int parentChangedCount = level > 0 ? levelChangedCounts[level - 1] : 0;
+		unsigned int dirtyCount = levelDirtyCounts[level].load(std::memory_order_relaxed);
+		if (dirtyCount == 0 && parentChangedCount == 0) {
+			continue;
+		}
+
+		//* The nodes of a level only depend on the level before, which is done at this point
+		const unsigned int first = levelStarts[level];
+		const unsigned int count = levelStarts[level + 1] - first;
+		// Children are expected to change in the same proportion as the transforms of the level before did
+		const unsigned long long parentCount = level > 0 ? levelStarts[level] - levelStarts[level - 1] : 1;
+		if ((parentChangedCount * count + dirtyCount * parentCount) * denseLevelFraction >= count * parentCount) {
+			//* If much of the level changes, it is cheaper to go through all of it in order than to jump from one listed transform to the next
+			std::atomic<unsigned int> changedCount(0);
+			JobSystem::parallelFor(count, 1024, [level, first, &changedCount](const unsigned int rangeFirst, const unsigned int rangeLast) {
+				calculateChangedNodes(level, first + rangeFirst, first + rangeLast, changedCount);
+			});
+			levelChangedCounts[level] = changedCount.load(std::memory_order_relaxed);
+		}
+		else {
+			//* Otherwise, the children of what changed on the level before join the edited transforms on the dirty list
+			JobSystem::parallelFor(parentChangedCount, 1024, [level](const unsigned int rangeFirst, const unsigned int rangeLast) {
+				markChildrenDirty(level - 1, rangeFirst, rangeLast);
+			});
+			dirtyCount = levelDirtyCounts[level].load(std::memory_order_relaxed);
+			JobSystem::parallelFor(dirtyCount, 1024, [level](const unsigned int rangeFirst, const unsigned int rangeLast) {
+				calculateDirtyTransforms(level, rangeFirst, rangeLast);
+			});
+
+			// What was dirty is what changed in this update; the emptied list of the last update takes its place
+			std::swap(levelDirtySlots[level], levelChangedSlots[level]);
+			levelChangedCounts[level] = dirtyCount;
+		}
+		levelDirtyCounts[level].store(0, std::memory_order_relaxed);
+	}
+}
+
+void Transforms::printBenchmark() {
+	//* Build a forest of 4000 trees with 5 children per node, 3 levels deep (124000 transforms)
+	const unsigned int treeCount = 4000, childCount = 5;
+	const int repetitions = 20;
+	JobSystem::initialize(0);
+	std::vector<Transform> roots, leaves;
+	for (unsigned int tree = 0; tree < treeCount; tree++) {
+		const Transform root = create(glm::vec3((float)tree, 0.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 1.0f);
+		roots.push_back(root);
+		for (unsigned int i = 0; i < childCount; i++) {
+			const Transform child = createChild(root, glm::vec3(1.0f, (float)i, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 0.5f);
+			for (unsigned int j = 0; j < childCount; j++) {
+				leaves.push_back(createChild(child, glm::vec3(0.0f, 1.0f, (float)j), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 0.5f));
+			}
+		}
+	}
+	update();
+
+	//* Time the update after editing every stride-th transform of the given list (none if the list is empty)
+	struct Scenario {
+		const char* name;
+		const std::vector<Transform>* edited;
+		unsigned int stride;
+	};
+	const std::vector<Transform> nothing;
+	const Scenario scenarios[] = {
+		{ "nothing changed", &nothing, 1 },
+		{ "a single leaf moved", &leaves, (unsigned int)leaves.size() },
+		{ "a single tree moved", &roots, (unsigned int)roots.size() },
+		{ "1% of the leaves moved", &leaves, 100 },
+		{ "1% of the trees moved", &roots, 100 },
+		{ "all leaves moved", &leaves, 1 },
+		{ "all trees moved", &roots, 1 },
+	};
+	std::cout << "Transform hierarchy with " << levelStarts.back() << " transforms on " << JobSystem::getThreadCount() << " threads:" << std::endl;
+	for (const Scenario& scenario : scenarios) {
+		double totalMilliseconds = 0.0;
+		for (int repetition = 0; repetition < repetitions; repetition++) {
+			for (unsigned int i = 0; i < scenario.edited->size(); i += scenario.stride) {
+				const Transform transform = (*scenario.edited)[i];
+				setLocalPosition(transform, getLocalPosition(transform) + glm::vec3(0.0f, 0.01f, 0.0f));
+			}
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			update();
+			std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+			totalMilliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+		}
+		std::cout << "  " << scenario.name << ": " << totalMilliseconds / repetitions << " ms per update" << std::endl;
+	}
+	JobSystem::shutdown();
+}
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <cstring>
+#include <algorithm>
+
+#include "uploadManager.hpp"
+#include "glResources.hpp"
+
+//** Private **//
+// Offsets into the staging buffer are kept at multiples of this, which satisfies every alignment OpenGL may ask for
+const size_t stagingAlignment = 16;
+
+enum class UploadType {
+	Buffer,
+	Texture,
+};
+
+struct UploadRequest {
+	UploadType type;
+	unsigned int objectID;
+	int level, width, height;
+	int x, y;				// Where the texture data goes in the level; it may only fill a part of it
+	unsigned int format;	// Pixel format for uncompressed textures, internal format for compressed ones
+	unsigned int pixelType;	// Data type of the pixels' components for uncompressed textures
+	bool compressed;
+	std::vector<unsigned char> data;
+	size_t uploadedBytes;
+
+	// Buffers may be split anywhere, textures only between rows (or between rows of 4x4 blocks if they are compressed)
+	size_t rowSize;
+	int rowHeight;
+
+	std::function<void()> onComplete;
+};
+
+// An upload whose last chunk has been copied, waiting for its frame's fence
+struct CompletedUpload {
+	UploadType type;
+	unsigned int objectID;
+	std::function<void()> onComplete;
+};
+
+// Everything that was copied from the staging buffer during one frame, guarded by a single fence
+struct StagingFrame {
+	size_t size;	// Including the unused space at the end of the buffer if the frame wrapped around
+	GLsync fence;
+	std::vector<CompletedUpload> completedUploads;
+};
+
+GLBuffer stagingBuffer;
+size_t stagingBufferSize;
+size_t stagingHead = 0;		// Offset the next chunk is written to
+size_t stagingUsed = 0;		// Bytes that are still being read by the GPU
+size_t uploadBudgetPerFrame;
+size_t queuedBytes = 0;
+
+std::deque<UploadRequest> queuedUploads;
+std::deque<StagingFrame> framesInFlight;
+
+size_t alignStagingSize(const size_t size) {
+	return (size + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+}
+
+//* Reserves between minimumBytes and desiredBytes of contiguous space in the staging buffer
+// The buffer is used as a ring: new chunks are written behind the previous ones and the space is given back once the GPU
+// is done reading from it. If the end of the buffer is too small, it is skipped and we continue at the start
+bool allocateStagingSpace(const size_t minimumBytes, const size_t desiredBytes, size_t& frameSize, size_t& offset, size_t& size) {
+	if (stagingUsed == 0) {
+		stagingHead = 0;
+	}
+	if (stagingUsed == stagingBufferSize) {
+		return false;
+	}
+
+	// The oldest chunk still in use starts at the tail; everything from the head up to the tail is free
+	const size_t tail = (stagingHead + stagingBufferSize - stagingUsed) % stagingBufferSize;
+	size_t contiguousBytes;
+	if (stagingHead >= tail) {
+		contiguousBytes = stagingBufferSize - stagingHead;
+		if (contiguousBytes < minimumBytes) {
+			if (tail < minimumBytes) {
+				return false;
+			}
+			// The skipped space is given back together with the current frame's chunks
+			frameSize += contiguousBytes;
+			stagingUsed += contiguousBytes;
+			stagingHead = 0;
+			contiguousBytes = tail;
+		}
+	}
+	else {
+		contiguousBytes = tail - stagingHead;
+	}
+	if (contiguousBytes < minimumBytes) {
+		return false;
+	}
+
+	offset = stagingHead;
+	size = std::min(desiredBytes, contiguousBytes);
+	const size_t alignedSize = alignStagingSize(size);
+	stagingHead = (stagingHead + alignedSize) % stagingBufferSize;
+	stagingUsed += alignedSize;
+	frameSize += alignedSize;
+	return true;
+}
+
+// Copies the next chunk of the request to the GPU. Returns false if the staging buffer is full
+bool uploadChunk(UploadRequest& request, const size_t budgetBytes, size_t& frameSize) {
+	const size_t remainingBytes = request.data.size() - request.uploadedBytes;
+
+	//* Decide how much to copy: as much as the budget allows, but only whole rows and at least one of them
+	const size_t minimumBytes = std::min(request.rowSize, remainingBytes);
+	size_t desiredBytes = std::min(remainingBytes, std::max(budgetBytes, minimumBytes));
+	size_t offset, size;
+	if (!allocateStagingSpace(minimumBytes, desiredBytes, frameSize, offset, size)) {
+		return false;
+	}
+	if (size < remainingBytes) {
+		size = size / request.rowSize * request.rowSize;
+	}
+
+	//* Write the chunk into the staging buffer
+	// GL_MAP_UNSYNCHRONIZED_BIT tells OpenGL not to wait for the GPU before mapping, which is safe because the fences make sure
+	// that the GPU doesn't read from this part of the buffer anymore. GL_MAP_INVALIDATE_RANGE_BIT says that we overwrite all of it
+	glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffer.getID());
+	void* stagingMemory = glMapBufferRange(GL_COPY_READ_BUFFER, offset, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (stagingMemory == nullptr) {
+		std::cout << "Error: Failed to map the staging buffer" << std::endl;
+		return false;
+	}
+	std::memcpy(stagingMemory, &request.data[request.uploadedBytes], size);
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+	//* Let the GPU copy the chunk to its destination
+	// Neither of these calls has to wait for anything, the copy is simply queued behind the commands that were issued before
+	if (request.type == UploadType::Buffer) {
+		// GL_COPY_WRITE_BUFFER is used so that the element buffer binding of the currently bound VAO remains untouched
+		glBindBuffer(GL_COPY_WRITE_BUFFER, request.objectID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, request.uploadedBytes, size);
+	}
+	else {
+		// While a pixel unpack buffer is bound, the data pointer of glTexSubImage2D is interpreted as an offset into it
+		const int firstRow = (int)(request.uploadedBytes / request.rowSize) * request.rowHeight;
+		const int rows = std::min((int)(size / request.rowSize) * request.rowHeight, request.height - firstRow);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer.getID());
+		glBindTexture(GL_TEXTURE_2D, request.objectID);
+		if (request.compressed) {
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, request.level, request.x, request.y + firstRow, request.width, rows, request.format, (GLsizei)size, (void*)offset);
+		}
+		else {
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, request.level, request.x, request.y + firstRow, request.width, rows, request.format, request.pixelType, (void*)offset);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+		// Unbind it again, otherwise every later texture call with a data pointer would read from the staging buffer
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	request.uploadedBytes += size;
+	queuedBytes -= size;
+	return true;
+}
+
+void queueUpload(UploadRequest& request, const void* data, const size_t size, const std::function<void()>& onComplete) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	// The data is copied so that the caller doesn't have to keep it around until the upload is done
+	request.data.assign(bytes, bytes + size);
+	request.uploadedBytes = 0;
+	request.onComplete = onComplete;
+	queuedBytes += size;
+	queuedUploads.push_back(std::move(request));
+}
+
+void cancelUploads(const UploadType type, const unsigned int objectID) {
+	//* Drop the queued uploads, including the rest of one that has already been partly copied
+	// Chunks that have been copied stay in flight; OpenGL only deletes the object once the GPU is done with them
+	for (std::deque<UploadRequest>::iterator request = queuedUploads.begin(); request != queuedUploads.end();) {
+		if (request->type == type && request->objectID == objectID) {
+			queuedBytes -= request->data.size() - request->uploadedBytes;
+			request = queuedUploads.erase(request);
+		}
+		else {
+			request++;
+		}
+	}
+
+	//* Uploads that are complete but whose fence hasn't signaled yet don't tell their owner anymore
+	// Otherwise they would report to whichever object gets the ID next
+	for (unsigned int i = 0; i < framesInFlight.size(); i++) {
+		std::vector<CompletedUpload>& completedUploads = framesInFlight[i].completedUploads;
+		for (unsigned int j = 0; j < completedUploads.size(); j++) {
+			if (completedUploads[j].type == type && completedUploads[j].objectID == objectID) {
+				completedUploads[j].onComplete = nullptr;
+			}
+		}
+	}
+}
+
+//** Public **//
+void UploadManager::initialize(const size_t stagingBufferBytes, const size_t uploadBudgetBytesPerFrame) {
+	stagingBufferSize = alignStagingSize(stagingBufferBytes);
+	uploadBudgetPerFrame = uploadBudgetBytesPerFrame;
+
+	//* Create the staging buffer
+	// It is only ever written by the CPU and read by the GPU once, which is what "stream draw" stands for
+	stagingBuffer = GLBuffer(GLMemoryCategory::Staging, "Upload staging buffer");
+	glBindBuffer(GL_COPY_READ_BUFFER, stagingBuffer.getID());
+	glBufferData(GL_COPY_READ_BUFFER, stagingBufferSize, nullptr, GL_STREAM_DRAW);
+	stagingBuffer.setSize(stagingBufferSize);
+}
+
+// Allocates the buffer's storage right away and fills it in the background
+void UploadManager::uploadBuffer(const unsigned int bufferID, const void* data, const size_t size, const std::function<void()>& onComplete) {
+	glBindBuffer(GL_COPY_WRITE_BUFFER, bufferID);
+	glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+	GLResources::setSize(GLObjectType::Buffer, bufferID, size);
+
+	UploadRequest request;
+	request.type = UploadType::Buffer;
+	request.objectID = bufferID;
+	request.level = request.width = request.height = 0;
+	request.x = request.y = 0;
+	request.format = request.pixelType = 0;
+	request.compressed = false;
+	request.rowSize = 1;
+	request.rowHeight = 1;
+	queueUpload(request, data, size, onComplete);
+}
+
+// Allocates the texture level's storage right away and fills it in the background
+// The level's contents are undefined until onComplete is called, so it shouldn't be sampled before that
+void UploadManager::uploadTexture(const unsigned int textureID, const int level, const int width, const int height, const unsigned int format,
+	const bool compressed, const void* data, const size_t size, const std::function<void()>& onComplete) {
+	UploadRequest request;
+	request.type = UploadType::Texture;
+	request.objectID = textureID;
+	request.level = level;
+	request.width = width;
+	request.height = height;
+	request.x = request.y = 0;
+	request.format = format;
+	request.pixelType = GL_UNSIGNED_BYTE;
+	request.compressed = compressed;
+
+	//* Passing nullptr allocates the level without filling it
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	if (compressed) {
+		// Block compressed textures consist of rows of 4x4 pixel blocks
+		request.rowHeight = 4;
+		request.rowSize = size / ((height + 3) / 4);
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, (GLsizei)size, nullptr);
+	}
+	else {
+		request.rowHeight = 1;
+		request.rowSize = size / height;
+		glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+	}
+	queueUpload(request, data, size, onComplete);
+}
+
+// Fills a rectangle of an uncompressed texture level whose storage exists already, e.g. a slot of an atlas
+// pixelType is the data type of the pixels' components, e.g. GL_UNSIGNED_BYTE or GL_FLOAT. The rest of the level stays untouched
+void UploadManager::uploadTextureRegion(const unsigned int textureID, const int level, const int x, const int y, const int width, const int height,
+	const unsigned int format, const unsigned int pixelType, const void* data, const size_t size, const std::function<void()>& onComplete) {
+	UploadRequest request;
+	request.type = UploadType::Texture;
+	request.objectID = textureID;
+	request.level = level;
+	request.width = width;
+	request.height = height;
+	request.x = x;
+	request.y = y;
+	request.format = format;
+	request.pixelType = pixelType;
+	request.compressed = false;
+	request.rowHeight = 1;
+	request.rowSize = size / height;
+	queueUpload(request, data, size, onComplete);
+}
+
+// Drops the buffer's uploads that haven't finished yet. Their onComplete functions aren't called anymore
+void UploadManager::cancelBufferUploads(const unsigned int bufferID) {
+	cancelUploads(UploadType::Buffer, bufferID);
+}
+
+// Same as above for all uploads to the texture's levels
+void UploadManager::cancelTextureUploads(const unsigned int textureID) {
+	cancelUploads(UploadType::Texture, textureID);
+}
+
+// Should be called once per frame. Copies at most the upload budget's worth of queued data and reports finished uploads
+void UploadManager::update() {
+	//* Give back the staging space of frames the GPU is done with and tell the owners that their data has arrived
+	// A timeout of 0 means that we only query the fence's state instead of waiting for it
+	while (!framesInFlight.empty()) {
+		GLenum fenceState = glClientWaitSync(framesInFlight.front().fence, 0, 0);
+		if (fenceState != GL_ALREADY_SIGNALED && fenceState != GL_CONDITION_SATISFIED) {
+			break;
+		}
+		StagingFrame frame = std::move(framesInFlight.front());
+		framesInFlight.pop_front();
+		glDeleteSync(frame.fence);
+		stagingUsed -= frame.size;
+		for (unsigned int i = 0; i < frame.completedUploads.size(); i++) {
+			if (frame.completedUploads[i].onComplete) {
+				frame.completedUploads[i].onComplete();
+			}
+		}
+	}
+
+	//* Copy the queued uploads in order until the budget is used up
+	// Large uploads are split up and continued in the following frames
+	StagingFrame frame;
+	frame.size = 0;
+	size_t uploadedBytes = 0;
+	while (!queuedUploads.empty()) {
+		UploadRequest& request = queuedUploads.front();
+		if (request.uploadedBytes < request.data.size()) {
+			if (uploadedBytes >= uploadBudgetPerFrame) {
+				break;
+			}
+			const size_t previouslyUploaded = request.uploadedBytes;
+			if (!uploadChunk(request, uploadBudgetPerFrame - uploadedBytes, frame.size)) {
+				// The staging buffer is full, wait for the GPU to catch up
+				break;
+			}
+			uploadedBytes += request.uploadedBytes - previouslyUploaded;
+		}
+		if (request.uploadedBytes == request.data.size()) {
+			CompletedUpload completedUpload = { request.type, request.objectID, std::move(request.onComplete) };
+			frame.completedUploads.push_back(std::move(completedUpload));
+			queuedUploads.pop_front();
+		}
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	//* One fence guards everything that was copied this frame
+	// It is signaled once the GPU has processed every command issued up to this point, including our copies
+	if (frame.size > 0 || !frame.completedUploads.empty()) {
+		frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		framesInFlight.push_back(std::move(frame));
+	}
+}
+
+// Drops all uploads that haven't finished yet and frees the staging buffer. Their onComplete functions aren't called anymore
+void UploadManager::shutdown() {
+	for (unsigned int i = 0; i < framesInFlight.size(); i++) {
+		glDeleteSync(framesInFlight[i].fence);
+	}
+	framesInFlight.clear();
+	queuedUploads.clear();
+	queuedBytes = stagingHead = stagingUsed = 0;
+	stagingBuffer.reset();
+}
+
+void UploadManager::setUploadBudget(const size_t uploadBudgetBytesPerFrame) {
+	uploadBudgetPerFrame = uploadBudgetBytesPerFrame;
+}
+
+size_t UploadManager::getUploadBudget() {
+	return uploadBudgetPerFrame;
+}
+
+// Bytes that have been queued but not yet copied to the staging buffer
+size_t UploadManager::getQueuedBytes() {
+	return queuedBytes;
+}
+
+// Whether every queued upload has arrived on the GPU and its onComplete function has been called
+bool UploadManager::isIdle() {
+	return queuedUploads.empty() && framesInFlight.empty();
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+
+#include "views.hpp"
+#include "render.hpp"
+#include "window.hpp"
+#include "clusteredLighting.hpp"
+#include "dynamicResolution.hpp"
+#include "glResources.hpp"
+#include "clock.hpp"
+
+//** Private **//
+const unsigned int matricesBindingPoint = 0;
+
+// Layout of the "matrices" uniform block (std140)
+struct ViewMatrices {
+	glm::mat4 viewMatrices[Views::maxViewCount];
+	glm::mat4 projectionMatrices[Views::maxViewCount];
+	// Scale (xy) and offset (zw) that move normalized device coordinates into the view's viewport
+	glm::vec4 viewportTransforms[Views::maxViewCount];
+	// x = first view of the current pass, y = number of views in the pass
+	int passViews[4];
+	// x = time at the start of the frame in seconds, which drives the animations calculated on the GPU
+	glm::vec4 animation;
+};
+
+GLBuffer matricesUBO;
+View views[Views::maxViewCount];
+unsigned int viewCount = 0;
+ViewMatrices viewMatrices;
+// 6 planes per view: left, right, bottom, top, near, far. xyz is the normal pointing inwards, w the distance from the origin
+glm::vec4 frustumPlanes[Views::maxViewCount][6];
+
+// Views are drawn together in one pass as long as their viewports don't overlap, so a pass is a range of consecutive views
+unsigned int passCount = 0;
+unsigned int passFirstView[Views::maxViewCount], passViewCount[Views::maxViewCount];
+
+bool viewportsOverlap(const glm::vec4& a, const glm::vec4& b) {
+	return a.x < b.x + b.z && b.x < a.x + a.z && a.y < b.y + b.w && b.y < a.y + a.w;
+}
+
+void groupPasses() {
+	passCount = 0;
+	for (unsigned int v = 0; v < viewCount; v++) {
+		bool fitsIntoPass = passCount > 0;
+		if (fitsIntoPass) {
+			const unsigned int pass = passCount - 1;
+			for (unsigned int other = passFirstView[pass]; other < passFirstView[pass] + passViewCount[pass]; other++) {
+				if (viewportsOverlap(views[v].viewport, views[other].viewport)) {
+					fitsIntoPass = false;
+				}
+			}
+		}
+		if (fitsIntoPass) {
+			passViewCount[passCount - 1]++;
+		}
+		else {
+			passFirstView[passCount] = v;
+			passViewCount[passCount] = 1;
+			passCount++;
+		}
+	}
+}
+
+// Takes the frustum planes apart from the combined view and projection matrix
+// Each plane is the sum or difference of the matrix' last row and one of the other rows
+void extractFrustumPlanes(const glm::mat4& viewProjectionMatrix, glm::vec4* planes) {
+	const glm::mat4& m = viewProjectionMatrix;
+	for (int axis = 0; axis < 3; axis++) {
+		for (int side = 0; side < 2; side++) {
+			const float sign = side == 0 ? 1.0f : -1.0f;
+			glm::vec4 plane = glm::vec4(
+				m[0][3] + sign * m[0][axis],
+				m[1][3] + sign * m[1][axis],
+				m[2][3] + sign * m[2][axis],
+				m[3][3] + sign * m[3][axis]);
+			// Normalizing makes w the actual distance, which the sphere test needs
+			planes[axis * 2 + side] = plane / glm::length(glm::vec3(plane.x, plane.y, plane.z));
+		}
+	}
+}
+
+//** Public **//
+void Views::initialize() {
+	//* Initialize a uniform buffer object (UBO) that manages uniforms across all shaders
+	// Saving the need to set the same uniforms for each shader individually
+	// We'll use this to share the view matrices and projection matrices of all views between shaders
+	// The GLBuffer creates the buffer and deletes it again once it is reset or destroyed
+	matricesUBO = GLBuffer(GLMemoryCategory::Uniforms, "View matrices");
+	// Tells OpenGL we are currently working with this UBO
+	glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO.getID());
+	// Here the actual data copying happens
+	// First argument is the buffer type, second argument is the size of the UBO
+	// Third argument is a pointer to the data, but since we don't have any data yet, we give nullptr
+	// 4th argument tells OpenGL how to handle the data. "Dynamic draw" specifies that the data changes often and is used many times
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(ViewMatrices), nullptr, GL_DYNAMIC_DRAW);
+	matricesUBO.setSize(sizeof(ViewMatrices));
+	// Link the UBO to binding point 0
+	// The binding point is a kind of register that tells each shader where to look for the UBO that needs to be used
+	glBindBufferBase(GL_UNIFORM_BUFFER, matricesBindingPoint, matricesUBO.getID());
+}
+
+void Views::shutdown() {
+	matricesUBO.reset();
+}
+
+void Views::clearViews() {
+	viewCount = 0;
+	passCount = 0;
+}
+
+// The first view is the primary one: the lights are binned for it
+void Views::addView(Camera& camera, const glm::vec4& viewport) {
+	if (viewCount == maxViewCount) {
+		std::cout << "Error: No more than " << maxViewCount << " views are supported" << std::endl;
+		return;
+	}
+	views[viewCount].camera = &camera;
+	views[viewCount].viewport = viewport;
+	viewCount++;
+	groupPasses();
+	updateAspectRatios();
+}
+
+unsigned int Views::getViewCount() {
+	return viewCount;
+}
+
+const View& Views::getView(const unsigned int index) {
+	return views[index];
+}
+
+// Matches the cameras' projections to the shape of their viewports. Should be called whenever the window's size changes
+void Views::updateAspectRatios() {
+	for (unsigned int v = 0; v < viewCount; v++) {
+		views[v].camera->aspectRatio = Window::getAspectRatio() * views[v].viewport.z / views[v].viewport.w;
+		views[v].camera->updateProjectionMatrix();
+	}
+}
+
+// Uploads the matrices of all views at once and prepares culling. Should be called once per frame before anything is drawn
+void Views::update() {
+	for (unsigned int v = 0; v < viewCount; v++) {
+		const Camera& camera = *views[v].camera;
+		viewMatrices.viewMatrices[v] = camera.viewMatrix;
+		viewMatrices.projectionMatrices[v] = camera.projectionMatrix;
+		const glm::vec4& viewport = views[v].viewport;
+		viewMatrices.viewportTransforms[v] = glm::vec4(viewport.z, viewport.w, 2.0f * viewport.x + viewport.z - 1.0f, 2.0f * viewport.y + viewport.w - 1.0f);
+		extractFrustumPlanes(camera.projectionMatrix * camera.viewMatrix, frustumPlanes[v]);
+	}
+	// Copy everything but the pass' views into the UBO, which are set with every pass
+	// First argument is the buffer type, second argument is the offset, third argument the data size and 4th argument a pointer to the data
+	glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(ViewMatrices, passViews), &viewMatrices);
+	// The time comes after the pass' views; it is the only value the animated cubes need per frame, however many there are
+	viewMatrices.animation = glm::vec4(Clock::getTime(), 0.0f, 0.0f, 0.0f);
+	glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ViewMatrices, animation), sizeof(viewMatrices.animation), &viewMatrices.animation);
+
+	// The lights are binned in the primary view's space and across its frustum
+	if (viewCount > 0) {
+		ClusteredLighting::setViewMatrix(views[0].camera->viewMatrix);
+		ClusteredLighting::setProjectionMatrix(views[0].camera->projectionMatrix);
+	}
+}
+
+// Tests a bounding sphere against the union of all view frusta: true if any view may see it
+bool Views::isVisible(const glm::vec3& center, const float radius) {
+	for (unsigned int v = 0; v < viewCount; v++) {
+		bool inside = true;
+		for (unsigned int p = 0; p < 6 && inside; p++) {
+			const glm::vec4& plane = frustumPlanes[v][p];
+			inside = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -radius;
+		}
+		if (inside) {
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int Views::getPassCount() {
+	return passCount;
+}
+
+// Clears the viewports of the pass and selects its views. Returns the number of views, which is the instance count per object
+unsigned int Views::beginPass(const unsigned int pass) {
+	if (pass == 0) {
+		// The 4 clip distances keep every view inside of its own viewport (see the vertex shaders)
+		for (int i = 0; i < 4; i++) {
+			glEnable(GL_CLIP_DISTANCE0 + i);
+		}
+		Render::clearWindow();
+	}
+	else {
+		//* Later passes draw over earlier ones, so only their own viewports are cleared
+		// The scissor test limits glClear() to the given rectangle (in pixels)
+		unsigned int renderWidth, renderHeight;
+		DynamicResolution::getRenderSize(renderWidth, renderHeight);
+		glEnable(GL_SCISSOR_TEST);
+		for (unsigned int v = passFirstView[pass]; v < passFirstView[pass] + passViewCount[pass]; v++) {
+			const glm::vec4& viewport = views[v].viewport;
+			const int x = (int)(viewport.x * renderWidth + 0.5f), y = (int)(viewport.y * renderHeight + 0.5f);
+			glScissor(x, y, (int)((viewport.x + viewport.z) * renderWidth + 0.5f) - x, (int)((viewport.y + viewport.w) * renderHeight + 0.5f) - y);
+			Render::clearWindow();
+		}
+		glDisable(GL_SCISSOR_TEST);
+	}
+
+	viewMatrices.passViews[0] = passFirstView[pass];
+	viewMatrices.passViews[1] = passViewCount[pass];
+	glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO.getID());
+	glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ViewMatrices, passViews), sizeof(viewMatrices.passViews), viewMatrices.passViews);
+	return passViewCount[pass];
+}
+
+// Should be called after the last pass
+void Views::endPasses() {
+	for (int i = 0; i < 4; i++) {
+		glDisable(GL_CLIP_DISTANCE0 + i);
+	}
+}
\ No newline at end of file
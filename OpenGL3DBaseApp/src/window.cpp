@@ -1,10 +1,11 @@
 #include <iostream>
 
 #include "window.hpp"
-#include "resourceManager.hpp"
+#include "views.hpp"
 
 //** Private **//
 float aspectRatio;
+unsigned int framebufferWidth, framebufferHeight;
 
 // Resize viewport if user resizes the window
 void resizeWindow(GLFWwindow* window, int width, int height) {
@@ -13,9 +14,11 @@ void resizeWindow(GLFWwindow* window, int width, int height) {
     // Third and 4th argument should be self explanatory
     glViewport(0, 0, width, height);
 
-    // Calculate the new aspect ratio and update the projection matrix (changes when aspect ratio is altered)
+    // Calculate the new aspect ratio and update the projection matrices of all views (change when aspect ratio is altered)
+    framebufferWidth = width;
+    framebufferHeight = height;
     aspectRatio = (float)width / height;
-    ResourceManager::giveCamera().updateProjectionMatrix();
+    Views::updateAspectRatios();
 }
 
 //** Public **//
@@ -39,6 +42,8 @@ GLFWwindow& Window::initialize() {
     GLFWwindow& window = *glfwCreateWindow(initialWidth, initialHeight, "OpenGL3DBaseApp", nullptr, nullptr);
     // Sets the current context to the window we created. Important as all drawing happens on the current context only
     glfwMakeContextCurrent(&window);
+    framebufferWidth = initialWidth;
+    framebufferHeight = initialHeight;
     aspectRatio = (float)initialWidth / initialHeight;
 
     //* Initialize GLAD
@@ -61,6 +66,24 @@ GLFWwindow& Window::initialize() {
     return window;
 }
 
+// Creates an invisible window whose OpenGL context shares its objects (buffers, textures, sync objects, ...) with the given window's context
+// Another thread can make it current and fill objects that the main thread then draws with. VAOs and framebuffers are never shared though
+// Has to be called on the main thread like every other GLFW function that creates windows. Returns nullptr if it fails
+GLFWwindow* Window::createSharedContext(GLFWwindow& window) {
+    // The context needs a window, but nobody should ever see it
+    // The version and profile hints from Window::initialize() are still set, so both contexts are alike
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    // This time, the 5th argument is the window whose context shares its objects with the new one
+    GLFWwindow* sharedContext = glfwCreateWindow(1, 1, "OpenGL3DBaseApp loader", nullptr, &window);
+    // Hints stay set until they are changed, so windows created later would be invisible as well
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (sharedContext == nullptr) {
+        std::cout << "Error: Failed to create a shared OpenGL context" << std::endl;
+    }
+    return sharedContext;
+}
+
 void Window::getMonitorScreenSize(unsigned int& width, unsigned int& height) {
     // Fetch the current monitor
     GLFWmonitor& monitor = *glfwGetPrimaryMonitor();
@@ -72,4 +95,9 @@ void Window::getMonitorScreenSize(unsigned int& width, unsigned int& height) {
 
 float Window::getAspectRatio() {
     return aspectRatio;
+}
+
+void Window::getFramebufferSize(unsigned int& width, unsigned int& height) {
+    width = framebufferWidth;
+    height = framebufferHeight;
 }
\ No newline at end of file